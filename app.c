@@ -57,6 +57,9 @@
 #include "src/oscillators.h"
 #include "src/irq.h"
 #include "src/scheduler.h"
+#include "src/trace.h"
+#include "src/profile.h"
+#include "src/dispatch.h"
 
 // See: https://docs.silabs.com/gecko-platform/latest/service/power_manager/overview
 #if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
@@ -176,11 +179,17 @@ SL_WEAK void app_init(void)
 
   gpioInit();
 
+  bleRoleSelect();                  //Server or client for this boot, PB1 held through reset picks the other role
+
   gpio_ext_init();
 
   letimer_init();                   //Initialize the LETIMER0 peripheral
 
   letimer_irq_init();               //Initialize the LETIMER0 interrupts
+
+  traceInit();                      //Start the DWT cycle counter for the event trace
+
+  profileInit();                    //Clear the profiling probes
 }
 
 
@@ -211,19 +220,21 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   // Just a trick to hide a compiler warning about unused input parameter evt.
   (void) evt;
 
-  handle_ble_event(evt); // put this code in ble.c/.h
-
-#if DEVICE_IS_BLE_SERVER
-
-  // sequence through states driven by events
-  temperature_state_machine(evt);    // put this code in scheduler.c/.h
-
-#else
-
-  discovery_state_machine(evt);
-
-#endif
-
+  TRACE_ENTER();
+
+  PROFILE_START(PROFILE_HANDLE_BLE_EVENT);
+  bleDispatch(evt);                  // every handler, the state machines included, is registered in src/dispatch.c
+  PROFILE_STOP(PROFILE_HANDLE_BLE_EVENT);
+
+  //External signals are recorded by their signal mask so each source gets its own latency bucket
+  if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_system_external_signal_id)
+    {
+      TRACE_EXIT(TRACE_TYPE_EXT_SIGNAL, evt->data.evt_system_external_signal.extsignals);
+    }
+  else
+    {
+      TRACE_EXIT(TRACE_TYPE_BT_EVENT, SL_BT_MSG_ID(evt->header));
+    }
 
 
 } // sl_bt_on_event()
@@ -25,6 +25,13 @@ extern const sli_bt_gattdb_t gattdb;
 #define gattdb_rgb_state                      35
 #define gattdb_gesture_state                  39
 #define gattdb_ota_control                    43
+#define gattdb_ota_data                       45
+#define gattdb_trace_data                     48
+#define gattdb_profile_data                   50
+#define gattdb_link_telemetry                 52
+#define gattdb_throughput_source              55
+#define gattdb_throughput_sink                58
+#define gattdb_throughput_control             60
 
 
 #endif // __GATT_DB_H
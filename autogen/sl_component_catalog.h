@@ -6,6 +6,9 @@
 #define SL_CATALOG_APP_LOG_PRESENT
 #define SL_CATALOG_BLUETOOTH_FEATURE_ADVERTISER_PRESENT
 #define SL_CATALOG_BLUETOOTH_FEATURE_CONNECTION_PRESENT
+#define SL_CATALOG_BLUETOOTH_FEATURE_L2CAP_PRESENT
+#define SL_CATALOG_BLUETOOTH_FEATURE_NVM_PRESENT
+#define SL_CATALOG_BLUETOOTH_FEATURE_POWER_CONTROL_PRESENT
 #define SL_CATALOG_BLUETOOTH_PRESENT
 #define SL_CATALOG_DEVICE_INIT_NVIC_PRESENT
 #define SL_CATALOG_EMLIB_CORE_DEBUG_CONFIG_PRESENT
@@ -53,6 +53,9 @@ sl_iostream_t *sl_iostream_vcom_handle = &sl_iostream_vcom.stream;
 sl_iostream_uart_t *sl_iostream_uart_vcom_handle = &sl_iostream_vcom;
 static sl_iostream_usart_context_t  context_vcom;
 static uint8_t  rx_buffer_vcom[SL_IOSTREAM_USART_VCOM_RX_BUFFER_SIZE];
+#if defined(SL_IOSTREAM_USART_VCOM_TX_BUFFER_SIZE) && (SL_IOSTREAM_USART_VCOM_TX_BUFFER_SIZE > 0)
+static uint8_t  tx_buffer_vcom[SL_IOSTREAM_USART_VCOM_TX_BUFFER_SIZE];
+#endif
 sl_iostream_instance_info_t sl_iostream_instance_vcom_info = {
   .handle = &sl_iostream_vcom.stream,
   .name = "vcom",
@@ -103,6 +106,14 @@ sl_status_t sl_iostream_usart_init_vcom(void)
 #endif
 #else
     .usart_location = SL_IOSTREAM_USART_VCOM_ROUTE_LOC,
+#endif
+#if defined(SL_IOSTREAM_USART_VCOM_TX_BUFFER_SIZE) && (SL_IOSTREAM_USART_VCOM_TX_BUFFER_SIZE > 0)
+    .tx_buffer = tx_buffer_vcom,
+    .tx_buffer_length = SL_IOSTREAM_USART_VCOM_TX_BUFFER_SIZE,
+    .tx_overflow_policy = SL_IOSTREAM_USART_VCOM_TX_OVERFLOW_POLICY,
+#else
+    .tx_buffer = NULL,
+    .tx_buffer_length = 0,
 #endif
   };
   sl_iostream_uart_config_t uart_config_vcom = {
@@ -5,7 +5,7 @@
 // <o SL_BT_CONFIG_USER_ADVERTISERS> Max number of advertisers reserved for user <0-8>
 // <i> Default: 1
 // <i> Define the number of advertisers the application needs.
-#define SL_BT_CONFIG_USER_ADVERTISERS     (1)
+#define SL_BT_CONFIG_USER_ADVERTISERS     (2)
 // <<< end of configuration section >>>
 
 #endif
\ No newline at end of file
@@ -28,7 +28,11 @@
 // <o SL_BT_CONFIG_MAX_SOFTWARE_TIMERS> Max number of software timers <0-16>
 // <i> Default: 4
 // <i> Define the number of software timers the application needs.  Each timer needs resources from the stack to be implemented. Increasing amount of soft timers may cause degraded performance in some use cases.
-#define SL_BT_CONFIG_MAX_SOFTWARE_TIMERS     (4)
+//
+// One per soft timer handle of the application, all of them can run at once:
+//   2 LCD_TIMER_HANDLE (src/lcd.h), 3 CB_TIMER_HANDLE (src/ble.h), 4 THROUGHPUT_TIMER_HANDLE (src/throughput.h),
+//   5 OTA_TIMER_HANDLE (src/ota.h), 6 TRACE_TIMER_HANDLE (src/trace.h)
+#define SL_BT_CONFIG_MAX_SOFTWARE_TIMERS     (5)
 
 #ifdef SL_CATALOG_BLUETOOTH_FEATURE_SYNC_PRESENT
 #include "sl_bluetooth_periodic_sync_config.h"
@@ -48,7 +52,16 @@
 // <i> advertising and scanning. The default value is an estimation for achieving adequate throughput
 // <i> and supporting multiple simultaneous connections. Consider increasing this value for
 // <i> higher data throughput over connections, advertising or scanning long advertisement data.
-#define SL_BT_CONFIG_BUFFER_SIZE    (3150)
+//
+// Sized for this application instead of the default:
+//     3150  default pool: stack internals, the 2 advertising sets and the scanner
+//   + 4208  8 links (SL_BT_CONFIG_MAX_CONNECTIONS) x 526: one ATT PDU queued each way at the 247 byte MTU,
+//           263 bytes each with the L2CAP header and buffer bookkeeping, so a queued indication on every
+//           link and the writes and reads of the client fit at once
+//   + 2080  the bulk channel (BULK_BUFFER_RESERVE in src/bulk.h): 4 credits x 260 bytes each way, so one bulk
+//           peer can not starve the indications of the other 7 links
+//   = 9438, rounded up to 9440
+#define SL_BT_CONFIG_BUFFER_SIZE    (9440)
 
 // </h> End Bluetooth Stack Configuration
 
@@ -5,6 +5,8 @@
 // <o SL_BT_CONFIG_MAX_CONNECTIONS> Max number of connections reserved for user <0-32>
 // <i> Default: 4
 // <i> Define the number of connections the application needs.
-#define SL_BT_CONFIG_MAX_CONNECTIONS     (4)
+// The stack buffer pool, SL_BT_CONFIG_BUFFER_SIZE in sl_bluetooth_config.h, holds a queued ATT PDU each way
+// per connection, resize it with this count. The soft timers do not depend on it, they are one per module.
+#define SL_BT_CONFIG_MAX_CONNECTIONS     (8)
 // <<< end of configuration section >>>
 #endif
\ No newline at end of file
@@ -66,6 +66,18 @@
 // <i> Default: 32
 #define SL_IOSTREAM_USART_VCOM_RX_BUFFER_SIZE    32
 
+// <o SL_IOSTREAM_USART_VCOM_TX_BUFFER_SIZE> Transmit buffer size
+// <i> Default: 0
+// <i> Size of the ring drained by the TX interrupt. 0 keeps the synchronous, byte by byte transmit.
+#define SL_IOSTREAM_USART_VCOM_TX_BUFFER_SIZE    256
+
+// <o SL_IOSTREAM_USART_VCOM_TX_OVERFLOW_POLICY> Transmit buffer overflow policy
+// <SL_IOSTREAM_USART_TX_OVERFLOW_DROP=> Drop the new character
+// <SL_IOSTREAM_USART_TX_OVERFLOW_BLOCK=> Block until there is room
+// <SL_IOSTREAM_USART_TX_OVERFLOW_OVERWRITE=> Overwrite the oldest character
+// <i> Default: SL_IOSTREAM_USART_TX_OVERFLOW_BLOCK
+#define SL_IOSTREAM_USART_VCOM_TX_OVERFLOW_POLICY    SL_IOSTREAM_USART_TX_OVERFLOW_BLOCK
+
 // <q SL_IOSTREAM_USART_VCOM_CONVERT_BY_DEFAULT_LF_TO_CRLF> Convert \n to \r\n
 // <i> It can be changed at runtime using the C API.
 // <i> Default: 0
@@ -94,12 +94,35 @@ extern "C" {
  *
  *       SL_IOSTREAM_USART_<instance_name>_RESTRICT_ENERGY_MODE_TO_ALLOW_RECEPTION
  *
+ * ## Buffered transmit
+ *
+ *   When a transmit buffer is configured, characters written to the stream are
+ *   stored in a ring buffer and drained by the TX buffer level (TXBL) interrupt
+ *   instead of being written synchronously. The writer returns as soon as the
+ *   characters are queued. The EM1 requirement is only held while bytes are in
+ *   flight. The behavior when the ring is full is selected per instance:
+ *
+ *       SL_IOSTREAM_USART_<instance_name>_TX_BUFFER_SIZE
+ *       SL_IOSTREAM_USART_<instance_name>_TX_OVERFLOW_POLICY
+ *
+ *   A driver that writes the USART directly, e.g. by LDMA, can arm the TX
+ *   complete (TXC) interrupt and have its callback run from the stream's IRQ
+ *   handler once the last byte has left the shifter, see
+ *   sl_iostream_usart_set_txc_callback().
+ *
  * @{
  ******************************************************************************/
 
 // -----------------------------------------------------------------------------
 // Data Types
 
+/// @brief IO Stream USART transmit buffer overflow policy
+typedef enum {
+  SL_IOSTREAM_USART_TX_OVERFLOW_DROP = 0,       ///< Discard the new character
+  SL_IOSTREAM_USART_TX_OVERFLOW_BLOCK = 1,      ///< Wait until the ISR frees room in the buffer
+  SL_IOSTREAM_USART_TX_OVERFLOW_OVERWRITE = 2,  ///< Discard the oldest queued character
+} sl_iostream_usart_tx_overflow_policy_t;
+
 /// @brief IO Stream USART config
 typedef struct {
   USART_TypeDef *usart;       ///< Pointer to USART peripheral
@@ -122,6 +145,9 @@ typedef struct {
 #else
   uint8_t usart_location;     ///< USART location. Available only on certain devices.
 #endif
+  uint8_t *tx_buffer;         ///< Transmit ring buffer, NULL for synchronous transmit
+  size_t tx_buffer_length;    ///< Transmit ring buffer length
+  sl_iostream_usart_tx_overflow_policy_t tx_overflow_policy; ///< Behavior when the transmit ring is full
 } sl_iostream_usart_config_t;
 
 /// @brief IO Stream USART context
@@ -140,6 +166,14 @@ typedef struct {
   uint8_t rts_pin;            ///< Flow control, RTS pin
   uint8_t flags;
 #endif
+  uint8_t *tx_buffer;         ///< Transmit ring buffer, NULL for synchronous transmit
+  size_t tx_buffer_length;    ///< Transmit ring buffer length
+  volatile uint32_t tx_read_index;  ///< Index in transmit buffer to be sent next
+  volatile uint32_t tx_write_index; ///< Index in transmit buffer to be written to
+  volatile uint32_t tx_count;       ///< Number of characters queued for transmit
+  uint32_t tx_dropped;        ///< Characters lost because the transmit ring was full
+  sl_iostream_usart_tx_overflow_policy_t tx_overflow_policy; ///< Behavior when the transmit ring is full
+  void (*txc_callback)(void); ///< Called from the TXC interrupt, NULL for none
 } sl_iostream_usart_context_t;
 
 // -----------------------------------------------------------------------------
@@ -173,6 +207,18 @@ sl_status_t sl_iostream_usart_init(sl_iostream_uart_t *iostream_uart,
  ******************************************************************************/
 void sl_iostream_usart_irq_handler(void *stream_context);
 
+/*******************************************************************************
+ * Set the function called from the TX complete interrupt.
+ *
+ * @param[in] iostream_uart  IO Stream UART handle.
+ *
+ * @param[in] callback  Called from the IRQ handler each time an armed TXC
+ *                      interrupt fires, NULL for none. The interrupt is
+ *                      disabled again before the call.
+ ******************************************************************************/
+void sl_iostream_usart_set_txc_callback(sl_iostream_uart_t *iostream_uart,
+                                        void (*callback)(void));
+
 /** @} (end addtogroup iostream_usart) */
 /** @} (end addtogroup iostream) */
 
@@ -60,6 +60,11 @@
 static sl_status_t usart_tx(void *context,
                             char c);
 
+static sl_status_t usart_tx_buffered(sl_iostream_usart_context_t *usart_context,
+                                     char c);
+
+static uint8_t pop_tx_data(sl_iostream_usart_context_t *usart_context);
+
 static void usart_enable_rx(void *context);
 
 static sl_status_t usart_deinit(void *context);
@@ -103,6 +108,19 @@ sl_status_t sl_iostream_usart_init(sl_iostream_uart_t *iostream_uart,
   usart_context->rts_port = config->rts_port;
 #endif
 
+  // Transmit ring, drained from the TXBL interrupt when present
+  usart_context->tx_buffer = config->tx_buffer;
+  usart_context->tx_buffer_length = (config->tx_buffer != NULL) ? config->tx_buffer_length : 0;
+  usart_context->tx_read_index = 0;
+  usart_context->tx_write_index = 0;
+  usart_context->tx_count = 0;
+  usart_context->tx_dropped = 0;
+  usart_context->tx_overflow_policy = config->tx_overflow_policy;
+  usart_context->txc_callback = NULL;
+  if ((usart_context->tx_buffer != NULL) && (usart_context->tx_buffer_length == 0)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
   // Enable peripheral clocks
 #if defined(_CMU_HFPERCLKEN0_MASK)
   CMU_ClockEnable(cmuClock_HFPER, true);
@@ -197,6 +215,13 @@ sl_status_t sl_iostream_usart_init(sl_iostream_uart_t *iostream_uart,
   // Enable RX interrupts
   USART_IntEnable(config->usart, USART_IF_RXDATAV);
 
+  // The TX IRQ is only enabled by the UART layer when Power Manager is present,
+  // the buffered transmit path needs it regardless
+  if (usart_context->tx_buffer != NULL) {
+    NVIC_ClearPendingIRQ(uart_config->tx_irq_number);
+    NVIC_EnableIRQ(uart_config->tx_irq_number);
+  }
+
   // Finally enable it
   USART_Enable(config->usart, usartEnable);
 
@@ -223,8 +248,25 @@ void sl_iostream_usart_irq_handler(void *stream_context)
       USART_IntDisable(usart_context->usart, USART_IF_RXDATAV);
     }
   }
+  if ((usart_context->tx_buffer != NULL)
+      && (usart_context->usart->IEN & USART_IEN_TXBL)) {
+    // Refill the USART from the transmit ring while it has room
+    while ((usart_context->tx_count > 0)
+           && (usart_context->usart->STATUS & USART_STATUS_TXBL)) {
+      usart_context->usart->TXDATA = pop_tx_data(usart_context);
+    }
+    if (usart_context->tx_count == 0) {
+      USART_IntDisable(usart_context->usart, USART_IEN_TXBL);
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+      // Last byte is in the shifter, release EM1 once it is on the wire
+      USART_IntClear(usart_context->usart, USART_IF_TXC);
+      USART_IntEnable(usart_context->usart, USART_IF_TXC);
+#endif
+    }
+  }
 #if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
-  if (usart_context->usart->IF & USART_IF_TXC) {
+  if ((usart_context->usart->IEN & USART_IEN_TXC)
+      && (usart_context->usart->IF & USART_IF_TXC)) {
     bool idle;
     USART_IntClear(usart_context->usart, USART_IF_TXC);
     USART_IntDisable(usart_context->usart, USART_IF_TXC);
@@ -232,10 +274,25 @@ void sl_iostream_usart_irq_handler(void *stream_context)
     if (idle == false) {
       USART_IntEnable(usart_context->usart, USART_IF_TXC);
     }
+    if (usart_context->txc_callback != NULL) {
+      usart_context->txc_callback();
+    }
   }
 #endif
 }
 
+/**************************************************************************//**
+ * @brief Set the TX complete callback
+ *****************************************************************************/
+void sl_iostream_usart_set_txc_callback(sl_iostream_uart_t *iostream_uart,
+                                        void (*callback)(void))
+{
+  sl_iostream_usart_context_t *usart_context = (sl_iostream_usart_context_t *)iostream_uart->stream.context;
+
+  // A single word store, the IRQ handler sees either the old or the new callback
+  usart_context->txc_callback = callback;
+}
+
 /*******************************************************************************
  **************************   LOCAL FUNCTIONS   ********************************
  ******************************************************************************/
@@ -248,6 +305,10 @@ static sl_status_t usart_tx(void *context,
 {
   sl_iostream_usart_context_t *usart_context = (sl_iostream_usart_context_t *)context;
 
+  if (usart_context->tx_buffer != NULL) {
+    return usart_tx_buffered(usart_context, c);
+  }
+
   USART_Tx(usart_context->usart, (uint8_t)c);
 
 #if defined(SL_CATALOG_POWER_MANAGER_PRESENT) && !defined(SL_IOSTREAM_UART_FLUSH_TX_BUFFER)
@@ -262,6 +323,80 @@ static sl_status_t usart_tx(void *context,
 
   return SL_STATUS_OK;
 }
+/***************************************************************************//**
+ * Queue a character in the transmit ring and arm the TXBL interrupt
+ ******************************************************************************/
+static sl_status_t usart_tx_buffered(sl_iostream_usart_context_t *usart_context,
+                                     char c)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_ATOMIC();
+  if (usart_context->tx_count >= usart_context->tx_buffer_length) {
+    switch (usart_context->tx_overflow_policy) {
+      case SL_IOSTREAM_USART_TX_OVERFLOW_BLOCK:
+        // Feed the USART from here instead of waiting on the ISR, so that a
+        // write issued from an interrupt or a critical section cannot deadlock.
+        // Interrupts stay enabled while waiting for room in the USART buffer.
+        while (usart_context->tx_count >= usart_context->tx_buffer_length) {
+          CORE_EXIT_ATOMIC();
+          while (!(USART_StatusGet(usart_context->usart) & USART_STATUS_TXBL)) {
+          }
+          CORE_ENTER_ATOMIC();
+          if ((usart_context->tx_count >= usart_context->tx_buffer_length)
+              && (USART_StatusGet(usart_context->usart) & USART_STATUS_TXBL)) {
+            usart_context->usart->TXDATA = pop_tx_data(usart_context);
+          }
+        }
+        break;
+
+      case SL_IOSTREAM_USART_TX_OVERFLOW_OVERWRITE:
+        (void)pop_tx_data(usart_context);
+        usart_context->tx_dropped++;
+        break;
+
+      case SL_IOSTREAM_USART_TX_OVERFLOW_DROP:
+      default:
+        usart_context->tx_dropped++;
+        CORE_EXIT_ATOMIC();
+        return SL_STATUS_FULL;
+    }
+  }
+
+  usart_context->tx_buffer[usart_context->tx_write_index] = (uint8_t)c;
+  usart_context->tx_write_index++;
+  if (usart_context->tx_write_index == usart_context->tx_buffer_length) {
+    usart_context->tx_write_index = 0;
+  }
+  usart_context->tx_count++;
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+  // TXC is re-armed by the ISR once the ring has drained
+  USART_IntDisable(usart_context->usart, USART_IF_TXC);
+#endif
+  USART_IntEnable(usart_context->usart, USART_IEN_TXBL);
+  CORE_EXIT_ATOMIC();
+
+  return SL_STATUS_OK;
+}
+
+/***************************************************************************//**
+ * Pop the oldest character from the transmit ring. Must be called with
+ * interrupts masked and a non-empty ring.
+ ******************************************************************************/
+static uint8_t pop_tx_data(sl_iostream_usart_context_t *usart_context)
+{
+  uint8_t c = usart_context->tx_buffer[usart_context->tx_read_index];
+
+  usart_context->tx_read_index++;
+  if (usart_context->tx_read_index == usart_context->tx_buffer_length) {
+    usart_context->tx_read_index = 0;
+  }
+  usart_context->tx_count--;
+
+  return c;
+}
+
 /***************************************************************************//**
  * Enable ISR on Rx
  ******************************************************************************/
@@ -278,6 +413,20 @@ static sl_status_t usart_deinit(void *context)
 {
   sl_iostream_usart_context_t *usart_context = (sl_iostream_usart_context_t *)context;
 
+  // Flush what is left in the transmit ring
+  if (usart_context->tx_buffer != NULL) {
+    CORE_DECLARE_IRQ_STATE;
+
+    CORE_ENTER_ATOMIC();
+    USART_IntDisable(usart_context->usart, USART_IEN_TXBL);
+    while (usart_context->tx_count > 0) {
+      while (!(USART_StatusGet(usart_context->usart) & USART_STATUS_TXBL)) {
+      }
+      usart_context->usart->TXDATA = pop_tx_data(usart_context);
+    }
+    CORE_EXIT_ATOMIC();
+  }
+
   // Wait until transfer is completed
   while (!(USART_StatusGet(usart_context->usart) & USART_STATUS_TXBL)) {
   }
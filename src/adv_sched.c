@@ -0,0 +1,317 @@
+/**
+ * @file    :   adv_sched.c
+ * @brief   :   API for the server advertising scheduler
+ *
+ *              The current of each step is estimated from the charge of one advertising event and
+ *              the interval, and the charge of every step is summed while the server advertises,
+ *              so each connection reports the time it took and what advertising cost on average.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/adv_sched.h"
+#include "ble_device_type.h"
+
+#if BUILD_INCLUDES_BLE_SERVER
+#include "src/irq.h"
+#include "src/lcd.h"
+#include "src/tx_power.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+//Parameters of one step
+typedef struct
+{
+  uint16_t interval;                //0.625 ms units
+  uint32_t duration_ms;             //0 runs until connected
+}adv_sched_set_t;
+
+typedef enum
+{
+  adv_sched_idle,                   //Connected, or not started yet
+  adv_sched_running,
+  adv_sched_stopped,                //The slow step ran out, waiting for advSchedWake()
+}adv_sched_state_t;
+
+//Connections opened during one step
+typedef struct
+{
+  uint32_t connects;
+  uint32_t connect_ms_total;        //Sum of the times to connect, from the start of advertising
+}adv_sched_stats_t;
+
+static const adv_sched_set_t adv_sched_sets[adv_sched_steps] =
+{
+  [adv_sched_fast]    = { ADV_SCHED_FAST_INTERVAL, ADV_SCHED_FAST_MS },
+  [adv_sched_medium]  = { ADV_SCHED_MEDIUM_INTERVAL, ADV_SCHED_MEDIUM_MS },
+  [adv_sched_backoff] = { ADV_SCHED_BACKOFF_INTERVAL, ADV_SCHED_BACKOFF_MS },
+  [adv_sched_slow]    = { ADV_SCHED_SLOW_INTERVAL, ADV_SCHED_SLOW_MS },
+};
+
+static struct
+{
+  uint8_t handle;
+  adv_sched_state_t state;
+  adv_sched_step_t step;
+  uint32_t start_ms;                //letimerMilliseconds() when advertising started
+  uint32_t step_ms;                 //letimerMilliseconds() when the current step started
+  uint64_t charge_nc;               //Estimated charge of the finished steps since start_ms, 32 bits wrap after about 54 h at the slow step
+  adv_sched_stats_t stats[adv_sched_steps];
+}adv_sched = { .handle = SL_BT_INVALID_ADVERTISING_SET_HANDLE };
+
+
+/*
+ * Returns the estimated average current while advertising in a step
+ *
+ * Parameters:
+ *   adv_sched_step_t step: Step of the schedule
+ *
+ * Returns:
+ *   uint32_t: Current in uA
+ */
+static uint32_t adv_sched_current_ua(adv_sched_step_t step)
+{
+  uint32_t period_ms = ((adv_sched_sets[step].interval * 5) / 8) + ADV_SCHED_ADV_DELAY_MS;
+
+  return ADV_SCHED_SLEEP_UA + (ADV_SCHED_EVENT_CHARGE_NC / period_ms);             //nC per ms is uA
+}
+
+
+/*
+ * Adds the charge of the current step up to now
+ *
+ * Parameters:
+ *   uint32_t now_ms: letimerMilliseconds()
+ *
+ * Returns:
+ *   None
+ */
+static void adv_sched_account(uint32_t now_ms)
+{
+  adv_sched.charge_nc += (uint64_t)(now_ms - adv_sched.step_ms) * adv_sched_current_ua(adv_sched.step);
+  adv_sched.step_ms = now_ms;
+}
+
+
+/*
+ * Returns the average current since advertising started
+ *
+ * Parameters:
+ *   uint32_t now_ms: letimerMilliseconds(), the current step must be accounted up to it
+ *
+ * Returns:
+ *   uint32_t: Current in uA
+ */
+static uint32_t adv_sched_average_ua(uint32_t now_ms)
+{
+  uint32_t elapsed_ms = now_ms - adv_sched.start_ms;
+
+  if(elapsed_ms == 0)
+    return adv_sched_current_ua(adv_sched.step);
+
+  return (uint32_t)(adv_sched.charge_nc / elapsed_ms);
+}
+
+
+/*
+ * Sets the timing of a step and starts advertising with it, the set must not be advertising
+ *
+ * Parameters:
+ *   adv_sched_step_t step: Step of the schedule
+ *
+ * Returns:
+ *   None
+ */
+static void adv_sched_enter(adv_sched_step_t step)
+{
+  sl_status_t error_status;
+  const adv_sched_set_t *set = &adv_sched_sets[step];
+
+  adv_sched.step = step;
+  adv_sched.step_ms = letimerMilliseconds();
+
+  txPowerAdvertise(adv_sched.handle, step == adv_sched_fast);                //A client that just left is likely close, the later steps reach further
+
+  //The stack ends the step with sl_bt_evt_advertiser_timeout_id once the duration runs out
+  error_status = sl_bt_advertiser_set_timing(adv_sched.handle, set->interval, set->interval, set->duration_ms / 10, 0);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nBluetooth Advertising Handle Setting Timing Parameters Error\r\n");
+
+  error_status = sl_bt_advertiser_start(adv_sched.handle, sl_bt_advertiser_general_discoverable, sl_bt_advertiser_connectable_scannable);
+  if(error_status != SL_STATUS_OK)
+    {
+      LOG_ERROR("\r\nBluetooth Advertising Start Error\r\n");
+      return;
+    }
+
+  adv_sched.state = adv_sched_running;
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Advertising");
+}
+
+
+/*
+ * Takes over the connectable advertising set, called at boot once the set is created
+ *
+ * Parameters:
+ *   uint8_t handle: Advertising set handle
+ *
+ * Returns:
+ *   None
+ */
+void advSchedInit(uint8_t handle)
+{
+  adv_sched.handle = handle;
+  adv_sched.state = adv_sched_idle;
+}
+
+
+/*
+ * Starts advertising with the fast step, called at boot, when a connection closes and while contexts are free after one opens
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void advSchedStart()
+{
+  sl_status_t error_status;
+
+  //A client leaving while others stay connected restarts a schedule that is still running
+  if(adv_sched.state == adv_sched_running)
+    {
+      error_status = sl_bt_advertiser_stop(adv_sched.handle);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nBluetooth Advertising Stop Error\r\n");
+    }
+
+  adv_sched.start_ms = letimerMilliseconds();
+  adv_sched.charge_nc = 0;
+
+  adv_sched_enter(adv_sched_fast);
+}
+
+
+/*
+ * Stops advertising on a new connection and reports the time to connect and the estimated advertising current
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void advSchedConnected()
+{
+  sl_status_t error_status;
+  uint32_t now_ms = letimerMilliseconds();
+  adv_sched_stats_t *stats = &adv_sched.stats[adv_sched.step];
+
+  error_status = sl_bt_advertiser_stop(adv_sched.handle);                    //Stop the advertising since a new connection is found
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nBluetooth Advertising Stop Error\r\n");
+
+  if(adv_sched.state != adv_sched_running)
+    {
+      adv_sched.state = adv_sched_idle;
+      return;
+    }
+
+  adv_sched.state = adv_sched_idle;
+  adv_sched_account(now_ms);
+
+  stats->connects++;
+  stats->connect_ms_total += now_ms - adv_sched.start_ms;
+
+  LOG_INFO("\r\nConnected after %lu ms of advertising in step %d, ~%lu uA on average\r\n", now_ms - adv_sched.start_ms,
+           adv_sched.step, adv_sched_average_ua(now_ms));
+
+  for(uint32_t i = 0; i < adv_sched_steps; i++)
+    {
+      if(adv_sched.stats[i].connects == 0)
+        continue;
+
+      LOG_INFO("\r\nAdvertising step %lu, %lu ms interval, ~%lu uA: %lu connections, %lu ms mean time to connect\r\n", i,
+               (adv_sched_sets[i].interval * 5) / 8, adv_sched_current_ua(i), adv_sched.stats[i].connects,
+               adv_sched.stats[i].connect_ms_total / adv_sched.stats[i].connects);
+    }
+}
+
+
+/*
+ * Moves on to the next step when the duration of the current one ends, or stops after the slow step
+ *
+ * Parameters:
+ *   uint8_t handle: Advertising set handle from sl_bt_evt_advertiser_timeout_id
+ *
+ * Returns:
+ *   None
+ */
+void advSchedTimeout(uint8_t handle)
+{
+  uint32_t now_ms = letimerMilliseconds();
+
+  //A timeout queued behind the connection opened event is stale
+  if((handle != adv_sched.handle) || (adv_sched.state != adv_sched_running))
+    return;
+
+  adv_sched_account(now_ms);
+
+  if(adv_sched.step < adv_sched_slow)
+    {
+      adv_sched_enter(adv_sched.step + 1);
+      return;
+    }
+
+  adv_sched.state = adv_sched_stopped;
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Adv Stopped");
+
+  LOG_INFO("\r\nAdvertising stopped after %lu ms without a connection, ~%lu uA on average\r\n", now_ms - adv_sched.start_ms,
+           adv_sched_average_ua(now_ms));
+}
+
+
+/*
+ * Restarts the fast step while not connected, called on a button press or any local event that means a
+ * client is likely looking for the server
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void advSchedWake()
+{
+  sl_status_t error_status;
+
+  switch(adv_sched.state)
+  {
+    case adv_sched_running:
+      if(adv_sched.step == adv_sched_fast)
+        break;
+
+      //The time to connect still counts from the disconnect, only the interval goes back to fast
+      error_status = sl_bt_advertiser_stop(adv_sched.handle);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nBluetooth Advertising Stop Error\r\n");
+
+      adv_sched_account(letimerMilliseconds());
+      adv_sched_enter(adv_sched_fast);
+      break;
+
+    case adv_sched_stopped:
+      advSchedStart();
+      break;
+
+    default:
+      break;
+  }
+}
+
+#endif   //BUILD_INCLUDES_BLE_SERVER
@@ -0,0 +1,114 @@
+/**
+ * @file    :   adv_sched.h
+ * @brief   :   Headers and function definitions for the server advertising scheduler
+ *
+ *              After boot and after every disconnect the server advertises in a fast burst for
+ *              quick reconnection, then backs off step by step to a slow interval. Each step runs
+ *              for the stack's advertising duration, so no soft timer is needed to move on.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef ADV_SCHED_H
+#define ADV_SCHED_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+
+//Steps of the schedule: interval in 0.625 ms units and time in the step in ms, 0 for the last step runs until connected
+#define ADV_SCHED_FAST_INTERVAL (48)              //30 ms
+#define ADV_SCHED_FAST_MS (30000)
+#define ADV_SCHED_MEDIUM_INTERVAL (244)           //152.5 ms
+#define ADV_SCHED_MEDIUM_MS (30000)
+#define ADV_SCHED_BACKOFF_INTERVAL (668)          //417.5 ms
+#define ADV_SCHED_BACKOFF_MS (60000)
+#define ADV_SCHED_SLOW_INTERVAL (1636)            //1022.5 ms
+
+//Time in the slow step before advertising stops until advSchedWake(), 0 keeps advertising. At most 655350 ms
+#define ADV_SCHED_SLOW_MS (0)
+
+//Charge of one legacy advertising event on all 3 channels: TX, the scan request listen window and the radio wake up.
+//An estimate for the BG13 at 0 dBm, calibrate it against Energy Profiler
+#define ADV_SCHED_EVENT_CHARGE_NC (20000)
+
+//Floor current between events in EM2, an estimate
+#define ADV_SCHED_SLEEP_UA (3)
+
+//Mean of the 0 - 10 ms random delay the controller adds to every advertising interval
+#define ADV_SCHED_ADV_DELAY_MS (5)
+
+typedef enum
+{
+  adv_sched_fast,
+  adv_sched_medium,
+  adv_sched_backoff,
+  adv_sched_slow,
+  adv_sched_steps,                  //Number of steps
+}adv_sched_step_t;
+
+
+/*
+ * Takes over the connectable advertising set, called at boot once the set is created
+ *
+ * Parameters:
+ *   uint8_t handle: Advertising set handle
+ *
+ * Returns:
+ *   None
+ */
+void advSchedInit(uint8_t handle);
+
+
+/*
+ * Starts advertising with the fast step, called at boot, when a connection closes and while contexts are free after one opens
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void advSchedStart();
+
+
+/*
+ * Stops advertising on a new connection and reports the time to connect and the estimated advertising current
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void advSchedConnected();
+
+
+/*
+ * Moves on to the next step when the duration of the current one ends, or stops after the slow step
+ *
+ * Parameters:
+ *   uint8_t handle: Advertising set handle from sl_bt_evt_advertiser_timeout_id
+ *
+ * Returns:
+ *   None
+ */
+void advSchedTimeout(uint8_t handle);
+
+
+/*
+ * Restarts the fast step while not connected, called on a button press or any local event that means a
+ * client is likely looking for the server
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void advSchedWake();
+
+
+#endif   //ADV_SCHED_H
@@ -0,0 +1,303 @@
+/**
+ * @file    :   bench.c
+ * @brief   :   API for the end-to-end temperature latency benchmark
+ *
+ *              The two boards do not share a clock, so the client never compares its own
+ *              ticks with server ticks. The server measures the acquisition to send time
+ *              and the indication round trip on its clock and carries both in the stamp,
+ *              the client adds half the round trip as the link time and its own arrival
+ *              to display time measured on its clock.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/bench.h"
+#include "string.h"
+
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+#if BENCH_ENABLE
+#include "stdbool.h"
+#include "ble_device_type.h"
+#include "src/irq.h"
+#include "src/ble.h"
+#include "src/server_conn.h"
+#endif
+
+//Offsets of the stamp fields after the 5 byte HTM value
+#define HTM_VALUE_LEN (5)
+#define BENCH_ACQUISITION_OFFSET (HTM_VALUE_LEN)
+#define BENCH_AGE_OFFSET (HTM_VALUE_LEN + 4)
+#define BENCH_RTT_OFFSET (HTM_VALUE_LEN + 8)
+
+#define BITSTREAM_TO_UINT32(p) ((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+
+
+/*
+ * Clears a set of latency statistics
+ *
+ * Parameters:
+ *   bench_stats_t *stats: Statistics to clear
+ *
+ * Returns:
+ *   None
+ */
+void benchStatsReset(bench_stats_t *stats)
+{
+  memset(stats, 0, sizeof(bench_stats_t));
+}
+
+
+/*
+ * Adds a latency sample
+ *
+ * Parameters:
+ *   bench_stats_t *stats: Statistics to update
+ *   uint32_t latency_us: Sample in microseconds
+ *
+ * Returns:
+ *   None
+ */
+void benchStatsAdd(bench_stats_t *stats, uint32_t latency_us)
+{
+  stats->samples[stats->count % BENCH_WINDOW] = latency_us;
+  stats->count++;
+  stats->total += latency_us;
+
+  if(latency_us > stats->max)
+    stats->max = latency_us;
+}
+
+
+/*
+ * Returns a percentile over the samples held in the window
+ *
+ * Parameters:
+ *   bench_stats_t *stats: Statistics to read
+ *   uint32_t percent: Percentile, 0 to 100
+ *
+ * Returns:
+ *   uint32_t: Latency in microseconds, 0 when there are no samples
+ */
+uint32_t benchStatsPercentile(bench_stats_t *stats, uint32_t percent)
+{
+  uint32_t sorted[BENCH_WINDOW];
+  uint32_t n = (stats->count < BENCH_WINDOW) ? stats->count : BENCH_WINDOW;
+
+  if(n == 0)
+    return 0;
+
+  memcpy(sorted, stats->samples, n * sizeof(uint32_t));
+
+  //Insertion sort, the window is small and this only runs when a summary is printed
+  for(uint32_t i = 1; i < n; i++)
+    {
+      uint32_t value = sorted[i];
+      uint32_t j = i;
+
+      while((j > 0) && (sorted[j - 1] > value))
+        {
+          sorted[j] = sorted[j - 1];
+          j--;
+        }
+      sorted[j] = value;
+    }
+
+  if(percent > 100)
+    percent = 100;
+
+  return sorted[((percent * (n - 1)) + 50) / 100];
+}
+
+
+/*
+ * Prints the count, mean, p50, p90, p99 and max of a set of statistics over VCOM
+ *
+ * Parameters:
+ *   const char *name: Label printed with the summary
+ *   bench_stats_t *stats: Statistics to print
+ *
+ * Returns:
+ *   None
+ */
+void benchStatsPrint(const char *name, bench_stats_t *stats)
+{
+  uint32_t mean = (stats->count != 0) ? (uint32_t)(stats->total / stats->count) : 0;
+
+  LOG_INFO("BENCH %s n=%"PRIu32" mean=%"PRIu32" p50=%"PRIu32" p90=%"PRIu32" p99=%"PRIu32" max=%"PRIu32" us",
+           name, stats->count, mean, benchStatsPercentile(stats, 50), benchStatsPercentile(stats, 90),
+           benchStatsPercentile(stats, 99), stats->max);
+}
+
+
+#if BENCH_ENABLE
+
+#if BUILD_INCLUDES_BLE_SERVER
+
+static uint32_t bench_acquisition_ticks = 0;     //Tick of the underflow that started the sample being measured
+
+static bench_stats_t bench_confirm_stats;        //Underflow to confirmation received, one clock, every link
+static bench_stats_t bench_rtt_stats;            //Indication send to confirmation received, every link
+
+
+/*
+ * Server: marks the start of a measurement, called when the LETIMER0 underflow starts the sensor power up
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void benchServerAcquisition()
+{
+  bench_acquisition_ticks = (uint32_t)letimerLastUnderflowTicks();
+}
+
+
+/*
+ * Server: appends the benchmark stamp after the HTM value being built
+ *
+ * Parameters:
+ *   uint8_t *payload: First byte after the HTM value, BENCH_PAYLOAD_LEN bytes are written
+ *
+ * Returns:
+ *   None
+ */
+void benchServerStamp(uint8_t *payload)
+{
+  UINT32_TO_BITSTREAM(payload, bench_acquisition_ticks);
+  UINT32_TO_BITSTREAM(payload, 0);                      //Age, filled in when the indication is sent
+  UINT32_TO_BITSTREAM(payload, 0);                      //Round trip of the link, filled in when the indication is sent
+}
+
+
+/*
+ * Server: fills in the age and the previous round trip of the link just before the temperature
+ * indication of a connection is handed to the stack
+ *
+ * Parameters:
+ *   struct server_conn *ctx: Connection context, its temperature value holds the stamped indication
+ *
+ * Returns:
+ *   None
+ */
+void benchServerSend(struct server_conn *ctx)
+{
+  server_char_state_t *state = &ctx->chars[server_char_htm];
+  bench_link_t *link = &state->bench;
+  uint8_t *p = &state->value[BENCH_AGE_OFFSET];
+
+  if(state->len < (HTM_VALUE_LEN + BENCH_PAYLOAD_LEN))
+    return;
+
+  //Only counts once the stack takes the indication and marks it in flight, a failed send is stamped again on the retry
+  link->send_ticks = (uint32_t)letimerTicks();
+  link->acquisition_ticks = BITSTREAM_TO_UINT32(&state->value[BENCH_ACQUISITION_OFFSET]);
+
+  UINT32_TO_BITSTREAM(p, link->send_ticks - link->acquisition_ticks);
+  UINT32_TO_BITSTREAM(p, link->last_rtt);
+}
+
+
+/*
+ * Server: records the confirmation of the temperature indication in flight on a connection
+ *
+ * Parameters:
+ *   struct server_conn *ctx: Connection context
+ *
+ * Returns:
+ *   None
+ */
+void benchServerConfirmed(struct server_conn *ctx)
+{
+  server_char_state_t *state = &ctx->chars[server_char_htm];
+  bench_link_t *link = &state->bench;
+  uint32_t now = (uint32_t)letimerTicks();
+
+  if(state->is_in_flight == false)
+    return;
+
+  link->last_rtt = now - link->send_ticks;
+
+  benchStatsAdd(&bench_rtt_stats, (uint32_t)letimerTicksToUs(link->last_rtt));
+  benchStatsAdd(&bench_confirm_stats, (uint32_t)letimerTicksToUs(now - link->acquisition_ticks));
+
+  if((bench_confirm_stats.count % BENCH_SUMMARY_INTERVAL) == 0)
+    {
+      benchStatsPrint("uf_to_confirm", &bench_confirm_stats);
+      benchStatsPrint("indication_rtt", &bench_rtt_stats);
+    }
+}
+
+#endif   //BUILD_INCLUDES_BLE_SERVER
+
+#if BUILD_INCLUDES_BLE_CLIENT
+
+static uint32_t bench_arrival_ticks = 0;         //Client tick the last temperature indication arrived
+
+static bench_stats_t bench_e2e_stats;            //Underflow on the server to LCD updated on the client
+static bench_stats_t bench_server_stats;         //Underflow to indication send, server side
+static bench_stats_t bench_link_stats;           //Half the indication round trip
+static bench_stats_t bench_client_stats;         //Arrival to LCD updated, client side
+
+
+/*
+ * Client: marks the arrival of a temperature indication
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void benchClientArrival()
+{
+  bench_arrival_ticks = (uint32_t)letimerTicks();
+}
+
+
+/*
+ * Client: records a sample once the temperature has been drawn on the LCD
+ *
+ * Parameters:
+ *   const uint8_t *value: Received characteristic value
+ *   size_t len: Length of the value
+ *
+ * Returns:
+ *   None
+ */
+void benchClientDisplayed(const uint8_t *value, size_t len)
+{
+  uint32_t server_us, link_us, client_us;
+
+  if(len < (HTM_VALUE_LEN + BENCH_PAYLOAD_LEN))          //Server is not running the benchmark
+    return;
+
+  if(BITSTREAM_TO_UINT32(&value[BENCH_RTT_OFFSET]) == 0)  //No round trip measured yet for this connection
+    return;
+
+  server_us = (uint32_t)letimerTicksToUs(BITSTREAM_TO_UINT32(&value[BENCH_AGE_OFFSET]));
+  link_us = (uint32_t)letimerTicksToUs(BITSTREAM_TO_UINT32(&value[BENCH_RTT_OFFSET]) / 2);
+  client_us = (uint32_t)letimerTicksToUs((uint32_t)letimerTicks() - bench_arrival_ticks);
+
+  benchStatsAdd(&bench_server_stats, server_us);
+  benchStatsAdd(&bench_link_stats, link_us);
+  benchStatsAdd(&bench_client_stats, client_us);
+  benchStatsAdd(&bench_e2e_stats, server_us + link_us + client_us);
+
+  if((bench_e2e_stats.count % BENCH_SUMMARY_INTERVAL) == 0)
+    {
+      benchStatsPrint("end_to_end", &bench_e2e_stats);
+      benchStatsPrint("server", &bench_server_stats);
+      benchStatsPrint("link", &bench_link_stats);
+      benchStatsPrint("client", &bench_client_stats);
+    }
+}
+
+#endif   //BUILD_INCLUDES_BLE_CLIENT
+
+#endif   //BENCH_ENABLE
@@ -0,0 +1,190 @@
+/**
+ * @file    :   bench.h
+ * @brief   :   Headers and function definitions for the end-to-end temperature latency benchmark
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "stdint.h"
+#include "stddef.h"
+
+//Set to 1 to append the benchmark stamp to every temperature indication and collect latency statistics
+#define BENCH_ENABLE (0)
+
+//Number of latency samples kept for the percentiles
+#define BENCH_WINDOW (64)
+
+//A summary is printed over VCOM after this many samples, 20 samples is one minute at the 3 second period
+#define BENCH_SUMMARY_INTERVAL (20)
+
+//Bytes appended after the 5 byte HTM value: acquisition tick, age at send and previous round trip, all uint32_t LETIMER0 ticks
+#if BENCH_ENABLE
+#define BENCH_PAYLOAD_LEN (12)
+#else
+#define BENCH_PAYLOAD_LEN (0)
+#endif
+
+//Benchmark state of the temperature characteristic on one link, kept in its server_char_state_t
+typedef struct
+{
+  uint32_t send_ticks;              //Tick the in flight indication was handed to the stack
+  uint32_t acquisition_ticks;       //Acquisition tick carried by the in flight indication
+  uint32_t last_rtt;                //Send to confirmation time of the last confirmed indication on the link
+}bench_link_t;
+
+//server_conn_t, declared here because src/server_conn.h includes this header through src/scheduler.h
+struct server_conn;
+
+//Latency samples in microseconds, percentiles are taken over the last BENCH_WINDOW samples
+typedef struct
+{
+  uint32_t samples[BENCH_WINDOW];
+  uint32_t count;                   //Samples added since the last reset
+  uint64_t total;                   //Sum of every sample since the last reset, for the mean
+  uint32_t max;                     //Largest sample since the last reset
+}bench_stats_t;
+
+
+/*
+ * Clears a set of latency statistics
+ *
+ * Parameters:
+ *   bench_stats_t *stats: Statistics to clear
+ *
+ * Returns:
+ *   None
+ */
+void benchStatsReset(bench_stats_t *stats);
+
+
+/*
+ * Adds a latency sample
+ *
+ * Parameters:
+ *   bench_stats_t *stats: Statistics to update
+ *   uint32_t latency_us: Sample in microseconds
+ *
+ * Returns:
+ *   None
+ */
+void benchStatsAdd(bench_stats_t *stats, uint32_t latency_us);
+
+
+/*
+ * Returns a percentile over the samples held in the window
+ *
+ * Parameters:
+ *   bench_stats_t *stats: Statistics to read
+ *   uint32_t percent: Percentile, 0 to 100
+ *
+ * Returns:
+ *   uint32_t: Latency in microseconds, 0 when there are no samples
+ */
+uint32_t benchStatsPercentile(bench_stats_t *stats, uint32_t percent);
+
+
+/*
+ * Prints the count, mean, p50, p90, p99 and max of a set of statistics over VCOM
+ *
+ * Parameters:
+ *   const char *name: Label printed with the summary
+ *   bench_stats_t *stats: Statistics to print
+ *
+ * Returns:
+ *   None
+ */
+void benchStatsPrint(const char *name, bench_stats_t *stats);
+
+
+#if BENCH_ENABLE
+
+/*
+ * Server: marks the start of a measurement, called when the LETIMER0 underflow starts the sensor power up
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void benchServerAcquisition();
+
+
+/*
+ * Server: appends the benchmark stamp after the HTM value being built
+ *
+ * Parameters:
+ *   uint8_t *payload: First byte after the HTM value, BENCH_PAYLOAD_LEN bytes are written
+ *
+ * Returns:
+ *   None
+ */
+void benchServerStamp(uint8_t *payload);
+
+
+/*
+ * Server: fills in the age and the previous round trip of the link just before the temperature
+ * indication of a connection is handed to the stack
+ *
+ * Parameters:
+ *   struct server_conn *ctx: Connection context, its temperature value holds the stamped indication
+ *
+ * Returns:
+ *   None
+ */
+void benchServerSend(struct server_conn *ctx);
+
+
+/*
+ * Server: records the confirmation of the temperature indication in flight on a connection
+ *
+ * Parameters:
+ *   struct server_conn *ctx: Connection context
+ *
+ * Returns:
+ *   None
+ */
+void benchServerConfirmed(struct server_conn *ctx);
+
+
+/*
+ * Client: marks the arrival of a temperature indication
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void benchClientArrival();
+
+
+/*
+ * Client: records a sample once the temperature has been drawn on the LCD
+ *
+ * Parameters:
+ *   const uint8_t *value: Received characteristic value
+ *   size_t len: Length of the value
+ *
+ * Returns:
+ *   None
+ */
+void benchClientDisplayed(const uint8_t *value, size_t len);
+
+#else
+
+static inline void benchServerAcquisition() {}
+static inline void benchServerStamp(uint8_t *payload) { (void)payload; }
+static inline void benchServerSend(struct server_conn *ctx) { (void)ctx; }
+static inline void benchServerConfirmed(struct server_conn *ctx) { (void)ctx; }
+static inline void benchClientArrival() {}
+static inline void benchClientDisplayed(const uint8_t *value, size_t len) { (void)value; (void)len; }
+
+#endif   //BENCH_ENABLE
+
+#endif   //BENCH_H
@@ -14,7 +14,19 @@
 #include "ble_device_type.h"
 #include <math.h>
 #include "src/scheduler.h"
+#include "src/connection.h"
+#include "src/conn_param.h"
+#include "src/throughput.h"
+#include "src/bulk.h"
+#include "src/broadcast.h"
+#include "src/adv_sched.h"
+#include "src/server_conn.h"
+#include "src/tx_power.h"
+#include "src/gateway.h"
+#include "src/bonding.h"
+#include "src/dispatch.h"
 #include "src/gpio.h"
+#include "src/irq.h"
 #include "string.h"
 
 
@@ -23,33 +35,20 @@
 #include "src/log.h"
 
 
-//Advertising and Connection Timing Parameters
-#define MAX_ADVERTISING_TIME (400)
-#define MIN_ADVERTISING_TIME (400)
-#define MAX_CONNECTION_TIME (60)
-#define MIN_CONNECTION_TIME (60)
-#define MIN_CE_LENGTH (0)
-#define MAX_CE_LENGTH (0xFFFF)
-#define SLAVE_LATENCY (3)
-#define CONNECTION_TIMEOUT (70)
-#define ADVERTISING_DURATION (0)
-#define ADVERTISING_MAX_EVENTS (0)
-
+//Scanning and Connection Timing Parameters, advertising timing is set by the advertising scheduler
 #define PASSIVE_SCAN (0)
 #define SCAN_INTERVAL (80)
 #define SCAN_WINDOW (40)
-#define CLIENT_LATENCY (4)
-#define CLIENT_MAX_CE_LENGTH (4)
-#define CLIENT_TIMEOUT (83)
-#define CONFIRM_BONDING (1)
 #define CONFIRM_PASSKEY (1)
-#define BONDING_FLAG (0x2F)
 #define READ_CHAR_ERROR_CODE (0x110F)
 
 //Data structure instance
 ble_data_struct_t ble_data ;
 
-#if (DEVICE_IS_BLE_SERVER == 0)
+//PB0 state, shared by the server and client handlers of the external signal
+static bool ble_button0_pressed = false;
+
+#if BUILD_INCLUDES_BLE_CLIENT
 // -----------------------------------------------
 // Private function, original from Dan Walkes. I fixed a sign extension bug.
 // We'll need this for Client A7 assignment to convert health thermometer
@@ -94,643 +93,962 @@ ble_data_struct_t* getBleDataPtr()
 }
 
 
+#if BUILD_INCLUDES_BLE_SERVER
+/*
+ * Lights LED0 while any client has temperature indications enabled and LED1 while any has gesture indications enabled
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void ble_led_update()
+{
+  if(serverConnAnyEnabled(server_char_htm) == true)
+    gpioLed0SetOn();
+  else
+    gpioLed0SetOff();
+
+  if(serverConnAnyEnabled(server_char_gesture) == true)
+    gpioLed1SetOn();
+  else
+    gpioLed1SetOff();
+}
+#endif
+
+
 /*
- * Event responder for Bluetooth events
+ * Shows the role and the device address at boot
  *
  * Parameters:
- *   sl_bt_msg_t event: Bluetooth events
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
  *
  * Returns:
  *   None
  */
-void handle_ble_event(sl_bt_msg_t *evt)
+void bleBoot(sl_bt_msg_t *evt)
 {
   sl_status_t error_status;
-  static bool button0_pressed = false;
 
-#if(DEVICE_IS_BLE_SERVER == 1)
-  uint8_t button_pressed = 0x01;
-  uint8_t button_released = 0x00;
-#endif
+  (void)evt;
 
-#if(DEVICE_IS_BLE_SERVER == 0)
-  static bool button1_pressed = false;
-  static uint8_t cnt = 1;
-#endif
+  displayPrintf(DISPLAY_ROW_NAME, BLE_DEVICE_TYPE_STRING);
+  displayPrintf(DISPLAY_ROW_ASSIGNMENT, "A9");
 
-  switch (SL_BT_MSG_ID(evt->header))                                                                           //Switching data on the header information
-  {
-#if (DEVICE_IS_BLE_SERVER == 1)
+  error_status =  sl_bt_system_get_identity_address(&ble_data.myAddress, &ble_data.myAddressType);        //On booting event, get the device address
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nBluetooth Booting Error\r\n");
 
-    case sl_bt_evt_system_boot_id:
-      displayInit();
+  displayPrintf(DISPLAY_ROW_BTADDR,"%02x:%02x:%02x:%02x:%02x:%02x",ble_data.myAddress.addr[5], ble_data.myAddress.addr[4], ble_data.myAddress.addr[3], ble_data.myAddress.addr[2] , ble_data.myAddress.addr[1], ble_data.myAddress.addr[0]);
 
-      displayPrintf(DISPLAY_ROW_NAME, BLE_DEVICE_TYPE_STRING);
-      displayPrintf(DISPLAY_ROW_ASSIGNMENT, "A9");
+  connParamLinkInit();
+  broadcastInit();
+}
 
-      error_status =  sl_bt_system_get_identity_address(&ble_data.myAddress, &ble_data.myAddressType);        //On booting event, get the device address
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBluetooth Booting Error\r\n");
 
-      displayPrintf(DISPLAY_ROW_BTADDR,"%02x:%02x:%02x:%02x:%02x:%02x",ble_data.myAddress.addr[5], ble_data.myAddress.addr[4], ble_data.myAddress.addr[3], ble_data.myAddress.addr[2] , ble_data.myAddress.addr[1], ble_data.myAddress.addr[0]);
+/*
+ * Starts tracking the parameters of a new link
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkOpened(sl_bt_msg_t *evt)
+{
+  connParamOpened(evt->data.evt_connection_opened.connection);                    //Fast while the peer discovers and pairs, relaxed once idle
+}
 
-      error_status = sl_bt_advertiser_create_set(&ble_data.advertisingSetHandle);                             //Create an advertising handle
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBluetooth Advertising Handle Setting Error\r\n");
 
-      error_status = sl_bt_advertiser_set_timing(ble_data.advertisingSetHandle, MIN_ADVERTISING_TIME, MAX_ADVERTISING_TIME , ADVERTISING_DURATION , ADVERTISING_MAX_EVENTS);           //Set timing parameters for the advertising handle
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBluetooth Advertising Handle Setting Timing Parameters Error\r\n");
+/*
+ * Records the parameters a link runs with
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_parameters_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkParameters(sl_bt_msg_t *evt)
+{
+  //      PACKSTRUCT( struct sl_bt_evt_connection_parameters_s
+  //      {
+  //        uint8_t  connection;    /**< Connection handle */
+  //        uint16_t interval;      /**< Connection interval. Time = Value x 1.25 ms */
+  //        uint16_t latency;       /**< Peripheral latency (how many connection intervals
+  //                                     the peripheral can skip) */
+  //        uint16_t timeout;       /**< Supervision timeout. Time = Value x 10 ms */
+  //        uint8_t  security_mode; /**< Enum @ref sl_bt_connection_security_t. Connection
+  //                                     security mode. Values:
+  //                                       - <b>sl_bt_connection_mode1_level1 (0x0):</b>
+  //                                         No security
+  //                                       - <b>sl_bt_connection_mode1_level2 (0x1):</b>
+  //                                         Unauthenticated pairing with encryption
+  //                                       - <b>sl_bt_connection_mode1_level3 (0x2):</b>
+  //                                         Authenticated pairing with encryption
+  //                                       - <b>sl_bt_connection_mode1_level4 (0x3):</b>
+  //                                         Authenticated Secure Connections pairing with
+  //                                         encryption using a 128-bit strength
+  //                                         encryption key */
+  //        uint16_t txsize;        /**< Maximum Data Channel PDU Payload size that the
+  //                                     controller can send in an air packet */
+  //      })
+  //      LOG_INFO("\r\nThe time-interval is %d milliseconds\r\n", ((evt->data.evt_connection_parameters.interval * 125)/100));          //Log the set parameters
+  //      LOG_INFO("\r\nThe latency is %d\r\n", evt->data.evt_connection_parameters.latency);
+  //      LOG_INFO("\r\nThe timeout is %d milliseconds\r\n", (evt->data.evt_connection_parameters.timeout * 10));
+  connParamUpdated(&evt->data.evt_connection_parameters);
+}
 
-      error_status = sl_bt_advertiser_start(ble_data.advertisingSetHandle, sl_bt_advertiser_general_discoverable, sl_bt_advertiser_connectable_scannable);   //Start advertising from the client
-      ble_data.is_connection = false;
-      displayPrintf(DISPLAY_ROW_CONNECTION, "Advertising");
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBluetooth Advertising Start Error\r\n");
 
-      uint8_t button_default = 0;
+/*
+ * Records the PHY a link switched to
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_phy_status_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkPhyStatus(sl_bt_msg_t *evt)
+{
+  connParamPhyUpdated(&evt->data.evt_connection_phy_status);
+}
+
 
-      error_status = sl_bt_gatt_server_write_attribute_value(gattdb_gesture_state, 0, 1, &button_default);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nButton Attribute Value Write Error\r\n");
+/*
+ * Records the ATT MTU agreed on a link
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_mtu_exchanged_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkMtuExchanged(sl_bt_msg_t *evt)
+{
+  connParamMtuExchanged(&evt->data.evt_gatt_mtu_exchanged);
+}
 
-      error_status = sl_bt_sm_delete_bondings();
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError Deleting bonding\r\n");
-      else
-        ble_data.is_bonded = false;
 
-      //      error_status = sl_bt_sm_configure(BONDING_FLAG, sm_io_capability_displayyesno);
-      //      if(error_status != SL_STATUS_OK)
-      //        LOG_ERROR("\r\nBonding Error\r\n");
+/*
+ * Stops tracking a link that closed
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkClosed(sl_bt_msg_t *evt)
+{
+  connParamClosed(evt->data.evt_connection_closed.connection);
+  throughputClosed(evt->data.evt_connection_closed.connection);
+}
 
-      break;
 
-      //      PACKSTRUCT( struct sl_bt_evt_connection_opened_s
-      //      {
-      //        bd_addr address;      /**< Remote device address */
-      //        uint8_t address_type; /**< Enum @ref sl_bt_gap_address_type_t. Remote device
-      //                                   address type. Values:
-      //                                     - <b>sl_bt_gap_public_address (0x0):</b> Public
-      //                                       device address
-      //                                     - <b>sl_bt_gap_static_address (0x1):</b> Static
-      //                                       device address
-      //                                     - <b>sl_bt_gap_random_resolvable_address
-      //                                       (0x2):</b> Resolvable private random address
-      //                                     - <b>sl_bt_gap_random_nonresolvable_address
-      //                                       (0x3):</b> Non-resolvable private random
-      //                                       address */
-      //        uint8_t master;       /**< Device role in connection. Values:
-      //                                     - <b>0:</b> Peripheral
-      //                                     - <b>1:</b> Central */
-      //        uint8_t connection;   /**< Handle for new connection */
-      //        uint8_t bonding;      /**< Bonding handle. Values:
-      //                                     - <b>SL_BT_INVALID_BONDING_HANDLE (0xff):</b> No
-      //                                       bonding
-      //                                     - <b>Other:</b> Bonding handle */
-      //        uint8_t advertiser;   /**< The local advertising set that this connection was
-      //                                   opened to. Values:
-      //                                     - <b>SL_BT_INVALID_ADVERTISING_SET_HANDLE
-      //                                       (0xff):</b> Invalid value or not applicable.
-      //                                       Ignore this field
-      //                                     - <b>Other:</b> The advertising set handle */
-      //      })
-    case sl_bt_evt_connection_opened_id:
-      ble_data.connectionSetHandle = evt->data.evt_connection_opened.connection;              //Save the connection handle
-
-      displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
+#if BUILD_INCLUDES_BLE_SERVER
 
-      displayPrintf(DISPLAY_ROW_9, " ");
+/*
+ * Server: creates the advertising set and starts advertising
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerBoot(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
 
-      error_status = sl_bt_advertiser_stop(ble_data.advertisingSetHandle);                    //Stop the advertising since a new connection is found
-      ble_data.is_connection = true;
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBluetooth Advertising Stop Error\r\n");
+  (void)evt;
 
+  error_status = sl_bt_advertiser_create_set(&ble_data.advertisingSetHandle);                             //Create an advertising handle
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nBluetooth Advertising Handle Setting Error\r\n");
 
-      error_status = sl_bt_connection_set_parameters(ble_data.connectionSetHandle, MIN_CONNECTION_TIME , MAX_CONNECTION_TIME, SLAVE_LATENCY, CONNECTION_TIMEOUT, MIN_CE_LENGTH, MAX_CE_LENGTH);      //Set timing parameters for the new connection
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBluetooth Advertising Connection Setup Error\r\n");
+  advSchedInit(ble_data.advertisingSetHandle);
+  advSchedStart();                                                                                         //Fast burst first, then backing off to the slow interval
+
+  ble_data.button_state = 0;                                                                               //Served on gesture reads, see bleServerUserReadRequest()
+  ble_data.connectionSetHandle = SERVER_NO_CONNECTION;
+}
 
-      error_status = sl_bt_sm_configure(BONDING_FLAG, sm_io_capability_displayyesno);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBonding Error\r\n");
 
-      error_status = sl_bt_sm_delete_bondings();
+/*
+ * Server: gives a new client its context and keeps advertising while contexts are free
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerOpened(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  server_conn_t *ctx;
+
+  //      PACKSTRUCT( struct sl_bt_evt_connection_opened_s
+  //      {
+  //        bd_addr address;      /**< Remote device address */
+  //        uint8_t address_type; /**< Enum @ref sl_bt_gap_address_type_t. Remote device
+  //                                   address type. Values:
+  //                                     - <b>sl_bt_gap_public_address (0x0):</b> Public
+  //                                       device address
+  //                                     - <b>sl_bt_gap_static_address (0x1):</b> Static
+  //                                       device address
+  //                                     - <b>sl_bt_gap_random_resolvable_address
+  //                                       (0x2):</b> Resolvable private random address
+  //                                     - <b>sl_bt_gap_random_nonresolvable_address
+  //                                       (0x3):</b> Non-resolvable private random
+  //                                       address */
+  //        uint8_t master;       /**< Device role in connection. Values:
+  //                                     - <b>0:</b> Peripheral
+  //                                     - <b>1:</b> Central */
+  //        uint8_t connection;   /**< Handle for new connection */
+  //        uint8_t bonding;      /**< Bonding handle. Values:
+  //                                     - <b>SL_BT_INVALID_BONDING_HANDLE (0xff):</b> No
+  //                                       bonding
+  //                                     - <b>Other:</b> Bonding handle */
+  //        uint8_t advertiser;   /**< The local advertising set that this connection was
+  //                                   opened to. Values:
+  //                                     - <b>SL_BT_INVALID_ADVERTISING_SET_HANDLE
+  //                                       (0xff):</b> Invalid value or not applicable.
+  //                                       Ignore this field
+  //                                     - <b>Other:</b> The advertising set handle */
+  //      })
+  advSchedConnected();                                                                    //The stack stopped the advertising for the new connection
+
+  //A known client brings its stored bond, the link is encrypted again without pairing once the client asks for security
+  ctx = serverConnAlloc(evt->data.evt_connection_opened.connection, evt->data.evt_connection_opened.bonding);
+  if(ctx == NULL)
+    {
+      LOG_ERROR("\r\nNo context left for connection %d\r\n", evt->data.evt_connection_opened.connection);
+      error_status = sl_bt_connection_close(evt->data.evt_connection_opened.connection);
       if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError Deleting bonding\r\n");
-      else
-        ble_data.is_bonded = false;
+        LOG_ERROR("\r\nError closing connection\r\n");
+      return;
+    }
 
-      error_status = sl_bt_system_set_soft_timer(TICKS_PER_125_MS , CB_TIMER_HANDLE , REPEATING_BUFFER);     //1 Hz timer, 1 second timer, generates event sl_bt_system_set_soft_timer_id
-      if (error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nSoft Timer Error\r\n");
+  ctx->opened_ms = letimerMilliseconds();
 
-      break;
+  if(serverConnCount() < SERVER_MAX_CLIENTS)
+    advSchedStart();                                                                      //Keep advertising for more clients while contexts are free
 
-    case sl_bt_evt_connection_closed_id:
-      error_status = sl_bt_advertiser_start(ble_data.advertisingSetHandle , sl_bt_advertiser_general_discoverable, sl_bt_advertiser_connectable_scannable);    //When connection is closed, start advertising again
-      //      LOG_INFO("\r\nConnection: %d closed due to: %d\r\n", evt->data.evt_connection_closed.connection, evt->data.evt_connection_closed.reason);
-      ble_data.is_connection = false;
-      ble_data.is_htm_indication_enabled = false;
-      ble_data.is_custom_indication_enabled = false;
-      ble_data.is_htm_indication_in_flight = false;
-      displayPrintf(DISPLAY_ROW_CONNECTION, "Advertising");
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBluetooth Advertising Start Error\r\n");
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
 
-      error_status = sl_bt_sm_delete_bondings();
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError Deleting bonding\r\n");
-      else
-        ble_data.is_bonded = false;
+  displayPrintf(DISPLAY_ROW_9, " ");
 
-      displayPrintf(DISPLAY_ROW_9, " ");
+  error_status = sl_bt_system_set_soft_timer(TICKS_PER_125_MS , CB_TIMER_HANDLE , REPEATING_BUFFER);     //1 Hz timer, 1 second timer, generates event sl_bt_system_set_soft_timer_id
+  if (error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nSoft Timer Error\r\n");
+}
+
+
+/*
+ * Server: frees the context of a client that left and advertises again
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerClosed(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx = serverConnFromEvent(evt);
+
+  //      LOG_INFO("\r\nConnection: %d closed due to: %d\r\n", evt->data.evt_connection_closed.connection, evt->data.evt_connection_closed.reason);
+  if(ctx != NULL)
+    linkStatsLog(&ctx->link, ctx->connection);
+  txPowerLinkClosed(ctx, evt->data.evt_connection_closed.reason);                     //Proposes the power of the next connection from this link's margin
+  serverConnFree(ctx);                                                                 //The bond stays stored, only this link is gone
+
+  advSchedStart();                                                                     //When a connection is closed, start advertising again with the fast burst
+  if(serverConnCount() != 0)
+    displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
+
+  displayPrintf(DISPLAY_ROW_9, " ");
+  if(evt->data.evt_connection_closed.connection == ble_data.connectionSetHandle)
+    {
       displayPrintf(DISPLAY_ROW_PASSKEY, " ");
       displayPrintf(DISPLAY_ROW_ACTION, " ");
+      ble_data.connectionSetHandle = SERVER_NO_CONNECTION;
+    }
 
-      gpioLed0SetOff();
-      gpioLed1SetOff();
-      break;
+  ble_led_update();
+}
 
-      //Event to clear the LCD charge every second in repeat mode
-    case sl_bt_evt_system_soft_timer_id:
 
-      if(evt->data.evt_system_soft_timer.handle == CB_TIMER_HANDLE)
-        {
-          uint16_t char_handle;
-          uint8_t data[5];
-          size_t data_len;
-          if((get_queue_depth() != 0) && (ble_data.is_htm_indication_in_flight == false))
-            {
-              read_queue(&char_handle, &data_len, data);
-              //              if(char_handle == gattdb_temperature_measurement)
-              //                {
-              //                  error_status = sl_bt_gatt_server_send_indication(ble_data.connectionSetHandle, char_handle , data_len , &data[0]);
-              //                  if(error_status != SL_STATUS_OK)
-              //                    LOG_ERROR("\r\nError sending indication\r\n");
-              //                  else
-              //                    ble_data.is_htm_indication_in_flight = true;
-              //                }
-              //              else if(char_handle == gattdb_button_state)
-              //                {
-              //                  error_status = sl_bt_gatt_server_send_indication(ble_data.connectionSetHandle, char_handle , data_len , &data[0]);
-              //                  if(error_status != SL_STATUS_OK)
-              //                    LOG_ERROR("\r\nError sending indication\r\n");
-              //                  else
-              //                    ble_data.is_htm_indication_in_flight = true;
-              //                }
-              error_status = sl_bt_gatt_server_send_indication(ble_data.connectionSetHandle, char_handle , data_len , data);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nError sending indication\r\n");
-              else
-                ble_data.is_htm_indication_in_flight = true;
-            }
-        }
+/*
+ * Server: polls the link profile and retries pending indications of every client, pumps the throughput test
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_soft_timer_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerSoftTimer(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx;
 
-      if(evt->data.evt_system_soft_timer.handle == LCD_TIMER_HANDLE)
+  if(evt->data.evt_system_soft_timer.handle == CB_TIMER_HANDLE)
+    {
+      for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
         {
-          displayUpdate();
+          ctx = serverConnSlot(slot);
+          if(ctx == NULL)
+            continue;
+
+          linkStatsPoll(&ctx->link, ctx->connection);
+
+          //Indications waiting, values lately dropped or refused, or a client still setting up the link want the fast profile
+          connParamPoll(ctx->connection, (serverConnBusy(ctx) == true) || (linkStatsCongested(&ctx->link) == true) ||
+                        ((ctx->chars[server_char_htm].is_enabled == false) && ((letimerMilliseconds() - ctx->opened_ms) < CONN_PARAM_SETUP_MS)));
+
+          serverConnFlush(ctx);                                                        //Retries a value the stack had no room for
         }
+    }
 
+  if(evt->data.evt_system_soft_timer.handle == THROUGHPUT_TIMER_HANDLE)
+    throughputServerPump();
+}
 
-      break;
 
-      //      PACKSTRUCT( struct sl_bt_evt_connection_parameters_s
-      //      {
-      //        uint8_t  connection;    /**< Connection handle */
-      //        uint16_t interval;      /**< Connection interval. Time = Value x 1.25 ms */
-      //        uint16_t latency;       /**< Peripheral latency (how many connection intervals
-      //                                     the peripheral can skip) */
-      //        uint16_t timeout;       /**< Supervision timeout. Time = Value x 10 ms */
-      //        uint8_t  security_mode; /**< Enum @ref sl_bt_connection_security_t. Connection
-      //                                     security mode. Values:
-      //                                       - <b>sl_bt_connection_mode1_level1 (0x0):</b>
-      //                                         No security
-      //                                       - <b>sl_bt_connection_mode1_level2 (0x1):</b>
-      //                                         Unauthenticated pairing with encryption
-      //                                       - <b>sl_bt_connection_mode1_level3 (0x2):</b>
-      //                                         Authenticated pairing with encryption
-      //                                       - <b>sl_bt_connection_mode1_level4 (0x3):</b>
-      //                                         Authenticated Secure Connections pairing with
-      //                                         encryption using a 128-bit strength
-      //                                         encryption key */
-      //        uint16_t txsize;        /**< Maximum Data Channel PDU Payload size that the
-      //                                     controller can send in an air packet */
-      //      })
-    case sl_bt_evt_connection_parameters_id:
-      //      LOG_INFO("\r\nThe time-interval is %d milliseconds\r\n", ((evt->data.evt_connection_parameters.interval * 125)/100));          //Log the set parameters
-      //      LOG_INFO("\r\nThe latency is %d\r\n", evt->data.evt_connection_parameters.latency);
-      //      LOG_INFO("\r\nThe timeout is %d milliseconds\r\n", (evt->data.evt_connection_parameters.timeout * 10));
+/*
+ * Server: moves the advertising schedule on to its next step
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_advertiser_timeout_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerAdvertiserTimeout(sl_bt_msg_t *evt)
+{
+  advSchedTimeout(evt->data.evt_advertiser_timeout.handle);
+}
 
-      break;
 
-    case sl_bt_evt_system_external_signal_id:
+/*
+ * Server: PB0 confirms a passkey, updates the gesture characteristic and indicates it to every bonded client
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_external_signal_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerExternalSignal(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  server_conn_t *ctx;
+  uint8_t button_pressed = 0x01;
+  uint8_t button_released = 0x00;
 
-      if(evt->data.evt_system_external_signal.extsignals == event_EXT_BUTTON0_Interrupt)
-        {
-          button0_pressed = !(button0_pressed);
+  if(evt->data.evt_system_external_signal.extsignals == event_EXT_BUTTON0_Interrupt)
+    {
+      ble_button0_pressed = !(ble_button0_pressed);
 
-          if((button0_pressed == true) && (ble_data.is_connection == true))
-            {
-              displayPrintf(DISPLAY_ROW_9, "Button Pressed");
-              ble_data.button_state = button_pressed;
-              error_status = sl_bt_gatt_server_write_attribute_value(gattdb_gesture_state, 0, 1, &button_pressed);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nButton press attribute write error\r\n");
+      if((ble_button0_pressed == true) && (serverConnCount() < SERVER_MAX_CLIENTS))
+        advSchedWake();                                                                //Someone is at the server, advertise fast again
 
-              if ((ble_data.is_bonded == false) && (ble_data.is_connection == true))
-                {
-                  error_status = sl_bt_sm_passkey_confirm(ble_data.connectionSetHandle , 1);
-                  if(error_status != SL_STATUS_OK)
-                    LOG_ERROR("\r\nError confirming passkey\r\n");
-                }
-            }
-          else if (button0_pressed == false)
-            {
-              displayPrintf(DISPLAY_ROW_9, "Button Released");
-              ble_data.button_state = button_released;
-              error_status = sl_bt_gatt_server_write_attribute_value(gattdb_gesture_state, 0, 1, &button_released);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nButton release attribute write error: %d\r\n", error_status);
-            }
+      if((ble_button0_pressed == true) && (serverConnCount() != 0))
+        {
+          displayPrintf(DISPLAY_ROW_9, "Button Pressed");
+          ble_data.button_state = button_pressed;                                      //Gesture reads are answered from this
 
-          if((ble_data.is_bonded == true) && (ble_data.is_connection == true) && (ble_data.is_custom_indication_enabled == true) && (ble_data.is_htm_indication_in_flight == false))
+          ctx = serverConnFind(ble_data.connectionSetHandle);                          //Client showing a passkey
+          if ((ctx != NULL) && (ctx->is_bonded == false))
             {
-              error_status = sl_bt_gatt_server_send_indication(ble_data.connectionSetHandle, gattdb_gesture_state, 1, &ble_data.button_state);
+              error_status = sl_bt_sm_passkey_confirm(ctx->connection , 1);
               if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nButton indication error: %d\r\n", error_status);
-              else
-                ble_data.is_htm_indication_in_flight = true;
+                LOG_ERROR("\r\nError confirming passkey\r\n");
             }
-          else if((ble_data.is_htm_indication_in_flight == true) && (ble_data.is_bonded == true))
-            {
-              write_queue(gattdb_gesture_state, 1, &ble_data.button_state);
-              //              write_queue(gattdb_button_state, 2, &ble_data.button_state);
-            }
-        }
-
-      break;
-
-      //      PACKSTRUCT( struct sl_bt_evt_gatt_server_characteristic_status_s
-      //      {
-      //        uint8_t  connection;          /**< Connection handle */
-      //        uint16_t characteristic;      /**< GATT characteristic handle. This value is
-      //                                           normally received from the
-      //                                           gatt_characteristic event. */
-      //        uint8_t  status_flags;        /**< Enum @ref
-      //                                           sl_bt_gatt_server_characteristic_status_flag_t.
-      //                                           Describes whether Client Characteristic
-      //                                           Configuration was changed or if a
-      //                                           confirmation was received. Values:
-      //                                             - <b>sl_bt_gatt_server_client_config
-      //                                               (0x1):</b> Characteristic client
-      //                                               configuration has been changed.
-      //                                             - <b>sl_bt_gatt_server_confirmation
-      //                                               (0x2):</b> Characteristic confirmation
-      //                                               has been received. */
-      //        uint16_t client_config_flags; /**< Enum @ref
-      //                                           sl_bt_gatt_server_client_configuration_t.
-      //                                           This field carries the new value of the
-      //                                           Client Characteristic Configuration. If the
-      //                                           status_flags is 0x2 (confirmation
-      //                                           received), the value of this field can be
-      //                                           ignored. */
-      //        uint16_t client_config;       /**< The handle of client-config descriptor. */
-      //      })
-    case sl_bt_evt_gatt_server_characteristic_status_id:
-      if((evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_rgb_state) && (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_indication)) //Indication enabled flag
-        {
-          ble_data.is_htm_indication_enabled = true;
-          gpioLed0SetOn();
         }
-      else if((evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_rgb_state) && (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_disable))
+      else if (ble_button0_pressed == false)
         {
-          ble_data.is_htm_indication_enabled = false;
-          gpioLed0SetOff();
+          displayPrintf(DISPLAY_ROW_9, "Button Released");
+          ble_data.button_state = button_released;
         }
 
-
-      if ((evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_rgb_state) && (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation))
+      //Each bonded client gets the gesture on its own link, a temperature indication in flight on it only delays this one
+      for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
         {
-          if(evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_confirmation)
-            ble_data.is_htm_indication_in_flight = false;                                                                          //If the config flag is 0x02, set the indication in flight to false
-        }
-
-      if((evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_gesture_state) && (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_indication)) //Indication enabled flag
-        {
-          ble_data.is_custom_indication_enabled = true;
-          gpioLed1SetOn();
+          ctx = serverConnSlot(slot);
+          if((ctx != NULL) && (ctx->is_bonded == true))
+            serverConnIndicate(ctx, server_char_gesture, &ble_data.button_state, 1);
         }
+    }
+}
 
-      else if ((evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_gesture_state) && (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_disable))
-        {
-          ble_data.is_custom_indication_enabled = false;
-          gpioLed1SetOff();
-        }
 
-      if ((evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_gesture_state) && (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation))
-        {
-          if(evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_confirmation)
-            ble_data.is_htm_indication_in_flight = false;                                                                          //If the config flag is 0x02, set the indication in flight to false
-        }
-      break;
+/*
+ * Server: tracks indication subscriptions and confirmations per client and characteristic
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_server_characteristic_status_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerCharacteristicStatus(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx = serverConnFromEvent(evt);
+  server_char_t characteristic;
+
+  //      PACKSTRUCT( struct sl_bt_evt_gatt_server_characteristic_status_s
+  //      {
+  //        uint8_t  connection;          /**< Connection handle */
+  //        uint16_t characteristic;      /**< GATT characteristic handle. This value is
+  //                                           normally received from the
+  //                                           gatt_characteristic event. */
+  //        uint8_t  status_flags;        /**< Enum @ref
+  //                                           sl_bt_gatt_server_characteristic_status_flag_t.
+  //                                           Describes whether Client Characteristic
+  //                                           Configuration was changed or if a
+  //                                           confirmation was received. Values:
+  //                                             - <b>sl_bt_gatt_server_client_config
+  //                                               (0x1):</b> Characteristic client
+  //                                               configuration has been changed.
+  //                                             - <b>sl_bt_gatt_server_confirmation
+  //                                               (0x2):</b> Characteristic confirmation
+  //                                               has been received. */
+  //        uint16_t client_config_flags; /**< Enum @ref
+  //                                           sl_bt_gatt_server_client_configuration_t.
+  //                                           This field carries the new value of the
+  //                                           Client Characteristic Configuration. If the
+  //                                           status_flags is 0x2 (confirmation
+  //                                           received), the value of this field can be
+  //                                           ignored. */
+  //        uint16_t client_config;       /**< The handle of client-config descriptor. */
+  //      })
+  if((evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_throughput_source) && (evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_client_config))
+    throughputServerConfig(evt->data.evt_gatt_server_characteristic_status.connection, (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_notification));
+
+  characteristic = serverConnChar(evt->data.evt_gatt_server_characteristic_status.characteristic);
+  if((ctx == NULL) || (characteristic == server_char_count))
+    return;
+
+  if(evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_client_config)                         //Indication enabled flag
+    {
+      ctx->chars[characteristic].is_enabled = (evt->data.evt_gatt_server_characteristic_status.client_config_flags == sl_bt_gatt_server_indication);
+      if(ctx->chars[characteristic].is_enabled == false)
+        ctx->chars[characteristic].is_pending = false;
+
+      ble_led_update();
+    }
+  else if(evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation)
+    {
+      if(characteristic == server_char_htm)
+        benchServerConfirmed(ctx);
+
+      serverConnConfirmed(ctx, characteristic);                                                                              //Clears the in flight flag of this characteristic only
+    }
+}
 
-    case sl_bt_evt_gatt_server_indication_timeout_id:
-      //      LOG_INFO("\r\nBluetooth Client Indication Acknowledgement Time-out\r\n");
-      if(ble_data.is_htm_indication_in_flight == true)
-        ble_data.is_htm_indication_in_flight = false;
 
-      ble_data.is_connection = false;
-      break;
+/*
+ * Server: answers reads of the user-type temperature and gesture characteristics. A temperature read
+ * gets the latest sample, or waits for the next one when the latest is stale
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_server_user_read_request_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerUserReadRequest(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx = serverConnFromEvent(evt);
+  uint8_t value[LINK_STATS_TELEMETRY_LEN];                                  //Largest value answered here, the temperature takes TEMPERATURE_VALUE_LEN
 
-    case sl_bt_evt_sm_confirm_bonding_id:
-      error_status = sl_bt_sm_bonding_confirm(ble_data.connectionSetHandle , CONFIRM_BONDING);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError setting up default parameters for the connection\r\n");
-      break;
+  if(ctx == NULL)
+    return;
 
-    case sl_bt_evt_sm_bonded_id:
-      displayPrintf(DISPLAY_ROW_CONNECTION, "Bonded");
-      displayPrintf(DISPLAY_ROW_PASSKEY, " ");
-      displayPrintf(DISPLAY_ROW_ACTION, " ");
-      ble_data.is_bonded = true;
+  switch(evt->data.evt_gatt_server_user_read_request.characteristic)
+  {
+    case gattdb_rgb_state:
+      if(temperatureLatest(value) == true)
+        serverConnReadRespond(ctx->connection, gattdb_rgb_state, evt->data.evt_gatt_server_user_read_request.offset, value, TEMPERATURE_VALUE_LEN);
+      else
+        ctx->chars[server_char_htm].is_read_pending = true;                 //The temperature state machine answers with the next sample
       break;
 
-    case sl_bt_evt_sm_confirm_passkey_id:
-      displayPrintf(DISPLAY_ROW_PASSKEY, "%d", evt->data.evt_sm_confirm_passkey.passkey);
-      displayPrintf(DISPLAY_ROW_ACTION, "Confirm with PB0");
+    case gattdb_gesture_state:
+      serverConnReadRespond(ctx->connection, gattdb_gesture_state, evt->data.evt_gatt_server_user_read_request.offset, &ble_data.button_state, 1);
       break;
 
-    case sl_bt_evt_sm_bonding_failed_id:
-      ble_data.is_bonded = false;
-      LOG_ERROR("\r\nError bonding\r\n");
+    case gattdb_link_telemetry:
+      linkStatsEncode(&ctx->link, value);                                   //The window of the link the read came in on
+      serverConnReadRespond(ctx->connection, gattdb_link_telemetry, evt->data.evt_gatt_server_user_read_request.offset, value, LINK_STATS_TELEMETRY_LEN);
       break;
 
     default:
-      break;
+      break;                                                                //Profile and trace data are answered by their own modules
+  }
+}
+
 
+/*
+ * Server: stops indicating to a client that missed a confirmation
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_server_indication_timeout_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerIndicationTimeout(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx = serverConnFromEvent(evt);
+
+  //      LOG_INFO("\r\nBluetooth Client Indication Acknowledgement Time-out\r\n");
+  //ATT allows nothing more on a link that missed a confirmation, stop indicating to this client only
+  if(ctx != NULL)
+    {
+      linkStatsTimeout(&ctx->link);
+      memset(ctx->chars, 0, sizeof(ctx->chars));
+      ble_led_update();
+    }
+}
+
+#endif   //BUILD_INCLUDES_BLE_SERVER
+
+
+#if BUILD_INCLUDES_BLE_CLIENT
+
+//Connection whose window statistics are on the LCD
+static uint8_t ble_series_connection = CLIENT_NO_CONNECTION;
+
+//Connection the trend plot follows, the first server to indicate until it leaves
+static uint8_t ble_trend_connection = CLIENT_NO_CONNECTION;
+
+
+/*
+ * Client: shows the window statistics of a server, the rows follow the server that indicated last
+ *
+ * Parameters:
+ *   client_conn_t *conn: Server connection
+ *
+ * Returns:
+ *   None
+ */
+static void ble_client_show_series(client_conn_t *conn)
+{
+  series_stats_t stats;
+  int32_t mean_x10;
+
+  seriesStats(&conn->series, &stats);
+  if(stats.count == 0)
+    return;
+
+  mean_x10 = (stats.mean_x10 < 0) ? -stats.mean_x10 : stats.mean_x10;
+  displayPrintf(DISPLAY_ROW_8, "S%"PRIu32" Avg=%s%ld.%ld C", clientConnIndex(conn), (stats.mean_x10 < 0) ? "-" : "",
+                mean_x10 / 10, mean_x10 % 10);
+#if DISPLAY_TREND_ENABLE
+  //DISPLAY_ROW_11 holds the trend plot, DISPLAY_ROW_ASSIGNMENT below it keeps its text
+  displayPrintf(DISPLAY_ROW_10, "%d..%d C Var=%lu.%02lu", stats.min, stats.max, stats.variance_x100 / 100, stats.variance_x100 % 100);
+#else
+  displayPrintf(DISPLAY_ROW_10, "Min=%d Max=%d C", stats.min, stats.max);
+  displayPrintf(DISPLAY_ROW_11, "Var=%lu.%02lu n=%lu", stats.variance_x100 / 100, stats.variance_x100 % 100, stats.count);
 #endif
 
-#if (DEVICE_IS_BLE_SERVER ==  0)
-    case sl_bt_evt_system_boot_id:
-      displayInit();
+  ble_series_connection = conn->connection;
+}
 
-      displayPrintf(DISPLAY_ROW_NAME, "Client");
-      displayPrintf(DISPLAY_ROW_ASSIGNMENT, "A9");
-      error_status = sl_bt_scanner_set_mode(PHYSICAL_LAYER_1M , PASSIVE_SCAN);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError mode setting scanner mode\r\n");
-      error_status = sl_bt_scanner_set_timing(PHYSICAL_LAYER_1M, SCAN_INTERVAL, SCAN_WINDOW);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError setting up bluetooth timing parameters\r\n");
-      error_status = sl_bt_connection_set_default_parameters(MIN_CONNECTION_TIME, MAX_CONNECTION_TIME, CLIENT_LATENCY , CLIENT_TIMEOUT, MIN_CE_LENGTH, CLIENT_MAX_CE_LENGTH);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError setting up default parameters for the connection\r\n");
-      error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
-      displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
 
-      error_status =  sl_bt_system_get_identity_address(&ble_data.myAddress, &ble_data.myAddressType);        //On booting event, get the device address
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBluetooth Booting Error\r\n");
+/*
+ * Client: sets up the scanner and starts looking for servers
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientBoot(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
 
-      displayPrintf(DISPLAY_ROW_BTADDR,"%02x:%02x:%02x:%02x:%02x:%02x",ble_data.myAddress.addr[5], ble_data.myAddress.addr[4], ble_data.myAddress.addr[3], ble_data.myAddress.addr[2] , ble_data.myAddress.addr[1], ble_data.myAddress.addr[0]);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError starting scanning\r\n");
+  (void)evt;
+
+  error_status = sl_bt_scanner_set_mode(PHYSICAL_LAYER_1M , PASSIVE_SCAN);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError mode setting scanner mode\r\n");
+  error_status = sl_bt_scanner_set_timing(PHYSICAL_LAYER_1M, SCAN_INTERVAL, SCAN_WINDOW);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting up bluetooth timing parameters\r\n");
+  connParamSetDefaults();                                                                //New links open fast for discovery
+  clientScannerUpdate();
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
+}
 
-      error_status = sl_bt_sm_delete_bondings();
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError Deleting bonding\r\n");
-      else
-        ble_data.is_bonded = false;
-      break;
 
-    case sl_bt_evt_scanner_scan_report_id:
-      error_status = sl_bt_scanner_stop();
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError stopping scanning\r\n");
+/*
+ * Client: hands a scan report to the connection table, or to the broadcast observer in broadcast mode
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_scanner_scan_report_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientScanReport(sl_bt_msg_t *evt)
+{
+#if BROADCAST_ENABLE
+  //Observer only, every server is read from its advertising data
+  broadcastScanReport(&evt->data.evt_scanner_scan_report);
+#else
+  //Servers advertising our services that are not connected yet, the connection table stops scanning while the open is pending
+  clientConnScanReport(&evt->data.evt_scanner_scan_report);
+#endif
+}
 
-      error_status = sl_bt_connection_open(SERVER_BT_ADDRESS, 0, PHYSICAL_LAYER_1M, &ble_data.connectionSetHandle);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError opening a connection\r\n");
 
-      break;
+/*
+ * Client: the push buttons act on the newest server
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientOpened(sl_bt_msg_t *evt)
+{
+  if(bondingClientPairing() == CLIENT_NO_CONNECTION)
+    ble_data.connectionSetHandle = evt->data.evt_connection_opened.connection;   //The push buttons act on the newest server unless a passkey is waiting for PB0
+}
 
-    case sl_bt_evt_connection_opened_id:
 
-      error_status = sl_bt_sm_configure(BONDING_FLAG, sm_io_capability_displayyesno);
-      if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nBonding Error\r\n");
-      break;
+/*
+ * Client: records the handles of the services discovered on a server
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_service_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientGattService(sl_bt_msg_t *evt)
+{
+  client_conn_t *conn;
+
+  //      if((evt->data.evt_gatt_service.uuid.data[0] == RGB_SERVICE_UUID[0]) && (evt->data.evt_gatt_service.uuid.len == RGB_SERVICE_UUID_LEN))
+  //        {
+  //          ble_data.htmServiceHandle = evt->data.evt_gatt_service.service;
+  //        }
+  //
+  //
+  //      else if((evt->data.evt_gatt_service.uuid.data[0] == GESTURE_SERVICE_UUID[0]) && (evt->data.evt_gatt_service.uuid.len == GESTURE_SERVICE_UUID_LEN))
+  //        {
+  //          ble_data.buttonServiceHandle = evt->data.evt_gatt_service.service;
+  //        }
+  conn = clientConnFromEvent(evt);
+  if(conn == NULL)
+    return;
+
+  if((memcmp(evt->data.evt_gatt_service.uuid.data , RGB_SERVICE_UUID, RGB_SERVICE_UUID_LEN ) == 0))
+    {
+      conn->htmServiceHandle = evt->data.evt_gatt_service.service;
+    }
+
+
+  else if((memcmp(evt->data.evt_gatt_service.uuid.data , GESTURE_SERVICE_UUID, GESTURE_SERVICE_UUID_LEN ) == 0))
+    {
+      conn->buttonServiceHandle = evt->data.evt_gatt_service.service;
+    }
+
+  else if((evt->data.evt_gatt_service.uuid.len == sizeof(GATT_SERVICE_UUID)) &&
+          (memcmp(evt->data.evt_gatt_service.uuid.data, GATT_SERVICE_UUID, sizeof(GATT_SERVICE_UUID)) == 0))
+    {
+      conn->gattServiceHandle = evt->data.evt_gatt_service.service;
+    }
+}
 
-    case  sl_bt_evt_gatt_service_id:
-
-      //      if((evt->data.evt_gatt_service.uuid.data[0] == RGB_SERVICE_UUID[0]) && (evt->data.evt_gatt_service.uuid.len == RGB_SERVICE_UUID_LEN))
-      //        {
-      //          ble_data.htmServiceHandle = evt->data.evt_gatt_service.service;
-      //        }
-      //
-      //
-      //      else if((evt->data.evt_gatt_service.uuid.data[0] == GESTURE_SERVICE_UUID[0]) && (evt->data.evt_gatt_service.uuid.len == GESTURE_SERVICE_UUID_LEN))
-      //        {
-      //          ble_data.buttonServiceHandle = evt->data.evt_gatt_service.service;
-      //        }
-      if((memcmp(evt->data.evt_gatt_service.uuid.data , RGB_SERVICE_UUID, RGB_SERVICE_UUID_LEN ) == 0))
-        {
-          ble_data.htmServiceHandle = evt->data.evt_gatt_service.service;
-        }
 
+/*
+ * Client: records the handles of the characteristics discovered on a server
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_characteristic_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientGattCharacteristic(sl_bt_msg_t *evt)
+{
+  client_conn_t *conn;
+
+  //      ble_data.htmCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
+
+  //      if((evt->data.evt_gatt_characteristic.uuid.data[0] == RGB_CHAR_UUID[0]))
+  //        {
+  //          ble_data.htmCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
+  //        }
+  //
+  //      else if((evt->data.evt_gatt_characteristic.uuid.data[0] == GESTURE_CHAR_UUID[0]))
+  //        {
+  //          ble_data.buttonCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
+  //        }
+
+  conn = clientConnFromEvent(evt);
+  if(conn == NULL)
+    return;
+
+  if(memcmp(evt->data.evt_gatt_characteristic.uuid.data , RGB_CHAR_UUID , 16) == 0)
+    {
+      conn->htmCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
+    }
+
+  else if(memcmp(evt->data.evt_gatt_characteristic.uuid.data , GESTURE_CHAR_UUID , 16) == 0)
+    {
+      conn->buttonCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
+    }
+}
 
-      else if((memcmp(evt->data.evt_gatt_service.uuid.data , GESTURE_SERVICE_UUID, GESTURE_SERVICE_UUID_LEN ) == 0))
-        {
-          ble_data.buttonServiceHandle = evt->data.evt_gatt_service.service;
-        }
-      break;
 
-    case sl_bt_evt_gatt_characteristic_id:
-      //      ble_data.htmCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
+/*
+ * Client: PB0 confirms a passkey and, with PB1, toggles gesture indications; PB1 alone reads the gesture state
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_external_signal_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientExternalSignal(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  client_conn_t *conn;
+  static bool button1_pressed = false;
+  static uint8_t cnt = 1;
 
-      //      if((evt->data.evt_gatt_characteristic.uuid.data[0] == RGB_CHAR_UUID[0]))
-      //        {
-      //          ble_data.htmCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
-      //        }
-      //
-      //      else if((evt->data.evt_gatt_characteristic.uuid.data[0] == GESTURE_CHAR_UUID[0]))
-      //        {
-      //          ble_data.buttonCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
-      //        }
+  conn = clientConnFind(ble_data.connectionSetHandle);                    //Server the push buttons act on
+  if(conn == NULL)
+    return;
 
-      if(memcmp(evt->data.evt_gatt_characteristic.uuid.data , RGB_CHAR_UUID , 16) == 0)
-        {
-          ble_data.htmCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
-        }
+  if(evt->data.evt_system_external_signal.extsignals == event_EXT_BUTTON0_Interrupt)
+    {
+      ble_button0_pressed = !(ble_button0_pressed);
 
-      else if(memcmp(evt->data.evt_gatt_characteristic.uuid.data , GESTURE_CHAR_UUID , 16) == 0)
+      if(ble_button0_pressed == true)
         {
-          ble_data.buttonCharacteristicHandle = evt->data.evt_gatt_characteristic.characteristic;
+          if(conn->is_bonded == false)
+            {
+              error_status = sl_bt_sm_passkey_confirm(conn->connection , 1);
+              if(error_status != SL_STATUS_OK)
+                LOG_ERROR("\r\nError confirming passkey - Client\r\n");
+            }
+          ble_data.indication_flag = 0x000F;
         }
-      break;
-
-    case sl_bt_evt_system_external_signal_id:
 
-      if(evt->data.evt_system_external_signal.extsignals == event_EXT_BUTTON0_Interrupt)
+      else if(ble_button0_pressed == false)
         {
-          button0_pressed = !(button0_pressed);
+          if(ble_data.indication_flag == 0x0FFF)
+            ble_data.indication_flag = 0xFFFF;
 
-          if(button0_pressed == true)
+          if(((ble_data.indication_flag & 0xFFFF) == 0xFFFF) && (conn->is_bonded == true))
             {
-              if(ble_data.is_bonded == false)
+              if(cnt == 1)
                 {
-                  error_status = sl_bt_sm_passkey_confirm(ble_data.connectionSetHandle , 1);
+                  error_status = sl_bt_gatt_set_characteristic_notification(conn->connection, conn->buttonCharacteristicHandle, sl_bt_gatt_disable);
                   if(error_status != SL_STATUS_OK)
-                    LOG_ERROR("\r\nError confirming passkey - Client\r\n");
+                    LOG_ERROR("\r\nError disabling indications: %d\r\n", error_status);
+                  cnt = 0;
                 }
-              ble_data.indication_flag = 0x000F;
-            }
-
-          else if(button0_pressed == false)
-            {
-              if(ble_data.indication_flag == 0x0FFF)
-                ble_data.indication_flag = 0xFFFF;
-
-              if(((ble_data.indication_flag & 0xFFFF) == 0xFFFF) && (ble_data.is_bonded == true))
+              else
                 {
-                  if(cnt == 1)
-                    {
-                      error_status = sl_bt_gatt_set_characteristic_notification(ble_data.connectionSetHandle, ble_data.buttonCharacteristicHandle, sl_bt_gatt_disable);
-                      if(error_status != SL_STATUS_OK)
-                        LOG_ERROR("\r\nError disabling indications: %d\r\n", error_status);
-                      cnt = 0;
-                    }
-                  else
-                    {
-                      error_status = sl_bt_gatt_set_characteristic_notification(ble_data.connectionSetHandle, ble_data.buttonCharacteristicHandle, sl_bt_gatt_indication);
-                      if(error_status != SL_STATUS_OK)
-                        LOG_ERROR("\r\nError enabling indications: %d\r\n", error_status);
-                      cnt = 1;
-                    }
-                  ble_data.indication_flag = 0x0000;
+                  error_status = sl_bt_gatt_set_characteristic_notification(conn->connection, conn->buttonCharacteristicHandle, sl_bt_gatt_indication);
+                  if(error_status != SL_STATUS_OK)
+                    LOG_ERROR("\r\nError enabling indications: %d\r\n", error_status);
+                  cnt = 1;
                 }
+              ble_data.indication_flag = 0x0000;
             }
         }
-      if(evt->data.evt_system_external_signal.extsignals == event_EXT_BUTTON1_Interrupt)
+    }
+  if(evt->data.evt_system_external_signal.extsignals == event_EXT_BUTTON1_Interrupt)
+    {
+      button1_pressed = !(button1_pressed);
+
+      if(button1_pressed == true)
         {
-          button1_pressed = !(button1_pressed);
+          if(conn->is_bonded == false)
+            error_status = sl_bt_gatt_read_characteristic_value(conn->connection , conn->buttonCharacteristicHandle);
 
-          if(button1_pressed == true)
+          if((conn->is_bonded == true))
             {
-              if(ble_data.is_bonded == false)
-                error_status = sl_bt_gatt_read_characteristic_value(ble_data.connectionSetHandle , ble_data.buttonCharacteristicHandle);
-
-              if((ble_data.is_bonded == true))
+              if(!(ble_data.indication_flag & 0x000F))
                 {
-                  if(!(ble_data.indication_flag & 0x000F))
-                    {
-                      error_status = sl_bt_gatt_read_characteristic_value(ble_data.connectionSetHandle  , ble_data.buttonCharacteristicHandle);
-                      if(error_status != SL_STATUS_OK)
-                        LOG_ERROR("\r\nError reading characteristic value for button state characteristic\r\n");
-                    }
+                  error_status = sl_bt_gatt_read_characteristic_value(conn->connection  , conn->buttonCharacteristicHandle);
+                  if(error_status != SL_STATUS_OK)
+                    LOG_ERROR("\r\nError reading characteristic value for button state characteristic\r\n");
                 }
-
-              if(ble_data.indication_flag == 0x000F)
-                ble_data.indication_flag = 0x00FF;
             }
 
-          else if(button1_pressed == false)
-            {
-              if(ble_data.indication_flag == 0x00FF)
-                ble_data.indication_flag = 0x0FFF;
-            }
+          if(ble_data.indication_flag == 0x000F)
+            ble_data.indication_flag = 0x00FF;
         }
 
+      else if(button1_pressed == false)
+        {
+          if(ble_data.indication_flag == 0x00FF)
+            ble_data.indication_flag = 0x0FFF;
+        }
+    }
+}
 
-      break;
 
-      //Event to clear the LCD charge every second in repeat mode
-    case sl_bt_evt_system_soft_timer_id:
-      if(evt->data.evt_system_soft_timer.handle == LCD_TIMER_HANDLE)
-        displayUpdate();
-      break;
+/*
+ * Client: cancels a stuck open and polls every open server once per LCD tick, pumps the throughput test
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_soft_timer_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientSoftTimer(sl_bt_msg_t *evt)
+{
+  client_conn_t *conn;
 
-    case sl_bt_evt_gatt_procedure_completed_id:
+  if(evt->data.evt_system_soft_timer.handle == LCD_TIMER_HANDLE)
+    {
+      clientConnOpenPoll();                         //An open to a server that stopped advertising would block scanning
 
-      if((evt->data.evt_gatt_procedure_completed.result == SL_STATUS_BT_ATT_INSUFFICIENT_ENCRYPTION))
+      //Servers still being discovered keep the fast profile, the rest relax
+      for(uint32_t slot = 0; slot < CLIENT_MAX_SERVERS; slot++)
         {
-          error_status = sl_bt_sm_increase_security(ble_data.connectionSetHandle);
-          if(error_status != SL_STATUS_OK)
-            LOG_ERROR("\r\nError increasing security\r\n");
+          conn = clientConnSlot(slot);
+          if((conn != NULL) && (conn->is_open == true))
+            {
+              connParamPoll(conn->connection, (conn->state != state3_INDICATION_ENABLED));
+              bulkClientPoll(conn->connection, (conn->state == state3_INDICATION_ENABLED));
+              throughputClientPoll(conn->connection, (conn->state == state3_INDICATION_ENABLED));
+            }
         }
-      break;
+    }
 
-    case sl_bt_evt_gatt_characteristic_value_id:
+  if(evt->data.evt_system_soft_timer.handle == THROUGHPUT_TIMER_HANDLE)
+    throughputClientPump();
+}
 
-      if((evt->data.evt_gatt_characteristic_value.characteristic == gattdb_gesture_state))
-        {
-          if(evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_handle_value_indication)
-            {
-              error_status = sl_bt_gatt_send_characteristic_confirmation(ble_data.connectionSetHandle);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nError fetching characteristic notification confirmation: Button : %d\r\n", error_status);
 
-              if(evt->data.evt_gatt_characteristic_value.value.data[0] == 0)
-                displayPrintf(DISPLAY_ROW_9, "Button Released");
+/*
+ * Client: confirms indications and shows the temperature and gesture values of a server
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_characteristic_value_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientCharacteristicValue(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  client_conn_t *conn;
 
-              else if(evt->data.evt_gatt_characteristic_value.value.data[0] == 1)
-                displayPrintf(DISPLAY_ROW_9, "Button Pressed");
+  if((evt->data.evt_gatt_characteristic_value.characteristic == gattdb_throughput_source))
+    throughputClientData(evt->data.evt_gatt_characteristic_value.connection, evt->data.evt_gatt_characteristic_value.value.len);
 
-            }
+  if((evt->data.evt_gatt_characteristic_value.characteristic == gattdb_gesture_state))
+    {
+      if(evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_handle_value_indication)
+        {
+          error_status = sl_bt_gatt_send_characteristic_confirmation(evt->data.evt_gatt_characteristic_value.connection);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError fetching characteristic notification confirmation: Button : %d\r\n", error_status);
 
-          if(evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_read_response)
-            {
-              if(evt->data.evt_gatt_characteristic_value.value.data[0] == 0)
-                displayPrintf(DISPLAY_ROW_9, "Button Released");
+          if(evt->data.evt_gatt_characteristic_value.value.data[0] == 0)
+            displayPrintf(DISPLAY_ROW_9, "Button Released");
 
-              else if(evt->data.evt_gatt_characteristic_value.value.data[0] == 1)
-                displayPrintf(DISPLAY_ROW_9, "Button Pressed");
-            }
+          else if(evt->data.evt_gatt_characteristic_value.value.data[0] == 1)
+            displayPrintf(DISPLAY_ROW_9, "Button Pressed");
 
         }
-      if((evt->data.evt_gatt_characteristic_value.characteristic == gattdb_rgb_state))
+
+      if(evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_read_response)
         {
-          error_status = sl_bt_gatt_send_characteristic_confirmation(ble_data.connectionSetHandle);
-          if(error_status != SL_STATUS_OK)
-            LOG_ERROR("\r\nError fetching characteristic notification confirmation: Temperauture: %d\r\n", error_status);
+          if(evt->data.evt_gatt_characteristic_value.value.data[0] == 0)
+            displayPrintf(DISPLAY_ROW_9, "Button Released");
 
-          ble_data.temp_value = FLOAT_TO_INT32(evt->data.evt_gatt_characteristic_value.value.data);
-          displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d C", ble_data.temp_value);
+          else if(evt->data.evt_gatt_characteristic_value.value.data[0] == 1)
+            displayPrintf(DISPLAY_ROW_9, "Button Pressed");
         }
-      break;
 
-    case sl_bt_evt_connection_closed_id:
+    }
+  if((evt->data.evt_gatt_characteristic_value.characteristic == gattdb_rgb_state))
+    {
+      benchClientArrival();
 
-      error_status = sl_bt_sm_delete_bondings();
+      error_status = sl_bt_gatt_send_characteristic_confirmation(evt->data.evt_gatt_characteristic_value.connection);
       if(error_status != SL_STATUS_OK)
-        LOG_ERROR("\r\nError Deleting bonding\r\n");
-      else
-        ble_data.is_bonded = false;
-      displayPrintf(DISPLAY_ROW_PASSKEY, " ");
-      displayPrintf(DISPLAY_ROW_ACTION, " ");
-      displayPrintf(DISPLAY_ROW_9, " ");
-      displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-      break;
+        LOG_ERROR("\r\nError fetching characteristic notification confirmation: Temperauture: %d\r\n", error_status);
 
-    case sl_bt_evt_sm_bonded_id:
-      displayPrintf(DISPLAY_ROW_CONNECTION, "Bonded");
-      displayPrintf(DISPLAY_ROW_PASSKEY, " ");
-      displayPrintf(DISPLAY_ROW_ACTION, " ");
-      ble_data.is_bonded = true;
-      break;
+      conn = clientConnFromEvent(evt);
+      if(conn == NULL)
+        return;
 
-    case sl_bt_evt_sm_confirm_passkey_id:
-      displayPrintf(DISPLAY_ROW_PASSKEY, "%d", evt->data.evt_sm_confirm_passkey.passkey);
-      displayPrintf(DISPLAY_ROW_ACTION, "Confirm with PB0");
-      break;
+      conn->temp_value = FLOAT_TO_INT32(evt->data.evt_gatt_characteristic_value.value.data);
+      conn->samples++;
+      seriesAdd(&conn->series, conn->temp_value);
+      gatewaySample(conn);
+      displayPrintf(DISPLAY_ROW_TEMPVALUE, "S%"PRIu32" Temp=%d C", clientConnIndex(conn), conn->temp_value);
+      ble_client_show_series(conn);
+
+      if(ble_trend_connection == CLIENT_NO_CONNECTION)
+        {
+          ble_trend_connection = conn->connection;
+          displayTrendClear();
+        }
+      if(conn->connection == ble_trend_connection)
+        displayTrendAdd(conn->temp_value);
+
+      benchClientDisplayed(evt->data.evt_gatt_characteristic_value.value.data, evt->data.evt_gatt_characteristic_value.value.len);
+    }
+}
 
-    case sl_bt_evt_sm_bonding_failed_id:
-      ble_data.is_bonded = false;
-      LOG_ERROR("\r\nError bonding\r\n");
-      break;
 
+/*
+ * Client: clears the passkey rows when the server the buttons act on leaves, and the window statistics rows and trend plot when their server leaves
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientClosed(sl_bt_msg_t *evt)
+{
+  //The rest of the LCD belongs to the discovery state machine, which still sees the connection after this
+  if(evt->data.evt_connection_closed.connection == ble_data.connectionSetHandle)
+    {
+      displayPrintf(DISPLAY_ROW_PASSKEY, " ");
+      displayPrintf(DISPLAY_ROW_ACTION, " ");
+      displayPrintf(DISPLAY_ROW_9, " ");
+    }
+
+  if(evt->data.evt_connection_closed.connection == ble_series_connection)
+    {
+      displayPrintf(DISPLAY_ROW_8, " ");
+      displayPrintf(DISPLAY_ROW_10, " ");
+#if (DISPLAY_TREND_ENABLE == 0)
+      displayPrintf(DISPLAY_ROW_11, " ");
 #endif
-  }
+      ble_series_connection = CLIENT_NO_CONNECTION;
+    }
+
+  if(evt->data.evt_connection_closed.connection == ble_trend_connection)
+    {
+      displayTrendClear();
+      ble_trend_connection = CLIENT_NO_CONNECTION;
+    }
 }
+
+#endif   //BUILD_INCLUDES_BLE_CLIENT
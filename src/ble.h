@@ -30,17 +30,14 @@ typedef struct
   bd_addr myAddress;
   uint8_t myAddressType;
 
-  // values unique for server
+  // values unique for server, the state of each connected client is in its server_conn_t context
   uint8_t advertisingSetHandle;
-  bool is_bonded;
+  uint8_t button_state;
 
-  // values unique for client
+  // connection the push buttons act on: on the client the newest server, on the server the client showing a passkey
   uint8_t connectionSetHandle;
-  bool is_connection;
-  bool is_htm_indication_in_flight;
-  bool is_htm_indication_enabled;
-  bool is_custom_indication_enabled;
-  uint8_t button_state;
+
+  // values unique for client
   uint32_t htmServiceHandle;
   uint32_t buttonServiceHandle;
   uint16_t htmCharacteristicHandle;
@@ -65,15 +62,292 @@ ble_data_struct_t* getBleDataPtr();
 
 
 /*
- * Event responder for Bluetooth events
+ * Shows the role and the device address at boot
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void bleBoot(sl_bt_msg_t *evt);
+
+
+/*
+ * Starts tracking the parameters of a new link
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkOpened(sl_bt_msg_t *evt);
+
+
+/*
+ * Records the parameters a link runs with
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_parameters_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkParameters(sl_bt_msg_t *evt);
+
+
+/*
+ * Records the PHY a link switched to
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_phy_status_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkPhyStatus(sl_bt_msg_t *evt);
+
+
+/*
+ * Records the ATT MTU agreed on a link
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_mtu_exchanged_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkMtuExchanged(sl_bt_msg_t *evt);
+
+
+/*
+ * Stops tracking a link that closed
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void bleLinkClosed(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: creates the advertising set and starts advertising
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerBoot(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: gives a new client its context and keeps advertising while contexts are free
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerOpened(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: frees the context of a client that left and advertises again
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerClosed(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: polls the link profile and retries pending indications of every client, pumps the throughput test
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_soft_timer_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerSoftTimer(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: moves the advertising schedule on to its next step
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_advertiser_timeout_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerAdvertiserTimeout(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: PB0 confirms a passkey, updates the gesture characteristic and indicates it to every bonded client
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_external_signal_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerExternalSignal(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: tracks indication subscriptions and confirmations per client and characteristic
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_server_characteristic_status_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerCharacteristicStatus(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: answers reads of the user-type temperature and gesture characteristics. A temperature read
+ * gets the latest sample, or waits for the next one when the latest is stale
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_server_user_read_request_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerUserReadRequest(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: stops indicating to a client that missed a confirmation
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_server_indication_timeout_id
+ *
+ * Returns:
+ *   None
+ */
+void bleServerIndicationTimeout(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: sets up the scanner and starts looking for servers
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientBoot(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: hands a scan report to the connection table, or to the broadcast observer in broadcast mode
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_scanner_scan_report_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientScanReport(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: the push buttons act on the newest server
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientOpened(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: records the handles of the services discovered on a server
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_service_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientGattService(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: records the handles of the characteristics discovered on a server
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_characteristic_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientGattCharacteristic(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: PB0 confirms a passkey and, with PB1, toggles gesture indications; PB1 alone reads the gesture state
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_external_signal_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientExternalSignal(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: cancels a stuck open and polls every open server once per LCD tick, pumps the throughput test
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_soft_timer_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientSoftTimer(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: confirms indications and shows the temperature and gesture values of a server
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_characteristic_value_id
+ *
+ * Returns:
+ *   None
+ */
+void bleClientCharacteristicValue(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: clears the passkey rows when the server the buttons act on leaves, and the window statistics rows and trend plot when their server leaves
  *
  * Parameters:
- *   sl_bt_msg_t event: Bluetooth events
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
  *
  * Returns:
  *   None
  */
-void handle_ble_event(sl_bt_msg_t *evt);
+void bleClientClosed(sl_bt_msg_t *evt);
 
 
 #endif  //BLE_H
@@ -20,18 +20,45 @@
  */
 #define DEVICE_IS_BLE_SERVER 0
 
+/*
+ * Set to 1 to build both roles into one image. DEVICE_IS_BLE_SERVER is then the role the
+ * board boots into, holding PB1 through reset starts the other one.
+ */
+#define DEVICE_ROLE_AT_BOOT 1
+
 
 // For your Bluetooth Client implementations.
 // Set this #define to the bd_addr of the Gecko that will be your Server.
 //                   bd_addr  [0]   [1]   [2]   [3]   [4]   [5] <- array indices
 #define SERVER_BT_ADDRESS (bd_addr){.addr = { 0x26, 0x03, 0x92, 0x27, 0xFD, 0x84 }}
 
+// Every server the client connects to at once, up to SL_BT_CONFIG_MAX_CONNECTIONS of them.
+// Add one {.addr = {...}} entry per Gecko, same byte order as SERVER_BT_ADDRESS.
+#define SERVER_BT_ADDRESS_LIST { \
+    {.addr = { 0x26, 0x03, 0x92, 0x27, 0xFD, 0x84 }}, \
+  }
+
+// Set to 1 to connect only to the servers in SERVER_BT_ADDRESS_LIST,
+// 0 to connect to any server advertising our services.
+#define SCAN_USE_ADDRESS_LIST 0
+
 //#define SERVER_BT_ADDRESS (bd_addr){.addr = { 0x7E, 0x65, 0xA6, 0x14, 0x2E, 0x84 }}
 
 //bd_addr server_addr = {{ 0x7E, 0x65, 0xA6, 0x14, 0x2E, 0x84 }};
 
 
-#if DEVICE_IS_BLE_SERVER
+#if DEVICE_ROLE_AT_BOOT
+
+// Role picked by bleRoleSelect() in app_init(), see src/dispatch.h
+bool bleRoleIsServer();
+
+#define BUILD_INCLUDES_BLE_SERVER 1
+#define BUILD_INCLUDES_BLE_CLIENT 1
+#define BLE_DEVICE_TYPE_STRING (bleRoleIsServer() ? "Server" : "Client")
+static inline bool IsServerDevice() { return bleRoleIsServer(); }
+static inline bool IsClientDevice() { return !bleRoleIsServer(); }
+
+#elif DEVICE_IS_BLE_SERVER
 
 #define BUILD_INCLUDES_BLE_SERVER 1
 #define BUILD_INCLUDES_BLE_CLIENT 0
@@ -0,0 +1,436 @@
+/**
+ * @file    :   bonding.c
+ * @brief   :   API for pairing and bond handling
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/bonding.h"
+#include "src/ble.h"
+#include "src/lcd.h"
+#include "src/gpio.h"
+#include "src/irq.h"
+#include "src/server_conn.h"
+#include "src/connection.h"
+#include "ble_device_type.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+#define CONFIRM_BONDING (1)
+#define BONDING_FLAG (0x2F)
+#define BONDABLE_MODE (1)
+#define BONDING_MAX_COUNT (8)
+#define BONDING_POLICY_LEAST_RECENTLY_USED (2)
+
+#if BUILD_INCLUDES_BLE_CLIENT
+static uint8_t bonding_client_pairing = CLIENT_NO_CONNECTION;       //Server whose passkey the LCD and PB0 are serving
+#endif
+
+
+/*
+ * Logs the time from connection open to the link being encrypted
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   uint32_t opened_ms: letimerMilliseconds() when the connection opened
+ *   uint8_t bonding: Stored bond used for the connection, SL_BT_INVALID_BONDING_HANDLE for a new pairing
+ *
+ * Returns:
+ *   None
+ */
+static void bonding_log_encrypted(uint8_t connection, uint32_t opened_ms, uint8_t bonding)
+{
+  LOG_INFO("\r\nConnection %d encrypted %"PRIu32" ms after open (%s)\r\n", connection,
+           letimerMilliseconds() - opened_ms, (bonding != SL_BT_INVALID_BONDING_HANDLE) ? "stored bond" : "new pairing");
+}
+
+
+/*
+ * Sets up the security manager at boot so bonds are stored in NVM and reused on reconnection,
+ * holding PB0 through the reset deletes every stored bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingBoot(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+
+  (void)evt;
+
+  if(gpioButton0Pressed() == true)
+    {
+      error_status = sl_bt_sm_delete_bondings();
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError Deleting bonding\r\n");
+      else
+        {
+          LOG_INFO("\r\nPB0 held at boot, stored bonds cleared\r\n");
+          displayPrintf(DISPLAY_ROW_ACTION, "Bonds cleared");
+        }
+    }
+
+  error_status = sl_bt_sm_store_bonding_configuration(BONDING_MAX_COUNT, BONDING_POLICY_LEAST_RECENTLY_USED);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError configuring bond storage\r\n");
+
+  error_status = sl_bt_sm_configure(BONDING_FLAG, sm_io_capability_displayyesno);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nBonding Error\r\n");
+
+  error_status = sl_bt_sm_set_bondable_mode(BONDABLE_MODE);                  //Without this the stack pairs but never stores the keys
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting bondable mode\r\n");
+}
+
+
+/*
+ * Shows the passkey and remembers the connection PB0 confirms it for
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_confirm_passkey_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingConfirmPasskey(sl_bt_msg_t *evt)
+{
+  getBleDataPtr()->connectionSetHandle = evt->data.evt_sm_confirm_passkey.connection;     //PB0 confirms the passkey of this peer
+  displayPrintf(DISPLAY_ROW_PASSKEY, "%d", evt->data.evt_sm_confirm_passkey.passkey);
+  displayPrintf(DISPLAY_ROW_ACTION, "Confirm with PB0");
+}
+
+
+#if BUILD_INCLUDES_BLE_SERVER
+
+/*
+ * Server: accepts a bonding request from a client
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_confirm_bonding_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingServerConfirmBonding(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+
+  error_status = sl_bt_sm_bonding_confirm(evt->data.evt_sm_confirm_bonding.connection , CONFIRM_BONDING);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting up default parameters for the connection\r\n");
+}
+
+
+/*
+ * Server: marks a link encrypted, and bonded if the client brought a stored bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_parameters_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingServerParameters(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx = serverConnFromEvent(evt);
+
+  //Reconnecting with a stored bond only runs the LL encryption procedure, no sl_bt_evt_sm_bonded_id follows it
+  if((ctx != NULL) && (evt->data.evt_connection_parameters.security_mode != sl_bt_connection_mode1_level1) && (ctx->is_encrypted == false))
+    {
+      ctx->is_encrypted = true;
+      bonding_log_encrypted(ctx->connection, ctx->opened_ms, ctx->bonding);
+
+      if(ctx->bonding != SL_BT_INVALID_BONDING_HANDLE)
+        {
+          ctx->is_bonded = true;
+          displayPrintf(DISPLAY_ROW_CONNECTION, "Bonded");
+        }
+    }
+}
+
+
+/*
+ * Server: records a new bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_bonded_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingServerBonded(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx = serverConnFromEvent(evt);
+
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Bonded");
+  displayPrintf(DISPLAY_ROW_PASSKEY, " ");
+  displayPrintf(DISPLAY_ROW_ACTION, " ");
+  if(ctx != NULL)
+    {
+      ctx->is_bonded = true;
+      ctx->bonding = evt->data.evt_sm_bonded.bonding;
+    }
+}
+
+
+/*
+ * Server: records a failed pairing
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_bonding_failed_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingServerFailed(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx = serverConnFromEvent(evt);
+
+  if(ctx != NULL)
+    ctx->is_bonded = false;
+  LOG_ERROR("\r\nError bonding\r\n");
+}
+
+#endif   //BUILD_INCLUDES_BLE_SERVER
+
+
+#if BUILD_INCLUDES_BLE_CLIENT
+
+/*
+ * Client: pairs with a server, or queues it while another server's passkey is waiting for PB0
+ *
+ * Parameters:
+ *   client_conn_t *conn: Server connection
+ *
+ * Returns:
+ *   None
+ */
+static void bonding_client_pair(client_conn_t *conn)
+{
+  sl_status_t error_status;
+
+  if((bonding_client_pairing != CLIENT_NO_CONNECTION) && (bonding_client_pairing != conn->connection))
+    {
+      conn->pair_pending = true;
+      return;
+    }
+
+  conn->pair_pending = false;
+  error_status = sl_bt_sm_increase_security(conn->connection);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError increasing security\r\n");
+  else
+    bonding_client_pairing = conn->connection;
+}
+
+
+/*
+ * Client: ends the pairing of a server and starts the next one that was queued
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle of the server whose pairing ended
+ *
+ * Returns:
+ *   None
+ */
+static void bonding_client_pair_next(uint8_t connection)
+{
+  client_conn_t *next;
+
+  if(bonding_client_pairing != connection)
+    return;
+
+  bonding_client_pairing = CLIENT_NO_CONNECTION;
+  for(uint32_t i = 0; i < CLIENT_MAX_SERVERS; i++)
+    {
+      next = clientConnSlot(i);
+      if((next != NULL) && (next->pair_pending == true) && (next->connection != connection))
+        {
+          bonding_client_pair(next);
+          return;
+        }
+    }
+}
+
+
+/*
+ * Client: server whose passkey the push buttons are serving
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint8_t: Stack connection handle, CLIENT_NO_CONNECTION while no server is pairing
+ */
+uint8_t bondingClientPairing(void)
+{
+  return bonding_client_pairing;
+}
+
+
+/*
+ * Client: encrypts a link to a bonded server straight away from the stored keys
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientOpened(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  client_conn_t *conn = clientConnFromEvent(evt);
+
+  if(conn == NULL)
+    return;
+
+  //A bonded server is encrypted straight away from the stored keys, a new one pairs when a read hits insufficient encryption
+  conn->bonding = evt->data.evt_connection_opened.bonding;
+  if(conn->bonding != SL_BT_INVALID_BONDING_HANDLE)
+    {
+      error_status = sl_bt_sm_increase_security(conn->connection);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError increasing security\r\n");
+    }
+}
+
+
+/*
+ * Client: marks a link encrypted, and bonded if the server was reached with a stored bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_parameters_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientParameters(sl_bt_msg_t *evt)
+{
+  client_conn_t *conn = clientConnFromEvent(evt);
+
+  if(conn == NULL)
+    return;
+
+  //Reconnecting with a stored bond only runs the LL encryption procedure, no sl_bt_evt_sm_bonded_id follows it
+  if((evt->data.evt_connection_parameters.security_mode != sl_bt_connection_mode1_level1) && (conn->is_encrypted == false))
+    {
+      conn->is_encrypted = true;
+      bonding_log_encrypted(conn->connection, conn->opened_ms, conn->bonding);
+
+      if(conn->bonding != SL_BT_INVALID_BONDING_HANDLE)
+        {
+          conn->is_bonded = true;
+          displayPrintf(DISPLAY_ROW_CONNECTION, "Bonded");
+        }
+    }
+}
+
+
+/*
+ * Client: pairs when a read or a CCCD write is refused for insufficient encryption, one server at a time
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_procedure_completed_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientProcedureCompleted(sl_bt_msg_t *evt)
+{
+  client_conn_t *conn = clientConnFromEvent(evt);
+
+  if((conn != NULL) && (evt->data.evt_gatt_procedure_completed.result == SL_STATUS_BT_ATT_INSUFFICIENT_ENCRYPTION) &&
+      (conn->is_encrypted == false))
+    bonding_client_pair(conn);
+}
+
+
+/*
+ * Client: records a new bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_bonded_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientBonded(sl_bt_msg_t *evt)
+{
+  client_conn_t *conn = clientConnFromEvent(evt);
+
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Bonded");
+  displayPrintf(DISPLAY_ROW_PASSKEY, " ");
+  displayPrintf(DISPLAY_ROW_ACTION, " ");
+  if(conn != NULL)
+    {
+      conn->is_bonded = true;
+      conn->bonding = evt->data.evt_sm_bonded.bonding;
+    }
+
+  bonding_client_pair_next(evt->data.evt_sm_bonded.connection);
+}
+
+
+/*
+ * Client: records a failed pairing, and pairs again from scratch if the server lost its side of the bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_bonding_failed_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientFailed(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  client_conn_t *conn = clientConnFromEvent(evt);
+
+  if(conn == NULL)
+    return;
+
+  conn->is_bonded = false;
+  LOG_ERROR("\r\nError bonding: %d\r\n", evt->data.evt_sm_bonding_failed.reason);
+  bonding_client_pair_next(conn->connection);
+
+  //The server lost its side of the bond, drop ours and pair from scratch
+  if((evt->data.evt_sm_bonding_failed.reason == SL_STATUS_BT_CTRL_PIN_OR_KEY_MISSING) && (conn->bonding != SL_BT_INVALID_BONDING_HANDLE))
+    {
+      error_status = sl_bt_sm_delete_bonding(conn->bonding);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError Deleting bonding\r\n");
+      conn->bonding = SL_BT_INVALID_BONDING_HANDLE;
+
+      bonding_client_pair(conn);
+    }
+}
+
+
+/*
+ * Client: hands the passkey on to the next queued server when the one pairing leaves
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientClosed(sl_bt_msg_t *evt)
+{
+  client_conn_t *conn = clientConnFromEvent(evt);
+
+  if(conn != NULL)
+    conn->pair_pending = false;
+
+  bonding_client_pair_next(evt->data.evt_connection_closed.connection);
+}
+
+#endif   //BUILD_INCLUDES_BLE_CLIENT
@@ -0,0 +1,176 @@
+/**
+ * @file    :   bonding.h
+ * @brief   :   Headers and function definitions for pairing and bond handling
+ *
+ *              Registered with the event dispatcher in both roles. The bond state of each link is
+ *              kept in its connection context, server_conn_t on the server and client_conn_t on the client.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef BONDING_H
+#define BONDING_H
+
+#include "sl_bt_api.h"
+
+
+/*
+ * Sets up the security manager at boot so bonds are stored in NVM and reused on reconnection,
+ * holding PB0 through the reset deletes every stored bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingBoot(sl_bt_msg_t *evt);
+
+
+/*
+ * Shows the passkey and remembers the connection PB0 confirms it for
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_confirm_passkey_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingConfirmPasskey(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: accepts a bonding request from a client
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_confirm_bonding_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingServerConfirmBonding(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: marks a link encrypted, and bonded if the client brought a stored bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_parameters_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingServerParameters(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: records a new bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_bonded_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingServerBonded(sl_bt_msg_t *evt);
+
+
+/*
+ * Server: records a failed pairing
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_bonding_failed_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingServerFailed(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: encrypts a link to a bonded server straight away from the stored keys
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientOpened(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: marks a link encrypted, and bonded if the server was reached with a stored bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_parameters_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientParameters(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: pairs when a read or a CCCD write is refused for insufficient encryption, one server at a time
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_procedure_completed_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientProcedureCompleted(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: records a new bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_bonded_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientBonded(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: records a failed pairing, and pairs again from scratch if the server lost its side of the bond
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_sm_bonding_failed_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientFailed(sl_bt_msg_t *evt);
+
+
+/*
+ * Client: server whose passkey the push buttons are serving
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint8_t: Stack connection handle, CLIENT_NO_CONNECTION while no server is pairing
+ */
+uint8_t bondingClientPairing(void);
+
+
+/*
+ * Client: hands the passkey on to the next queued server when the one pairing leaves
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void bondingClientClosed(sl_bt_msg_t *evt);
+
+
+#endif   //BONDING_H
@@ -0,0 +1,334 @@
+/**
+ * @file    :   broadcast.c
+ * @brief   :   API for the connectionless temperature broadcast
+ *
+ *              The sample is encrypted with AES in counter mode and authenticated with a two block
+ *              CBC-MAC, both keyed with BROADCAST_KEY. The nonce is the server address, a boot
+ *              counter kept in NVM and the sample sequence number, so a nonce never repeats even
+ *              though the sequence restarts at every boot.
+ *
+ *              The (boot, sequence) pair only grows, so the client drops a report that is not newer
+ *              than the last one it accepted from that server. The client keeps the pairs in RAM for
+ *              BROADCAST_MAX_SENDERS servers: after a client reset, or once a server has dropped out
+ *              of the table, the first authentic report heard from that server is accepted whatever
+ *              its age, and the reports after it must be newer.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/broadcast.h"
+
+#if BROADCAST_ENABLE
+#include "src/scan.h"
+#include "src/lcd.h"
+#include "src/irq.h"
+#include "mbedtls/aes.h"
+#include "string.h"
+
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+#define BROADCAST_BLOCK_LEN (16)
+#define BROADCAST_VALUE_LEN (4)
+#define BROADCAST_MIC_LEN (4)
+
+//Domain byte leading each AES block, keeps the keystream and MAC inputs apart
+#define BROADCAST_DOMAIN_KEYSTREAM (0x00)
+#define BROADCAST_DOMAIN_MIC (0x01)
+
+//Offsets in the manufacturer data payload
+#define BROADCAST_OFFSET_VERSION (2)
+#define BROADCAST_OFFSET_BOOT (3)
+#define BROADCAST_OFFSET_SEQUENCE (7)
+#define BROADCAST_OFFSET_VALUE (11)
+#define BROADCAST_OFFSET_MIC (15)
+
+static mbedtls_aes_context broadcast_aes;
+
+#if BUILD_INCLUDES_BLE_SERVER
+//Flags (BR/EDR not supported, not discoverable) then the manufacturer data
+#define BROADCAST_ADV_LEN (3 + 2 + BROADCAST_PAYLOAD_LEN)
+
+static uint8_t broadcast_handle;
+static bool broadcast_started = false;
+static bool broadcast_ready = false;        //The boot counter was stored, a nonce cannot repeat
+static bd_addr broadcast_address;
+static uint32_t broadcast_boot;
+static uint32_t broadcast_sequence = 0;
+#endif
+
+#if BUILD_INCLUDES_BLE_CLIENT
+typedef struct
+{
+  bool valid;
+  bd_addr address;
+  uint32_t boot;                    //Boot counter of the last report accepted
+  uint32_t sequence;                //Sequence number of the last report accepted
+  uint32_t seen_ms;
+}broadcast_sender_t;
+
+static broadcast_sender_t broadcast_senders[BROADCAST_MAX_SENDERS];
+#endif
+
+
+/*
+ * Builds the first AES block shared by the keystream and the MIC
+ *
+ * Parameters:
+ *   uint8_t domain: BROADCAST_DOMAIN_x
+ *   const bd_addr *address: Server address
+ *   uint32_t boot: Boot counter of the server
+ *   uint32_t sequence: Sample sequence number
+ *   uint8_t *block: Returns the 16 byte block
+ *
+ * Returns:
+ *   None
+ */
+static void broadcast_nonce(uint8_t domain, const bd_addr *address, uint32_t boot, uint32_t sequence, uint8_t *block)
+{
+  memset(block, 0, BROADCAST_BLOCK_LEN);
+  block[0] = domain;
+  memcpy(&block[1], address->addr, sizeof(address->addr));
+  memcpy(&block[7], &boot, sizeof(boot));
+  memcpy(&block[11], &sequence, sizeof(sequence));
+}
+
+
+/*
+ * Encrypts or decrypts the 4 byte value in place, counter mode is its own inverse
+ *
+ * Parameters:
+ *   const bd_addr *address: Server address
+ *   uint32_t boot: Boot counter of the server
+ *   uint32_t sequence: Sample sequence number
+ *   uint8_t *value: 4 byte value
+ *
+ * Returns:
+ *   None
+ */
+static void broadcast_crypt(const bd_addr *address, uint32_t boot, uint32_t sequence, uint8_t *value)
+{
+  uint8_t block[BROADCAST_BLOCK_LEN];
+  uint8_t keystream[BROADCAST_BLOCK_LEN];
+
+  broadcast_nonce(BROADCAST_DOMAIN_KEYSTREAM, address, boot, sequence, block);
+  mbedtls_aes_crypt_ecb(&broadcast_aes, MBEDTLS_AES_ENCRYPT, block, keystream);
+
+  for(uint32_t i = 0; i < BROADCAST_VALUE_LEN; i++)
+    value[i] ^= keystream[i];
+}
+
+
+/*
+ * Computes the MIC over the nonce and the ciphertext, fixed length input so plain CBC-MAC is sound
+ *
+ * Parameters:
+ *   const bd_addr *address: Server address
+ *   uint32_t boot: Boot counter of the server
+ *   uint32_t sequence: Sample sequence number
+ *   const uint8_t *ciphertext: 4 byte encrypted value
+ *   uint8_t *mic: Returns the 4 byte MIC
+ *
+ * Returns:
+ *   None
+ */
+static void broadcast_mic(const bd_addr *address, uint32_t boot, uint32_t sequence, const uint8_t *ciphertext, uint8_t *mic)
+{
+  uint8_t block[BROADCAST_BLOCK_LEN];
+  uint8_t chain[BROADCAST_BLOCK_LEN];
+
+  broadcast_nonce(BROADCAST_DOMAIN_MIC, address, boot, sequence, block);
+  mbedtls_aes_crypt_ecb(&broadcast_aes, MBEDTLS_AES_ENCRYPT, block, chain);
+
+  for(uint32_t i = 0; i < BROADCAST_VALUE_LEN; i++)          //Second block is the ciphertext padded with zeros
+    chain[i] ^= ciphertext[i];
+  mbedtls_aes_crypt_ecb(&broadcast_aes, MBEDTLS_AES_ENCRYPT, chain, block);
+
+  memcpy(mic, block, BROADCAST_MIC_LEN);
+}
+
+
+/*
+ * Loads the broadcast key, called at boot in both roles. The server also counts the boot in NVM
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void broadcastInit()
+{
+  static const uint8_t key[BROADCAST_BLOCK_LEN] = BROADCAST_KEY;
+
+  mbedtls_aes_init(&broadcast_aes);
+  if(mbedtls_aes_setkey_enc(&broadcast_aes, key, BROADCAST_BLOCK_LEN * 8) != 0)
+    LOG_ERROR("\r\nError loading the broadcast key\r\n");
+
+#if BUILD_INCLUDES_BLE_SERVER
+  sl_status_t error_status;
+  uint8_t address_type;
+  size_t boot_len = 0;
+
+  if(IsServerDevice() == false)
+    return;
+
+  error_status = sl_bt_system_get_identity_address(&broadcast_address, &address_type);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError reading the broadcast address\r\n");
+
+  //A missing key is the first boot, the counter starts at 1
+  broadcast_boot = 0;
+  error_status = sl_bt_nvm_load(BROADCAST_BOOT_KEY, sizeof(broadcast_boot), &boot_len, (uint8_t *)&broadcast_boot);
+  if((error_status != SL_STATUS_OK) || (boot_len != sizeof(broadcast_boot)))
+    broadcast_boot = 0;
+  broadcast_boot++;
+
+  //The count must be stored before it is used, a reset would otherwise reuse its nonces
+  error_status = sl_bt_nvm_save(BROADCAST_BOOT_KEY, sizeof(broadcast_boot), (uint8_t *)&broadcast_boot);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError storing the broadcast boot counter, not broadcasting\r\n");
+  else
+    broadcast_ready = true;
+
+  error_status = sl_bt_advertiser_create_set(&broadcast_handle);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError creating the broadcast advertising set\r\n");
+
+  error_status = sl_bt_advertiser_set_timing(broadcast_handle, BROADCAST_INTERVAL, BROADCAST_INTERVAL, 0, 0);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting the broadcast timing\r\n");
+#endif
+}
+
+
+#if BUILD_INCLUDES_BLE_SERVER
+/*
+ * Server: encrypts a new sample into the advertising data, advertising starts with the first sample
+ *
+ * Parameters:
+ *   int32_t temperature_mc: Temperature in thousandths of a degree C
+ *
+ * Returns:
+ *   None
+ */
+void broadcastUpdate(int32_t temperature_mc)
+{
+  sl_status_t error_status;
+  uint8_t adv[BROADCAST_ADV_LEN];
+  uint8_t *payload = &adv[5];
+  uint16_t company = BROADCAST_COMPANY_ID;
+
+  if(broadcast_ready == false)
+    return;
+
+  broadcast_sequence++;
+
+  adv[0] = 2;
+  adv[1] = 0x01;                                             //Flags
+  adv[2] = 0x04;
+  adv[3] = BROADCAST_PAYLOAD_LEN + 1;
+  adv[4] = AD_TYPE_MANUFACTURER_DATA;
+
+  memcpy(&payload[0], &company, sizeof(company));
+  payload[BROADCAST_OFFSET_VERSION] = BROADCAST_VERSION;
+  memcpy(&payload[BROADCAST_OFFSET_BOOT], &broadcast_boot, sizeof(broadcast_boot));
+  memcpy(&payload[BROADCAST_OFFSET_SEQUENCE], &broadcast_sequence, sizeof(broadcast_sequence));
+  memcpy(&payload[BROADCAST_OFFSET_VALUE], &temperature_mc, BROADCAST_VALUE_LEN);
+
+  broadcast_crypt(&broadcast_address, broadcast_boot, broadcast_sequence, &payload[BROADCAST_OFFSET_VALUE]);
+  broadcast_mic(&broadcast_address, broadcast_boot, broadcast_sequence, &payload[BROADCAST_OFFSET_VALUE], &payload[BROADCAST_OFFSET_MIC]);
+
+  error_status = sl_bt_advertiser_set_data(broadcast_handle, 0, sizeof(adv), adv);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting the broadcast data\r\n");
+
+  if(broadcast_started == false)
+    {
+      error_status = sl_bt_advertiser_start(broadcast_handle, sl_bt_advertiser_user_data, sl_bt_advertiser_non_connectable);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError starting the broadcast\r\n");
+      else
+        broadcast_started = true;
+    }
+}
+#endif
+
+#if BUILD_INCLUDES_BLE_CLIENT
+
+/*
+ * Client: decodes a broadcast from a scan report. Forged reports are dropped, and so are reports not newer
+ * than the last one accepted from the same server while it is in the sender table
+ *
+ * Parameters:
+ *   sl_bt_evt_scanner_scan_report_t *report: Scan report event
+ *
+ * Returns:
+ *   None
+ */
+void broadcastScanReport(sl_bt_evt_scanner_scan_report_t *report)
+{
+  const uint8_t *payload;
+  uint8_t len;
+  uint16_t company;
+  uint32_t boot;
+  uint32_t sequence;
+  uint8_t value[BROADCAST_VALUE_LEN];
+  uint8_t mic[BROADCAST_MIC_LEN];
+  int32_t temperature_mc;
+  broadcast_sender_t *sender = NULL;
+  broadcast_sender_t *oldest = &broadcast_senders[0];
+  uint32_t now = letimerMilliseconds();
+
+  payload = scanAdFind(report->data.data, report->data.len, AD_TYPE_MANUFACTURER_DATA, &len);
+  if((payload == NULL) || (len != BROADCAST_PAYLOAD_LEN))
+    return;
+
+  memcpy(&company, &payload[0], sizeof(company));
+  if((company != BROADCAST_COMPANY_ID) || (payload[BROADCAST_OFFSET_VERSION] != BROADCAST_VERSION))
+    return;
+
+  memcpy(&boot, &payload[BROADCAST_OFFSET_BOOT], sizeof(boot));
+  memcpy(&sequence, &payload[BROADCAST_OFFSET_SEQUENCE], sizeof(sequence));
+
+  for(uint32_t i = 0; i < BROADCAST_MAX_SENDERS; i++)
+    {
+      if((broadcast_senders[i].valid == true) && (memcmp(&broadcast_senders[i].address, &report->address, sizeof(bd_addr)) == 0))
+        sender = &broadcast_senders[i];
+      else if((oldest->valid == true) && ((broadcast_senders[i].valid == false) || (broadcast_senders[i].seen_ms < oldest->seen_ms)))
+        oldest = &broadcast_senders[i];
+    }
+
+  //Every advertising event repeats the sample and a replay carries an older pair, only a newer pair is decoded
+  if((sender != NULL) && ((boot < sender->boot) || ((boot == sender->boot) && (sequence <= sender->sequence))))
+    return;
+
+  broadcast_mic(&report->address, boot, sequence, &payload[BROADCAST_OFFSET_VALUE], mic);
+  if(memcmp(mic, &payload[BROADCAST_OFFSET_MIC], BROADCAST_MIC_LEN) != 0)
+    return;
+
+  if(sender == NULL)
+    {
+      sender = oldest;
+      sender->valid = true;
+      sender->address = report->address;
+    }
+  sender->boot = boot;
+  sender->sequence = sequence;
+  sender->seen_ms = now;
+
+  memcpy(value, &payload[BROADCAST_OFFSET_VALUE], BROADCAST_VALUE_LEN);
+  broadcast_crypt(&report->address, boot, sequence, value);
+  memcpy(&temperature_mc, value, sizeof(temperature_mc));
+
+  LOG_INFO("\r\nBroadcast %02x:%02x:%02x:%02x:%02x:%02x #%"PRIu32" at %d dBm: %"PRId32" C\r\n", report->address.addr[5],
+           report->address.addr[4], report->address.addr[3], report->address.addr[2], report->address.addr[1], report->address.addr[0],
+           sequence, report->rssi, temperature_mc / 1000);
+
+  displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d C", (int)(temperature_mc / 1000));
+}
+#endif
+
+#endif   //BROADCAST_ENABLE
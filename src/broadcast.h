@@ -0,0 +1,106 @@
+/**
+ * @file    :   broadcast.h
+ * @brief   :   Headers and function definitions for the connectionless temperature broadcast
+ *
+ *              The server samples without a connection and places the encrypted temperature in
+ *              the manufacturer data of a second, non-connectable advertising set. Clients read
+ *              it from scan reports and never connect.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "ble_device_type.h"
+
+//Set to 1 in both roles for broadcast mode: the server advertises every sample, the client only observes
+#define BROADCAST_ENABLE (0)
+
+//128-bit key shared by every board of a deployment, replace it before deploying
+#define BROADCAST_KEY { 0x45, 0x43, 0x45, 0x4e, 0x35, 0x38, 0x32, 0x33, 0x2d, 0x62, 0x63, 0x61, 0x73, 0x74, 0x2d, 0x31 }
+
+//Advertising interval of the broadcast set in 0.625 ms units, 1 s gives each observer several chances per 3 s sample
+#define BROADCAST_INTERVAL (1600)
+
+//Company identifier 0xFFFF is reserved for testing, followed by the payload format version
+#define BROADCAST_COMPANY_ID (0xFFFF)
+#define BROADCAST_VERSION (0x01)
+
+//Manufacturer data payload: company (2), version (1), boot counter (4), sequence (4), ciphertext (4), MIC (4)
+#define BROADCAST_PAYLOAD_LEN (19)
+
+//NVM key of the server boot counter, in the 0x4000 to 0x407F range the stack leaves to the application
+#define BROADCAST_BOOT_KEY (0x4000)
+
+//Servers whose last boot and sequence number the client remembers, the oldest is replaced
+#define BROADCAST_MAX_SENDERS (8)
+
+
+#if BROADCAST_ENABLE
+
+/*
+ * Loads the broadcast key, called at boot in both roles. The server also counts the boot in NVM
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void broadcastInit();
+
+
+#if BUILD_INCLUDES_BLE_SERVER
+
+/*
+ * Server: encrypts a new sample into the advertising data, advertising starts with the first sample
+ *
+ * Parameters:
+ *   int32_t temperature_mc: Temperature in thousandths of a degree C
+ *
+ * Returns:
+ *   None
+ */
+void broadcastUpdate(int32_t temperature_mc);
+
+#else
+
+static inline void broadcastUpdate(int32_t temperature_mc) { (void)temperature_mc; }
+
+#endif   //BUILD_INCLUDES_BLE_SERVER
+
+#if BUILD_INCLUDES_BLE_CLIENT
+
+/*
+ * Client: decodes a broadcast from a scan report. Forged reports are dropped, and so are reports not newer
+ * than the last one accepted from the same server while it is in the sender table
+ *
+ * Parameters:
+ *   sl_bt_evt_scanner_scan_report_t *report: Scan report event
+ *
+ * Returns:
+ *   None
+ */
+void broadcastScanReport(sl_bt_evt_scanner_scan_report_t *report);
+
+#else
+
+static inline void broadcastScanReport(sl_bt_evt_scanner_scan_report_t *report) { (void)report; }
+
+#endif   //BUILD_INCLUDES_BLE_CLIENT
+
+#else
+
+static inline void broadcastInit() {}
+static inline void broadcastUpdate(int32_t temperature_mc) { (void)temperature_mc; }
+static inline void broadcastScanReport(sl_bt_evt_scanner_scan_report_t *report) { (void)report; }
+
+#endif   //BROADCAST_ENABLE
+
+#endif   //BROADCAST_H
@@ -0,0 +1,308 @@
+/**
+ * @file    :   bulk.c
+ * @brief   :   API for the L2CAP bulk channel
+ *
+ *              Flow control is credit based: the receiver grants BULK_CREDITS PDUs when the
+ *              channel opens and returns credits in batches of half that as records are consumed,
+ *              so the sender can never hold more than its share of the receiver's buffer pool.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/bulk.h"
+
+#if BULK_ENABLE
+#include "src/throughput.h"
+#include "string.h"
+
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+#define BULK_NO_CONNECTION (0xFF)
+
+//Credits are returned once this many received PDUs have been consumed
+#define BULK_CREDIT_BATCH ((BULK_CREDITS + 1) / 2)
+
+//SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS is 1, so there is a single channel on either side
+typedef struct
+{
+  bool in_use;                      //Request sent or accepted
+  bool is_open;                     //Both sides agreed on the channel
+  uint8_t connection;
+  uint16_t cid;                     //Channel endpoint of the peer
+  uint16_t peer_mtu;
+  uint16_t peer_mps;
+  uint16_t credits;                 //PDUs the peer still accepts from us
+  uint16_t consumed;                //PDUs received since credits were last returned
+}bulk_channel_t;
+
+static bulk_channel_t bulk_channel = { .connection = BULK_NO_CONNECTION };
+
+
+/*
+ * Marks the channel open with the parameters the peer announced
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   uint16_t cid: Channel endpoint of the peer
+ *   uint16_t mtu: SDU limit of the peer
+ *   uint16_t mps: PDU limit of the peer
+ *   uint16_t credits: Initial credits granted by the peer
+ *
+ * Returns:
+ *   None
+ */
+static void bulk_open(uint8_t connection, uint16_t cid, uint16_t mtu, uint16_t mps, uint16_t credits)
+{
+  bulk_channel.in_use = true;
+  bulk_channel.is_open = true;
+  bulk_channel.connection = connection;
+  bulk_channel.cid = cid;
+  bulk_channel.peer_mtu = mtu;
+  bulk_channel.peer_mps = mps;
+  bulk_channel.credits = credits;
+  bulk_channel.consumed = 0;
+
+  LOG_INFO("\r\nBulk channel open on connection %d: MPS %d, %d credits\r\n", connection, mps, credits);
+}
+
+
+/*
+ * Frees the channel
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void bulk_close()
+{
+  memset(&bulk_channel, 0, sizeof(bulk_channel));
+  bulk_channel.connection = BULK_NO_CONNECTION;
+}
+
+
+/*
+ * Client: opens the bulk channel on a server if none is open yet, called once per second for every open connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bool ready: true once discovery has finished on the connection
+ *
+ * Returns:
+ *   None
+ */
+void bulkClientPoll(uint8_t connection, bool ready)
+{
+  sl_status_t error_status;
+
+  if((ready == false) || (bulk_channel.in_use == true))
+    return;
+
+  error_status = sl_bt_l2cap_coc_send_connection_request(connection, BULK_PSM, BULK_MTU, BULK_MPS, BULK_CREDITS);
+  if(error_status != SL_STATUS_OK)
+    {
+      LOG_ERROR("\r\nError requesting the bulk channel: %d\r\n", error_status);
+      return;
+    }
+
+  bulk_channel.in_use = true;
+  bulk_channel.connection = connection;
+}
+
+
+/*
+ * Returns the largest record payload the peer accepts on a connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   size_t: Bytes after the record header, 0 if the connection has no open bulk channel
+ */
+size_t bulkMaxRecord(uint8_t connection)
+{
+  uint16_t limit;
+
+  if((bulk_channel.is_open == false) || (bulk_channel.connection != connection))
+    return 0;
+
+  limit = (bulk_channel.peer_mps < bulk_channel.peer_mtu) ? bulk_channel.peer_mps : bulk_channel.peer_mtu;
+  if(limit > BULK_MPS)
+    limit = BULK_MPS;
+
+  return limit - BULK_HEADER_LEN;
+}
+
+
+/*
+ * Sends one record on the bulk channel of a connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bulk_type_t type: Record type
+ *   const uint8_t *data: Record payload
+ *   size_t len: Payload length, at most bulkMaxRecord()
+ *
+ * Returns:
+ *   sl_status_t: SL_STATUS_OK if queued, SL_STATUS_NO_MORE_RESOURCE if the peer has no credit left or the
+ *                stack buffers are full, SL_STATUS_INVALID_STATE if no channel is open
+ */
+sl_status_t bulkSend(uint8_t connection, bulk_type_t type, const uint8_t *data, size_t len)
+{
+  sl_status_t error_status;
+  uint8_t pdu[BULK_MPS];
+  uint16_t sdu_len = len + 1;
+
+  if((bulk_channel.is_open == false) || (bulk_channel.connection != connection))
+    return SL_STATUS_INVALID_STATE;
+
+  if(len > bulkMaxRecord(connection))
+    return SL_STATUS_INVALID_PARAMETER;
+
+  if(bulk_channel.credits == 0)
+    return SL_STATUS_NO_MORE_RESOURCE;
+
+  memcpy(pdu, &sdu_len, sizeof(sdu_len));
+  pdu[2] = type;
+  memcpy(&pdu[BULK_HEADER_LEN], data, len);
+
+  error_status = sl_bt_l2cap_coc_send_data(connection, bulk_channel.cid, len + BULK_HEADER_LEN, pdu);
+  if(error_status == SL_STATUS_OK)
+    bulk_channel.credits--;
+
+  return error_status;
+}
+
+
+/*
+ * Hands a received record on by type and returns credits once a batch has been consumed
+ *
+ * Parameters:
+ *   sl_bt_evt_l2cap_coc_data_t *data: Data event
+ *
+ * Returns:
+ *   None
+ */
+static void bulk_receive(sl_bt_evt_l2cap_coc_data_t *data)
+{
+  sl_status_t error_status;
+
+  if(data->data.len >= BULK_HEADER_LEN)
+    {
+      switch(data->data.data[2])
+      {
+        case bulk_type_test:
+          throughputBulkData(data->connection, data->data.len - BULK_HEADER_LEN);
+          break;
+
+        default:
+          LOG_INFO("\r\nBulk record type %d, %d bytes, no consumer\r\n", data->data.data[2], data->data.len - BULK_HEADER_LEN);
+          break;
+      }
+    }
+
+  //Records are consumed as they arrive, so the buffer is free again as soon as the event returns
+  if(++bulk_channel.consumed >= BULK_CREDIT_BATCH)
+    {
+      error_status = sl_bt_l2cap_coc_send_le_flow_control_credit(data->connection, bulk_channel.cid, bulk_channel.consumed);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError returning bulk credits\r\n");
+      else
+        bulk_channel.consumed = 0;
+    }
+}
+
+
+/*
+ * Opens, accepts and closes the channel, returns credits for received records and hands them on by type
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void bulk_handle_ble_event(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+
+  switch (SL_BT_MSG_ID(evt->header))
+  {
+    //Server side, the client asks for the channel
+    case sl_bt_evt_l2cap_coc_connection_request_id:
+      {
+        sl_bt_evt_l2cap_coc_connection_request_t *request = &evt->data.evt_l2cap_coc_connection_request;
+        uint16_t result = sl_bt_l2cap_connection_successful;
+
+        if(request->le_psm != BULK_PSM)
+          result = sl_bt_l2cap_le_psm_not_supported;
+        else if(bulk_channel.in_use == true)
+          result = sl_bt_l2cap_no_resources_available;
+
+        error_status = sl_bt_l2cap_coc_send_connection_response(request->connection, request->source_cid, BULK_MTU, BULK_MPS,
+                                                                BULK_CREDITS, result);
+        if(error_status != SL_STATUS_OK)
+          LOG_ERROR("\r\nError answering the bulk channel request\r\n");
+        else if(result == sl_bt_l2cap_connection_successful)
+          bulk_open(request->connection, request->source_cid, request->mtu, request->mps, request->initial_credit);
+      }
+      break;
+
+    //Client side, the server answered
+    case sl_bt_evt_l2cap_coc_connection_response_id:
+      {
+        sl_bt_evt_l2cap_coc_connection_response_t *response = &evt->data.evt_l2cap_coc_connection_response;
+
+        if(response->connection != bulk_channel.connection)
+          break;
+
+        if(response->l2cap_errorcode == sl_bt_l2cap_connection_successful)
+          bulk_open(response->connection, response->destination_cid, response->mtu, response->mps, response->initial_credit);
+        else
+          {
+            //A refusing server keeps the channel slot so the request is not repeated every second
+            LOG_ERROR("\r\nBulk channel refused: %d\r\n", response->l2cap_errorcode);
+            bulk_channel.is_open = false;
+          }
+      }
+      break;
+
+    case sl_bt_evt_l2cap_coc_le_flow_control_credit_id:
+      if(evt->data.evt_l2cap_coc_le_flow_control_credit.connection == bulk_channel.connection)
+        bulk_channel.credits += evt->data.evt_l2cap_coc_le_flow_control_credit.credits;
+      break;
+
+    case sl_bt_evt_l2cap_coc_data_id:
+      if(evt->data.evt_l2cap_coc_data.connection == bulk_channel.connection)
+        bulk_receive(&evt->data.evt_l2cap_coc_data);
+      break;
+
+    case sl_bt_evt_l2cap_coc_channel_disconnected_id:
+      if(evt->data.evt_l2cap_coc_channel_disconnected.connection == bulk_channel.connection)
+        {
+          LOG_INFO("\r\nBulk channel closed: %d\r\n", evt->data.evt_l2cap_coc_channel_disconnected.reason);
+          bulk_close();
+        }
+      break;
+
+    case sl_bt_evt_l2cap_command_rejected_id:
+      if(evt->data.evt_l2cap_command_rejected.connection == bulk_channel.connection)
+        LOG_ERROR("\r\nBulk channel command %d rejected: %d\r\n", evt->data.evt_l2cap_command_rejected.code,
+                  evt->data.evt_l2cap_command_rejected.reason);
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      if(evt->data.evt_connection_closed.connection == bulk_channel.connection)
+        bulk_close();
+      break;
+
+    default:
+      break;
+  }
+}
+
+#endif   //BULK_ENABLE
@@ -0,0 +1,127 @@
+/**
+ * @file    :   bulk.h
+ * @brief   :   Headers and function definitions for the L2CAP bulk channel
+ *
+ *              The client opens one LE credit-based connection-oriented channel to the first
+ *              server it discovers. Bulk records (history, deferred logs, traces, test data) then
+ *              move without the per-packet ATT header or an indication round trip.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef BULK_H
+#define BULK_H
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "sl_bluetooth_config.h"
+
+//Set to 0 to keep every transfer on GATT, SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS can then go back to 0
+#define BULK_ENABLE (1)
+
+//LE_PSM of the channel, from the dynamic range 0x0080 - 0x00FF
+#define BULK_PSM (0x0080)
+
+//Largest PDU payload either side accepts, one LL packet with DLE at 251 bytes less the 4 byte L2CAP header
+#define BULK_MPS (244)
+
+//Each record is sent as one unsegmented SDU, so the SDU limit is the PDU limit
+#define BULK_MTU (BULK_MPS)
+
+//Stack buffer cost of one received PDU beyond its payload: L2CAP header and buffer bookkeeping, an estimate
+#define BULK_PDU_OVERHEAD (16)
+
+//Share of the stack buffer pool kept for the channel, the last term of SL_BT_CONFIG_BUFFER_SIZE in sl_bluetooth_config.h.
+//The rest of the pool serves the 8 links, so the channel may not grow into it:
+//  4 credits x (244 + 16) bytes = 1040 unread PDUs received, plus as many queued to send on the credits of the peer
+//  = 2080
+#define BULK_BUFFER_RESERVE (2080)
+
+//Credits granted to the peer: half of the reserve, as the other half holds the PDUs sent the other way
+#define BULK_CREDITS ((BULK_BUFFER_RESERVE / 2) / (BULK_MPS + BULK_PDU_OVERHEAD))
+
+//Record header: 2 byte SDU length, as the first K-frame of an SDU carries it, then 1 byte record type
+#define BULK_HEADER_LEN (3)
+
+//Record types
+typedef enum
+{
+  bulk_type_test,                   //Throughput test data, counted and discarded
+  bulk_type_history,                //Stored samples
+  bulk_type_log,                    //Deferred log text
+  bulk_type_trace,                  //Event trace records
+}bulk_type_t;
+
+
+#if BULK_ENABLE
+
+/*
+ * Client: opens the bulk channel on a server if none is open yet, called once per second for every open connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bool ready: true once discovery has finished on the connection
+ *
+ * Returns:
+ *   None
+ */
+void bulkClientPoll(uint8_t connection, bool ready);
+
+
+/*
+ * Returns the largest record payload the peer accepts on a connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   size_t: Bytes after the record header, 0 if the connection has no open bulk channel
+ */
+size_t bulkMaxRecord(uint8_t connection);
+
+
+/*
+ * Sends one record on the bulk channel of a connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bulk_type_t type: Record type
+ *   const uint8_t *data: Record payload
+ *   size_t len: Payload length, at most bulkMaxRecord()
+ *
+ * Returns:
+ *   sl_status_t: SL_STATUS_OK if queued, SL_STATUS_NO_MORE_RESOURCE if the peer has no credit left or the
+ *                stack buffers are full, SL_STATUS_INVALID_STATE if no channel is open
+ */
+sl_status_t bulkSend(uint8_t connection, bulk_type_t type, const uint8_t *data, size_t len);
+
+
+/*
+ * Opens, accepts and closes the channel, returns credits for received records and hands them on by type
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void bulk_handle_ble_event(sl_bt_msg_t *evt);
+
+#else
+
+static inline void bulkClientPoll(uint8_t connection, bool ready) { (void)connection; (void)ready; }
+static inline size_t bulkMaxRecord(uint8_t connection) { (void)connection; return 0; }
+static inline sl_status_t bulkSend(uint8_t connection, bulk_type_t type, const uint8_t *data, size_t len)
+{
+  (void)connection; (void)type; (void)data; (void)len;
+  return SL_STATUS_INVALID_STATE;
+}
+static inline void bulk_handle_ble_event(sl_bt_msg_t *evt) { (void)evt; }
+
+#endif   //BULK_ENABLE
+
+#endif   //BULK_H
@@ -0,0 +1,427 @@
+/**
+ * @file    :   conn_param.c
+ * @brief   :   API for the adaptive connection-parameter manager
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/conn_param.h"
+#include "src/irq.h"
+#include "sl_bluetooth_connection_config.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+//Parameters of one profile, in the units of sl_bt_connection_set_parameters()
+typedef struct
+{
+  uint16_t min_interval;
+  uint16_t max_interval;
+  uint16_t latency;
+  uint16_t timeout;
+} conn_param_set_t;
+
+//State of one connection
+typedef struct
+{
+  bool in_use;
+  uint8_t connection;
+  conn_param_profile_t requested;   //Last profile asked for
+  bool pending;                     //Waiting for the sl_bt_evt_connection_parameters_id answering the request
+  uint32_t requested_ms;            //letimerMilliseconds() when the request was sent
+  uint32_t busy_ms;                 //letimerMilliseconds() of the last traffic demand
+  uint16_t interval;                //Parameters the link runs with, from the last event
+  uint16_t latency;
+  uint16_t timeout;
+  uint16_t txsize;                  //Largest data channel PDU payload the controller sends
+  uint16_t mtu;                     //ATT MTU agreed in the exchange
+  uint8_t phy;                      //Active PHY, CONN_PARAM_PHY_x
+} conn_param_t;
+
+static const conn_param_set_t conn_param_sets[] =
+{
+  [conn_param_fast]    = { CONN_PARAM_FAST_MIN_INTERVAL, CONN_PARAM_FAST_MAX_INTERVAL, CONN_PARAM_FAST_LATENCY, CONN_PARAM_FAST_TIMEOUT },
+  [conn_param_relaxed] = { CONN_PARAM_RELAXED_INTERVAL, CONN_PARAM_RELAXED_INTERVAL, CONN_PARAM_RELAXED_LATENCY, CONN_PARAM_RELAXED_TIMEOUT },
+};
+
+static conn_param_t conn_param_table[SL_BT_CONFIG_MAX_CONNECTIONS];
+
+
+/*
+ * Looks up the entry of a connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   conn_param_t*: The entry, NULL if the connection is not tracked
+ */
+static conn_param_t* conn_param_find(uint8_t connection)
+{
+  for(uint32_t i = 0; i < SL_BT_CONFIG_MAX_CONNECTIONS; i++)
+    {
+      if((conn_param_table[i].in_use == true) && (conn_param_table[i].connection == connection))
+        return &conn_param_table[i];
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Asks for a profile on a connection, as central the controller applies it, as peripheral the central decides
+ *
+ * Parameters:
+ *   conn_param_t *entry: Connection entry
+ *   conn_param_profile_t profile: conn_param_fast or conn_param_relaxed
+ *
+ * Returns:
+ *   None
+ */
+static void conn_param_request(conn_param_t *entry, conn_param_profile_t profile)
+{
+  sl_status_t error_status;
+  const conn_param_set_t *set = &conn_param_sets[profile];
+
+  entry->requested = profile;
+
+  if((entry->interval >= set->min_interval) && (entry->interval <= set->max_interval) && (entry->latency == set->latency))
+    return;                                                                   //Already running it, no event would answer
+
+  error_status = sl_bt_connection_set_parameters(entry->connection, set->min_interval, set->max_interval, set->latency, set->timeout,
+                                                 CONN_PARAM_MIN_CE_LENGTH, CONN_PARAM_MAX_CE_LENGTH);
+  if(error_status != SL_STATUS_OK)
+    {
+      LOG_ERROR("\r\nError requesting connection parameters: %d\r\n", error_status);
+      entry->requested = conn_param_none;                                     //Tried again on the next poll
+      return;
+    }
+
+  entry->pending = true;
+  entry->requested_ms = letimerMilliseconds();
+}
+
+
+/*
+ * Sets the fast profile as the default for connections this device opens as central
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void connParamSetDefaults()
+{
+  sl_status_t error_status;
+  const conn_param_set_t *set = &conn_param_sets[conn_param_fast];
+
+  error_status = sl_bt_connection_set_default_parameters(set->min_interval, set->max_interval, set->latency, set->timeout,
+                                                         CONN_PARAM_MIN_CE_LENGTH, CONN_PARAM_MAX_CE_LENGTH);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting up default parameters for the connection\r\n");
+}
+
+
+/*
+ * Offers the larger ATT MTU and prefers the 2M PHY on every connection, called at boot in both roles
+ *
+ * The controller runs data length extension on its own up to what the stack buffers allow, the result
+ * shows up as txsize in sl_bt_evt_connection_parameters_id.
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void connParamLinkInit()
+{
+  sl_status_t error_status;
+  uint16_t max_mtu;
+
+  error_status = sl_bt_gatt_set_max_mtu(CONN_PARAM_MAX_MTU, &max_mtu);         //The GATT client then starts the exchange on open
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting the ATT MTU\r\n");
+
+  error_status = sl_bt_connection_set_default_preferred_phy(CONN_PARAM_PHY_2M, CONN_PARAM_PHY_ANY);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting the preferred PHY\r\n");
+}
+
+
+/*
+ * Starts tracking a connection and asks for the 2M PHY, the link stays on 1M if the peer lacks it
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void connParamOpened(uint8_t connection)
+{
+  sl_status_t error_status;
+  conn_param_t *entry = conn_param_find(connection);
+
+  for(uint32_t i = 0; (entry == NULL) && (i < SL_BT_CONFIG_MAX_CONNECTIONS); i++)
+    {
+      if(conn_param_table[i].in_use == false)
+        entry = &conn_param_table[i];
+    }
+
+  if(entry == NULL)
+    return;
+
+  entry->in_use = true;
+  entry->connection = connection;
+  entry->requested = conn_param_none;
+  entry->pending = false;
+  entry->busy_ms = letimerMilliseconds();         //A new link always has discovery or pairing ahead of it
+  entry->interval = 0;
+  entry->latency = 0;
+  entry->timeout = 0;
+  entry->txsize = CONN_PARAM_DEFAULT_TXSIZE;
+  entry->mtu = CONN_PARAM_DEFAULT_MTU;
+  entry->phy = CONN_PARAM_PHY_1M;
+
+  error_status = sl_bt_connection_set_preferred_phy(connection, CONN_PARAM_PHY_2M, CONN_PARAM_PHY_ANY);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError requesting the 2M PHY\r\n");
+}
+
+
+/*
+ * Stops tracking a connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void connParamClosed(uint8_t connection)
+{
+  conn_param_t *entry = conn_param_find(connection);
+
+  if(entry != NULL)
+    entry->in_use = false;
+}
+
+
+/*
+ * Marks traffic demand on a connection, switches it to the fast profile straight away
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void connParamBusy(uint8_t connection)
+{
+  connParamPoll(connection, true);
+}
+
+
+/*
+ * Re-evaluates the profile of a connection, called periodically
+ *
+ * The link goes fast as soon as there is demand and relaxes only after CONN_PARAM_IDLE_MS without any.
+ * A request is sent only when the wanted profile changes, so a central and a peripheral both running the
+ * manager do not keep overriding each other.
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bool busy: true if the caller has traffic waiting on the connection
+ *
+ * Returns:
+ *   None
+ */
+void connParamPoll(uint8_t connection, bool busy)
+{
+  conn_param_t *entry = conn_param_find(connection);
+  uint32_t now = letimerMilliseconds();
+  conn_param_profile_t wanted;
+
+  if(entry == NULL)
+    return;
+
+  if(busy == true)
+    entry->busy_ms = now;
+
+  if((entry->pending == true) && ((now - entry->requested_ms) >= CONN_PARAM_RESPONSE_MS))
+    {
+      LOG_INFO("\r\nConnection %d: no answer to the parameter request\r\n", connection);
+      entry->pending = false;                                                 //Not repeated until the wanted profile changes
+    }
+
+  wanted = ((now - entry->busy_ms) < CONN_PARAM_IDLE_MS) ? conn_param_fast : conn_param_relaxed;
+
+  if((wanted != entry->requested) && (entry->pending == false))
+    conn_param_request(entry, wanted);
+}
+
+
+/*
+ * Records the parameters the link actually runs with
+ *
+ * Parameters:
+ *   sl_bt_evt_connection_parameters_t *params: Connection parameters event
+ *
+ * Returns:
+ *   None
+ */
+void connParamUpdated(sl_bt_evt_connection_parameters_t *params)
+{
+  conn_param_t *entry = conn_param_find(params->connection);
+  bool changed;
+
+  if(entry == NULL)
+    return;
+
+  //Security changes raise this event too, only a change of timing answers a request
+  changed = (params->interval != entry->interval) || (params->latency != entry->latency) || (params->timeout != entry->timeout);
+  if(params->txsize != entry->txsize)
+    {
+      entry->txsize = params->txsize;
+      LOG_INFO("\r\nConnection %d: data length %d bytes\r\n", params->connection, params->txsize);
+    }
+  if(changed == false)
+    return;
+
+  entry->interval = params->interval;
+  entry->latency = params->latency;
+  entry->timeout = params->timeout;
+
+  //The first event after open carries the parameters the central chose, a link already fast needs no request
+  if((entry->requested == conn_param_none) && (params->interval <= CONN_PARAM_FAST_MAX_INTERVAL))
+    entry->requested = conn_param_fast;
+
+  if(entry->pending == true)
+    {
+      const conn_param_set_t *set = &conn_param_sets[entry->requested];
+
+      if((params->interval < set->min_interval) || (params->interval > set->max_interval) || (params->latency != set->latency))
+        LOG_INFO("\r\nConnection %d: peer chose other parameters than requested\r\n", params->connection);
+
+      entry->pending = false;
+    }
+
+  LOG_INFO("\r\nConnection %d: interval %d.%02d ms, latency %d, timeout %d ms\r\n", params->connection,
+           (params->interval * 125) / 100, (params->interval * 125) % 100, params->latency, params->timeout * 10);
+}
+
+
+/*
+ * Records the PHY a link switched to
+ *
+ * Parameters:
+ *   sl_bt_evt_connection_phy_status_t *status: PHY status event
+ *
+ * Returns:
+ *   None
+ */
+void connParamPhyUpdated(sl_bt_evt_connection_phy_status_t *status)
+{
+  conn_param_t *entry = conn_param_find(status->connection);
+
+  if(entry == NULL)
+    return;
+
+  entry->phy = status->phy;
+  LOG_INFO("\r\nConnection %d: PHY %s\r\n", status->connection,
+           (status->phy == CONN_PARAM_PHY_2M) ? "2M" : ((status->phy == CONN_PARAM_PHY_CODED) ? "Coded" : "1M"));
+}
+
+
+/*
+ * Records the ATT MTU agreed on a link
+ *
+ * Parameters:
+ *   sl_bt_evt_gatt_mtu_exchanged_t *exchanged: MTU exchanged event
+ *
+ * Returns:
+ *   None
+ */
+void connParamMtuExchanged(sl_bt_evt_gatt_mtu_exchanged_t *exchanged)
+{
+  conn_param_t *entry = conn_param_find(exchanged->connection);
+
+  if(entry == NULL)
+    return;
+
+  entry->mtu = exchanged->mtu;
+  LOG_INFO("\r\nConnection %d: ATT MTU %d\r\n", exchanged->connection, exchanged->mtu);
+}
+
+
+/*
+ * Returns the PHY of a link
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   uint8_t: CONN_PARAM_PHY_1M, CONN_PARAM_PHY_2M or CONN_PARAM_PHY_CODED
+ */
+uint8_t connParamPhy(uint8_t connection)
+{
+  conn_param_t *entry = conn_param_find(connection);
+
+  return (entry == NULL) ? CONN_PARAM_PHY_1M : entry->phy;
+}
+
+
+/*
+ * Returns the ATT MTU of a link, the largest ATT payload is 3 bytes less for notifications and indications
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   uint16_t: ATT MTU, CONN_PARAM_DEFAULT_MTU until the exchange completes
+ */
+uint16_t connParamMtu(uint8_t connection)
+{
+  conn_param_t *entry = conn_param_find(connection);
+
+  return (entry == NULL) ? CONN_PARAM_DEFAULT_MTU : entry->mtu;
+}
+
+
+/*
+ * Returns the largest link layer payload the controller sends, set by data length extension
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   uint16_t: Bytes per data channel PDU, CONN_PARAM_DEFAULT_TXSIZE until the stack reports it
+ */
+uint16_t connParamTxSize(uint8_t connection)
+{
+  conn_param_t *entry = conn_param_find(connection);
+
+  return (entry == NULL) ? CONN_PARAM_DEFAULT_TXSIZE : entry->txsize;
+}
+
+
+/*
+ * Returns the connection interval of a link
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   uint16_t: Interval in 1.25 ms units, 0 until the stack reports it
+ */
+uint16_t connParamInterval(uint8_t connection)
+{
+  conn_param_t *entry = conn_param_find(connection);
+
+  return (entry == NULL) ? 0 : entry->interval;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file    :   conn_param.h
+ * @brief   :   Headers and function definitions for the adaptive connection-parameter manager
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef CONN_PARAM_H
+#define CONN_PARAM_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "app.h"
+
+//Fast profile, used for discovery, pairing and queue drain. Intervals in 1.25 ms units, timeout in 10 ms units
+#define CONN_PARAM_FAST_MIN_INTERVAL (6)          //7.5 ms
+#define CONN_PARAM_FAST_MAX_INTERVAL (12)         //15 ms
+#define CONN_PARAM_FAST_LATENCY (0)
+#define CONN_PARAM_FAST_TIMEOUT (100)             //1 s
+
+//Relaxed profile for steady state, the peripheral latency is chosen so the link still wakes twice per sampling period
+#define CONN_PARAM_RELAXED_INTERVAL_MS (200)
+#define CONN_PARAM_RELAXED_INTERVAL ((CONN_PARAM_RELAXED_INTERVAL_MS * 4) / 5)
+#define CONN_PARAM_RELAXED_LATENCY (((LETIMER_PERIOD_MS / 2) / CONN_PARAM_RELAXED_INTERVAL_MS) - 1)
+#define CONN_PARAM_RELAXED_TIMEOUT (((2 * (CONN_PARAM_RELAXED_LATENCY + 1) * CONN_PARAM_RELAXED_INTERVAL_MS) + 1000) / 10)
+
+#define CONN_PARAM_MIN_CE_LENGTH (0)
+#define CONN_PARAM_MAX_CE_LENGTH (0xFFFF)
+
+//Time without traffic demand before the link is relaxed
+#define CONN_PARAM_IDLE_MS (2000)
+
+//A request with no sl_bt_evt_connection_parameters_id after this long is given up until the wanted profile changes
+#define CONN_PARAM_RESPONSE_MS (5000)
+
+//Largest ATT MTU offered in the exchange, a notification then carries up to 244 bytes
+#define CONN_PARAM_MAX_MTU (247)
+
+//PHY bits of sl_bt_connection_set_preferred_phy()
+#define CONN_PARAM_PHY_1M (0x01)
+#define CONN_PARAM_PHY_2M (0x02)
+#define CONN_PARAM_PHY_CODED (0x04)
+#define CONN_PARAM_PHY_ANY (0xFF)
+
+//Values a link starts with until the negotiation events arrive
+#define CONN_PARAM_DEFAULT_MTU (23)
+#define CONN_PARAM_DEFAULT_TXSIZE (27)
+
+//Time after open during which a server waiting for indications to be enabled keeps the fast profile
+#define CONN_PARAM_SETUP_MS (10000)
+
+typedef enum
+{
+  conn_param_none,                  //Nothing requested yet, the link runs whatever the central chose
+  conn_param_fast,
+  conn_param_relaxed,
+}conn_param_profile_t;
+
+
+/*
+ * Sets the fast profile as the default for connections this device opens as central
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void connParamSetDefaults();
+
+
+/*
+ * Offers the larger ATT MTU and prefers the 2M PHY on every connection, called at boot in both roles
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void connParamLinkInit();
+
+
+/*
+ * Starts tracking a connection and asks for the 2M PHY, the link stays on 1M if the peer lacks it
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void connParamOpened(uint8_t connection);
+
+
+/*
+ * Stops tracking a connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void connParamClosed(uint8_t connection);
+
+
+/*
+ * Marks traffic demand on a connection, switches it to the fast profile straight away
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void connParamBusy(uint8_t connection);
+
+
+/*
+ * Re-evaluates the profile of a connection, called periodically
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bool busy: true if the caller has traffic waiting on the connection
+ *
+ * Returns:
+ *   None
+ */
+void connParamPoll(uint8_t connection, bool busy);
+
+
+/*
+ * Records the parameters the link actually runs with
+ *
+ * Parameters:
+ *   sl_bt_evt_connection_parameters_t *params: Connection parameters event
+ *
+ * Returns:
+ *   None
+ */
+void connParamUpdated(sl_bt_evt_connection_parameters_t *params);
+
+
+/*
+ * Records the PHY a link switched to
+ *
+ * Parameters:
+ *   sl_bt_evt_connection_phy_status_t *status: PHY status event
+ *
+ * Returns:
+ *   None
+ */
+void connParamPhyUpdated(sl_bt_evt_connection_phy_status_t *status);
+
+
+/*
+ * Records the ATT MTU agreed on a link
+ *
+ * Parameters:
+ *   sl_bt_evt_gatt_mtu_exchanged_t *exchanged: MTU exchanged event
+ *
+ * Returns:
+ *   None
+ */
+void connParamMtuExchanged(sl_bt_evt_gatt_mtu_exchanged_t *exchanged);
+
+
+/*
+ * Returns the PHY of a link
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   uint8_t: CONN_PARAM_PHY_1M, CONN_PARAM_PHY_2M or CONN_PARAM_PHY_CODED
+ */
+uint8_t connParamPhy(uint8_t connection);
+
+
+/*
+ * Returns the ATT MTU of a link, the largest ATT payload is 3 bytes less for notifications and indications
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   uint16_t: ATT MTU, CONN_PARAM_DEFAULT_MTU until the exchange completes
+ */
+uint16_t connParamMtu(uint8_t connection);
+
+
+/*
+ * Returns the largest link layer payload the controller sends, set by data length extension
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   uint16_t: Bytes per data channel PDU, CONN_PARAM_DEFAULT_TXSIZE until the stack reports it
+ */
+uint16_t connParamTxSize(uint8_t connection);
+
+
+/*
+ * Returns the connection interval of a link
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   uint16_t: Interval in 1.25 ms units, 0 until the stack reports it
+ */
+uint16_t connParamInterval(uint8_t connection);
+
+
+#endif   //CONN_PARAM_H
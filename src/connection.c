@@ -0,0 +1,453 @@
+/**
+ * @file    :   connection.c
+ * @brief   :   API for the client connection table
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/connection.h"
+#include "src/scan.h"
+#include "src/irq.h"
+#include "ble_device_type.h"
+#include "string.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+static client_conn_t client_table[CLIENT_MAX_SERVERS];
+
+static bool client_scanning = false;
+
+#if SCAN_USE_ADDRESS_LIST
+//Servers the client connects to, see SERVER_BT_ADDRESS_LIST in ble_device_type.h
+static const bd_addr client_servers[] = SERVER_BT_ADDRESS_LIST;
+
+#define CLIENT_NUM_KNOWN_SERVERS (sizeof(client_servers) / sizeof(client_servers[0]))
+#endif
+
+//Strongest server heard since the ranking window started
+typedef struct
+{
+  bool valid;
+  bd_addr address;
+  uint8_t address_type;
+  int8_t rssi;                    //Smoothed RSSI from the seen table
+  uint32_t window_start_ms;       //letimerMilliseconds() of the first candidate report of the window
+} client_candidate_t;
+
+static client_candidate_t client_candidate;
+
+
+/*
+ * Allocates a table entry for a connection being opened
+ *
+ * Parameters:
+ *   uint8_t connection: Handle returned by sl_bt_connection_open
+ *   bd_addr *address: Address of the server
+ *
+ * Returns:
+ *   client_conn_t*: The new entry, NULL if the table is full
+ */
+client_conn_t* clientConnAlloc(uint8_t connection, bd_addr *address)
+{
+  for(uint32_t slot = 0; slot < CLIENT_MAX_SERVERS; slot++)
+    {
+      if(client_table[slot].in_use == false)
+        {
+          memset(&client_table[slot], 0, sizeof(client_conn_t));
+          client_table[slot].in_use = true;
+          client_table[slot].connection = connection;
+          client_table[slot].address = *address;
+          client_table[slot].state = state0_NO_CONNECTION;
+          client_table[slot].bonding = SL_BT_INVALID_BONDING_HANDLE;
+          seriesInit(&client_table[slot].series);
+          return &client_table[slot];
+        }
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Releases a table entry
+ *
+ * Parameters:
+ *   client_conn_t *conn: Entry to release
+ *
+ * Returns:
+ *   None
+ */
+void clientConnFree(client_conn_t *conn)
+{
+  conn->in_use = false;
+  conn->is_open = false;
+  conn->connection = CLIENT_NO_CONNECTION;
+}
+
+
+/*
+ * Looks up a table entry by connection handle
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   client_conn_t*: The entry, NULL if the handle is not in the table
+ */
+client_conn_t* clientConnFind(uint8_t connection)
+{
+  for(uint32_t slot = 0; slot < CLIENT_MAX_SERVERS; slot++)
+    {
+      if((client_table[slot].in_use == true) && (client_table[slot].connection == connection))
+        return &client_table[slot];
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Looks up a table entry by server address
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *
+ * Returns:
+ *   client_conn_t*: The entry, NULL if the address is not in the table
+ */
+client_conn_t* clientConnFindAddress(bd_addr *address)
+{
+  for(uint32_t slot = 0; slot < CLIENT_MAX_SERVERS; slot++)
+    {
+      if((client_table[slot].in_use == true) && (memcmp(&client_table[slot].address, address, sizeof(bd_addr)) == 0))
+        return &client_table[slot];
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Looks up the table entry an event belongs to
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   client_conn_t*: The entry, NULL if the event carries no connection handle or the handle is unknown
+ */
+client_conn_t* clientConnFromEvent(sl_bt_msg_t *evt)
+{
+  switch (SL_BT_MSG_ID(evt->header))
+  {
+    case sl_bt_evt_connection_opened_id:
+      return clientConnFind(evt->data.evt_connection_opened.connection);
+
+    case sl_bt_evt_connection_closed_id:
+      return clientConnFind(evt->data.evt_connection_closed.connection);
+
+    case sl_bt_evt_connection_parameters_id:
+      return clientConnFind(evt->data.evt_connection_parameters.connection);
+
+    case sl_bt_evt_gatt_service_id:
+      return clientConnFind(evt->data.evt_gatt_service.connection);
+
+    case sl_bt_evt_gatt_characteristic_id:
+      return clientConnFind(evt->data.evt_gatt_characteristic.connection);
+
+    case sl_bt_evt_gatt_characteristic_value_id:
+      return clientConnFind(evt->data.evt_gatt_characteristic_value.connection);
+
+    case sl_bt_evt_gatt_procedure_completed_id:
+      return clientConnFind(evt->data.evt_gatt_procedure_completed.connection);
+
+    case sl_bt_evt_sm_confirm_passkey_id:
+      return clientConnFind(evt->data.evt_sm_confirm_passkey.connection);
+
+    case sl_bt_evt_sm_confirm_bonding_id:
+      return clientConnFind(evt->data.evt_sm_confirm_bonding.connection);
+
+    case sl_bt_evt_sm_bonded_id:
+      return clientConnFind(evt->data.evt_sm_bonded.connection);
+
+    case sl_bt_evt_sm_bonding_failed_id:
+      return clientConnFind(evt->data.evt_sm_bonding_failed.connection);
+
+    default:
+      return NULL;
+  }
+}
+
+
+/*
+ * Returns a table entry by slot, used to walk the table
+ *
+ * Parameters:
+ *   uint32_t slot: 0 to CLIENT_MAX_SERVERS - 1
+ *
+ * Returns:
+ *   client_conn_t*: The entry, NULL if the slot is unused
+ */
+client_conn_t* clientConnSlot(uint32_t slot)
+{
+  if((slot >= CLIENT_MAX_SERVERS) || (client_table[slot].in_use == false))
+    return NULL;
+
+  return &client_table[slot];
+}
+
+
+/*
+ * Returns the slot number of an entry, used to label servers on the LCD and in logs
+ *
+ * Parameters:
+ *   client_conn_t *conn: Table entry
+ *
+ * Returns:
+ *   uint32_t: Slot number
+ */
+uint32_t clientConnIndex(client_conn_t *conn)
+{
+  return (uint32_t)(conn - client_table);
+}
+
+
+/*
+ * Returns the number of entries in use
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t: Number of servers connected or being connected
+ */
+uint32_t clientConnCount()
+{
+  uint32_t count = 0;
+
+  for(uint32_t slot = 0; slot < CLIENT_MAX_SERVERS; slot++)
+    {
+      if(client_table[slot].in_use == true)
+        count++;
+    }
+
+  return count;
+}
+
+
+/*
+ * Returns whether an open is in progress, the stack only runs one at a time
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   bool: true if a connection was requested and has not opened or failed yet
+ */
+static bool client_open_pending()
+{
+  for(uint32_t slot = 0; slot < CLIENT_MAX_SERVERS; slot++)
+    {
+      if((client_table[slot].in_use == true) && (client_table[slot].is_open == false))
+        return true;
+    }
+
+  return false;
+}
+
+
+#if SCAN_USE_ADDRESS_LIST
+/*
+ * Checks whether an address is one of the servers listed in SERVER_BT_ADDRESS_LIST
+ *
+ * Parameters:
+ *   bd_addr *address: Advertiser address
+ *
+ * Returns:
+ *   bool: true if the address is listed
+ */
+static bool client_server_listed(bd_addr *address)
+{
+  for(uint32_t i = 0; i < CLIENT_NUM_KNOWN_SERVERS; i++)
+    {
+      if(memcmp(&client_servers[i], address, sizeof(bd_addr)) == 0)
+        return true;
+    }
+
+  return false;
+}
+#endif
+
+
+/*
+ * Starts an open towards a server
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *   uint8_t address_type: Server address type from the scan report
+ *
+ * Returns:
+ *   None
+ */
+static void client_open(bd_addr *address, uint8_t address_type)
+{
+  sl_status_t error_status;
+  uint8_t connection;
+  client_conn_t *conn;
+
+  //Scanning stops while the open is pending, clientScannerUpdate() resumes it once the open resolves
+  if(client_scanning == true)
+    {
+      error_status = sl_bt_scanner_stop();
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError stopping scanning\r\n");
+      client_scanning = false;
+    }
+
+  error_status = sl_bt_connection_open(*address, address_type, PHYSICAL_LAYER_1M, &connection);
+  if(error_status != SL_STATUS_OK)
+    {
+      LOG_ERROR("\r\nError opening a connection\r\n");
+      clientScannerUpdate();
+      return;
+    }
+
+  conn = clientConnAlloc(connection, address);
+  if(conn != NULL)
+    conn->open_ms = letimerMilliseconds();
+}
+
+
+/*
+ * Filters a scan report and opens the strongest server heard during the ranking window
+ *
+ * Parameters:
+ *   sl_bt_evt_scanner_scan_report_t *report: Scan report
+ *
+ * Returns:
+ *   None
+ */
+void clientConnScanReport(sl_bt_evt_scanner_scan_report_t *report)
+{
+  int8_t rssi;
+  uint8_t adv_type = report->packet_type & 0x07;
+  uint32_t now;
+
+  //Every advertiser goes through the seen table so its advertising data is only parsed once
+  if(scanFilterReport(report, &rssi) == false)
+    return;
+
+  if((adv_type != 0) && (adv_type != 1))                 //Only connectable advertising
+    return;
+
+#if SCAN_USE_ADDRESS_LIST
+  if(client_server_listed(&report->address) == false)
+    return;
+#endif
+
+  if((clientConnFindAddress(&report->address) != NULL) || (client_open_pending() == true) || (clientConnCount() >= CLIENT_MAX_SERVERS))
+    return;
+
+  now = letimerMilliseconds();
+
+  if(client_candidate.valid == false)
+    {
+      client_candidate.valid = true;
+      client_candidate.window_start_ms = now;
+      client_candidate.address = report->address;
+      client_candidate.address_type = report->address_type;
+      client_candidate.rssi = rssi;
+    }
+  else if((memcmp(&client_candidate.address, &report->address, sizeof(bd_addr)) == 0) || (rssi > client_candidate.rssi))
+    {
+      client_candidate.address = report->address;
+      client_candidate.address_type = report->address_type;
+      client_candidate.rssi = rssi;
+    }
+
+  if((now - client_candidate.window_start_ms) < SCAN_RANK_WINDOW_MS)
+    return;
+
+  LOG_INFO("\r\nOpening %02x:%02x:%02x:%02x:%02x:%02x at %d dBm\r\n", client_candidate.address.addr[5], client_candidate.address.addr[4],
+           client_candidate.address.addr[3], client_candidate.address.addr[2], client_candidate.address.addr[1], client_candidate.address.addr[0],
+           client_candidate.rssi);
+
+  client_candidate.valid = false;
+  client_open(&client_candidate.address, client_candidate.address_type);
+}
+
+
+/*
+ * Cancels an open that has not completed within CLIENT_OPEN_TIMEOUT_MS, called once per LCD tick. The
+ * closed event that follows frees the entry and resumes scanning
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void clientConnOpenPoll()
+{
+  sl_status_t error_status;
+  client_conn_t *conn;
+  uint32_t now = letimerMilliseconds();
+
+  for(uint32_t slot = 0; slot < CLIENT_MAX_SERVERS; slot++)
+    {
+      conn = &client_table[slot];
+      if((conn->in_use == false) || (conn->is_open == true) || (conn->is_cancelled == true)
+          || ((now - conn->open_ms) < CLIENT_OPEN_TIMEOUT_MS))
+        continue;
+
+      LOG_INFO("\r\nOpen of %02x:%02x:%02x:%02x:%02x:%02x timed out\r\n", conn->address.addr[5], conn->address.addr[4],
+               conn->address.addr[3], conn->address.addr[2], conn->address.addr[1], conn->address.addr[0]);
+
+      //Cancels the connection establishment, a failed close is tried again on the next tick
+      error_status = sl_bt_connection_close(conn->connection);
+      if(error_status != SL_STATUS_OK)
+        {
+          LOG_ERROR("\r\nError cancelling a connection open\r\n");
+          continue;
+        }
+
+      conn->is_cancelled = true;
+    }
+}
+
+
+/*
+ * Starts scanning when a slot is free and no open is pending, stops it otherwise
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void clientScannerUpdate()
+{
+  sl_status_t error_status;
+  bool want_scan = (clientConnCount() < CLIENT_MAX_SERVERS) && (client_open_pending() == false);
+
+  if((want_scan == true) && (client_scanning == false))
+    {
+      error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError starting connection scanning\r\n");
+      else
+        client_scanning = true;
+    }
+
+  else if((want_scan == false) && (client_scanning == true))
+    {
+      error_status = sl_bt_scanner_stop();
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError stopping scanning\r\n");
+      client_scanning = false;
+    }
+}
@@ -0,0 +1,193 @@
+/**
+ * @file    :   connection.h
+ * @brief   :   Headers and function definitions for the client connection table
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "sl_bluetooth_connection_config.h"
+#include "src/scheduler.h"
+#include "src/gatt_cache.h"
+#include "src/series.h"
+
+//Number of servers the client holds at once, one stack connection each
+#define CLIENT_MAX_SERVERS (SL_BT_CONFIG_MAX_CONNECTIONS)
+
+//Connection handle value meaning no connection
+#define CLIENT_NO_CONNECTION (0xFF)
+
+//An open that has not completed after this long is cancelled so scanning can resume, the server stopped advertising
+#define CLIENT_OPEN_TIMEOUT_MS (5000)
+
+//State of one server connection, allocated when the connection is opened and freed when it closes
+typedef struct
+{
+  bool in_use;
+  bool is_open;                        //Set once sl_bt_evt_connection_opened_id arrives
+  bool is_cancelled;                   //The open timed out and was closed, the entry is freed on the closed event
+  bool is_bonded;
+  bool is_encrypted;                   //Set once the link is encrypted, with a new pairing or a stored bond
+  bool cccd_refused;                   //A CCCD write hit insufficient encryption, both are written again once encrypted
+  bool pair_pending;                   //Waits for the pairing of another server to end, the buttons confirm one passkey at a time
+  uint8_t bonding;                     //Stored bond of the server, SL_BT_INVALID_BONDING_HANDLE if none
+  uint8_t connection;                  //Stack connection handle, the key of the table
+  bd_addr address;
+  client_state_t state;                //Discovery state machine state for this connection
+  uint32_t gattServiceHandle;          //Generic Attribute service of the server, 0 until discovered
+  uint32_t htmServiceHandle;
+  uint32_t buttonServiceHandle;
+  uint16_t htmCharacteristicHandle;
+  uint16_t buttonCharacteristicHandle;
+  int32_t temp_value;
+  uint32_t samples;                    //Temperature indications received on this connection
+  series_t series;                     //Sliding window of the temperatures received on this connection
+  uint8_t db_hash[GATT_DATABASE_HASH_LEN];
+  bool db_hash_valid;                  //Set once the server Database Hash has been read
+  uint32_t open_ms;                    //letimerMilliseconds() when the open was requested
+  uint32_t opened_ms;                  //letimerMilliseconds() when the connection opened
+} client_conn_t;
+
+
+/*
+ * Allocates a table entry for a connection being opened
+ *
+ * Parameters:
+ *   uint8_t connection: Handle returned by sl_bt_connection_open
+ *   bd_addr *address: Address of the server
+ *
+ * Returns:
+ *   client_conn_t*: The new entry, NULL if the table is full
+ */
+client_conn_t* clientConnAlloc(uint8_t connection, bd_addr *address);
+
+
+/*
+ * Releases a table entry
+ *
+ * Parameters:
+ *   client_conn_t *conn: Entry to release
+ *
+ * Returns:
+ *   None
+ */
+void clientConnFree(client_conn_t *conn);
+
+
+/*
+ * Looks up a table entry by connection handle
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   client_conn_t*: The entry, NULL if the handle is not in the table
+ */
+client_conn_t* clientConnFind(uint8_t connection);
+
+
+/*
+ * Looks up a table entry by server address
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *
+ * Returns:
+ *   client_conn_t*: The entry, NULL if the address is not in the table
+ */
+client_conn_t* clientConnFindAddress(bd_addr *address);
+
+
+/*
+ * Looks up the table entry an event belongs to
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   client_conn_t*: The entry, NULL if the event carries no connection handle or the handle is unknown
+ */
+client_conn_t* clientConnFromEvent(sl_bt_msg_t *evt);
+
+
+/*
+ * Returns a table entry by slot, used to walk the table
+ *
+ * Parameters:
+ *   uint32_t slot: 0 to CLIENT_MAX_SERVERS - 1
+ *
+ * Returns:
+ *   client_conn_t*: The entry, NULL if the slot is unused
+ */
+client_conn_t* clientConnSlot(uint32_t slot);
+
+
+/*
+ * Returns the slot number of an entry, used to label servers on the LCD and in logs
+ *
+ * Parameters:
+ *   client_conn_t *conn: Table entry
+ *
+ * Returns:
+ *   uint32_t: Slot number
+ */
+uint32_t clientConnIndex(client_conn_t *conn);
+
+
+/*
+ * Returns the number of entries in use
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t: Number of servers connected or being connected
+ */
+uint32_t clientConnCount();
+
+
+/*
+ * Filters a scan report and opens the strongest server heard during the ranking window
+ *
+ * Parameters:
+ *   sl_bt_evt_scanner_scan_report_t *report: Scan report
+ *
+ * Returns:
+ *   None
+ */
+void clientConnScanReport(sl_bt_evt_scanner_scan_report_t *report);
+
+
+/*
+ * Cancels an open that has not completed within CLIENT_OPEN_TIMEOUT_MS, called once per LCD tick. The
+ * closed event that follows frees the entry and resumes scanning
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void clientConnOpenPoll();
+
+
+/*
+ * Starts scanning when a slot is free and no open is pending, stops it otherwise
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void clientScannerUpdate();
+
+
+#endif   //CONNECTION_H
@@ -0,0 +1,75 @@
+/**
+ * @file    :   dispatch.h
+ * @brief   :   Headers and function definitions for the Bluetooth event dispatcher
+ *
+ *              Modules register a handler for each event id they act on in one const table
+ *              sorted by event id. An event is looked up with a binary search and handed to
+ *              every entry for its id whose role matches the role picked at boot.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "ble_device_type.h"
+
+//Roles a handler runs in
+#define BLE_ROLE_SERVER (0x01)
+#define BLE_ROLE_CLIENT (0x02)
+#define BLE_ROLE_ANY (BLE_ROLE_SERVER | BLE_ROLE_CLIENT)
+
+typedef void (*ble_handler_t)(sl_bt_msg_t *evt);
+
+//One registration: the handler runs for events with this id in the given roles
+typedef struct
+{
+  uint32_t id;                      //SL_BT_MSG_ID() of the event
+  uint8_t roles;                    //BLE_ROLE_x
+  ble_handler_t handler;
+}ble_handler_entry_t;
+
+
+/*
+ * Picks the role for this boot, called from app_init() before the stack starts.
+ * With DEVICE_ROLE_AT_BOOT holding PB1 through reset starts the role DEVICE_IS_BLE_SERVER does not select
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void bleRoleSelect();
+
+
+/*
+ * Returns the role picked at boot
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   bool: true for the server, false for the client
+ */
+bool bleRoleIsServer();
+
+
+/*
+ * Hands an event to every handler registered for its id in the current role
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void bleDispatch(sl_bt_msg_t *evt);
+
+
+#endif   //DISPATCH_H
@@ -0,0 +1,429 @@
+/**
+ * @file    :   gateway.c
+ * @brief   :   API for the client gateway output
+ *
+ *              A frame is built and copied into the transmit ring inside one critical section, so
+ *              frames from the event loop and log lines from an ISR never interleave. The LDMA sends
+ *              the ring in contiguous runs straight to the USART TXDATA register on its TXBL request;
+ *              the ISR of each finished run frees it and starts the next, so the CPU never touches
+ *              the bytes again once they are queued. EM1 is held from the first run until the USART
+ *              TXC interrupt after the ring drains, the last bytes are still in the USART when the
+ *              LDMA finishes.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/gateway.h"
+
+#if BUILD_INCLUDES_BLE_CLIENT && GATEWAY_ENABLE
+#include "em_core.h"
+#include "em_cmu.h"
+#include "em_bus.h"
+#include "em_usart.h"
+#include "sl_power_manager.h"
+#include "sl_iostream.h"
+#include "sl_iostream_usart.h"
+#include "sl_iostream_init_usart_instances.h"
+#include "app_log.h"
+#include "src/series.h"
+#include "src/irq.h"
+#include "string.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+//Largest payload of any frame type
+#define GATEWAY_PAYLOAD_MAX (GATEWAY_LOG_LINE_MAX)
+
+//Bytes of the CRC after the payload
+#define GATEWAY_CRC_LEN (2)
+
+//USART the log output was sent on before gateway mode took it over
+#define GATEWAY_USART (USART0)
+
+static struct
+{
+  uint8_t buffer[GATEWAY_TX_BUFFER_SIZE];
+  uint32_t head;                    //Next byte written
+  uint32_t tail;                    //Next byte sent
+  uint32_t count;                   //Bytes queued, the running transfer included
+  uint32_t in_flight;               //Bytes of the running LDMA transfer, 0 when idle
+  bool is_em1_held;                 //From the first run until the USART has sent the last byte
+  uint8_t seq;                      //Also counts dropped frames, so the host sees them as gaps
+  char log_line[GATEWAY_LOG_LINE_MAX];
+  uint32_t log_len;
+}gateway;
+
+//CRC-16/CCITT-FALSE, one entry per 4 bit step
+static const uint16_t gateway_crc_table[16] =
+{
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static sl_status_t gateway_log_write(void *context, const void *buffer, size_t length);
+
+//Stream the log output is moved to, each line becomes a GATEWAY_FRAME_LOG frame
+static sl_iostream_t gateway_log_stream =
+{
+  .context = NULL,
+  .write = gateway_log_write,
+  .read = NULL
+};
+
+
+/*
+ * Adds bytes to a CRC-16/CCITT-FALSE
+ *
+ * Parameters:
+ *   uint16_t crc: CRC so far, 0xFFFF to start
+ *   const uint8_t *data: Bytes to add
+ *   uint32_t length: Number of bytes
+ *
+ * Returns:
+ *   uint16_t: The updated CRC
+ */
+static uint16_t gateway_crc(uint16_t crc, const uint8_t *data, uint32_t length)
+{
+  for(uint32_t i = 0; i < length; i++)
+    {
+      crc = (crc << 4) ^ gateway_crc_table[(crc >> 12) ^ (data[i] >> 4)];
+      crc = (crc << 4) ^ gateway_crc_table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+
+  return crc;
+}
+
+
+/*
+ * Starts an LDMA transfer of the next contiguous run of the ring, if any and if none is running.
+ * Called with interrupts masked
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void gateway_dma_start()
+{
+  uint32_t length;
+
+  if((gateway.in_flight != 0) || (gateway.count == 0))
+    return;
+
+  //Up to the end of the ring, the rest goes in the next transfer
+  length = GATEWAY_TX_BUFFER_SIZE - gateway.tail;
+  if(length > gateway.count)
+    length = gateway.count;
+  gateway.in_flight = length;
+
+  //The USART stops in EM2, hold EM1 until the ring drains and the USART is done with it
+  if(gateway.is_em1_held == false)
+    {
+      sl_power_manager_add_em_requirement(SL_POWER_MANAGER_EM1);
+      gateway.is_em1_held = true;
+    }
+
+  LDMA->CH[GATEWAY_DMA_CHANNEL].SRC = (uint32_t)&gateway.buffer[gateway.tail];
+  LDMA->CH[GATEWAY_DMA_CHANNEL].CTRL = LDMA_CH_CTRL_STRUCTTYPE_TRANSFER |
+                                       (((length - 1) << _LDMA_CH_CTRL_XFERCNT_SHIFT) & _LDMA_CH_CTRL_XFERCNT_MASK) |
+                                       LDMA_CH_CTRL_BLOCKSIZE_UNIT1 |
+                                       LDMA_CH_CTRL_REQMODE_BLOCK |
+                                       LDMA_CH_CTRL_DONEIFSEN |
+                                       LDMA_CH_CTRL_SIZE_BYTE |
+                                       LDMA_CH_CTRL_SRCINC_ONE |
+                                       LDMA_CH_CTRL_DSTINC_NONE;
+
+  BUS_RegMaskedClear(&LDMA->CHDONE, 1 << GATEWAY_DMA_CHANNEL);
+  BUS_RegMaskedSet(&LDMA->CHEN, 1 << GATEWAY_DMA_CHANNEL);
+}
+
+
+/*
+ * Queues one frame, or drops it whole if the ring has no room for it. Never waits
+ *
+ * Parameters:
+ *   gateway_frame_t type: Frame type
+ *   const void *payload: Payload bytes
+ *   uint32_t length: Payload length, up to GATEWAY_PAYLOAD_MAX
+ *
+ * Returns:
+ *   None
+ */
+static void gateway_send(gateway_frame_t type, const void *payload, uint32_t length)
+{
+  uint8_t frame[sizeof(gateway_header_t) + GATEWAY_PAYLOAD_MAX + GATEWAY_CRC_LEN];
+  gateway_header_t header;
+  uint32_t frame_len = sizeof(gateway_header_t) + length + GATEWAY_CRC_LEN;
+  uint32_t first;
+  uint16_t crc;
+
+  CORE_DECLARE_IRQ_STATE;
+
+  header.sync = GATEWAY_SYNC;
+  header.length = length;
+  header.type = type;
+  header.time_ms = letimerMilliseconds();
+
+  CORE_ENTER_CRITICAL();
+
+  header.seq = gateway.seq++;
+  if((GATEWAY_TX_BUFFER_SIZE - gateway.count) < frame_len)
+    {
+      CORE_EXIT_CRITICAL();
+      return;
+    }
+
+  memcpy(frame, &header, sizeof(gateway_header_t));
+  memcpy(&frame[sizeof(gateway_header_t)], payload, length);
+  crc = gateway_crc(0xFFFF, &frame[1], sizeof(gateway_header_t) - 1 + length);
+  frame[sizeof(gateway_header_t) + length] = crc & 0xFF;
+  frame[sizeof(gateway_header_t) + length + 1] = crc >> 8;
+
+  //Copy in at most two runs, the second one from the start of the ring
+  first = GATEWAY_TX_BUFFER_SIZE - gateway.head;
+  if(first > frame_len)
+    first = frame_len;
+  memcpy(&gateway.buffer[gateway.head], frame, first);
+  memcpy(gateway.buffer, &frame[first], frame_len - first);
+  gateway.head = (gateway.head + frame_len) & (GATEWAY_TX_BUFFER_SIZE - 1);
+  gateway.count += frame_len;
+
+  gateway_dma_start();
+
+  CORE_EXIT_CRITICAL();
+}
+
+
+/*
+ * Write function of the log stream, collects text into lines and sends each line as one frame
+ *
+ * Parameters:
+ *   void *context: Unused
+ *   const void *buffer: Text
+ *   size_t length: Number of characters
+ *
+ * Returns:
+ *   sl_status_t: SL_STATUS_OK, a line that does not fit in the ring is dropped like any frame
+ */
+static sl_status_t gateway_log_write(void *context, const void *buffer, size_t length)
+{
+  const char *text = buffer;
+
+  CORE_DECLARE_IRQ_STATE;
+
+  (void)context;
+
+  CORE_ENTER_CRITICAL();
+  for(size_t i = 0; i < length; i++)
+    {
+      if((text[i] != '\n') && (text[i] != '\r'))
+        gateway.log_line[gateway.log_len++] = text[i];
+
+      if(((text[i] == '\n') && (gateway.log_len != 0)) || (gateway.log_len == GATEWAY_LOG_LINE_MAX))
+        {
+          gateway_send(GATEWAY_FRAME_LOG, gateway.log_line, gateway.log_len);
+          gateway.log_len = 0;
+        }
+    }
+  CORE_EXIT_CRITICAL();
+
+  return SL_STATUS_OK;
+}
+
+
+/*
+ * Sets up the LDMA channel on the VCOM USART and moves the log output into frames
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void gatewayBoot(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+
+  (void)evt;
+
+  memset(&gateway, 0, sizeof(gateway));
+
+  //Let the log stream finish what it queued before boot, its ring is drained by the TXBL and TXC interrupts
+  while(GATEWAY_USART->IEN & (USART_IEN_TXBL | USART_IEN_TXC))
+    ;
+
+  sl_iostream_usart_set_txc_callback(sl_iostream_uart_vcom_handle, gatewayTransmitComplete);
+
+  error_status = app_log_iostream_set(&gateway_log_stream);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError moving the log output to the gateway: %d\r\n", (int)error_status);
+
+  CMU_ClockEnable(cmuClock_LDMA, true);
+
+  LDMA->CH[GATEWAY_DMA_CHANNEL].REQSEL = LDMA_CH_REQSEL_SOURCESEL_USART0 | LDMA_CH_REQSEL_SIGSEL_USART0TXBL;
+  LDMA->CH[GATEWAY_DMA_CHANNEL].CFG = 0;
+  LDMA->CH[GATEWAY_DMA_CHANNEL].LOOP = 0;
+  LDMA->CH[GATEWAY_DMA_CHANNEL].LINK = 0;
+  LDMA->CH[GATEWAY_DMA_CHANNEL].DST = (uint32_t)&GATEWAY_USART->TXDATA;
+
+  LDMA->IFC = 1 << GATEWAY_DMA_CHANNEL;
+  BUS_RegMaskedSet(&LDMA->IEN, 1 << GATEWAY_DMA_CHANNEL);
+  NVIC_ClearPendingIRQ(LDMA_IRQn);
+  NVIC_EnableIRQ(LDMA_IRQn);
+
+  LOG_INFO("\r\nGateway output on VCOM, frame ring %d bytes\r\n", GATEWAY_TX_BUFFER_SIZE);
+}
+
+
+/*
+ * Reports a received temperature and the window statistics of its server
+ *
+ * Parameters:
+ *   client_conn_t *conn: Server connection, its series already holds the sample
+ *
+ * Returns:
+ *   None
+ */
+void gatewaySample(client_conn_t *conn)
+{
+  gateway_sample_t sample;
+  gateway_stats_t stats_frame;
+  series_stats_t stats;
+
+  sample.server = clientConnIndex(conn);
+  sample.connection = conn->connection;
+  sample.temp_c = seriesAt(&conn->series, 0);
+  sample.samples = conn->samples;
+  gateway_send(GATEWAY_FRAME_SAMPLE, &sample, sizeof(sample));
+
+  seriesStats(&conn->series, &stats);
+  stats_frame.server = sample.server;
+  stats_frame.connection = sample.connection;
+  stats_frame.count = stats.count;
+  stats_frame.latest = stats.latest;
+  stats_frame.min = stats.min;
+  stats_frame.max = stats.max;
+  stats_frame.mean_x10 = stats.mean_x10;
+  stats_frame.variance_x100 = stats.variance_x100;
+  gateway_send(GATEWAY_FRAME_STATS, &stats_frame, sizeof(stats_frame));
+}
+
+
+/*
+ * Fills in and sends a link frame
+ *
+ * Parameters:
+ *   gateway_link_event_t event: Opened or closed
+ *   uint8_t connection: Stack connection handle
+ *   uint16_t reason: Close reason, 0 on open
+ *
+ * Returns:
+ *   None
+ */
+static void gateway_link(gateway_link_event_t event, uint8_t connection, uint16_t reason)
+{
+  gateway_link_t link;
+  client_conn_t *conn = clientConnFind(connection);
+
+  memset(&link, 0, sizeof(link));
+  link.event = event;
+  link.server = (conn != NULL) ? clientConnIndex(conn) : 0xFF;
+  link.connection = connection;
+  if(conn != NULL)
+    memcpy(link.address, conn->address.addr, sizeof(link.address));
+  link.reason = reason;
+
+  gateway_send(GATEWAY_FRAME_LINK, &link, sizeof(link));
+}
+
+
+/*
+ * Reports a server connection that opened
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void gatewayOpened(sl_bt_msg_t *evt)
+{
+  gateway_link(GATEWAY_LINK_OPENED, evt->data.evt_connection_opened.connection, 0);
+}
+
+
+/*
+ * Reports a server connection that closed
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void gatewayClosed(sl_bt_msg_t *evt)
+{
+  gateway_link(GATEWAY_LINK_CLOSED, evt->data.evt_connection_closed.connection, evt->data.evt_connection_closed.reason);
+}
+
+
+/*
+ * Advances the transmit ring past the finished LDMA transfer and starts the next one, or arms the USART TXC
+ * interrupt once the ring is empty. Called from the LDMA ISR
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void gatewayTransmitDone()
+{
+  if(gateway.in_flight == 0)
+    return;
+
+  gateway.tail = (gateway.tail + gateway.in_flight) & (GATEWAY_TX_BUFFER_SIZE - 1);
+  gateway.count -= gateway.in_flight;
+  gateway.in_flight = 0;
+
+  gateway_dma_start();
+  if(gateway.in_flight != 0)
+    return;
+
+  //The last bytes are still in the TX buffer and the shifter, EM1 goes in gatewayTransmitComplete()
+  USART_IntClear(GATEWAY_USART, USART_IF_TXC);
+  USART_IntEnable(GATEWAY_USART, USART_IF_TXC);
+  if(GATEWAY_USART->STATUS & USART_STATUS_TXC)
+    USART_IntSet(GATEWAY_USART, USART_IF_TXC);                 //Already on the wire before the flag was cleared
+}
+
+
+/*
+ * Releases EM1 once the USART has sent the last byte of the ring, unless a new run started since.
+ * Called from the USART TX ISR
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void gatewayTransmitComplete()
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  if((gateway.in_flight == 0) && (gateway.is_em1_held == true))
+    {
+      sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
+      gateway.is_em1_held = false;
+    }
+  CORE_EXIT_CRITICAL();
+}
+
+#endif   //BUILD_INCLUDES_BLE_CLIENT && GATEWAY_ENABLE
@@ -0,0 +1,191 @@
+/**
+ * @file    :   gateway.h
+ * @brief   :   Headers and function definitions for the client gateway output
+ *
+ *              In gateway mode the client reports every temperature it receives, the window
+ *              statistics of its server and every server connection opened or closed as binary
+ *              frames over VCOM, for tools/gateway_ingest.py on the host. Frames are queued in a RAM
+ *              ring and sent by LDMA, so reporting never waits for the USART; a frame that does not
+ *              fit is dropped and shows as a gap in the sequence numbers. The log output is carried
+ *              in frames too, so the LDMA is the only writer of the USART.
+ *
+ *              Frame, little endian:
+ *                sync (GATEWAY_SYNC), payload length, type, sequence number, letimerMilliseconds()
+ *                (uint32), payload, CRC-16/CCITT-FALSE of everything after the sync byte (uint16)
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "src/connection.h"
+#include "ble_device_type.h"
+
+//Set to 1 to send binary frames over VCOM instead of text logs
+#define GATEWAY_ENABLE (0)
+
+//Size of the transmit ring, must be a power of 2 and at most the 2048 transfers of one LDMA descriptor
+#define GATEWAY_TX_BUFFER_SIZE (1024)
+
+//LDMA channel of the transmit, the SDK drivers allocate channels from 0
+#define GATEWAY_DMA_CHANNEL (7)
+
+//First byte of every frame
+#define GATEWAY_SYNC (0xA5)
+
+//Longest log line carried in one frame, longer lines are split
+#define GATEWAY_LOG_LINE_MAX (96)
+
+//Frame types
+typedef enum
+{
+  GATEWAY_FRAME_SAMPLE = 1,
+  GATEWAY_FRAME_LINK = 2,
+  GATEWAY_FRAME_STATS = 3,
+  GATEWAY_FRAME_LOG = 4
+}gateway_frame_t;
+
+//Events of GATEWAY_FRAME_LINK
+typedef enum
+{
+  GATEWAY_LINK_OPENED = 1,
+  GATEWAY_LINK_CLOSED = 2
+}gateway_link_event_t;
+
+//Header of every frame, 8 bytes
+typedef struct __attribute__((packed))
+{
+  uint8_t sync;                     //GATEWAY_SYNC
+  uint8_t length;                   //Payload bytes
+  uint8_t type;                     //gateway_frame_t
+  uint8_t seq;                      //Counts every frame, sent or dropped
+  uint32_t time_ms;                 //letimerMilliseconds() when the frame was queued
+}gateway_header_t;
+
+//GATEWAY_FRAME_SAMPLE, one temperature indication, 8 bytes
+typedef struct __attribute__((packed))
+{
+  uint8_t server;                   //clientConnIndex() of the server
+  uint8_t connection;
+  int16_t temp_c;
+  uint32_t samples;                 //Indications received on the connection
+}gateway_sample_t;
+
+//GATEWAY_FRAME_LINK, 11 bytes
+typedef struct __attribute__((packed))
+{
+  uint8_t event;                    //gateway_link_event_t
+  uint8_t server;                   //clientConnIndex() of the server, 0xFF if the connection has no table entry
+  uint8_t connection;
+  uint8_t address[6];               //Server address, least significant byte first
+  uint16_t reason;                  //sl_status_t of the close, 0 on open
+}gateway_link_t;
+
+//GATEWAY_FRAME_STATS, window statistics after a sample, 17 bytes
+typedef struct __attribute__((packed))
+{
+  uint8_t server;
+  uint8_t connection;
+  uint8_t count;                    //Samples in the window
+  int16_t latest;
+  int16_t min;
+  int16_t max;
+  int32_t mean_x10;
+  uint32_t variance_x100;
+}gateway_stats_t;
+
+
+#if BUILD_INCLUDES_BLE_CLIENT && GATEWAY_ENABLE
+
+/*
+ * Sets up the LDMA channel on the VCOM USART and moves the log output into frames
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void gatewayBoot(sl_bt_msg_t *evt);
+
+
+/*
+ * Reports a received temperature and the window statistics of its server
+ *
+ * Parameters:
+ *   client_conn_t *conn: Server connection, its series already holds the sample
+ *
+ * Returns:
+ *   None
+ */
+void gatewaySample(client_conn_t *conn);
+
+
+/*
+ * Reports a server connection that opened
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_opened_id
+ *
+ * Returns:
+ *   None
+ */
+void gatewayOpened(sl_bt_msg_t *evt);
+
+
+/*
+ * Reports a server connection that closed
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void gatewayClosed(sl_bt_msg_t *evt);
+
+
+/*
+ * Advances the transmit ring past the finished LDMA transfer and starts the next one, or arms the USART TXC
+ * interrupt once the ring is empty. Called from the LDMA ISR
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void gatewayTransmitDone();
+
+
+/*
+ * Releases EM1 once the USART has sent the last byte of the ring, unless a new run started since.
+ * Called from the USART TX ISR
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void gatewayTransmitComplete();
+
+#else
+
+static inline void gatewayBoot(sl_bt_msg_t *evt) { (void)evt; }
+static inline void gatewaySample(client_conn_t *conn) { (void)conn; }
+static inline void gatewayOpened(sl_bt_msg_t *evt) { (void)evt; }
+static inline void gatewayClosed(sl_bt_msg_t *evt) { (void)evt; }
+static inline void gatewayTransmitDone() { }
+static inline void gatewayTransmitComplete() { }
+
+#endif   //BUILD_INCLUDES_BLE_CLIENT && GATEWAY_ENABLE
+
+
+#endif   //GATEWAY_H
@@ -0,0 +1,130 @@
+/**
+ * @file    :   gatt_cache.c
+ * @brief   :   API for the client GATT handle cache
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/gatt_cache.h"
+#include "string.h"
+
+typedef struct
+{
+  bool valid;
+  bd_addr address;
+  uint8_t hash[GATT_DATABASE_HASH_LEN];
+  gatt_cache_handles_t handles;
+  uint32_t last_used;                     //Value of gatt_cache_clock when the entry was last stored or hit
+} gatt_cache_entry_t;
+
+static gatt_cache_entry_t gatt_cache[GATT_CACHE_DEPTH];
+static uint32_t gatt_cache_clock = 0;
+
+
+/*
+ * Finds the entry of a server
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *
+ * Returns:
+ *   gatt_cache_entry_t*: The entry, NULL if the server is not cached
+ */
+static gatt_cache_entry_t* gatt_cache_find(bd_addr *address)
+{
+  for(uint32_t i = 0; i < GATT_CACHE_DEPTH; i++)
+    {
+      if((gatt_cache[i].valid == true) && (memcmp(&gatt_cache[i].address, address, sizeof(bd_addr)) == 0))
+        return &gatt_cache[i];
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Looks up the handles stored for a server whose database hash is unchanged
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *   const uint8_t *hash: Database hash just read from the server, GATT_DATABASE_HASH_LEN bytes
+ *   gatt_cache_handles_t *handles: Filled in on a hit
+ *
+ * Returns:
+ *   bool: true on a hit, false if the server is unknown or its database changed
+ */
+bool gattCacheLookup(bd_addr *address, const uint8_t *hash, gatt_cache_handles_t *handles)
+{
+  gatt_cache_entry_t *entry = gatt_cache_find(address);
+
+  if(entry == NULL)
+    return false;
+
+  if(memcmp(entry->hash, hash, GATT_DATABASE_HASH_LEN) != 0)       //The server database changed, its handles may have moved
+    {
+      entry->valid = false;
+      return false;
+    }
+
+  entry->last_used = ++gatt_cache_clock;
+  *handles = entry->handles;
+  return true;
+}
+
+
+/*
+ * Stores the handles discovered on a server
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *   const uint8_t *hash: Database hash read from the server, GATT_DATABASE_HASH_LEN bytes
+ *   gatt_cache_handles_t *handles: Discovered handles
+ *
+ * Returns:
+ *   None
+ */
+void gattCacheStore(bd_addr *address, const uint8_t *hash, gatt_cache_handles_t *handles)
+{
+  gatt_cache_entry_t *entry = gatt_cache_find(address);
+
+  if(entry == NULL)                                               //Take a free entry, else the least recently used one
+    {
+      entry = &gatt_cache[0];
+      for(uint32_t i = 0; i < GATT_CACHE_DEPTH; i++)
+        {
+          if(gatt_cache[i].valid == false)
+            {
+              entry = &gatt_cache[i];
+              break;
+            }
+          if(gatt_cache[i].last_used < entry->last_used)
+            entry = &gatt_cache[i];
+        }
+    }
+
+  entry->valid = true;
+  entry->address = *address;
+  memcpy(entry->hash, hash, GATT_DATABASE_HASH_LEN);
+  entry->handles = *handles;
+  entry->last_used = ++gatt_cache_clock;
+}
+
+
+/*
+ * Drops the entry of a server, used when cached handles turn out to be stale
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *
+ * Returns:
+ *   None
+ */
+void gattCacheInvalidate(bd_addr *address)
+{
+  gatt_cache_entry_t *entry = gatt_cache_find(address);
+
+  if(entry != NULL)
+    entry->valid = false;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file    :   gatt_cache.h
+ * @brief   :   Headers and function definitions for the client GATT handle cache
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef GATT_CACHE_H
+#define GATT_CACHE_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+
+//Number of servers whose handles are remembered, the least recently used entry is replaced
+#define GATT_CACHE_DEPTH (8)
+
+//Length of the Database Hash characteristic value
+#define GATT_DATABASE_HASH_LEN (16)
+
+//Generic Attribute service 0x1801 and its Database Hash characteristic 0x2B2A, little endian. The hash is read by UUID
+//since its handle on the server is only known once the layout is, and a changed hash usually means a changed layout
+#define GATT_SERVICE_UUID (uint8_t [2]){ 0x01, 0x18 }
+#define GATT_DATABASE_HASH_UUID (uint8_t [2]){ 0x2A, 0x2B }
+
+//Characteristic handles discovered on one server
+typedef struct
+{
+  uint16_t htmCharacteristicHandle;
+  uint16_t buttonCharacteristicHandle;
+} gatt_cache_handles_t;
+
+
+/*
+ * Looks up the handles stored for a server whose database hash is unchanged
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *   const uint8_t *hash: Database hash just read from the server, GATT_DATABASE_HASH_LEN bytes
+ *   gatt_cache_handles_t *handles: Filled in on a hit
+ *
+ * Returns:
+ *   bool: true on a hit, false if the server is unknown or its database changed
+ */
+bool gattCacheLookup(bd_addr *address, const uint8_t *hash, gatt_cache_handles_t *handles);
+
+
+/*
+ * Stores the handles discovered on a server
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *   const uint8_t *hash: Database hash read from the server, GATT_DATABASE_HASH_LEN bytes
+ *   gatt_cache_handles_t *handles: Discovered handles
+ *
+ * Returns:
+ *   None
+ */
+void gattCacheStore(bd_addr *address, const uint8_t *hash, gatt_cache_handles_t *handles);
+
+
+/*
+ * Drops the entry of a server, used when cached handles turn out to be stale
+ *
+ * Parameters:
+ *   bd_addr *address: Server address
+ *
+ * Returns:
+ *   None
+ */
+void gattCacheInvalidate(bd_addr *address);
+
+
+#endif   //GATT_CACHE_H
@@ -195,3 +195,33 @@ void extcomin_enable(bool enable)
   else
     GPIO_PinOutClear(EXTCOMIN_PORT, EXTCOMIN_PIN);
 }
+
+
+/*
+ * Reads the level of push button PB0, the button is active low
+ *
+ * Parameters:
+ *  None
+ *
+ * Returns:
+ *   bool: true while PB0 is held down
+ */
+bool gpioButton0Pressed()
+{
+  return (GPIO_PinInGet(EXT_BUTTON_PORT, EXT_BUTTON_PIN) == 0);
+}
+
+
+/*
+ * Reads the level of push button PB1, the button is active low
+ *
+ * Parameters:
+ *  None
+ *
+ * Returns:
+ *   bool: true while PB1 is held down
+ */
+bool gpioButton1Pressed()
+{
+  return (GPIO_PinInGet(EXT_BUTTON_1_PORT, EXT_BUTTON_1_PIN) == 0);
+}
@@ -35,6 +35,8 @@ void i2c_gpioDeInit();
 void gpioSensorEnSetOn();
 void sensorDisable();
 void extcomin_enable(bool enable);
+bool gpioButton0Pressed();
+bool gpioButton1Pressed();
 
 
 
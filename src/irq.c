@@ -9,13 +9,21 @@
 
 #include "em_letimer.h"
 #include "em_i2c.h"
+#include "em_core.h"
+#include "em_cmu.h"
 #include "stdint.h"
 #include "gpio.h"
 #include "scheduler.h"
 #include "stdint.h"
 #include "app.h"
+#include "src/irq.h"
+#include "src/timers.h"
+#include "src/trace.h"
+#include "src/profile.h"
+#include "src/gateway.h"
 
-static uint32_t log_time = 0;
+static volatile uint32_t letimer_underflows = 0;      //Number of LETIMER0 underflows since boot
+static uint32_t letimer_tick_freq = 0;                 //LETIMER0 counter frequency in Hz
 
 #define INCLUDE_LOG_DEBUG 1
 #include "src/log.h"
@@ -33,6 +41,8 @@ static uint32_t log_time = 0;
  */
 void letimer_irq_init()
 {
+  letimer_tick_freq = CMU_ClockFreqGet(cmuClock_LFA) / PRESCALAR_VALUE;     //Cache the counter frequency for the tick conversions
+
   LETIMER_IntEnable(LETIMER0, LETIMER_IEN_UF);            //Enable the underflow flag for the LETIMER0 peripheral
   int int_bit = LETIMER0-> IEN;
 
@@ -64,6 +74,9 @@ void letimer_irq_init()
  */
 void LETIMER0_IRQHandler(void)
 {
+  PROFILE_START(PROFILE_LETIMER0_IRQ);
+  TRACE_ENTER();
+
   uint32_t int_flags = 0;
   int int_bit = 0;;
 
@@ -71,7 +84,14 @@ void LETIMER0_IRQHandler(void)
 
   if (int_flags & LETIMER_IFC_UF)                       //At underflow event, set temperature measurement event
     {
+      CORE_DECLARE_IRQ_STATE;
+
+      //Count the underflow and clear its flag together, so letimerTicks() in a higher priority ISR sees one of the two
+      CORE_ENTER_CRITICAL();
+      letimer_underflows++;
       LETIMER_IntClear(LETIMER0, LETIMER_IFC_UF);      //Clear the set interrupt flag
+      CORE_EXIT_CRITICAL();
+
       int_bit = LETIMER0-> IFC;
       if(int_bit != 0)                                //Check if the bit got cleared
         {
@@ -85,7 +105,6 @@ void LETIMER0_IRQHandler(void)
             }
         }
       setSchedulerEventTemp();
-      log_time += LETIMER_PERIOD_MS;
     }
 
   else if (int_flags & LETIMER_IFC_COMP1)
@@ -107,6 +126,8 @@ void LETIMER0_IRQHandler(void)
       LETIMER_IntDisable(LETIMER0, LETIMER_IEN_COMP1);    //Disable the COMP1 interrupt till the time_delay function is not called again
     }
 
+  TRACE_EXIT(TRACE_TYPE_ISR, TRACE_ISR_LETIMER0);
+  PROFILE_STOP(PROFILE_LETIMER0_IRQ);
 }
 
 
@@ -121,6 +142,9 @@ void LETIMER0_IRQHandler(void)
  */
 void I2C0_IRQHandler()
 {
+  PROFILE_START(PROFILE_I2C0_IRQ);
+  TRACE_ENTER();
+
   I2C_TransferReturn_TypeDef i2c_temp_sensor_transfer_result;
 
   i2c_temp_sensor_transfer_result = I2C_Transfer(I2C0);                //Transfer the I2C sequence
@@ -130,6 +154,115 @@ void I2C0_IRQHandler()
 
   if (i2c_temp_sensor_transfer_result < 0)
     LOG_ERROR("\r\n%d\r\n", i2c_temp_sensor_transfer_result);
+
+  TRACE_EXIT(TRACE_TYPE_ISR, TRACE_ISR_I2C0);
+  PROFILE_STOP(PROFILE_I2C0_IRQ);
+}
+
+
+/*
+ * Returns the monotonic LETIMER0 tick count since boot
+ *
+ * Combines the underflow count with the live down-counter. An underflow that
+ * is pending but not yet serviced is accounted for, so the value never steps
+ * backwards when read from a critical section or a higher priority ISR.
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t ticks: Ticks of the prescaled LETIMER0 clock since boot
+ */
+uint64_t letimerTicks()
+{
+  uint32_t underflows;
+  uint32_t count;
+  uint32_t period;
+
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+
+  underflows = letimer_underflows;
+  count = LETIMER_CounterGet(LETIMER0);
+
+  if(LETIMER_IntGet(LETIMER0) & LETIMER_IF_UF)         //Underflow happened but the ISR has not run yet
+    {
+      underflows++;
+      count = LETIMER_CounterGet(LETIMER0);             //Re-read, the counter has reloaded
+    }
+
+  period = LETIMER_CompareGet(LETIMER0, 0) + 1;        //COMP0 is the top value, the counter runs COMP0..0
+
+  CORE_EXIT_CRITICAL();
+
+  return ((uint64_t)underflows * period) + (period - 1 - count);
+}
+
+
+/*
+ * Returns the tick count at the most recent LETIMER0 underflow, the start of the current measurement period
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t ticks: Ticks since boot at the last underflow
+ */
+uint64_t letimerLastUnderflowTicks()
+{
+  uint64_t ticks = letimerTicks();
+  uint32_t period = LETIMER_CompareGet(LETIMER0, 0) + 1;
+
+  return ticks - (ticks % period);
+}
+
+
+/*
+ * Returns the frequency of the LETIMER0 tick
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t frequency: Ticks per second
+ */
+uint32_t letimerTickFrequency()
+{
+  return letimer_tick_freq;
+}
+
+
+/*
+ * Converts LETIMER0 ticks to microseconds using integer math
+ *
+ * Parameters:
+ *   uint64_t ticks: Tick count or tick difference
+ *
+ * Returns:
+ *   uint64_t time_us: Time in microseconds
+ */
+uint64_t letimerTicksToUs(uint64_t ticks)
+{
+  if(letimer_tick_freq == 0)
+    return 0;
+
+  return (ticks * 1000000ULL) / letimer_tick_freq;
+}
+
+
+/*
+ * Returns time elapsed in microseconds
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t time_elapsed: Time elapsed since boot in microseconds, with the resolution of one LETIMER0 tick
+ */
+uint64_t letimerMicroseconds()
+{
+  return letimerTicksToUs(letimerTicks());
 }
 
 
@@ -140,11 +273,11 @@ void I2C0_IRQHandler()
  *   None
  *
  * Returns:
- *   uint32_t time_elapsed: Time elapsed in milliseconds with a resolution of 3000 milliseconds
+ *   uint32_t time_elapsed: Time elapsed in milliseconds, with the resolution of one LETIMER0 tick
  */
 uint32_t letimerMilliseconds()
 {
-  return log_time;
+  return (uint32_t)(letimerMicroseconds() / 1000);
 }
 
 
@@ -179,11 +312,17 @@ void gpio_ext_init()
  */
 void GPIO_EVEN_IRQHandler(void)
 {
+  PROFILE_START(PROFILE_GPIO_EVEN_IRQ);
+  TRACE_ENTER();
+
   uint32_t flags = GPIO_IntGet();                 //Get the raised interrupt flag
 
   GPIO_IntClear(flags);
 
   setSchedulerEventExternalPushButton0();
+
+  TRACE_EXIT(TRACE_TYPE_ISR, TRACE_ISR_GPIO_EVEN);
+  PROFILE_STOP(PROFILE_GPIO_EVEN_IRQ);
 }
 
 /*
@@ -197,9 +336,40 @@ void GPIO_EVEN_IRQHandler(void)
  */
 void GPIO_ODD_IRQHandler(void)
 {
+  PROFILE_START(PROFILE_GPIO_ODD_IRQ);
+  TRACE_ENTER();
+
   uint32_t flags = GPIO_IntGet();                 //Get the raised interrupt flag
 
   GPIO_IntClear(flags);
 
   setSchedulerEventExternalPushButton1();
+
+  TRACE_EXIT(TRACE_TYPE_ISR, TRACE_ISR_GPIO_ODD);
+  PROFILE_STOP(PROFILE_GPIO_ODD_IRQ);
+}
+
+#if BUILD_INCLUDES_BLE_CLIENT && GATEWAY_ENABLE
+/*
+ * ISR for the LDMA, a gateway transmit run finished
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void LDMA_IRQHandler(void)
+{
+  TRACE_ENTER();
+
+  uint32_t flags = LDMA->IF & (1 << GATEWAY_DMA_CHANNEL);
+
+  LDMA->IFC = flags;
+
+  if(flags != 0)
+    gatewayTransmitDone();
+
+  TRACE_EXIT(TRACE_TYPE_ISR, TRACE_ISR_LDMA);
 }
+#endif   //BUILD_INCLUDES_BLE_CLIENT && GATEWAY_ENABLE
@@ -24,6 +24,66 @@
 void letimer_irq_init();
 
 
+/*
+ * Returns the monotonic LETIMER0 tick count since boot
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t ticks: Ticks of the prescaled LETIMER0 clock since boot
+ */
+uint64_t letimerTicks();
+
+
+/*
+ * Returns the tick count at the most recent LETIMER0 underflow, the start of the current measurement period
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t ticks: Ticks since boot at the last underflow
+ */
+uint64_t letimerLastUnderflowTicks();
+
+
+/*
+ * Returns the frequency of the LETIMER0 tick
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t frequency: Ticks per second
+ */
+uint32_t letimerTickFrequency();
+
+
+/*
+ * Converts LETIMER0 ticks to microseconds using integer math
+ *
+ * Parameters:
+ *   uint64_t ticks: Tick count or tick difference
+ *
+ * Returns:
+ *   uint64_t time_us: Time in microseconds
+ */
+uint64_t letimerTicksToUs(uint64_t ticks);
+
+
+/*
+ * Returns time elapsed in microseconds
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t time_elapsed: Time elapsed since boot in microseconds, with the resolution of one LETIMER0 tick
+ */
+uint64_t letimerMicroseconds();
+
+
 /*
  * Returns time elapsed in milliseconds
  *
@@ -31,7 +91,7 @@ void letimer_irq_init();
  *   None
  *
  * Returns:
- *   uint32_t time_elapsed: Time elapsed in milliseconds with a resolution of 3000 milliseconds
+ *   uint32_t time_elapsed: Time elapsed in milliseconds, with the resolution of one LETIMER0 tick
  */
 uint32_t letimerMilliseconds();
 
@@ -57,9 +57,11 @@
 
 #include "glib.h" // the low-level graphics driver/library
 #include "dmd.h"  // the dot matrix display driver
+#include "sl_memlcd_display.h" // display size and bits per pixel of the framebuffer
 
 
 #include "lcd.h"
+#include "profile.h"
 
 
 // Include logging specifically for this .c file
@@ -84,6 +86,12 @@ struct display_data {
 	// GLIB_Context required for use with GLIB_ functions
 	GLIB_Context_t           glibContext;
 
+#if DISPLAY_TREND_ENABLE
+  // y of the newest trend sample, the next segment starts there
+  bool                     trend_has_last;
+  int32_t                  trend_last_y;
+#endif
+
 };
 
 
@@ -151,6 +159,8 @@ void displayPrintf(enum display_row row, const char *format, ...)
    //    return;
    //}
 
+   PROFILE_START(PROFILE_DISPLAY_PRINTF);
+
    // Convert the variable length / formatted input to a string
    // IMPORTANT: Don't use sprintf() as that can write beyond the end of the buffer
    //            allocated for strToDisplay!
@@ -221,6 +231,8 @@ void displayPrintf(enum display_row row, const char *format, ...)
        LOG_ERROR("DMD_updateDisplay() returned non-zero error code=0x%04x", (unsigned int) status);
    }
 
+   PROFILE_STOP(PROFILE_DISPLAY_PRINTF);
+
 } // displayPrintf()
 
 
@@ -349,3 +361,143 @@ void gpioSetDisplayExtcomin(bool extcomin_state)
   extcomin_enable(extcomin_state);
 }
 
+
+/**
+ * Event dispatcher handler for sl_bt_evt_system_boot_id, the display comes up before
+ * any other boot handler writes to it.
+ */
+void displayBoot(sl_bt_msg_t *evt)
+{
+  (void)evt;
+
+  displayInit();
+} // displayBoot()
+
+
+/**
+ * Event dispatcher handler for sl_bt_evt_system_soft_timer_id, toggles EXTCOMIN on the LCD timer.
+ */
+void displaySoftTimer(sl_bt_msg_t *evt)
+{
+  if(evt->data.evt_system_soft_timer.handle == LCD_TIMER_HANDLE)
+    displayUpdate();
+} // displaySoftTimer()
+
+
+
+#if DISPLAY_TREND_ENABLE
+
+// First framebuffer line of the trend plot, the line after its last one and its height
+#define DISPLAY_TREND_TOP       (DISPLAY_TREND_ROW * DISPLAY_LINE_HEIGHT)
+#define DISPLAY_TREND_BOTTOM    (DISPLAY_TREND_END_ROW * DISPLAY_LINE_HEIGHT)
+#define DISPLAY_TREND_HEIGHT    (DISPLAY_TREND_BOTTOM - DISPLAY_TREND_TOP)
+
+// Bytes of one framebuffer line, one bit per pixel with pixel x at bit (x % 8) of byte (x / 8)
+#define DISPLAY_BYTES_PER_LINE  ((SL_MEMLCD_DISPLAY_WIDTH * SL_MEMLCD_DISPLAY_BPP) / 8)
+
+
+/**
+ * Maps a temperature onto a framebuffer line of the trend plot, the bottom line is DISPLAY_TREND_MIN_C
+ */
+static int32_t displayTrendY(int32_t value)
+{
+  if (value < DISPLAY_TREND_MIN_C) {
+      value = DISPLAY_TREND_MIN_C;
+  }
+  if (value > DISPLAY_TREND_MAX_C) {
+      value = DISPLAY_TREND_MAX_C;
+  }
+
+  return (DISPLAY_TREND_BOTTOM - 1) -
+         (((value - DISPLAY_TREND_MIN_C) * (DISPLAY_TREND_HEIGHT - 1)) / (DISPLAY_TREND_MAX_C - DISPLAY_TREND_MIN_C));
+} // displayTrendY()
+
+
+/**
+ * Adds a sample to the trend plot. The plot lines of the framebuffer are shifted one column to the
+ * left, the freed right column is cleared and only the segment from the previous sample to this one
+ * is drawn. Clearing the column marks exactly the plot lines dirty, so DMD_updateDisplay() sends
+ * those lines and nothing else. The cost is the same for every sample however long the plot has run.
+ */
+void displayTrendAdd(int32_t value)
+{
+  EMSTATUS               status;
+  struct display_data    *display = displayGetData();
+  uint8_t                *framebuffer;
+  uint8_t                *line;
+  int32_t                y = displayTrendY(value);
+
+  PROFILE_START(PROFILE_DISPLAY_TREND);
+
+  status = DMD_getFrameBuffer((void **) &framebuffer);
+  if (status != DMD_OK) {
+      LOG_ERROR("DMD_getFrameBuffer() returned non-zero error code=0x%04x", (unsigned int) status);
+      PROFILE_STOP(PROFILE_DISPLAY_TREND);
+      return;
+  }
+
+  // Scroll: pixel x + 1 moves to pixel x, the bit shifted out of each byte comes from the next one
+  for (int32_t row = DISPLAY_TREND_TOP; row < DISPLAY_TREND_BOTTOM; row++) {
+      line = framebuffer + (row * DISPLAY_BYTES_PER_LINE);
+      for (int32_t i = 0; i < (DISPLAY_BYTES_PER_LINE - 1); i++) {
+          line[i] = (line[i] >> 1) | (line[i + 1] << 7);
+      }
+      line[DISPLAY_BYTES_PER_LINE - 1] >>= 1;
+  }
+
+  // Clear the new column, in the background color
+  display->glibContext.foregroundColor = White;
+  status = GLIB_drawLineV(&display->glibContext, SL_MEMLCD_DISPLAY_WIDTH - 1, DISPLAY_TREND_TOP, DISPLAY_TREND_BOTTOM - 1);
+  display->glibContext.foregroundColor = Black;
+  if (status != GLIB_OK) {
+      LOG_ERROR("GLIB_drawLineV() returned non-zero error code=0x%04x", (unsigned int) status);
+  }
+
+  // Newest segment, a single point for the first sample
+  status = GLIB_drawLine(&display->glibContext,
+                         SL_MEMLCD_DISPLAY_WIDTH - 2,
+                         display->trend_has_last ? display->trend_last_y : y,
+                         SL_MEMLCD_DISPLAY_WIDTH - 1,
+                         y);
+  if (status != GLIB_OK) {
+      LOG_ERROR("GLIB_drawLine() returned non-zero error code=0x%04x", (unsigned int) status);
+  }
+
+  display->trend_has_last = true;
+  display->trend_last_y = y;
+
+  status = DMD_updateDisplay();
+  if (status != DMD_OK) {
+      LOG_ERROR("DMD_updateDisplay() returned non-zero error code=0x%04x", (unsigned int) status);
+  }
+
+  PROFILE_STOP(PROFILE_DISPLAY_TREND);
+} // displayTrendAdd()
+
+
+/**
+ * Clears the trend plot, the next sample starts a new one at the right edge.
+ */
+void displayTrendClear()
+{
+  EMSTATUS               status;
+  struct display_data    *display = displayGetData();
+  GLIB_Rectangle_t       plot = { 0, DISPLAY_TREND_TOP, SL_MEMLCD_DISPLAY_WIDTH - 1, DISPLAY_TREND_BOTTOM - 1 };
+
+  // Fill in the background color
+  display->glibContext.foregroundColor = White;
+  status = GLIB_drawRectFilled(&display->glibContext, &plot);
+  display->glibContext.foregroundColor = Black;
+  if (status != GLIB_OK) {
+      LOG_ERROR("GLIB_drawRectFilled() returned non-zero error code=0x%04x", (unsigned int) status);
+  }
+
+  display->trend_has_last = false;
+
+  status = DMD_updateDisplay();
+  if (status != DMD_OK) {
+      LOG_ERROR("DMD_updateDisplay() returned non-zero error code=0x%04x", (unsigned int) status);
+  }
+} // displayTrendClear()
+
+#endif // DISPLAY_TREND_ENABLE
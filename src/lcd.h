@@ -26,6 +26,8 @@
 #ifndef SRC_LCD_H_
 #define SRC_LCD_H_
 
+#include "sl_bt_api.h"
+
 
 
 
@@ -58,6 +60,16 @@ enum display_row {
 #define REPEATING_BUFFER (0)
 #define LCD_TIMER_HANDLE (2)
 
+// Temperature trend plot, one column per sample, drawn from the top of DISPLAY_TREND_ROW down to
+// DISPLAY_TREND_END_ROW, which keeps its text. Samples outside DISPLAY_TREND_MIN_C..DISPLAY_TREND_MAX_C are clamped, the
+// scale is fixed so a new sample never redraws the older columns
+#define DISPLAY_TREND_ENABLE (1)
+#define DISPLAY_LINE_HEIGHT  (10)               // GLIB_FontNarrow6x8 height plus its line spacing
+#define DISPLAY_TREND_ROW    (DISPLAY_ROW_11)
+#define DISPLAY_TREND_END_ROW (DISPLAY_ROW_ASSIGNMENT)  // First row below the plot
+#define DISPLAY_TREND_MIN_C  (15)
+#define DISPLAY_TREND_MAX_C  (35)
+
 // function prototypes
 
 void displayInit();
@@ -65,6 +77,19 @@ void displayUpdate();
 void displayPrintf(enum display_row row, const char *format, ...);
 void gpioSetDisplayExtcomin(bool extcomin_state);
 
+// event dispatcher handlers, registered ahead of every other handler for their event
+void displayBoot(sl_bt_msg_t *evt);
+void displaySoftTimer(sl_bt_msg_t *evt);
+
+#if DISPLAY_TREND_ENABLE
+// trend plot, rows from DISPLAY_TREND_ROW to before DISPLAY_TREND_END_ROW must not be written with displayPrintf() while it is shown
+void displayTrendAdd(int32_t value);
+void displayTrendClear();
+#else
+static inline void displayTrendAdd(int32_t value) { (void)value; }
+static inline void displayTrendClear() { }
+#endif
+
 
 
 
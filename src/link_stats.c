@@ -0,0 +1,355 @@
+/**
+ * @file    :   link_stats.c
+ * @brief   :   API for the server link quality statistics
+ *
+ *              The window is only summed when it is read, so recording an event stays a counter
+ *              increment in the current slot and moving on to the next slot clears one slot.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/link_stats.h"
+#include "src/server_conn.h"
+#include "src/irq.h"
+#include "string.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+
+/*
+ * Clamps a counter to a byte of the telemetry value
+ *
+ * Parameters:
+ *   uint32_t count: Counter
+ *
+ * Returns:
+ *   uint8_t: count, or 0xFF if it does not fit
+ */
+static uint8_t link_stats_sat8(uint32_t count)
+{
+  return (count > UINT8_MAX) ? UINT8_MAX : count;
+}
+
+
+/*
+ * Clamps a counter to 16 bits of the telemetry value
+ *
+ * Parameters:
+ *   uint32_t count: Counter
+ *
+ * Returns:
+ *   uint16_t: count, or 0xFFFF if it does not fit
+ */
+static uint16_t link_stats_sat16(uint32_t count)
+{
+  return (count > UINT16_MAX) ? UINT16_MAX : count;
+}
+
+
+/*
+ * Starts an empty window, called when the connection opens
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsInit(link_stats_t *stats)
+{
+  memset(stats, 0, sizeof(link_stats_t));
+  stats->filled = 1;
+  stats->slot_ms = letimerMilliseconds();
+}
+
+
+/*
+ * Moves on to the next slot once the current one has run LINK_STATS_SLOT_MS and asks the stack for
+ * the RSSI of the link. Called periodically
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsPoll(link_stats_t *stats, uint8_t connection)
+{
+  sl_status_t error_status;
+  uint32_t now = letimerMilliseconds();
+
+  if((now - stats->slot_ms) >= LINK_STATS_SLOT_MS)
+    {
+      stats->current = (stats->current + 1) % LINK_STATS_SLOTS;
+      memset(&stats->slots[stats->current], 0, sizeof(link_stats_slot_t));
+      if(stats->filled < LINK_STATS_SLOTS)
+        stats->filled++;
+
+      stats->slot_ms = now;
+      stats->is_rssi_requested = false;
+    }
+
+  //One RSSI sample per slot, the answer comes as sl_bt_evt_connection_rssi_id
+  if((stats->slots[stats->current].rssi_count == 0) && (stats->is_rssi_requested == false))
+    {
+      error_status = sl_bt_connection_get_rssi(connection);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError requesting the connection RSSI\r\n");
+      else
+        stats->is_rssi_requested = true;
+    }
+}
+
+
+/*
+ * Records an indication handed to the stack, or one the stack refused
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *   bool is_sent: false if the stack had no room for it
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsSent(link_stats_t *stats, bool is_sent)
+{
+  if(is_sent == true)
+    {
+      stats->slots[stats->current].sent++;
+      stats->sent_ms = letimerMilliseconds();
+    }
+  else
+    stats->slots[stats->current].send_failures++;
+}
+
+
+/*
+ * Records a confirmation and its latency from the send
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsConfirmed(link_stats_t *stats)
+{
+  link_stats_slot_t *slot = &stats->slots[stats->current];
+  uint32_t latency_ms = letimerMilliseconds() - stats->sent_ms;
+
+  slot->confirmed++;
+  slot->latency_sum_ms += latency_ms;
+  if(latency_ms > slot->latency_max_ms)
+    slot->latency_max_ms = link_stats_sat16(latency_ms);
+}
+
+
+/*
+ * Records a pending value replaced by a newer one before it went out
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsOverflow(link_stats_t *stats)
+{
+  stats->slots[stats->current].overflows++;
+}
+
+
+/*
+ * Records an indication that was never confirmed
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsTimeout(link_stats_t *stats)
+{
+  stats->slots[stats->current].timeouts++;
+  stats->timeouts_total++;
+}
+
+
+/*
+ * Adds the RSSI the stack reported to the window of its connection
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_rssi_id
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsRssi(sl_bt_msg_t *evt)
+{
+  server_conn_t *ctx = serverConnFromEvent(evt);
+  link_stats_slot_t *slot;
+  int8_t rssi = evt->data.evt_connection_rssi.rssi;
+
+  if(ctx == NULL)
+    return;
+
+  ctx->link.is_rssi_requested = false;
+  if(evt->data.evt_connection_rssi.status != 0)
+    return;
+
+  slot = &ctx->link.slots[ctx->link.current];
+  if((slot->rssi_count == 0) || (rssi < slot->rssi_min))
+    slot->rssi_min = rssi;
+  if((slot->rssi_count == 0) || (rssi > slot->rssi_max))
+    slot->rssi_max = rssi;
+  slot->rssi_sum += rssi;
+  slot->rssi_count++;
+}
+
+
+/*
+ * Sums the window
+ *
+ * Parameters:
+ *   const link_stats_t *stats: Window of the connection
+ *   link_stats_window_t *window: Filled in with the sums
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsWindow(const link_stats_t *stats, link_stats_window_t *window)
+{
+  const link_stats_slot_t *slot;
+  int32_t rssi_sum = 0;
+  uint32_t latency_sum_ms = 0;
+
+  memset(window, 0, sizeof(link_stats_window_t));
+  window->rssi_mean = LINK_STATS_NO_RSSI;
+  window->rssi_min = LINK_STATS_NO_RSSI;
+  window->rssi_max = LINK_STATS_NO_RSSI;
+
+  //Slots past filled were cleared when the window started, so walking all of them is safe
+  for(uint32_t i = 0; i < LINK_STATS_SLOTS; i++)
+    {
+      slot = &stats->slots[i];
+
+      if(slot->rssi_count != 0)
+        {
+          if((window->rssi_count == 0) || (slot->rssi_min < window->rssi_min))
+            window->rssi_min = slot->rssi_min;
+          if((window->rssi_count == 0) || (slot->rssi_max > window->rssi_max))
+            window->rssi_max = slot->rssi_max;
+          rssi_sum += slot->rssi_sum;
+          window->rssi_count += slot->rssi_count;
+        }
+
+      window->sent += slot->sent;
+      window->confirmed += slot->confirmed;
+      window->timeouts += slot->timeouts;
+      window->overflows += slot->overflows;
+      window->send_failures += slot->send_failures;
+      latency_sum_ms += slot->latency_sum_ms;
+      if(slot->latency_max_ms > window->latency_max_ms)
+        window->latency_max_ms = slot->latency_max_ms;
+    }
+
+  if(window->rssi_count != 0)
+    window->rssi_mean = rssi_sum / window->rssi_count;
+
+  if(window->confirmed != 0)
+    window->latency_mean_ms = latency_sum_ms / window->confirmed;
+}
+
+
+/*
+ * Checks whether the window saw indications pile up, the link then wants the fast connection profile
+ *
+ * Parameters:
+ *   const link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   bool: true if a pending value was replaced or the stack refused a send in the window
+ */
+bool linkStatsCongested(const link_stats_t *stats)
+{
+  for(uint32_t i = 0; i < LINK_STATS_SLOTS; i++)
+    {
+      if((stats->slots[i].overflows != 0) || (stats->slots[i].send_failures != 0))
+        return true;
+    }
+
+  return false;
+}
+
+
+/*
+ * Encodes the window as the link telemetry characteristic value, little endian:
+ * RSSI mean, min and max (int8), RSSI samples (uint8), indications sent and confirmed (uint16),
+ * mean and max confirmation latency in ms (uint16), indication timeouts, queue overflows and
+ * refused sends (uint8, saturated) and the window length in slots (uint8)
+ *
+ * Parameters:
+ *   const link_stats_t *stats: Window of the connection
+ *   uint8_t *value: LINK_STATS_TELEMETRY_LEN bytes
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsEncode(const link_stats_t *stats, uint8_t *value)
+{
+  link_stats_window_t window;
+  uint16_t field;
+
+  linkStatsWindow(stats, &window);
+
+  value[0] = (uint8_t)window.rssi_mean;
+  value[1] = (uint8_t)window.rssi_min;
+  value[2] = (uint8_t)window.rssi_max;
+  value[3] = window.rssi_count;
+
+  field = link_stats_sat16(window.sent);
+  value[4] = field & 0xFF;
+  value[5] = field >> 8;
+  field = link_stats_sat16(window.confirmed);
+  value[6] = field & 0xFF;
+  value[7] = field >> 8;
+  field = link_stats_sat16(window.latency_mean_ms);
+  value[8] = field & 0xFF;
+  value[9] = field >> 8;
+  field = link_stats_sat16(window.latency_max_ms);
+  value[10] = field & 0xFF;
+  value[11] = field >> 8;
+
+  value[12] = link_stats_sat8(window.timeouts);
+  value[13] = link_stats_sat8(window.overflows);
+  value[14] = link_stats_sat8(window.send_failures);
+  value[15] = stats->filled;
+}
+
+
+/*
+ * Prints the window over VCOM, called when the connection closes
+ *
+ * Parameters:
+ *   const link_stats_t *stats: Window of the connection
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsLog(const link_stats_t *stats, uint8_t connection)
+{
+  link_stats_window_t window;
+
+  linkStatsWindow(stats, &window);
+
+  LOG_INFO("\r\nConnection %d, last %lu ms: RSSI %d dBm (%d to %d), %lu indications, %lu confirmed in %lu ms mean %lu ms max, %lu timeouts (%lu in total), %lu overflows, %lu refused\r\n",
+           connection, (uint32_t)stats->filled * LINK_STATS_SLOT_MS, window.rssi_mean, window.rssi_min, window.rssi_max,
+           window.sent, window.confirmed, window.latency_mean_ms, window.latency_max_ms, window.timeouts,
+           stats->timeouts_total, window.overflows, window.send_failures);
+}
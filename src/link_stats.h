@@ -0,0 +1,220 @@
+/**
+ * @file    :   link_stats.h
+ * @brief   :   Headers and function definitions for the server link quality statistics
+ *
+ *              Each client connection keeps a rolling window of LINK_STATS_SLOTS slots, one per
+ *              LINK_STATS_SLOT_MS, with the connection RSSI, indications sent and confirmed, the
+ *              confirmation latency, indication timeouts and indication queue overflows. A client
+ *              reads the window of its own link from the link telemetry characteristic, and the
+ *              connection parameter and TX power logic use it to judge the link.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "app.h"
+
+//Window of 8 slots of one sampling period each, the RSSI is sampled once per slot
+#define LINK_STATS_SLOTS (8)
+#define LINK_STATS_SLOT_MS (LETIMER_PERIOD_MS)
+
+//Size of the link telemetry characteristic value
+#define LINK_STATS_TELEMETRY_LEN (16)
+
+//RSSI reported while the window holds no sample
+#define LINK_STATS_NO_RSSI (-128)
+
+//Counters of one slot
+typedef struct
+{
+  int16_t rssi_sum;
+  uint8_t rssi_count;
+  int8_t rssi_min;
+  int8_t rssi_max;
+  uint16_t sent;                    //Indications handed to the stack
+  uint16_t confirmed;
+  uint16_t timeouts;                //Indications never confirmed
+  uint16_t overflows;               //Pending values replaced by a newer one before they went out
+  uint16_t send_failures;           //Sends the stack refused, retried by the next flush
+  uint32_t latency_sum_ms;          //Send to confirmation
+  uint16_t latency_max_ms;
+}link_stats_slot_t;
+
+//Rolling window of one connection, kept in its server_conn_t
+typedef struct
+{
+  link_stats_slot_t slots[LINK_STATS_SLOTS];
+  uint8_t current;                  //Slot being filled
+  uint8_t filled;                   //Slots holding data, up to LINK_STATS_SLOTS
+  uint32_t slot_ms;                 //letimerMilliseconds() when the current slot started
+  uint32_t sent_ms;                 //letimerMilliseconds() when the indication in flight was sent
+  bool is_rssi_requested;           //sl_bt_connection_get_rssi() called, waiting for sl_bt_evt_connection_rssi_id
+  uint32_t timeouts_total;          //Since the connection opened
+}link_stats_t;
+
+//Sums over the window
+typedef struct
+{
+  int8_t rssi_mean;                 //LINK_STATS_NO_RSSI without samples
+  int8_t rssi_min;
+  int8_t rssi_max;
+  uint8_t rssi_count;
+  uint32_t sent;
+  uint32_t confirmed;
+  uint32_t timeouts;
+  uint32_t overflows;
+  uint32_t send_failures;
+  uint32_t latency_mean_ms;
+  uint32_t latency_max_ms;
+}link_stats_window_t;
+
+
+/*
+ * Starts an empty window, called when the connection opens
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsInit(link_stats_t *stats);
+
+
+/*
+ * Moves on to the next slot once the current one has run LINK_STATS_SLOT_MS and asks the stack for
+ * the RSSI of the link. Called periodically
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsPoll(link_stats_t *stats, uint8_t connection);
+
+
+/*
+ * Records an indication handed to the stack, or one the stack refused
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *   bool is_sent: false if the stack had no room for it
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsSent(link_stats_t *stats, bool is_sent);
+
+
+/*
+ * Records a confirmation and its latency from the send
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsConfirmed(link_stats_t *stats);
+
+
+/*
+ * Records a pending value replaced by a newer one before it went out
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsOverflow(link_stats_t *stats);
+
+
+/*
+ * Records an indication that was never confirmed
+ *
+ * Parameters:
+ *   link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsTimeout(link_stats_t *stats);
+
+
+/*
+ * Adds the RSSI the stack reported to the window of its connection
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_rssi_id
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsRssi(sl_bt_msg_t *evt);
+
+
+/*
+ * Sums the window
+ *
+ * Parameters:
+ *   const link_stats_t *stats: Window of the connection
+ *   link_stats_window_t *window: Filled in with the sums
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsWindow(const link_stats_t *stats, link_stats_window_t *window);
+
+
+/*
+ * Checks whether the window saw indications pile up, the link then wants the fast connection profile
+ *
+ * Parameters:
+ *   const link_stats_t *stats: Window of the connection
+ *
+ * Returns:
+ *   bool: true if a pending value was replaced or the stack refused a send in the window
+ */
+bool linkStatsCongested(const link_stats_t *stats);
+
+
+/*
+ * Encodes the window as the link telemetry characteristic value, little endian:
+ * RSSI mean, min and max (int8), RSSI samples (uint8), indications sent and confirmed (uint16),
+ * mean and max confirmation latency in ms (uint16), indication timeouts, queue overflows and
+ * refused sends (uint8, saturated) and the window length in slots (uint8)
+ *
+ * Parameters:
+ *   const link_stats_t *stats: Window of the connection
+ *   uint8_t *value: LINK_STATS_TELEMETRY_LEN bytes
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsEncode(const link_stats_t *stats, uint8_t *value);
+
+
+/*
+ * Prints the window over VCOM, called when the connection closes
+ *
+ * Parameters:
+ *   const link_stats_t *stats: Window of the connection
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void linkStatsLog(const link_stats_t *stats, uint8_t connection);
+
+
+#endif   //LINK_STATS_H
@@ -0,0 +1,547 @@
+/**
+ * @file    :   ota.c
+ * @brief   :   API for the in application firmware update
+ *
+ *              Image data is collected in a word aligned RAM block and written to the storage slot a
+ *              block at a time, the first write starts at offset 0 on a page boundary so
+ *              bootloader_eraseWriteStorage() erases every page as the image reaches it. Each finished
+ *              upload is timed against the PHY and ATT MTU of the link and logged with the earlier ones.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/ota.h"
+#include "ble_device_type.h"
+
+#if BUILD_INCLUDES_BLE_SERVER
+#include "btl_interface.h"
+#include "gatt_db.h"
+#include "string.h"
+#include "src/irq.h"
+#include "src/lcd.h"
+#include "src/conn_param.h"
+#include "src/server_conn.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+//Flash is written in 32 bit words, the last block is padded with erased bytes
+#define OTA_WORD_LEN (4)
+#define OTA_PAD_BYTE (0xFF)
+
+//LCD progress line every this many bytes
+#define OTA_PROGRESS_LEN (16 * OTA_BLOCK_LEN)
+
+typedef enum
+{
+  ota_idle,
+  ota_receiving,
+  ota_verifying,
+  ota_verified,                     //Set as the image to bootload, waiting for OTA_CMD_INSTALL
+}ota_state_t;
+
+//Uploads finished at one PHY and ATT MTU
+typedef struct
+{
+  uint8_t phy;
+  uint16_t mtu;
+  uint32_t uploads;
+  uint32_t last_bytes;              //Image size of the latest upload
+  uint32_t last_ms;                 //Upload time of the latest upload
+  uint32_t bytes_total;
+  uint32_t ms_total;
+}ota_stats_t;
+
+static struct
+{
+  bool ready;                       //bootloader_init() succeeded
+  ota_state_t state;
+  uint8_t connection;
+  bool connected;
+  bool install;                     //OTA_CMD_INSTALL arrived, reboot once verified and disconnected
+  uint32_t slot_len;
+  uint32_t offset;                  //Bytes written to the slot
+  uint32_t block_len;               //Bytes waiting in ota_block
+  uint32_t start_ms;                //letimerMilliseconds() at OTA_CMD_START
+  uint32_t verify_ms;               //letimerMilliseconds() when verification started
+  ota_stats_t stats[OTA_STATS_MAX];
+  uint8_t stats_count;
+}ota;
+
+//uint32_t keeps both word aligned for the flash controller and the parser
+static uint32_t ota_block[OTA_BLOCK_LEN / sizeof(uint32_t)];
+static uint32_t ota_verify_context[(BOOTLOADER_STORAGE_VERIFICATION_CONTEXT_SIZE + sizeof(uint32_t) - 1) / sizeof(uint32_t)];
+
+
+/*
+ * Starts or stops the verification timer
+ *
+ * Parameters:
+ *   bool run: true to start the timer
+ *
+ * Returns:
+ *   None
+ */
+static void ota_timer(bool run)
+{
+  sl_status_t error_status;
+
+  error_status = sl_bt_system_set_soft_timer((run == true) ? OTA_VERIFY_TICKS : 0, OTA_TIMER_HANDLE, 0);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting the OTA timer\r\n");
+}
+
+
+/*
+ * Drops the upload in progress
+ *
+ * Parameters:
+ *   const char *reason: Logged and shown on the LCD
+ *
+ * Returns:
+ *   None
+ */
+static void ota_abort(const char *reason)
+{
+  if(ota.state == ota_verifying)
+    ota_timer(false);
+
+  LOG_ERROR("\r\nOTA stopped after %lu bytes: %s\r\n", ota.offset + ota.block_len, reason);
+  displayPrintf(DISPLAY_ROW_10, "OTA failed");
+
+  ota.state = ota_idle;
+  ota.install = false;
+  ota.block_len = 0;
+}
+
+
+/*
+ * Writes the collected block to the storage slot, the last block is padded to a whole flash word
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   bool: false if the write failed or ran past the end of the slot
+ */
+static bool ota_flush()
+{
+  uint8_t *block = (uint8_t *)ota_block;
+  int32_t error_status;
+
+  if(ota.block_len == 0)
+    return true;
+
+  while((ota.block_len % OTA_WORD_LEN) != 0)
+    block[ota.block_len++] = OTA_PAD_BYTE;
+
+  if((ota.offset + ota.block_len) > ota.slot_len)
+    return false;
+
+  error_status = bootloader_eraseWriteStorage(OTA_SLOT, ota.offset, block, ota.block_len);
+  if(error_status != BOOTLOADER_OK)
+    {
+      LOG_ERROR("\r\nError writing the storage slot at %lu: 0x%lx\r\n", ota.offset, error_status);
+      return false;
+    }
+
+  ota.offset += ota.block_len;
+  ota.block_len = 0;
+
+  if((ota.offset % OTA_PROGRESS_LEN) == 0)
+    displayPrintf(DISPLAY_ROW_10, "OTA %lu kB", ota.offset / 1024);
+
+  return true;
+}
+
+
+/*
+ * Adds the upload that just ended to the table of its PHY and ATT MTU and logs the whole table
+ *
+ * Parameters:
+ *   uint32_t bytes: Image size
+ *   uint32_t upload_ms: Time from OTA_CMD_START to OTA_CMD_FINISH
+ *
+ * Returns:
+ *   None
+ */
+static void ota_record(uint32_t bytes, uint32_t upload_ms)
+{
+  uint8_t phy = connParamPhy(ota.connection);
+  uint16_t mtu = connParamMtu(ota.connection);
+  ota_stats_t *stats = NULL;
+
+  //PHY and MTU are the ones the link ended the upload with
+  for(uint32_t i = 0; i < ota.stats_count; i++)
+    {
+      if((ota.stats[i].phy == phy) && (ota.stats[i].mtu == mtu))
+        stats = &ota.stats[i];
+    }
+
+  if((stats == NULL) && (ota.stats_count < OTA_STATS_MAX))
+    {
+      stats = &ota.stats[ota.stats_count++];
+      stats->phy = phy;
+      stats->mtu = mtu;
+    }
+
+  if(stats != NULL)
+    {
+      stats->uploads++;
+      stats->last_bytes = bytes;
+      stats->last_ms = upload_ms;
+      stats->bytes_total += bytes;
+      stats->ms_total += upload_ms;
+    }
+
+  LOG_INFO("\r\nOTA upload of %lu bytes took %lu ms, %lu kbit/s, PHY %d, ATT MTU %d, interval %d\r\n", bytes, upload_ms,
+           (upload_ms != 0) ? (bytes * 8) / upload_ms : 0, phy, mtu, connParamInterval(ota.connection));
+
+  for(uint32_t i = 0; i < ota.stats_count; i++)
+    {
+      LOG_INFO("\r\nOTA PHY %d, ATT MTU %d: %lu uploads, last %lu bytes in %lu ms, %lu kbit/s on average\r\n",
+               ota.stats[i].phy, ota.stats[i].mtu, ota.stats[i].uploads, ota.stats[i].last_bytes, ota.stats[i].last_ms,
+               (ota.stats[i].ms_total != 0) ? (ota.stats[i].bytes_total * 8) / ota.stats[i].ms_total : 0);
+    }
+}
+
+
+/*
+ * Starts an upload at offset 0 of the storage slot
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle of the client
+ *
+ * Returns:
+ *   uint8_t: ATT error code, 0 on success
+ */
+static uint8_t ota_start(uint8_t connection)
+{
+  BootloaderStorageSlot_t slot;
+  int32_t error_status;
+
+  if(ota.ready == false)
+    return SL_STATUS_BT_ATT_REQUEST_NOT_SUPPORTED & 0xFF;
+
+  error_status = bootloader_getStorageSlotInfo(OTA_SLOT, &slot);
+  if(error_status != BOOTLOADER_OK)
+    {
+      LOG_ERROR("\r\nError reading the storage slot: 0x%lx\r\n", error_status);
+      return SL_STATUS_BT_ATT_REQUEST_NOT_SUPPORTED & 0xFF;
+    }
+
+  //A new start drops whatever was uploaded or verified before
+  if(ota.state == ota_verifying)
+    ota_timer(false);
+
+  ota.state = ota_receiving;
+  ota.connection = connection;
+  ota.connected = true;
+  ota.install = false;
+  ota.slot_len = slot.length;
+  ota.offset = 0;
+  ota.block_len = 0;
+  ota.start_ms = letimerMilliseconds();
+
+  LOG_INFO("\r\nOTA started, storage slot %d holds %lu bytes\r\n", OTA_SLOT, ota.slot_len);
+  displayPrintf(DISPLAY_ROW_10, "OTA receiving");
+
+  return 0;
+}
+
+
+/*
+ * Writes the last block, logs the upload time and starts verifying the image
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint8_t: ATT error code, 0 on success
+ */
+static uint8_t ota_finish()
+{
+  int32_t error_status;
+
+  if(ota.state != ota_receiving)
+    return SL_STATUS_BT_ATT_WRITE_REQUEST_REJECTED & 0xFF;
+
+  if(ota_flush() == false)
+    {
+      ota_abort("last block not written");
+      return SL_STATUS_BT_ATT_WRITE_REQUEST_REJECTED & 0xFF;
+    }
+
+  ota_record(ota.offset, letimerMilliseconds() - ota.start_ms);
+
+  error_status = bootloader_initVerifyImage(OTA_SLOT, ota_verify_context, sizeof(ota_verify_context));
+  if(error_status != BOOTLOADER_OK)
+    {
+      LOG_ERROR("\r\nError starting the image verification: 0x%lx\r\n", error_status);
+      ota_abort("verification not started");
+      return SL_STATUS_BT_ATT_WRITE_REQUEST_REJECTED & 0xFF;
+    }
+
+  //The parser runs a few steps per timer tick so sampling and the link keep running
+  ota.state = ota_verifying;
+  ota.verify_ms = letimerMilliseconds();
+  ota_timer(true);
+  displayPrintf(DISPLAY_ROW_10, "OTA verifying");
+
+  return 0;
+}
+
+
+/*
+ * Disconnects the client that asked for the install, or reboots into the bootloader once it has gone
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void ota_install()
+{
+  sl_status_t error_status;
+
+  if(ota.connected == false)
+    {
+      LOG_INFO("\r\nOTA rebooting into the bootloader to install the image\r\n");
+      bootloader_rebootAndInstall();
+      return;
+    }
+
+  //The reboot follows in otaClosed() so the client sees a clean disconnect
+  error_status = sl_bt_connection_close(ota.connection);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError closing the connection for the OTA install\r\n");
+}
+
+
+/*
+ * Initializes the bootloader interface at boot
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void otaBoot(sl_bt_msg_t *evt)
+{
+  int32_t error_status;
+
+  (void)evt;
+
+  error_status = bootloader_init();
+  ota.ready = (error_status == BOOTLOADER_OK);
+  if(ota.ready == false)
+    LOG_ERROR("\r\nError initializing the bootloader interface, OTA disabled: 0x%lx\r\n", error_status);
+}
+
+
+/*
+ * Stops an upload whose client disconnected, or installs a verified image once the client that asked for it has gone
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void otaClosed(sl_bt_msg_t *evt)
+{
+  if((ota.connected == false) || (evt->data.evt_connection_closed.connection != ota.connection))
+    return;
+
+  ota.connected = false;
+
+  if(ota.state == ota_receiving)
+    ota_abort("client disconnected");
+
+  else if((ota.state == ota_verified) && (ota.install == true))
+    ota_install();
+}
+
+
+/*
+ * Checks that a client is on an encrypted link before it may touch the storage slot
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   bool: true if the link is encrypted
+ */
+static bool ota_link_encrypted(uint8_t connection)
+{
+  server_conn_t *ctx = serverConnFind(connection);
+
+  return (ctx != NULL) && (ctx->is_encrypted == true);
+}
+
+
+/*
+ * Serves the OTA control point and takes image data, both need an encrypted link
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_server_user_write_request_id
+ *
+ * Returns:
+ *   None
+ */
+void otaUserWriteRequest(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  sl_bt_evt_gatt_server_user_write_request_t *request = &evt->data.evt_gatt_server_user_write_request;
+  uint8_t att_errorcode = 0;
+
+  if(request->characteristic == gattdb_ota_data)
+    {
+      uint8_t *data = request->value.data;
+      uint32_t len = request->value.len;
+      uint32_t chunk;
+
+      if(ota_link_encrypted(request->connection) == false)
+        att_errorcode = SL_STATUS_BT_ATT_INSUFFICIENT_ENCRYPTION & 0xFF;
+
+      else if((ota.state != ota_receiving) || (request->connection != ota.connection))
+        att_errorcode = SL_STATUS_BT_ATT_WRITE_NOT_PERMITTED & 0xFF;
+
+      else if((ota.offset + ota.block_len + len) > ota.slot_len)
+        {
+          ota_abort("image larger than the storage slot");
+          att_errorcode = SL_STATUS_BT_ATT_INSUFFICIENT_RESOURCES & 0xFF;
+        }
+
+      else
+        {
+          connParamBusy(ota.connection);
+
+          while(len > 0)
+            {
+              chunk = OTA_BLOCK_LEN - ota.block_len;
+              if(chunk > len)
+                chunk = len;
+
+              memcpy((uint8_t *)ota_block + ota.block_len, data, chunk);
+              ota.block_len += chunk;
+              data += chunk;
+              len -= chunk;
+
+              if((ota.block_len == OTA_BLOCK_LEN) && (ota_flush() == false))
+                {
+                  ota_abort("flash write failed");
+                  att_errorcode = SL_STATUS_BT_ATT_WRITE_REQUEST_REJECTED & 0xFF;
+                  break;
+                }
+            }
+        }
+
+      //Write commands take no response, a failed upload shows up as an error on the finish command
+      if(request->att_opcode == sl_bt_gatt_write_request)
+        {
+          error_status = sl_bt_gatt_server_send_user_write_response(request->connection, gattdb_ota_data, att_errorcode);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError sending the OTA data response\r\n");
+        }
+    }
+
+  if(request->characteristic == gattdb_ota_control)
+    {
+      if(ota_link_encrypted(request->connection) == false)
+        att_errorcode = SL_STATUS_BT_ATT_INSUFFICIENT_ENCRYPTION & 0xFF;
+
+      else if(request->value.len != 1)
+        att_errorcode = SL_STATUS_BT_ATT_INVALID_ATT_LENGTH & 0xFF;
+
+      else
+        {
+          switch(request->value.data[0])
+          {
+            case OTA_CMD_START:
+              att_errorcode = ota_start(request->connection);
+              break;
+
+            case OTA_CMD_FINISH:
+              att_errorcode = ota_finish();
+              break;
+
+            case OTA_CMD_INSTALL:
+              if((ota.state != ota_verifying) && (ota.state != ota_verified))
+                {
+                  att_errorcode = SL_STATUS_BT_ATT_WRITE_REQUEST_REJECTED & 0xFF;
+                  break;
+                }
+              ota.install = true;
+              break;
+
+            default:
+              att_errorcode = SL_STATUS_BT_ATT_VALUE_NOT_ALLOWED & 0xFF;
+              break;
+          }
+        }
+
+      error_status = sl_bt_gatt_server_send_user_write_response(request->connection, gattdb_ota_control, att_errorcode);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError sending the OTA control response\r\n");
+
+      //After the response so the client gets it before the link goes down
+      if((att_errorcode == 0) && (ota.state == ota_verified) && (ota.install == true))
+        ota_install();
+    }
+}
+
+
+/*
+ * Steps the image verification
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_soft_timer_id
+ *
+ * Returns:
+ *   None
+ */
+void otaSoftTimer(sl_bt_msg_t *evt)
+{
+  int32_t error_status = BOOTLOADER_ERROR_PARSE_CONTINUE;
+
+  if((evt->data.evt_system_soft_timer.handle != OTA_TIMER_HANDLE) || (ota.state != ota_verifying))
+    return;
+
+  for(uint32_t i = 0; (i < OTA_VERIFY_STEPS) && (error_status == BOOTLOADER_ERROR_PARSE_CONTINUE); i++)
+    error_status = bootloader_continueVerifyImage(ota_verify_context, NULL);
+
+  if(error_status == BOOTLOADER_ERROR_PARSE_CONTINUE)
+    return;
+
+  ota_timer(false);
+
+  if(error_status != BOOTLOADER_ERROR_PARSE_SUCCESS)
+    {
+      LOG_ERROR("\r\nOTA image failed verification: 0x%lx\r\n", error_status);
+      ota_abort("image not valid");
+      return;
+    }
+
+  error_status = bootloader_setImageToBootload(OTA_SLOT);
+  if(error_status != BOOTLOADER_OK)
+    {
+      LOG_ERROR("\r\nError setting the image to bootload: 0x%lx\r\n", error_status);
+      ota_abort("image not set to bootload");
+      return;
+    }
+
+  ota.state = ota_verified;
+  LOG_INFO("\r\nOTA image verified in %lu ms\r\n", letimerMilliseconds() - ota.verify_ms);
+  displayPrintf(DISPLAY_ROW_10, "OTA verified");
+
+  if(ota.install == true)
+    ota_install();
+}
+
+#endif   //BUILD_INCLUDES_BLE_SERVER
@@ -0,0 +1,94 @@
+/**
+ * @file    :   ota.h
+ * @brief   :   Headers and function definitions for the in application firmware update
+ *
+ *              The server takes the GBL image over the Silicon Labs OTA service while the application
+ *              keeps running: data writes are buffered in RAM and written a block at a time into the
+ *              bootloader storage slot, the image is verified in steps from a soft timer and only a
+ *              verified image is handed to the bootloader. Both OTA characteristics need a bonded,
+ *              encrypted link. Needs a bootloader with a storage slot, the AppLoader only bootloader
+ *              has none and the ota_dfu component is gone, so such a board is flashed once over SWD.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef OTA_H
+#define OTA_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+
+//Storage slot the image is written to
+#define OTA_SLOT (0)
+
+//RAM block collected before each flash write, a multiple of the flash word so every write is word aligned
+#define OTA_BLOCK_LEN (1024)
+
+//Soft timer that steps the image verification, 328 ticks is 10 ms
+#define OTA_TIMER_HANDLE (5)
+#define OTA_VERIFY_TICKS (328)
+
+//Parser calls per soft timer tick while verifying
+#define OTA_VERIFY_STEPS (4)
+
+//Upload times kept for the PHY and ATT MTU combinations seen
+#define OTA_STATS_MAX (8)
+
+//OTA control point opcodes
+#define OTA_CMD_START (0x00)                       //Discards any earlier upload and starts at offset 0
+#define OTA_CMD_FINISH (0x03)                      //Flushes the last block and verifies the image
+#define OTA_CMD_INSTALL (0x04)                     //Disconnects and reboots into the bootloader once verified
+
+
+/*
+ * Initializes the bootloader interface at boot
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void otaBoot(sl_bt_msg_t *evt);
+
+
+/*
+ * Stops an upload whose client disconnected, or installs a verified image once the client that asked for it has gone
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void otaClosed(sl_bt_msg_t *evt);
+
+
+/*
+ * Serves the OTA control point and takes image data
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_gatt_server_user_write_request_id
+ *
+ * Returns:
+ *   None
+ */
+void otaUserWriteRequest(sl_bt_msg_t *evt);
+
+
+/*
+ * Steps the image verification
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_soft_timer_id
+ *
+ * Returns:
+ *   None
+ */
+void otaSoftTimer(sl_bt_msg_t *evt);
+
+
+#endif   //OTA_H
@@ -0,0 +1,261 @@
+/**
+ * @file    :   profile.c
+ * @brief   :   API for the DWT cycle counter profiling probes
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/profile.h"
+
+#if PROFILE_ENABLE
+
+#include "em_core.h"
+#include "em_cmu.h"
+#include "gatt_db.h"
+#include "string.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+typedef struct
+{
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+}profile_stats_t;
+
+static profile_stats_t profile_stats[PROFILE_NUM_PROBES];
+
+//Snapshot served to GATT reads, taken at offset 0 so a long read sees one consistent table
+static profile_entry_t profile_snapshot[PROFILE_NUM_PROBES];
+
+static const char *profile_names[PROFILE_NUM_PROBES] =
+{
+  "LETIMER0_IRQ",
+  "I2C0_IRQ",
+  "GPIO_EVEN_IRQ",
+  "GPIO_ODD_IRQ",
+  "handle_ble_event",
+  "temperature_sm",
+  "discovery_sm",
+  "displayPrintf",
+  "ble_dispatch_lookup",
+  "display_trend"
+};
+
+
+/*
+ * Enables the DWT cycle counter and resets every probe
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void profileInit()
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;       //Enable the DWT block
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                  //Start the cycle counter, left running if the trace already started it
+
+  profileReset();
+}
+
+
+/*
+ * Adds one sample to a probe. Safe to call from an ISR
+ *
+ * Parameters:
+ *   profile_probe_t probe: Probe to update
+ *   uint32_t cycles: Cycles spent in the probed code
+ *
+ * Returns:
+ *   None
+ */
+void profileUpdate(profile_probe_t probe, uint32_t cycles)
+{
+  profile_stats_t *stats = &profile_stats[probe];
+
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+
+  if((stats->count == 0) || (cycles < stats->min))
+    stats->min = cycles;
+  if(cycles > stats->max)
+    stats->max = cycles;
+  stats->total += cycles;
+  stats->count++;
+
+  CORE_EXIT_CRITICAL();
+}
+
+
+/*
+ * Clears the statistics of every probe
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void profileReset()
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  memset(profile_stats, 0, sizeof(profile_stats));
+  CORE_EXIT_CRITICAL();
+}
+
+
+/*
+ * Copies the statistics of one probe
+ *
+ * Parameters:
+ *   profile_probe_t probe: Probe to read
+ *   profile_entry_t *entry: Destination
+ *
+ * Returns:
+ *   None
+ */
+void profileGet(profile_probe_t probe, profile_entry_t *entry)
+{
+  profile_stats_t stats;
+
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  stats = profile_stats[probe];
+  CORE_EXIT_CRITICAL();
+
+  entry->count = stats.count;
+  entry->min = stats.min;
+  entry->max = stats.max;
+  entry->mean = (stats.count != 0) ? (uint32_t)(stats.total / stats.count) : 0;
+}
+
+
+/*
+ * Prints the statistics of every probe to VCOM
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void profileDump()
+{
+  profile_entry_t entry;
+
+  app_log("PROFILE cpu_hz=%"PRIu32"\n", CMU_ClockFreqGet(cmuClock_CORE));
+
+  for(uint32_t probe = 0; probe < PROFILE_NUM_PROBES; probe++)
+    {
+      profileGet((profile_probe_t)probe, &entry);
+      app_log("PROFILE %-16s count=%"PRIu32" min=%"PRIu32" max=%"PRIu32" mean=%"PRIu32"\n",
+              profile_names[probe], entry.count, entry.min, entry.max, entry.mean);
+    }
+}
+
+
+/*
+ * Serves the profile characteristic: user reads return the probe table, user writes take a PROFILE_CMD_* command
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void profile_handle_ble_event(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+
+  switch (SL_BT_MSG_ID(evt->header))
+  {
+    case sl_bt_evt_gatt_server_user_read_request_id:
+      if(evt->data.evt_gatt_server_user_read_request.characteristic == gattdb_profile_data)
+        {
+          uint16_t offset = evt->data.evt_gatt_server_user_read_request.offset;
+          uint16_t mtu = 0;
+          uint16_t sent_len;
+          size_t len = 0;
+
+          error_status = sl_bt_gatt_server_get_mtu(evt->data.evt_gatt_server_user_read_request.connection, &mtu);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError reading the ATT MTU\r\n");
+
+          if(offset == 0)                               //A new read, later blob reads continue from the same snapshot
+            {
+              for(uint32_t probe = 0; probe < PROFILE_NUM_PROBES; probe++)
+                profileGet((profile_probe_t)probe, &profile_snapshot[probe]);
+            }
+
+          if(offset <= sizeof(profile_snapshot))
+            {
+              len = sizeof(profile_snapshot) - offset;
+              if((mtu > 1) && (len > (size_t)(mtu - 1)))
+                len = mtu - 1;
+
+              error_status = sl_bt_gatt_server_send_user_read_response(evt->data.evt_gatt_server_user_read_request.connection,
+                                                                       gattdb_profile_data, 0, len,
+                                                                       (uint8_t *)profile_snapshot + offset, &sent_len);
+            }
+          else
+            error_status = sl_bt_gatt_server_send_user_read_response(evt->data.evt_gatt_server_user_read_request.connection,
+                                                                     gattdb_profile_data, SL_STATUS_BT_ATT_INVALID_OFFSET & 0xFF,
+                                                                     0, NULL, &sent_len);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError sending the profile read response\r\n");
+        }
+      break;
+
+    case sl_bt_evt_gatt_server_user_write_request_id:
+      if(evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_profile_data)
+        {
+          uint8_t att_errorcode = 0;
+
+          if(evt->data.evt_gatt_server_user_write_request.value.len < 1)
+            att_errorcode = SL_STATUS_BT_ATT_INVALID_ATT_LENGTH & 0xFF;
+
+          else
+            {
+              switch(evt->data.evt_gatt_server_user_write_request.value.data[0])
+              {
+                case PROFILE_CMD_RESET:
+                  profileReset();
+                  break;
+
+                case PROFILE_CMD_DUMP_VCOM:
+                  profileDump();
+                  break;
+
+                default:
+                  att_errorcode = SL_STATUS_BT_ATT_VALUE_NOT_ALLOWED & 0xFF;
+                  break;
+              }
+            }
+
+          if(evt->data.evt_gatt_server_user_write_request.att_opcode == sl_bt_gatt_write_request)
+            {
+              error_status = sl_bt_gatt_server_send_user_write_response(evt->data.evt_gatt_server_user_write_request.connection,
+                                                                        gattdb_profile_data, att_errorcode);
+              if(error_status != SL_STATUS_OK)
+                LOG_ERROR("\r\nError sending the profile write response\r\n");
+            }
+        }
+      break;
+
+    default:
+      break;
+  }
+}
+
+#endif   //PROFILE_ENABLE
@@ -0,0 +1,164 @@
+/**
+ * @file    :   profile.h
+ * @brief   :   Headers and function definitions for the DWT cycle counter profiling probes
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "stdint.h"
+#include "em_device.h"
+#include "sl_bt_api.h"
+
+//Set to 0 to compile the probes out, PROFILE_START/PROFILE_STOP then expand to nothing
+#define PROFILE_ENABLE (1)
+
+//Commands written to the profile characteristic
+#define PROFILE_CMD_RESET (0x00)
+#define PROFILE_CMD_DUMP_VCOM (0x01)
+
+//Probe identifiers, also the order of the entries returned over GATT
+typedef enum
+{
+  PROFILE_LETIMER0_IRQ = 0,
+  PROFILE_I2C0_IRQ,
+  PROFILE_GPIO_EVEN_IRQ,
+  PROFILE_GPIO_ODD_IRQ,
+  PROFILE_HANDLE_BLE_EVENT,
+  PROFILE_TEMPERATURE_SM,
+  PROFILE_DISCOVERY_SM,
+  PROFILE_DISPLAY_PRINTF,
+  PROFILE_BLE_DISPATCH,             //Table lookup alone, PROFILE_HANDLE_BLE_EVENT covers the lookup and the handlers
+  PROFILE_DISPLAY_TREND,            //One trend plot sample, scroll, segment and LCD update
+  PROFILE_NUM_PROBES
+}profile_probe_t;
+
+//Statistics for one probe as returned over GATT, 16 bytes, little endian
+typedef struct __attribute__((packed))
+{
+  uint32_t count;          //Number of samples since the last reset
+  uint32_t min;            //Minimum cycles, 0 when count is 0
+  uint32_t max;            //Maximum cycles
+  uint32_t mean;           //Mean cycles
+}profile_entry_t;
+
+
+#if PROFILE_ENABLE
+
+/*
+ * Enables the DWT cycle counter and resets every probe
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void profileInit();
+
+
+/*
+ * Returns the current DWT cycle count
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t: DWT CYCCNT value
+ */
+static inline uint32_t profileCycles()
+{
+  return DWT->CYCCNT;
+}
+
+
+/*
+ * Adds one sample to a probe. Safe to call from an ISR
+ *
+ * Parameters:
+ *   profile_probe_t probe: Probe to update
+ *   uint32_t cycles: Cycles spent in the probed code
+ *
+ * Returns:
+ *   None
+ */
+void profileUpdate(profile_probe_t probe, uint32_t cycles);
+
+
+/*
+ * Clears the statistics of every probe
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void profileReset();
+
+
+/*
+ * Copies the statistics of one probe
+ *
+ * Parameters:
+ *   profile_probe_t probe: Probe to read
+ *   profile_entry_t *entry: Destination
+ *
+ * Returns:
+ *   None
+ */
+void profileGet(profile_probe_t probe, profile_entry_t *entry);
+
+
+/*
+ * Prints the statistics of every probe to VCOM
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void profileDump();
+
+
+/*
+ * Serves the profile characteristic: user reads return the probe table, user writes take a PROFILE_CMD_* command
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void profile_handle_ble_event(sl_bt_msg_t *evt);
+
+#else
+
+static inline void profileInit() {}
+static inline void profileReset() {}
+static inline void profileDump() {}
+static inline void profile_handle_ble_event(sl_bt_msg_t *evt) { (void)evt; }
+
+#endif   //PROFILE_ENABLE
+
+
+/*
+ * Brackets the probed code. Each probe declares its own start variable so probes can nest
+ */
+#if PROFILE_ENABLE
+#define PROFILE_START(probe) \
+  uint32_t profile_start_##probe = profileCycles()
+
+#define PROFILE_STOP(probe) \
+  profileUpdate((probe), profileCycles() - profile_start_##probe)
+#else
+#define PROFILE_START(probe)
+#define PROFILE_STOP(probe)
+#endif
+
+#endif   //PROFILE_H
@@ -0,0 +1,218 @@
+/**
+ * @file    :   scan.c
+ * @brief   :   API for the client scan report filter
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/scan.h"
+#include "src/scheduler.h"
+#include "src/irq.h"
+#include "string.h"
+
+#define UUID128_LEN (16)
+
+//One advertiser, found by its address hash with linear probing
+typedef struct
+{
+  bool valid;
+  bool is_server;                 //Advertising data lists one of our services
+  bd_addr address;
+  int16_t rssi;                   //Smoothed RSSI in dBm
+  uint32_t classified_ms;         //letimerMilliseconds() when the advertising data was last parsed
+  uint32_t seen_ms;               //letimerMilliseconds() of the last report
+} scan_seen_t;
+
+static scan_seen_t scan_seen[SCAN_SEEN_SIZE];
+
+
+/*
+ * Hashes a device address to its home slot, FNV-1a over the six address bytes
+ *
+ * Parameters:
+ *   bd_addr *address: Device address
+ *
+ * Returns:
+ *   uint32_t: Home slot, 0 to SCAN_SEEN_SIZE - 1
+ */
+static uint32_t scan_hash(bd_addr *address)
+{
+  uint32_t hash = 2166136261u;
+
+  for(uint32_t i = 0; i < sizeof(address->addr); i++)
+    {
+      hash ^= address->addr[i];
+      hash *= 16777619u;
+    }
+
+  return hash & (SCAN_SEEN_SIZE - 1);
+}
+
+
+/*
+ * Finds the entry of an address, or the slot it should take
+ *
+ * Slots are never emptied, only overwritten, so the entry of an address is always within SCAN_SEEN_MAX_PROBE
+ * slots of its home slot and before the first empty one. When the window is full the least recently seen
+ * entry in it is taken.
+ *
+ * Parameters:
+ *   bd_addr *address: Device address
+ *   bool *found: Set to true if the address already has an entry
+ *
+ * Returns:
+ *   scan_seen_t*: The entry of the address, or the slot to store it in
+ */
+static scan_seen_t* scan_seen_lookup(bd_addr *address, bool *found)
+{
+  uint32_t home = scan_hash(address);
+  scan_seen_t *oldest = &scan_seen[home];
+
+  *found = false;
+
+  for(uint32_t probe = 0; probe < SCAN_SEEN_MAX_PROBE; probe++)
+    {
+      scan_seen_t *entry = &scan_seen[(home + probe) & (SCAN_SEEN_SIZE - 1)];
+
+      if(entry->valid == false)
+        return entry;
+
+      if(memcmp(&entry->address, address, sizeof(bd_addr)) == 0)
+        {
+          *found = true;
+          return entry;
+        }
+
+      if((int32_t)(entry->seen_ms - oldest->seen_ms) < 0)
+        oldest = entry;
+    }
+
+  return oldest;
+}
+
+
+/*
+ * Checks whether advertising data lists a 128-bit service UUID, the AD structures are walked in place
+ *
+ * Parameters:
+ *   const uint8_t *data: Advertising data
+ *   uint8_t len: Length of the advertising data
+ *   const uint8_t *uuid: Service UUID, 16 bytes little endian
+ *
+ * Returns:
+ *   bool: true if an incomplete or complete 128-bit UUID list contains the UUID
+ */
+bool scanAdHasService128(const uint8_t *data, uint8_t len, const uint8_t *uuid)
+{
+  uint32_t pos = 0;
+
+  //Each AD structure is a length byte, a type byte and length - 1 bytes of payload
+  while(pos < len)
+    {
+      uint8_t field_len = data[pos];
+
+      if(field_len == 0)                                    //Zero padding ends the significant part
+        break;
+
+      if((pos + 1 + field_len) > len)                       //Truncated structure
+        break;
+
+      uint8_t type = data[pos + 1];
+
+      if((type == AD_TYPE_INCOMPLETE_UUID128) || (type == AD_TYPE_COMPLETE_UUID128))
+        {
+          for(uint32_t off = pos + 2; (off + UUID128_LEN) <= (pos + 1 + field_len); off += UUID128_LEN)
+            {
+              if(memcmp(&data[off], uuid, UUID128_LEN) == 0)
+                return true;
+            }
+        }
+
+      pos += 1 + field_len;
+    }
+
+  return false;
+}
+
+
+/*
+ * Finds the first AD structure of a type, the AD structures are walked in place
+ *
+ * Parameters:
+ *   const uint8_t *data: Advertising data
+ *   uint8_t len: Length of the advertising data
+ *   uint8_t type: AD type
+ *   uint8_t *field_len: Returns the payload length of the structure, without the type byte
+ *
+ * Returns:
+ *   const uint8_t*: Payload of the structure, NULL if there is none of that type
+ */
+const uint8_t* scanAdFind(const uint8_t *data, uint8_t len, uint8_t type, uint8_t *field_len)
+{
+  uint32_t pos = 0;
+
+  while(pos < len)
+    {
+      uint8_t ad_len = data[pos];
+
+      if((ad_len == 0) || ((pos + 1 + ad_len) > len))
+        break;
+
+      if(data[pos + 1] == type)
+        {
+          *field_len = ad_len - 1;
+          return &data[pos + 2];
+        }
+
+      pos += 1 + ad_len;
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Records a scan report in the seen-device table and classifies the advertiser
+ *
+ * A device already in the table only has its RSSI updated, its advertising data is parsed on the first
+ * report and again once the classification is SCAN_SEEN_TTL_MS old.
+ *
+ * Parameters:
+ *   sl_bt_evt_scanner_scan_report_t *report: Scan report
+ *   int8_t *rssi: Filled in with the smoothed RSSI of the advertiser
+ *
+ * Returns:
+ *   bool: true if the advertiser runs our services and its smoothed RSSI is at least SCAN_RSSI_MIN
+ */
+bool scanFilterReport(sl_bt_evt_scanner_scan_report_t *report, int8_t *rssi)
+{
+  bool found;
+  uint32_t now = letimerMilliseconds();
+  scan_seen_t *entry = scan_seen_lookup(&report->address, &found);
+
+  if(found == false)
+    {
+      entry->valid = true;
+      entry->address = report->address;
+      entry->rssi = report->rssi;
+      entry->classified_ms = now - SCAN_SEEN_TTL_MS;         //Forces the parse below
+    }
+  else
+    entry->rssi = (3 * entry->rssi + report->rssi) / 4;      //Smooths fading so ranking is not decided by one report
+
+  entry->seen_ms = now;
+
+  if((now - entry->classified_ms) >= SCAN_SEEN_TTL_MS)
+    {
+      entry->is_server = scanAdHasService128(report->data.data, report->data.len, RGB_SERVICE_UUID) ||
+          scanAdHasService128(report->data.data, report->data.len, GESTURE_SERVICE_UUID);
+      entry->classified_ms = now;
+    }
+
+  *rssi = (int8_t)entry->rssi;
+
+  return (entry->is_server == true) && (entry->rssi >= SCAN_RSSI_MIN);
+}
+
@@ -0,0 +1,82 @@
+/**
+ * @file    :   scan.h
+ * @brief   :   Headers and function definitions for the client scan report filter
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+
+//Reports weaker than this are not connection candidates, in dBm
+#define SCAN_RSSI_MIN (-85)
+
+//Slots in the seen-device table, a power of two
+#define SCAN_SEEN_SIZE (32)
+
+//Slots probed from the home slot of an address, bounds the cost of a lookup whatever the table holds
+#define SCAN_SEEN_MAX_PROBE (8)
+
+//The advertising data of a seen device is parsed again once its classification is this old
+#define SCAN_SEEN_TTL_MS (10000)
+
+//Time candidates are collected before the strongest one is opened, longer than one server advertising interval
+#define SCAN_RANK_WINDOW_MS (300)
+
+//AD types carrying 128-bit service UUIDs
+#define AD_TYPE_INCOMPLETE_UUID128 (0x06)
+#define AD_TYPE_COMPLETE_UUID128 (0x07)
+
+//AD type of the broadcast payload
+#define AD_TYPE_MANUFACTURER_DATA (0xFF)
+
+
+/*
+ * Checks whether advertising data lists a 128-bit service UUID, the AD structures are walked in place
+ *
+ * Parameters:
+ *   const uint8_t *data: Advertising data
+ *   uint8_t len: Length of the advertising data
+ *   const uint8_t *uuid: Service UUID, 16 bytes little endian
+ *
+ * Returns:
+ *   bool: true if an incomplete or complete 128-bit UUID list contains the UUID
+ */
+bool scanAdHasService128(const uint8_t *data, uint8_t len, const uint8_t *uuid);
+
+
+/*
+ * Finds the first AD structure of a type, the AD structures are walked in place
+ *
+ * Parameters:
+ *   const uint8_t *data: Advertising data
+ *   uint8_t len: Length of the advertising data
+ *   uint8_t type: AD type
+ *   uint8_t *field_len: Returns the payload length of the structure, without the type byte
+ *
+ * Returns:
+ *   const uint8_t*: Payload of the structure, NULL if there is none of that type
+ */
+const uint8_t* scanAdFind(const uint8_t *data, uint8_t len, uint8_t type, uint8_t *field_len);
+
+
+/*
+ * Records a scan report in the seen-device table and classifies the advertiser
+ *
+ * Parameters:
+ *   sl_bt_evt_scanner_scan_report_t *report: Scan report
+ *   int8_t *rssi: Filled in with the smoothed RSSI of the advertiser
+ *
+ * Returns:
+ *   bool: true if the advertiser runs our services and its smoothed RSSI is at least SCAN_RSSI_MIN
+ */
+bool scanFilterReport(sl_bt_evt_scanner_scan_report_t *report, int8_t *rssi);
+
+
+#endif   //SCAN_H
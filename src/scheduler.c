@@ -19,6 +19,13 @@
 #include "lcd.h"
 #include "ble_device_type.h"
 #include "ble.h"
+#include "src/connection.h"
+#include "src/server_conn.h"
+#include "src/gatt_cache.h"
+#include "src/broadcast.h"
+#include "src/irq.h"
+#include "app.h"
+#include "string.h"
 #include <stdio.h>
 #include <stdbool.h>
 #include <assert.h>
@@ -34,18 +41,13 @@
 #define bit_I2C_TRANSFER (4)
 
 
+static temp_state_t temp_next_state = state0_IDLE;                  //First state is Idle by default
+static client_conn_t *client_current = NULL;                        //Connection that last ran the discovery state machine
 
-#define PTR_OUT_OF_BOUND (-1)
-
-// Declare memory for the queue/buffer/fifo, and the write and read pointers
-queue_struct_t   my_queue[QUEUE_DEPTH]; // the queue
-uint32_t         wptr = 0;              // write pointer
-uint32_t         rptr = 0;              // read pointer
-
-static bool isfull = false;
-static bool isempty = true;
-
-static uint32_t length = 0;
+//Latest sample, temperature reads are answered from RAM instead of a GATT database write per sample
+static uint8_t temperature_latest[TEMPERATURE_VALUE_LEN];
+static uint32_t temperature_latest_ms = 0;                          //letimerMilliseconds() when it was taken
+static bool temperature_latest_valid = false;
 
 
 /* Sets an event when interrupt is triggered
@@ -148,6 +150,39 @@ void setSchedulerEventExternalPushButton1()
 
 }
 
+
+/*
+ * Checks whether the server should take temperature samples
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   bool: true if a client has indications enabled or waits for a read, or always in broadcast mode where the advertising data carries the sample
+ */
+static bool temperature_wanted()
+{
+  return (BROADCAST_ENABLE == 1) || (serverConnAnyEnabled(server_char_htm) == true) || (serverConnAnyReadPending(server_char_htm) == true);
+}
+
+
+/*
+ * Indicates a temperature sample to one client
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context of the client
+ *   uint8_t *buffer: HTM value with the flags byte, followed by the benchmark stamp when enabled
+ *   size_t len: Buffer length
+ *
+ * Returns:
+ *   None
+ */
+static void temperature_indicate(server_conn_t *ctx, uint8_t *buffer, size_t len)
+{
+  //A gesture indication in flight on this link holds the sample as its newest value, other links are not affected
+  serverConnIndicate(ctx, server_char_htm, buffer, len);
+}
+
 /*
  * State Machine for temperature measurement
  *
@@ -159,34 +194,31 @@ void setSchedulerEventExternalPushButton1()
  */
 void temperature_state_machine(sl_bt_msg_t *evt)
 {
-  ble_data_struct_t *bleData;
-  sl_status_t error_status;
-
-  bleData = getBleDataPtr();
+  server_conn_t *ctx;
 
-  uint8_t htm_temperature_buffer[5];
+  uint8_t htm_temperature_buffer[5 + BENCH_PAYLOAD_LEN];
   uint8_t *p = &htm_temperature_buffer[1];
   uint32_t htm_temperature_flt;
 
   temp_state_t currentState;
 
-  static temp_state_t nextState = state0_IDLE;                             //First state is Idle by default
-
-  currentState = nextState;                                           //Update the current state
+  currentState = temp_next_state;                                           //Update the current state
 
   switch(currentState)
   {
     case state0_IDLE:
-      nextState = state0_IDLE;
+      temp_next_state = state0_IDLE;
 
-      if(bleData->is_connection == true)
+      if((serverConnCount() != 0) || (BROADCAST_ENABLE == 1))
         {
           if (evt->data.evt_system_external_signal.extsignals == event_LETIMER0_UF)
             {
 
+              benchServerAcquisition();                                  //Benchmark latency is measured from this underflow
+
               timerWaitUs_irq(80000);                                    //Wait for 80 msec [Setup time]
 
-              nextState = state1_COMP1_POWER_ON;
+              temp_next_state = state1_COMP1_POWER_ON;
             }
         }
 
@@ -195,9 +227,9 @@ void temperature_state_machine(sl_bt_msg_t *evt)
       break;
 
     case state1_COMP1_POWER_ON:
-      nextState = state1_COMP1_POWER_ON;
+      temp_next_state = state1_COMP1_POWER_ON;
 
-      if((bleData->is_connection == true) && (bleData->is_htm_indication_enabled ==  true))
+      if(temperature_wanted() == true)
         {
           if(evt->data.evt_system_external_signal.extsignals == event_LETIMER0_COMP1)                             //Event when the timer delay elapses
             {
@@ -205,12 +237,12 @@ void temperature_state_machine(sl_bt_msg_t *evt)
 
               sendI2C_command();                                        //Write temperature measurement sequence to the sensor
 
-              nextState = state2_I2C_TRANSFER_COMPLETE;
+              temp_next_state = state2_I2C_TRANSFER_COMPLETE;
             }
         }
       else
         {
-          nextState = state0_IDLE;
+          temp_next_state = state0_IDLE;
           displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
         }
 
@@ -218,9 +250,9 @@ void temperature_state_machine(sl_bt_msg_t *evt)
       break;
 
     case state2_I2C_TRANSFER_COMPLETE:
-      nextState = state2_I2C_TRANSFER_COMPLETE;
+      temp_next_state = state2_I2C_TRANSFER_COMPLETE;
 
-      if((bleData->is_connection == true) && (bleData->is_htm_indication_enabled ==  true))
+      if(temperature_wanted() == true)
         {
 
           if(evt->data.evt_system_external_signal.extsignals == event_I2C_Transfer_Complete)                    //Event when the I2C transfer is completed
@@ -229,13 +261,13 @@ void temperature_state_machine(sl_bt_msg_t *evt)
 
               timerWaitUs_irq(10800);                                //I2C sequence time to wait while the sequence is transmitted [10.8 msec]
 
-              nextState = state3_COMP1_I2C_TRANSFER_COMPLETE;
+              temp_next_state = state3_COMP1_I2C_TRANSFER_COMPLETE;
             }
         }
 
       else
         {
-          nextState = state0_IDLE;
+          temp_next_state = state0_IDLE;
           sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
           displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
         }
@@ -243,10 +275,10 @@ void temperature_state_machine(sl_bt_msg_t *evt)
       break;
 
     case state3_COMP1_I2C_TRANSFER_COMPLETE:
-      nextState = state3_COMP1_I2C_TRANSFER_COMPLETE;
+      temp_next_state = state3_COMP1_I2C_TRANSFER_COMPLETE;
 
 
-      if((bleData->is_connection == true) && (bleData->is_htm_indication_enabled ==  true))
+      if(temperature_wanted() == true)
         {
 
           if(evt->data.evt_system_external_signal.extsignals == event_LETIMER0_COMP1)                       //Event when the write sequence is written
@@ -255,22 +287,22 @@ void temperature_state_machine(sl_bt_msg_t *evt)
 
               receiveI2C_command();                              //Transmit the read command
 
-              nextState = state4_UNDERFLOW_READ;
+              temp_next_state = state4_UNDERFLOW_READ;
             }
 
         }
 
       else
         {
-          nextState = state0_IDLE;
+          temp_next_state = state0_IDLE;
           displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
         }
       break;
 
     case state4_UNDERFLOW_READ:
-      nextState = state4_UNDERFLOW_READ;
+      temp_next_state = state4_UNDERFLOW_READ;
 
-      if((bleData->is_connection == true) && (bleData->is_htm_indication_enabled ==  true))
+      if(temperature_wanted() == true)
         {
           if(evt->data.evt_system_external_signal.extsignals == event_I2C_Transfer_Complete)             //Event when the I2C transfer is completed
             {
@@ -281,40 +313,42 @@ void temperature_state_machine(sl_bt_msg_t *evt)
 
               displayPrintf(DISPLAY_ROW_TEMPVALUE, "Temp=%d C", temp_in_C);
 
+              broadcastUpdate((int32_t)temp_in_C * 1000);
+
+              htm_temperature_buffer[0] = 0;                           //Flags: Celsius, no time stamp or type
               htm_temperature_flt = UINT32_TO_FLOAT(temp_in_C*1000, -3);
 
               UINT32_TO_BITSTREAM(p, htm_temperature_flt);
-              //              LOG_INFO("\r\nConnection handle: %d\r\n", bleData->is_connection);
-              //              LOG_INFO("\r\nIndication Enabled: %d\r\n", bleData->is_indication_enabled);
-              //              LOG_INFO("\r\nIndication in flight: %d\r\n", bleData->is_indication_in_flight);
 
+              //Kept in RAM for reads, the GATT database holds no copy of the value
+              memcpy(temperature_latest, htm_temperature_buffer, TEMPERATURE_VALUE_LEN);
+              temperature_latest_ms = letimerMilliseconds();
+              temperature_latest_valid = true;
+              serverConnReadAnswer(server_char_htm, temperature_latest, TEMPERATURE_VALUE_LEN);
 
-              //Only write to local GATT database if there is a connection present, if the indicate button is enabled on the GUI
+              //Broadcast mode and reads sample without indications, nothing more to send
+              if(serverConnAnyEnabled(server_char_htm) == false)
+                {
+                  temp_next_state = state0_IDLE;
+                  break;
+                }
 
-              error_status = sl_bt_gatt_server_write_attribute_value(gattdb_rgb_state,  0,  5,  p);          //Update the local GATT database
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nUpdating Local Gatt-Database Error\r\n");
+              benchServerStamp(p);                                 //Append the benchmark stamp after the HTM value
 
 
-              //Only send indication if there is a connection present, if the indicate button is enabled on the GUI and no other indication is in flight
-              if((bleData->is_htm_indication_in_flight == false))
+              //Every client with indications enabled gets the sample on its own link
+              for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
                 {
-                  error_status = sl_bt_gatt_server_send_indication(bleData->connectionSetHandle, gattdb_rgb_state, 5, &htm_temperature_buffer[0]);   //Send an indication with the temperature data buffer
-                  if(error_status != SL_STATUS_OK)
-                    LOG_ERROR("\r\nSending Indication Error: %d\r\n", error_status);
-                  else
-                    bleData->is_htm_indication_in_flight = true;      //Set the flag to true if indication was sent
-                }
-              else
-                {
-                  write_queue(gattdb_rgb_state, sizeof(htm_temperature_buffer), htm_temperature_buffer);
+                  ctx = serverConnSlot(slot);
+                  if(ctx != NULL)
+                    temperature_indicate(ctx, htm_temperature_buffer, sizeof(htm_temperature_buffer));
                 }
             }
-          nextState = state0_IDLE;
+          temp_next_state = state0_IDLE;
         }
       else
         {
-          nextState = state0_IDLE;
+          temp_next_state = state0_IDLE;
           sl_power_manager_remove_em_requirement(SL_POWER_MANAGER_EM1);
           displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
         }
@@ -327,7 +361,76 @@ void temperature_state_machine(sl_bt_msg_t *evt)
 
 
 /*
- * State Machine for client discovery
+ * Releases a server connection that closed and resumes scanning for a replacement
+ *
+ * Parameters:
+ *   client_conn_t *conn: Connection that closed
+ *   uint16_t reason: Close reason from the stack
+ *
+ * Returns:
+ *   None
+ */
+static void discovery_connection_closed(client_conn_t *conn, uint16_t reason)
+{
+  LOG_INFO("Server %"PRIu32" closed, reason 0x%04x, %"PRIu32" samples", clientConnIndex(conn), reason, conn->samples);
+
+  conn->state = state0_NO_CONNECTION;
+  clientConnFree(conn);
+  clientScannerUpdate();
+
+  if(clientConnCount() == 0)
+    {
+      displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
+      displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
+      displayPrintf(DISPLAY_ROW_BTADDR2, " ");
+    }
+  else
+    displayPrintf(DISPLAY_ROW_CONNECTION, "Servers: %"PRIu32, clientConnCount());
+}
+
+
+/*
+ * Starts the full service and characteristic discovery of a server
+ *
+ * Parameters:
+ *   client_conn_t *conn: Connection to discover
+ *
+ * Returns:
+ *   None
+ */
+static void discovery_start_full(client_conn_t *conn)
+{
+  sl_status_t error_status;
+
+  conn->state = state1_TEMP_SERVICE_DISCOVERED;
+
+  error_status = sl_bt_gatt_discover_primary_services_by_uuid(conn->connection, RGB_SERVICE_UUID_LEN , RGB_SERVICE_UUID);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError discovering a service - HTM\r\n");
+}
+
+
+/*
+ * Marks a connection ready once both indications are enabled
+ *
+ * Parameters:
+ *   client_conn_t *conn: Connection that finished discovery
+ *   bool cached: true if the handles came from the GATT cache
+ *
+ * Returns:
+ *   None
+ */
+static void discovery_ready(client_conn_t *conn, bool cached)
+{
+  LOG_INFO("Server %"PRIu32" ready %"PRIu32" ms after open, %s", clientConnIndex(conn),
+           letimerMilliseconds() - conn->opened_ms, (cached == true) ? "cached handles" : "full discovery");
+
+  displayPrintf(DISPLAY_ROW_CONNECTION, "Handling Indications");
+}
+
+
+/*
+ * State Machine for client discovery, one instance per server connection
  *
  * Parameters:
  *   sl_bt_msg_t event: Gives the current event set from the external signals data structure of the Bluetooth Stack
@@ -337,205 +440,215 @@ void temperature_state_machine(sl_bt_msg_t *evt)
  */
 void discovery_state_machine(sl_bt_msg_t *evt)
 {
-  ble_data_struct_t *bleData;
+  client_conn_t *conn;
   sl_status_t error_status;
 
-  bleData = getBleDataPtr();
+  conn = clientConnFromEvent(evt);                                          //Events without a known connection do not drive discovery
+  if(conn == NULL)
+    return;
 
-  client_state_t currentState;
+  client_current = conn;
 
-  static client_state_t nextState = state0_NO_CONNECTION;                             //First state is Idle by default
+  if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)          //A close ends discovery from any state
+    {
+      discovery_connection_closed(conn, evt->data.evt_connection_closed.reason);
+      return;
+    }
 
-  currentState = nextState;                                           //Update the current state
+  //The refused write starts pairing in bonding.c but discovery goes on, the CCCDs are written again from state3
+  if((SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
+      && (evt->data.evt_gatt_procedure_completed.result == SL_STATUS_BT_ATT_INSUFFICIENT_ENCRYPTION))
+    conn->cccd_refused = true;
 
-  switch(currentState)
+  switch(conn->state)
   {
     case state0_NO_CONNECTION:
-      nextState = state0_NO_CONNECTION;
-
       if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_opened_id)
         {
-          //          nextState = state0_BUTTON_SERVICE_DISCOVERY;
-          nextState = state1_TEMP_SERVICE_DISCOVERED;
-          displayPrintf(DISPLAY_ROW_CONNECTION, "Connected");
+          conn->is_open = true;
+          conn->opened_ms = letimerMilliseconds();
+          clientScannerUpdate();                                            //The open resolved, look for the next server
+          displayPrintf(DISPLAY_ROW_CONNECTION, "Servers: %"PRIu32, clientConnCount());
 
-          displayPrintf(DISPLAY_ROW_BTADDR2,"%02x:%02x:%02x:%02x:%02x:%02x",SERVER_BT_ADDRESS.addr[5], SERVER_BT_ADDRESS.addr[4], SERVER_BT_ADDRESS.addr[3], SERVER_BT_ADDRESS.addr[2] , SERVER_BT_ADDRESS.addr[1], SERVER_BT_ADDRESS.addr[0]);
-          error_status = sl_bt_gatt_discover_primary_services_by_uuid(bleData->connectionSetHandle, RGB_SERVICE_UUID_LEN , RGB_SERVICE_UUID);
-          if(error_status != SL_STATUS_OK)
-            LOG_ERROR("\r\nError discovering a service - HTM\r\n");
+          displayPrintf(DISPLAY_ROW_BTADDR2,"%02x:%02x:%02x:%02x:%02x:%02x",conn->address.addr[5], conn->address.addr[4], conn->address.addr[3], conn->address.addr[2] , conn->address.addr[1], conn->address.addr[0]);
 
-        }
-      else
-        {
-          if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
+          //Read the Database Hash first, if it matches the cache the discovery procedures are skipped. Its handle on the
+          //server is not known yet, so the Generic Attribute service is found by UUID and the hash read by UUID within it
+          conn->state = state0_GATT_SERVICE_DISCOVERY;
+          error_status = sl_bt_gatt_discover_primary_services_by_uuid(conn->connection, sizeof(GATT_SERVICE_UUID), GATT_SERVICE_UUID);
+          if(error_status != SL_STATUS_OK)
             {
-              nextState = state0_NO_CONNECTION;
-              error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nError starting connection scanning\r\n");
-              displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
-              displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-              displayPrintf(DISPLAY_ROW_BTADDR2, " ");
+              LOG_ERROR("\r\nError discovering the Generic Attribute service\r\n");
+              discovery_start_full(conn);
             }
         }
       break;
 
-    case state1_TEMP_SERVICE_DISCOVERED:
-      nextState = state1_TEMP_SERVICE_DISCOVERED;
-
+    case state0_GATT_SERVICE_DISCOVERY:
       if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          //          nextState = state1_BUTTON_SERVICE_DISCOVERED;
-          nextState = state2_TEMP_MEASUREMENT_CHAR_ENABLED;
+          if((evt->data.evt_gatt_procedure_completed.result != SL_STATUS_OK) || (conn->gattServiceHandle == 0))
+            {
+              discovery_start_full(conn);
+              break;
+            }
 
-          error_status = sl_bt_gatt_discover_characteristics_by_uuid(bleData->connectionSetHandle, bleData->htmServiceHandle, sizeof(RGB_CHAR_UUID), RGB_CHAR_UUID );
+          conn->state = state0_DATABASE_HASH_READ;
+          error_status = sl_bt_gatt_read_characteristic_value_by_uuid(conn->connection, conn->gattServiceHandle, sizeof(GATT_DATABASE_HASH_UUID),
+                                                                      GATT_DATABASE_HASH_UUID);
           if(error_status != SL_STATUS_OK)
-            LOG_ERROR("\r\nError discovering a characteristic - TEMPERATURE MEASUREMENT\r\n");
+            {
+              LOG_ERROR("\r\nError reading the database hash\r\n");
+              discovery_start_full(conn);
+            }
         }
-      else
+      break;
+
+    case state0_DATABASE_HASH_READ:
+      //The value comes in the Read By Type response of the server, at whatever handle its layout puts it
+      if((SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_characteristic_value_id)
+          && (evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_read_by_type_response)
+          && (evt->data.evt_gatt_characteristic_value.value.len == GATT_DATABASE_HASH_LEN))
+        {
+          memcpy(conn->db_hash, evt->data.evt_gatt_characteristic_value.value.data, GATT_DATABASE_HASH_LEN);
+          conn->db_hash_valid = true;
+        }
+
+      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
+          gatt_cache_handles_t handles;
+
+          if((conn->db_hash_valid == true) && (gattCacheLookup(&conn->address, conn->db_hash, &handles) == true))
             {
-              nextState = state0_NO_CONNECTION;
+              conn->htmCharacteristicHandle = handles.htmCharacteristicHandle;
+              conn->buttonCharacteristicHandle = handles.buttonCharacteristicHandle;
+              conn->state = state2_CACHED_INDICATION_ENABLED;
 
-              error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
+              error_status = sl_bt_gatt_set_characteristic_notification(conn->connection, conn->htmCharacteristicHandle, sl_bt_gatt_indication);
               if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nError starting connection scanning\r\n");
-              displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
-              displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-              displayPrintf(DISPLAY_ROW_BTADDR2, " ");
+                LOG_ERROR("\r\nError setting up characteristic notification\r\n");
             }
+          else
+            discovery_start_full(conn);
         }
-
       break;
 
-    case state2_TEMP_MEASUREMENT_CHAR_ENABLED:
-      nextState = state2_TEMP_MEASUREMENT_CHAR_ENABLED;
-
+    case state2_CACHED_INDICATION_ENABLED:
       if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          //          nextState = state2_BUTTON_MEASUREMENT_CHAR_ENABLED;
-          nextState = state0_BUTTON_SERVICE_DISCOVERY;
+          if(evt->data.evt_gatt_procedure_completed.result == SL_STATUS_BT_ATT_INVALID_HANDLE)     //Cached handle is stale, discover again
+            {
+              gattCacheInvalidate(&conn->address);
+              discovery_start_full(conn);
+              break;
+            }
 
-          error_status = sl_bt_gatt_set_characteristic_notification(bleData->connectionSetHandle, bleData->htmCharacteristicHandle, sl_bt_gatt_indication);
+          conn->state = state3_INDICATION_ENABLED;
+          error_status = sl_bt_gatt_set_characteristic_notification(conn->connection, conn->buttonCharacteristicHandle, sl_bt_gatt_indication);
           if(error_status != SL_STATUS_OK)
             LOG_ERROR("\r\nError setting up characteristic notification\r\n");
           else
-            displayPrintf(DISPLAY_ROW_CONNECTION, "Handling Indications");
+            discovery_ready(conn, true);
         }
-      else
+      break;
+
+    case state1_TEMP_SERVICE_DISCOVERED:
+      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
-            {
-              nextState = state0_NO_CONNECTION;
-              error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nError starting connection scanning\r\n");
-              displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
-              displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-              displayPrintf(DISPLAY_ROW_BTADDR2, " ");
-            }
-        }
+          conn->state = state2_TEMP_MEASUREMENT_CHAR_ENABLED;
 
+          error_status = sl_bt_gatt_discover_characteristics_by_uuid(conn->connection, conn->htmServiceHandle, sizeof(RGB_CHAR_UUID), RGB_CHAR_UUID );
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError discovering a characteristic - TEMPERATURE MEASUREMENT\r\n");
+        }
       break;
 
-    case state0_BUTTON_SERVICE_DISCOVERY:
-      nextState = state0_BUTTON_SERVICE_DISCOVERY;
+    case state2_TEMP_MEASUREMENT_CHAR_ENABLED:
       if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          //          nextState = state1_TEMP_SERVICE_DISCOVERED;
-          nextState = state1_BUTTON_SERVICE_DISCOVERED;
+          conn->state = state0_BUTTON_SERVICE_DISCOVERY;
 
-          error_status = sl_bt_gatt_discover_primary_services_by_uuid(bleData->connectionSetHandle, GESTURE_SERVICE_UUID_LEN, GESTURE_SERVICE_UUID);
+          error_status = sl_bt_gatt_set_characteristic_notification(conn->connection, conn->htmCharacteristicHandle, sl_bt_gatt_indication);
           if(error_status != SL_STATUS_OK)
-            LOG_ERROR("\r\nError discovering a service - BUTTON\r\n");
+            LOG_ERROR("\r\nError setting up characteristic notification\r\n");
         }
+      break;
 
-      else
+    case state0_BUTTON_SERVICE_DISCOVERY:
+      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
-            {
-              nextState = state0_NO_CONNECTION;
-              error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nError starting connection scanning\r\n");
-              displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
-              displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-              displayPrintf(DISPLAY_ROW_BTADDR2, " ");
-            }
-        }
+          conn->state = state1_BUTTON_SERVICE_DISCOVERED;
 
+          error_status = sl_bt_gatt_discover_primary_services_by_uuid(conn->connection, GESTURE_SERVICE_UUID_LEN, GESTURE_SERVICE_UUID);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError discovering a service - BUTTON\r\n");
+        }
       break;
 
-
     case state1_BUTTON_SERVICE_DISCOVERED:
-      nextState = state1_BUTTON_SERVICE_DISCOVERED;
-
       if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          //          nextState = state2_TEMP_MEASUREMENT_CHAR_ENABLED;
-          nextState = state2_BUTTON_MEASUREMENT_CHAR_ENABLED;
+          conn->state = state2_BUTTON_MEASUREMENT_CHAR_ENABLED;
 
-          error_status = sl_bt_gatt_discover_characteristics_by_uuid(bleData->connectionSetHandle, bleData->buttonServiceHandle, sizeof(GESTURE_CHAR_UUID), GESTURE_CHAR_UUID);
+          error_status = sl_bt_gatt_discover_characteristics_by_uuid(conn->connection, conn->buttonServiceHandle, sizeof(GESTURE_CHAR_UUID), GESTURE_CHAR_UUID);
           if(error_status != SL_STATUS_OK)
             LOG_ERROR("\r\nError discovering a characteristic - BUTTON\r\n");
         }
-      else
-        {
-          if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
-            {
-              nextState = state0_NO_CONNECTION;
-              error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nError starting connection scanning\r\n");
-              displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
-              displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-              displayPrintf(DISPLAY_ROW_BTADDR2, " ");
-            }
-        }
       break;
 
-
     case state2_BUTTON_MEASUREMENT_CHAR_ENABLED:
-      nextState = state2_BUTTON_MEASUREMENT_CHAR_ENABLED;
-
       if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          nextState = state3_INDICATION_ENABLED;
-          error_status = sl_bt_gatt_set_characteristic_notification(bleData->connectionSetHandle, bleData->buttonCharacteristicHandle, sl_bt_gatt_indication);
+          conn->state = state3_INDICATION_ENABLED;
+          error_status = sl_bt_gatt_set_characteristic_notification(conn->connection, conn->buttonCharacteristicHandle, sl_bt_gatt_indication);
           if(error_status != SL_STATUS_OK)
             LOG_ERROR("\r\nError setting up characteristic notification\r\n");
           else
-            displayPrintf(DISPLAY_ROW_CONNECTION, "Handling Indications");
-        }
-      else
-        {
-          if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
+            discovery_ready(conn, false);
+
+          if(conn->db_hash_valid == true)                                   //Remember the handles for the next connection to this server
             {
-              nextState = state0_NO_CONNECTION;
-              error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
-              if(error_status != SL_STATUS_OK)
-                LOG_ERROR("\r\nError starting connection scanning\r\n");
-              displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
-              displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-              displayPrintf(DISPLAY_ROW_BTADDR2, " ");
+              gatt_cache_handles_t handles;
+
+              handles.htmCharacteristicHandle = conn->htmCharacteristicHandle;
+              handles.buttonCharacteristicHandle = conn->buttonCharacteristicHandle;
+              gattCacheStore(&conn->address, conn->db_hash, &handles);
             }
         }
       break;
 
-
     case state3_INDICATION_ENABLED:
-      nextState = state3_INDICATION_ENABLED;
+      //Runs on the parameters event that reports encryption, a write still in flight makes the stack refuse it until its completion
+      if((conn->cccd_refused == true) && (conn->is_encrypted == true))
+        {
+          error_status = sl_bt_gatt_set_characteristic_notification(conn->connection, conn->htmCharacteristicHandle, sl_bt_gatt_indication);
+          if(error_status == SL_STATUS_OK)
+            {
+              conn->cccd_refused = false;
+              conn->state = state4_TEMP_CCCD_REWRITE;
+            }
+        }
+      break;
 
-      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_closed_id)
+    case state4_TEMP_CCCD_REWRITE:
+      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
         {
-          nextState = state0_NO_CONNECTION;
-          error_status = sl_bt_scanner_start(PHYSICAL_LAYER_1M, sl_bt_scanner_discover_observation);
+          conn->state = state4_BUTTON_CCCD_REWRITE;
+          error_status = sl_bt_gatt_set_characteristic_notification(conn->connection, conn->buttonCharacteristicHandle, sl_bt_gatt_indication);
           if(error_status != SL_STATUS_OK)
-            LOG_ERROR("\r\nError starting connection scanning\r\n");
-          displayPrintf(DISPLAY_ROW_CONNECTION, "Discovering");
-          displayPrintf(DISPLAY_ROW_TEMPVALUE, " ");
-          displayPrintf(DISPLAY_ROW_BTADDR2, " ");
+            {
+              LOG_ERROR("\r\nError setting up characteristic notification\r\n");
+              conn->state = state3_INDICATION_ENABLED;
+            }
+        }
+      break;
+
+    case state4_BUTTON_CCCD_REWRITE:
+      if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_gatt_procedure_completed_id)
+        {
+          conn->state = state3_INDICATION_ENABLED;
+          LOG_INFO("Server %"PRIu32" indications enabled after pairing, %"PRIu32" ms after open", clientConnIndex(conn),
+                   letimerMilliseconds() - conn->opened_ms);
         }
       break;
 
@@ -545,144 +658,52 @@ void discovery_state_machine(sl_bt_msg_t *evt)
 }
 
 /*
- * Computes the next pointer in the circular buffer
+ * Returns the state the temperature state machine will run on its next event
  *
  * Parameters:
- *   ptr: Current pointer location
- *
- * Returns:
- *   Incremented pointer
- */
-static uint32_t nextPtr(uint32_t ptr) {
-
-
-  if(ptr >= QUEUE_DEPTH)                    //If pointer is greater than the maximum depth, return an error
-    return PTR_OUT_OF_BOUND;
-
-
-  else if((ptr + 1) == QUEUE_DEPTH)         //If the queue is full, wrap the pointer to the front
-    return 0;
-
-  else                                     //If the queue is not full, return the incremented pointer
-    return ptr + 1;
-
-} // nextPtr()
-
-
-
-/*
- *Writes to the circular buffer
- *
- * Parameters:
- *   charHandle: The characteristic handle
- *   bufferLength: The length of data to be written
- *   indication_data[]: Data buffer to be written in the queue
+ *   None
  *
  * Returns:
- *   If the queue is full(true) or not(false)
+ *   temp_state_t: Current temperature state machine state
  */
-bool write_queue (uint16_t charHandle , size_t bufferLength , uint8_t indication_data[])
+temp_state_t getTemperatureState()
 {
-
-  if (isfull)                           //If full flag is set, return true
-    return true;
-
-  my_queue[wptr].charHandle = charHandle;
-  my_queue[wptr].bufferLength = bufferLength;
-  memcpy(my_queue[wptr].buffer , indication_data , bufferLength);
-
-  length++;                            //Increment length
-
-  isempty = false;                     //Reset empty flag since a successful entry has been made
-
-  if(length == QUEUE_DEPTH)            //Check if queue is full
-    isfull = true;
-
-  if (!isfull)                        //If the queue is not full, increment the write pointer
-    wptr = nextPtr(wptr);
-
-  return false;
-
-} // write_queue()
-
-
-
-/*
- * Reads the circular buffer
- *
- * Parameters:
- *   *charHandle: The characteristic handle pointer
- *   *bufferLength: The length of data to be written pointer
- *   *indication_data[]: Data buffer to be read from the queue pointer
- *
- * Returns:
- *   If the queue is full or not
- */
-bool read_queue (uint16_t *charHandle , size_t *bufferLength , uint8_t *indication_data) {
-
-  if (isempty)                     //If empty flag is set, returns true
-    return true;
-
-
-  *charHandle = my_queue[rptr].charHandle;
-  *bufferLength = my_queue[rptr].bufferLength;
-  memcpy(indication_data , my_queue[rptr].buffer , my_queue[rptr].bufferLength);
-
-  length--;                      //Decrement the length
-
-  if(isfull)                     //If previously the queue was full, now since one place is available, increment the write pointer
-    wptr = nextPtr(wptr);
-
-  isfull = false;                //Reset the full flag since one entry has been popped from the queue
-
-  rptr = nextPtr(rptr);          //Process the read pointer
-
-  if(wptr == rptr)               //Empty condition
-    isempty = true;
-
-  return false;
-
-} // read_queue()
-
+  return temp_next_state;
+}
 
 
 /*
- * Gets the queue status
+ * Copies the latest temperature sample for a read of the user-type temperature characteristic
  *
  * Parameters:
- *   *wptr: Write pointer value
- *   *rptr: Read pointer value
- *   *full: Whether full or not
- *   *empty: Whether empty or not
+ *   uint8_t *value: Returns TEMPERATURE_VALUE_LEN bytes, flags byte then the IEEE-11073 float
  *
  * Returns:
- *   None
+ *   bool: true if a sample newer than TEMPERATURE_READ_MAX_AGE_MS was copied, false if the read has to wait for the next one
  */
-void get_queue_status (uint32_t *_wptr, uint32_t *_rptr, bool *_full, bool *_empty)
+bool temperatureLatest(uint8_t *value)
 {
+  if((temperature_latest_valid == false) || ((letimerMilliseconds() - temperature_latest_ms) > TEMPERATURE_READ_MAX_AGE_MS))
+    return false;
 
-  *_wptr = wptr;
-  *_rptr = rptr;
-
-  *_full = isfull;
-  *_empty = isempty;
-
-} // get_queue_status()
-
+  memcpy(value, temperature_latest, TEMPERATURE_VALUE_LEN);
+  return true;
+}
 
 
 /*
- * Returns the queue length
+ * Returns the discovery state of the connection that last ran the discovery state machine
  *
  * Parameters:
  *   None
  *
  * Returns:
- *   Length of the queue
+ *   client_state_t: Discovery state machine state, state0_NO_CONNECTION if no connection has run it
  */
-uint32_t get_queue_depth()
+client_state_t getDiscoveryState()
 {
+  if((client_current == NULL) || (client_current->in_use == false))
+    return state0_NO_CONNECTION;
 
-  return length;          //Returns length
-
-} // get_queue_depth()
+  return client_current->state;
+}
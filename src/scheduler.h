@@ -11,6 +11,7 @@
 #define SCHEDULER_H
 
 #include "src/ble.h"
+#include "src/bench.h"
 
 
 //
@@ -66,11 +67,17 @@ typedef enum
   state2_TEMP_MEASUREMENT_CHAR_ENABLED,
   state2_BUTTON_MEASUREMENT_CHAR_ENABLED,
   state3_INDICATION_ENABLED,
+  state0_GATT_SERVICE_DISCOVERY,
+  state0_DATABASE_HASH_READ,
+  state2_CACHED_INDICATION_ENABLED,
+  state4_TEMP_CCCD_REWRITE,
+  state4_BUTTON_CCCD_REWRITE,
   CLIENT_NUM_STATES
 }client_state_t;
 
-#define QUEUE_DEPTH      (16)
-#define USE_ALL_ENTRIES  (1)
+#define INDICATION_MAX_LEN (5 + BENCH_PAYLOAD_LEN)   //HTM value plus the benchmark stamp when enabled
+#define TEMPERATURE_VALUE_LEN (5)                     //HTM value served on reads, flags byte and IEEE-11073 float
+#define TEMPERATURE_READ_MAX_AGE_MS (LETIMER_PERIOD_MS)   //Older samples make a read wait for the next one
 
 /*
  * Sets an event when interrupt is triggered
@@ -152,7 +159,7 @@ void setSchedulerEventExternalPushButton1();
 void temperature_state_machine(sl_bt_msg_t *evt);
 
 /*
- * State Machine for client discovery
+ * State Machine for client discovery, one instance per server connection
  *
  * Parameters:
  *   sl_bt_msg_t event: Gives the current event set from the external signals data structure of the Bluetooth Stack
@@ -163,33 +170,41 @@ void temperature_state_machine(sl_bt_msg_t *evt);
 void discovery_state_machine(sl_bt_msg_t *evt);
 
 
-
-// This is the number of entries in the queue. Please leave
-// this value set to 16.
-
-// Student edit:
-//   define this to 1 if your design uses all array entries
-//   define this to 0 if your design leaves 1 array entry empty
-
-
+/*
+ * Returns the state the temperature state machine will run on its next event
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   temp_state_t: Current temperature state machine state
+ */
+temp_state_t getTemperatureState();
 
 
-// Modern C (circa 2021 does it this way)
-// typedef <name> is referred to as an anonymous struct definition
-// This is the structure of 1 queue/buffer entry
-typedef struct {
+/*
+ * Copies the latest temperature sample for a read of the user-type temperature characteristic
+ *
+ * Parameters:
+ *   uint8_t *value: Returns TEMPERATURE_VALUE_LEN bytes, flags byte then the IEEE-11073 float
+ *
+ * Returns:
+ *   bool: true if a sample newer than TEMPERATURE_READ_MAX_AGE_MS was copied, false if the read has to wait for the next one
+ */
+bool temperatureLatest(uint8_t *value);
 
-  uint16_t charHandle; // Char handle from gatt_db.h
-  size_t bufferLength; // Length of buffer in bytes to send
-  uint8_t buffer[5]; // The actual data buffer for the indication. Need space for HTM (5 bytes) and button_state (2 bytes) indications, array [0] holds the flags byte.
 
-} queue_struct_t;
+/*
+ * Returns the discovery state of the connection that last ran the discovery state machine
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   client_state_t: Discovery state machine state, state0_NO_CONNECTION if no connection has run it
+ */
+client_state_t getDiscoveryState();
 
 
-// function prototypes
-bool     write_queue (uint16_t charHandle , size_t bufferLength , uint8_t indication_data[]);
-bool     read_queue (uint16_t *charHandle , size_t *bufferLength , uint8_t *indication_data);
-void     get_queue_status (uint32_t *_wptr, uint32_t *_rptr, bool *_full, bool *_empty);
-uint32_t get_queue_depth (void);
 
 #endif
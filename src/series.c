@@ -0,0 +1,200 @@
+/**
+ * @file    :   series.c
+ * @brief   :   API for the client temperature time series
+ *
+ *              A sample leaving the window is the one its replacement overwrites in the ring, so the
+ *              running sums drop it before the slot is reused and the queues drop it if it is still
+ *              their oldest candidate. A new sample removes the candidates it beats from the back of
+ *              each queue, which keeps every queue head the extreme of the window.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/series.h"
+#include "string.h"
+
+
+/*
+ * Returns the ring position of the newest candidate of a queue
+ *
+ * Parameters:
+ *   const series_queue_t *queue: Monotonic queue, not empty
+ *
+ * Returns:
+ *   uint8_t: Ring position
+ */
+static uint8_t series_queue_back(const series_queue_t *queue)
+{
+  return queue->index[(queue->head + queue->count - 1) % SERIES_WINDOW];
+}
+
+
+/*
+ * Drops the oldest candidate of a queue if it sits at a ring position about to be overwritten
+ *
+ * Parameters:
+ *   series_queue_t *queue: Monotonic queue
+ *   uint8_t position: Ring position leaving the window
+ *
+ * Returns:
+ *   None
+ */
+static void series_queue_expire(series_queue_t *queue, uint8_t position)
+{
+  if((queue->count != 0) && (queue->index[queue->head] == position))
+    {
+      queue->head = (queue->head + 1) % SERIES_WINDOW;
+      queue->count--;
+    }
+}
+
+
+/*
+ * Appends a ring position to a queue, at most SERIES_WINDOW positions are ever queued
+ *
+ * Parameters:
+ *   series_queue_t *queue: Monotonic queue
+ *   uint8_t position: Ring position of the new sample
+ *
+ * Returns:
+ *   None
+ */
+static void series_queue_push(series_queue_t *queue, uint8_t position)
+{
+  queue->index[(queue->head + queue->count) % SERIES_WINDOW] = position;
+  queue->count++;
+}
+
+
+/*
+ * Starts an empty window, called when the connection is allocated
+ *
+ * Parameters:
+ *   series_t *series: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void seriesInit(series_t *series)
+{
+  memset(series, 0, sizeof(series_t));
+}
+
+
+/*
+ * Adds a sample, dropping the oldest one once the window is full
+ *
+ * Parameters:
+ *   series_t *series: Window of the connection
+ *   int32_t value: Temperature in degrees C, clamped to int16_t
+ *
+ * Returns:
+ *   None
+ */
+void seriesAdd(series_t *series, int32_t value)
+{
+  uint8_t position = series->total % SERIES_WINDOW;
+  int16_t sample;
+  int16_t old;
+
+  if(value > INT16_MAX)
+    value = INT16_MAX;
+  if(value < INT16_MIN)
+    value = INT16_MIN;
+  sample = value;
+
+  //The sample at position leaves the window
+  if(series->total >= SERIES_WINDOW)
+    {
+      old = series->values[position];
+      series->sum -= old;
+#if SERIES_VARIANCE_ENABLE
+      series->sum_squares -= (uint64_t)((int32_t)old * old);
+#endif
+      series_queue_expire(&series->min_queue, position);
+      series_queue_expire(&series->max_queue, position);
+    }
+
+  //Candidates the new sample beats can never be the extreme again
+  while((series->min_queue.count != 0) && (series->values[series_queue_back(&series->min_queue)] >= sample))
+    series->min_queue.count--;
+  while((series->max_queue.count != 0) && (series->values[series_queue_back(&series->max_queue)] <= sample))
+    series->max_queue.count--;
+
+  series->values[position] = sample;
+  series_queue_push(&series->min_queue, position);
+  series_queue_push(&series->max_queue, position);
+
+  series->sum += sample;
+#if SERIES_VARIANCE_ENABLE
+  series->sum_squares += (uint64_t)((int32_t)sample * sample);
+#endif
+  series->total++;
+}
+
+
+/*
+ * Reads a sample of the window by age
+ *
+ * Parameters:
+ *   const series_t *series: Window of the connection
+ *   uint32_t age: 0 for the latest sample, up to seriesCount() - 1 for the oldest
+ *
+ * Returns:
+ *   int16_t: The sample
+ */
+int16_t seriesAt(const series_t *series, uint32_t age)
+{
+  return series->values[(series->total - 1 - age) % SERIES_WINDOW];
+}
+
+
+/*
+ * Returns the number of samples in the window
+ *
+ * Parameters:
+ *   const series_t *series: Window of the connection
+ *
+ * Returns:
+ *   uint32_t: Samples, up to SERIES_WINDOW
+ */
+uint32_t seriesCount(const series_t *series)
+{
+  return (series->total < SERIES_WINDOW) ? series->total : SERIES_WINDOW;
+}
+
+
+/*
+ * Reads the statistics of the window from the running sums and the queue heads
+ *
+ * Parameters:
+ *   const series_t *series: Window of the connection
+ *   series_stats_t *stats: Filled in with the statistics
+ *
+ * Returns:
+ *   None
+ */
+void seriesStats(const series_t *series, series_stats_t *stats)
+{
+  uint64_t count;
+
+  memset(stats, 0, sizeof(series_stats_t));
+  stats->count = seriesCount(series);
+  if(stats->count == 0)
+    return;
+
+  stats->latest = seriesAt(series, 0);
+  stats->min = series->values[series->min_queue.index[series->min_queue.head]];
+  stats->max = series->values[series->max_queue.index[series->max_queue.head]];
+  stats->mean_x10 = (series->sum * 10) / (int32_t)stats->count;
+
+#if SERIES_VARIANCE_ENABLE
+  //n * sum of squares - sum^2 is never negative, and over n^2 it is the population variance
+  count = stats->count;
+  stats->variance_x100 = (((count * series->sum_squares) - (uint64_t)((int64_t)series->sum * series->sum)) * 100) / (count * count);
+#else
+  (void)count;
+#endif
+}
@@ -0,0 +1,123 @@
+/**
+ * @file    :   series.h
+ * @brief   :   Headers and function definitions for the client temperature time series
+ *
+ *              Each server connection keeps a ring of the last SERIES_WINDOW temperatures it indicated.
+ *              The minimum, maximum, mean and variance of the ring are kept up to date as samples come
+ *              in, with running sums and a monotonic queue of candidates for each extreme, so adding a
+ *              sample and reading the statistics cost the same however long the window is.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef SERIES_H
+#define SERIES_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+//Samples in the sliding window, 32 samples is 96 seconds at the 3 second temperature period
+#define SERIES_WINDOW (32)
+
+//Set to 0 to drop the sum of squares when the variance is not wanted
+#define SERIES_VARIANCE_ENABLE (1)
+
+//Monotonic queue of ring positions, the values at the positions are increasing for the minimum and decreasing for the maximum
+typedef struct
+{
+  uint8_t index[SERIES_WINDOW];
+  uint8_t head;                     //Position of the oldest candidate in index
+  uint8_t count;
+}series_queue_t;
+
+//Sliding window of one server, kept in its client_conn_t
+typedef struct
+{
+  int16_t values[SERIES_WINDOW];    //Ring of samples in degrees C
+  uint32_t total;                   //Samples added since the connection opened, the next one goes to values[total % SERIES_WINDOW]
+  int32_t sum;                      //Of the samples in the window
+#if SERIES_VARIANCE_ENABLE
+  uint64_t sum_squares;
+#endif
+  series_queue_t min_queue;
+  series_queue_t max_queue;
+}series_t;
+
+//Statistics of the window
+typedef struct
+{
+  uint32_t count;                   //Samples in the window, 0 leaves the rest unset
+  int16_t latest;
+  int16_t min;
+  int16_t max;
+  int32_t mean_x10;                 //Mean in 0.1 degrees C
+  uint32_t variance_x100;           //Population variance in 0.01 degrees C squared, 0 if SERIES_VARIANCE_ENABLE is 0
+}series_stats_t;
+
+
+/*
+ * Starts an empty window, called when the connection is allocated
+ *
+ * Parameters:
+ *   series_t *series: Window of the connection
+ *
+ * Returns:
+ *   None
+ */
+void seriesInit(series_t *series);
+
+
+/*
+ * Adds a sample, dropping the oldest one once the window is full
+ *
+ * Parameters:
+ *   series_t *series: Window of the connection
+ *   int32_t value: Temperature in degrees C, clamped to int16_t
+ *
+ * Returns:
+ *   None
+ */
+void seriesAdd(series_t *series, int32_t value);
+
+
+/*
+ * Reads a sample of the window by age
+ *
+ * Parameters:
+ *   const series_t *series: Window of the connection
+ *   uint32_t age: 0 for the latest sample, up to seriesCount() - 1 for the oldest
+ *
+ * Returns:
+ *   int16_t: The sample
+ */
+int16_t seriesAt(const series_t *series, uint32_t age);
+
+
+/*
+ * Returns the number of samples in the window
+ *
+ * Parameters:
+ *   const series_t *series: Window of the connection
+ *
+ * Returns:
+ *   uint32_t: Samples, up to SERIES_WINDOW
+ */
+uint32_t seriesCount(const series_t *series);
+
+
+/*
+ * Reads the statistics of the window from the running sums and the queue heads
+ *
+ * Parameters:
+ *   const series_t *series: Window of the connection
+ *   series_stats_t *stats: Filled in with the statistics
+ *
+ * Returns:
+ *   None
+ */
+void seriesStats(const series_t *series, series_stats_t *stats);
+
+
+#endif   //SERIES_H
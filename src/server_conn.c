@@ -0,0 +1,463 @@
+/**
+ * @file    :   server_conn.c
+ * @brief   :   API for the server connection table
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/server_conn.h"
+#include "src/bench.h"
+#include "src/tx_power.h"
+#include "gatt_db.h"
+#include "string.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+static server_conn_t server_table[SERVER_MAX_CLIENTS];
+
+//Local GATT database handle of each indicated characteristic
+static const uint16_t server_char_handles[server_char_count] =
+{
+  [server_char_htm]     = gattdb_rgb_state,
+  [server_char_gesture] = gattdb_gesture_state,
+};
+
+
+/*
+ * Allocates a context for a connection that opened
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   uint8_t bonding: Stored bond of the client, SL_BT_INVALID_BONDING_HANDLE if none
+ *
+ * Returns:
+ *   server_conn_t*: The new context, NULL if the table is full
+ */
+server_conn_t* serverConnAlloc(uint8_t connection, uint8_t bonding)
+{
+  for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
+    {
+      if(server_table[slot].in_use == false)
+        {
+          memset(&server_table[slot], 0, sizeof(server_conn_t));
+          server_table[slot].in_use = true;
+          server_table[slot].connection = connection;
+          server_table[slot].bonding = bonding;
+          server_table[slot].last_sent = server_char_count - 1;
+          server_table[slot].tx_power_ddbm = TX_POWER_UNKNOWN_DDBM;
+          linkStatsInit(&server_table[slot].link);
+          return &server_table[slot];
+        }
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Releases a context
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Context to release
+ *
+ * Returns:
+ *   None
+ */
+void serverConnFree(server_conn_t *ctx)
+{
+  if(ctx != NULL)
+    ctx->in_use = false;
+}
+
+
+/*
+ * Looks up a context by connection handle
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   server_conn_t*: The context, NULL if the handle is not in the table
+ */
+server_conn_t* serverConnFind(uint8_t connection)
+{
+  for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
+    {
+      if((server_table[slot].in_use == true) && (server_table[slot].connection == connection))
+        return &server_table[slot];
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Looks up the context an event belongs to
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   server_conn_t*: The context, NULL if the event carries no connection handle or the handle is unknown
+ */
+server_conn_t* serverConnFromEvent(sl_bt_msg_t *evt)
+{
+  switch (SL_BT_MSG_ID(evt->header))
+  {
+    case sl_bt_evt_connection_opened_id:
+      return serverConnFind(evt->data.evt_connection_opened.connection);
+
+    case sl_bt_evt_connection_closed_id:
+      return serverConnFind(evt->data.evt_connection_closed.connection);
+
+    case sl_bt_evt_connection_parameters_id:
+      return serverConnFind(evt->data.evt_connection_parameters.connection);
+
+    case sl_bt_evt_connection_rssi_id:
+      return serverConnFind(evt->data.evt_connection_rssi.connection);
+
+    case sl_bt_evt_gatt_server_characteristic_status_id:
+      return serverConnFind(evt->data.evt_gatt_server_characteristic_status.connection);
+
+    case sl_bt_evt_gatt_server_indication_timeout_id:
+      return serverConnFind(evt->data.evt_gatt_server_indication_timeout.connection);
+
+    case sl_bt_evt_gatt_server_user_read_request_id:
+      return serverConnFind(evt->data.evt_gatt_server_user_read_request.connection);
+
+    case sl_bt_evt_sm_confirm_passkey_id:
+      return serverConnFind(evt->data.evt_sm_confirm_passkey.connection);
+
+    case sl_bt_evt_sm_confirm_bonding_id:
+      return serverConnFind(evt->data.evt_sm_confirm_bonding.connection);
+
+    case sl_bt_evt_sm_bonded_id:
+      return serverConnFind(evt->data.evt_sm_bonded.connection);
+
+    case sl_bt_evt_sm_bonding_failed_id:
+      return serverConnFind(evt->data.evt_sm_bonding_failed.connection);
+
+    default:
+      return NULL;
+  }
+}
+
+
+/*
+ * Returns a context by slot, used to walk the table
+ *
+ * Parameters:
+ *   uint32_t slot: 0 to SERVER_MAX_CLIENTS - 1
+ *
+ * Returns:
+ *   server_conn_t*: The context, NULL if the slot is unused
+ */
+server_conn_t* serverConnSlot(uint32_t slot)
+{
+  if((slot >= SERVER_MAX_CLIENTS) || (server_table[slot].in_use == false))
+    return NULL;
+
+  return &server_table[slot];
+}
+
+
+/*
+ * Returns the number of contexts in use
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t: Number of clients connected
+ */
+uint32_t serverConnCount()
+{
+  uint32_t count = 0;
+
+  for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
+    {
+      if(server_table[slot].in_use == true)
+        count++;
+    }
+
+  return count;
+}
+
+
+/*
+ * Maps a GATT characteristic handle to the characteristic it indicates
+ *
+ * Parameters:
+ *   uint16_t characteristic: Local GATT database handle
+ *
+ * Returns:
+ *   server_char_t: The characteristic, server_char_count if the handle is not indicated
+ */
+server_char_t serverConnChar(uint16_t characteristic)
+{
+  for(uint32_t ch = 0; ch < server_char_count; ch++)
+    {
+      if(server_char_handles[ch] == characteristic)
+        return ch;
+    }
+
+  return server_char_count;
+}
+
+
+/*
+ * Checks whether any client has indications enabled on a characteristic
+ *
+ * Parameters:
+ *   server_char_t ch: Indicated characteristic
+ *
+ * Returns:
+ *   bool: true if at least one connection has it enabled
+ */
+bool serverConnAnyEnabled(server_char_t ch)
+{
+  for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
+    {
+      if((server_table[slot].in_use == true) && (server_table[slot].chars[ch].is_enabled == true))
+        return true;
+    }
+
+  return false;
+}
+
+
+/*
+ * Checks whether any client waits for the answer to a read of a characteristic
+ *
+ * Parameters:
+ *   server_char_t ch: Characteristic
+ *
+ * Returns:
+ *   bool: true if at least one connection has a read pending
+ */
+bool serverConnAnyReadPending(server_char_t ch)
+{
+  for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
+    {
+      if((server_table[slot].in_use == true) && (server_table[slot].chars[ch].is_read_pending == true))
+        return true;
+    }
+
+  return false;
+}
+
+
+/*
+ * Answers a read of a user-type characteristic from a value held in RAM
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   uint16_t characteristic: Local GATT database handle
+ *   uint16_t offset: Offset of the read, non zero for a blob read
+ *   const uint8_t *value: Whole value
+ *   size_t len: Value length
+ *
+ * Returns:
+ *   None
+ */
+void serverConnReadRespond(uint8_t connection, uint16_t characteristic, uint16_t offset, const uint8_t *value, size_t len)
+{
+  sl_status_t error_status;
+  uint16_t sent_len;
+
+  if(offset <= len)
+    error_status = sl_bt_gatt_server_send_user_read_response(connection, characteristic, 0, len - offset, (uint8_t *)value + offset, &sent_len);
+  else
+    error_status = sl_bt_gatt_server_send_user_read_response(connection, characteristic, SL_STATUS_BT_ATT_INVALID_OFFSET & 0xFF, 0, NULL, &sent_len);
+
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError sending the read response: %d\r\n", error_status);
+}
+
+
+/*
+ * Answers every read of a characteristic that waited for a new value
+ *
+ * Parameters:
+ *   server_char_t ch: Characteristic
+ *   const uint8_t *value: New value
+ *   size_t len: Value length
+ *
+ * Returns:
+ *   None
+ */
+void serverConnReadAnswer(server_char_t ch, const uint8_t *value, size_t len)
+{
+  for(uint32_t slot = 0; slot < SERVER_MAX_CLIENTS; slot++)
+    {
+      if((server_table[slot].in_use == true) && (server_table[slot].chars[ch].is_read_pending == true))
+        {
+          server_table[slot].chars[ch].is_read_pending = false;
+          serverConnReadRespond(server_table[slot].connection, server_char_handles[ch], 0, value, len);
+        }
+    }
+}
+
+
+/*
+ * Checks whether any characteristic of a connection waits for its confirmation
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *
+ * Returns:
+ *   bool: true if an indication is in flight
+ */
+static bool server_conn_in_flight(server_conn_t *ctx)
+{
+  for(uint32_t ch = 0; ch < server_char_count; ch++)
+    {
+      if(ctx->chars[ch].is_in_flight == true)
+        return true;
+    }
+
+  return false;
+}
+
+
+/*
+ * Sends the pending value of a characteristic
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *   server_char_t ch: Indicated characteristic
+ *
+ * Returns:
+ *   None
+ */
+static void server_conn_send(server_conn_t *ctx, server_char_t ch)
+{
+  sl_status_t error_status;
+  server_char_state_t *state = &ctx->chars[ch];
+
+  if(ch == server_char_htm)
+    benchServerSend(ctx);
+
+  error_status = sl_bt_gatt_server_send_indication(ctx->connection, server_char_handles[ch], state->len, state->value);
+  if(error_status != SL_STATUS_OK)
+    {
+      //Stays pending, the next flush tries again
+      LOG_ERROR("\r\nSending Indication Error: %d\r\n", error_status);
+      linkStatsSent(&ctx->link, false);
+      return;
+    }
+
+  linkStatsSent(&ctx->link, true);
+
+  state->is_pending = false;
+  state->is_in_flight = true;
+  ctx->last_sent = ch;
+}
+
+
+/*
+ * Indicates a value on one connection. ATT allows one indication in flight per connection, so while
+ * another characteristic waits for its confirmation the value is kept as that characteristic's newest
+ * pending value and sent once the link is free
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *   server_char_t ch: Indicated characteristic
+ *   const uint8_t *data: Value
+ *   size_t len: Value length, at most INDICATION_MAX_LEN
+ *
+ * Returns:
+ *   None
+ */
+void serverConnIndicate(server_conn_t *ctx, server_char_t ch, const uint8_t *data, size_t len)
+{
+  server_char_state_t *state = &ctx->chars[ch];
+
+  if((state->is_enabled == false) || (len > INDICATION_MAX_LEN))
+    return;
+
+  //A newer value replaces one that has not gone out yet, the client only wants the latest
+  if(state->is_pending == true)
+    linkStatsOverflow(&ctx->link);
+
+  memcpy(state->value, data, len);
+  state->len = len;
+  state->is_pending = true;
+
+  serverConnFlush(ctx);
+}
+
+
+/*
+ * Sends a pending value if no indication is in flight, characteristics take turns. Called on confirmation and periodically
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *
+ * Returns:
+ *   None
+ */
+void serverConnFlush(server_conn_t *ctx)
+{
+  uint32_t ch;
+
+  if(server_conn_in_flight(ctx) == true)
+    return;
+
+  for(uint32_t i = 1; i <= server_char_count; i++)
+    {
+      ch = (ctx->last_sent + i) % server_char_count;
+
+      if(ctx->chars[ch].is_pending == true)
+        {
+          server_conn_send(ctx, ch);
+          return;
+        }
+    }
+}
+
+
+/*
+ * Marks the indication of a characteristic confirmed and sends the next pending value
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *   server_char_t ch: Characteristic that was confirmed
+ *
+ * Returns:
+ *   None
+ */
+void serverConnConfirmed(server_conn_t *ctx, server_char_t ch)
+{
+  if(ctx->chars[ch].is_in_flight == true)
+    linkStatsConfirmed(&ctx->link);
+
+  ctx->chars[ch].is_in_flight = false;
+
+  serverConnFlush(ctx);
+}
+
+
+/*
+ * Checks whether a connection has values waiting to be indicated
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *
+ * Returns:
+ *   bool: true if any characteristic is pending or in flight
+ */
+bool serverConnBusy(server_conn_t *ctx)
+{
+  for(uint32_t ch = 0; ch < server_char_count; ch++)
+    {
+      if((ctx->chars[ch].is_pending == true) || (ctx->chars[ch].is_in_flight == true))
+        return true;
+    }
+
+  return false;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file    :   server_conn.h
+ * @brief   :   Headers and function definitions for the server connection table
+ *
+ *              Every client connected to the server gets its own context with its bonding state
+ *              and, for each indicated characteristic, whether indications are enabled, whether
+ *              one is waiting for its confirmation and the newest value not sent yet, along with
+ *              the link quality window of the connection.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef SERVER_CONN_H
+#define SERVER_CONN_H
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "sl_bluetooth_connection_config.h"
+#include "src/scheduler.h"
+#include "src/link_stats.h"
+
+//Number of clients the server serves at once, one stack connection each
+#define SERVER_MAX_CLIENTS (SL_BT_CONFIG_MAX_CONNECTIONS)
+
+//Connection handle value meaning no connection
+#define SERVER_NO_CONNECTION (0xFF)
+
+//Characteristics the server indicates
+typedef enum
+{
+  server_char_htm,                  //Temperature, gattdb_rgb_state
+  server_char_gesture,              //Push button, gattdb_gesture_state
+  server_char_count,
+}server_char_t;
+
+//Indication state of one characteristic on one connection
+typedef struct
+{
+  bool is_enabled;                  //The client wrote the CCCD for indications
+  bool is_in_flight;                //Sent, waiting for the confirmation
+  bool is_pending;                  //value holds the newest value, not sent yet
+  bool is_read_pending;             //A read waits for the next sample, answered by serverConnReadAnswer()
+  uint8_t len;
+  uint8_t value[INDICATION_MAX_LEN];
+#if BENCH_ENABLE
+  bench_link_t bench;               //Stamp of the value in flight, temperature only
+#endif
+}server_char_state_t;
+
+//State of one client connection, allocated when the connection opens and freed when it closes
+typedef struct server_conn
+{
+  bool in_use;
+  uint8_t connection;                  //Stack connection handle, the key of the table
+  bool is_bonded;
+  bool is_encrypted;                   //Set once the link is encrypted, with a new pairing or a stored bond
+  uint8_t bonding;                     //Stored bond of the client, SL_BT_INVALID_BONDING_HANDLE if none
+  uint32_t opened_ms;                  //letimerMilliseconds() when the connection opened
+  server_char_state_t chars[server_char_count];
+  server_char_t last_sent;             //Pending characteristics take turns, starting after this one
+  link_stats_t link;                   //Rolling link quality window
+  int16_t tx_power_ddbm;               //Power LE Power Control holds the link at in 0.1 dBm, read with each RSSI sample
+} server_conn_t;
+
+
+/*
+ * Allocates a context for a connection that opened
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   uint8_t bonding: Stored bond of the client, SL_BT_INVALID_BONDING_HANDLE if none
+ *
+ * Returns:
+ *   server_conn_t*: The new context, NULL if the table is full
+ */
+server_conn_t* serverConnAlloc(uint8_t connection, uint8_t bonding);
+
+
+/*
+ * Releases a context
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Context to release
+ *
+ * Returns:
+ *   None
+ */
+void serverConnFree(server_conn_t *ctx);
+
+
+/*
+ * Looks up a context by connection handle
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   server_conn_t*: The context, NULL if the handle is not in the table
+ */
+server_conn_t* serverConnFind(uint8_t connection);
+
+
+/*
+ * Looks up the context an event belongs to
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   server_conn_t*: The context, NULL if the event carries no connection handle or the handle is unknown
+ */
+server_conn_t* serverConnFromEvent(sl_bt_msg_t *evt);
+
+
+/*
+ * Returns a context by slot, used to walk the table
+ *
+ * Parameters:
+ *   uint32_t slot: 0 to SERVER_MAX_CLIENTS - 1
+ *
+ * Returns:
+ *   server_conn_t*: The context, NULL if the slot is unused
+ */
+server_conn_t* serverConnSlot(uint32_t slot);
+
+
+/*
+ * Returns the number of contexts in use
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t: Number of clients connected
+ */
+uint32_t serverConnCount();
+
+
+/*
+ * Maps a GATT characteristic handle to the characteristic it indicates
+ *
+ * Parameters:
+ *   uint16_t characteristic: Local GATT database handle
+ *
+ * Returns:
+ *   server_char_t: The characteristic, server_char_count if the handle is not indicated
+ */
+server_char_t serverConnChar(uint16_t characteristic);
+
+
+/*
+ * Checks whether any client has indications enabled on a characteristic
+ *
+ * Parameters:
+ *   server_char_t ch: Indicated characteristic
+ *
+ * Returns:
+ *   bool: true if at least one connection has it enabled
+ */
+bool serverConnAnyEnabled(server_char_t ch);
+
+
+/*
+ * Checks whether any client waits for the answer to a read of a characteristic
+ *
+ * Parameters:
+ *   server_char_t ch: Characteristic
+ *
+ * Returns:
+ *   bool: true if at least one connection has a read pending
+ */
+bool serverConnAnyReadPending(server_char_t ch);
+
+
+/*
+ * Answers a read of a user-type characteristic from a value held in RAM
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   uint16_t characteristic: Local GATT database handle
+ *   uint16_t offset: Offset of the read, non zero for a blob read
+ *   const uint8_t *value: Whole value
+ *   size_t len: Value length
+ *
+ * Returns:
+ *   None
+ */
+void serverConnReadRespond(uint8_t connection, uint16_t characteristic, uint16_t offset, const uint8_t *value, size_t len);
+
+
+/*
+ * Answers every read of a characteristic that waited for a new value
+ *
+ * Parameters:
+ *   server_char_t ch: Characteristic
+ *   const uint8_t *value: New value
+ *   size_t len: Value length
+ *
+ * Returns:
+ *   None
+ */
+void serverConnReadAnswer(server_char_t ch, const uint8_t *value, size_t len);
+
+
+/*
+ * Indicates a value on one connection. ATT allows one indication in flight per connection, so while
+ * another characteristic waits for its confirmation the value is kept as that characteristic's newest
+ * pending value and sent once the link is free
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *   server_char_t ch: Indicated characteristic
+ *   const uint8_t *data: Value
+ *   size_t len: Value length, at most INDICATION_MAX_LEN
+ *
+ * Returns:
+ *   None
+ */
+void serverConnIndicate(server_conn_t *ctx, server_char_t ch, const uint8_t *data, size_t len);
+
+
+/*
+ * Sends a pending value if no indication is in flight, characteristics take turns. Called on confirmation and periodically
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *
+ * Returns:
+ *   None
+ */
+void serverConnFlush(server_conn_t *ctx);
+
+
+/*
+ * Marks the indication of a characteristic confirmed and sends the next pending value
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *   server_char_t ch: Characteristic that was confirmed
+ *
+ * Returns:
+ *   None
+ */
+void serverConnConfirmed(server_conn_t *ctx, server_char_t ch);
+
+
+/*
+ * Checks whether a connection has values waiting to be indicated
+ *
+ * Parameters:
+ *   server_conn_t *ctx: Connection context
+ *
+ * Returns:
+ *   bool: true if any characteristic is pending or in flight
+ */
+bool serverConnBusy(server_conn_t *ctx);
+
+
+#endif   //SERVER_CONN_H
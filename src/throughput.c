@@ -0,0 +1,717 @@
+/**
+ * @file    :   throughput.c
+ * @brief   :   API for the link throughput test
+ *
+ *              The client measures notifications from the source for THROUGHPUT_WINDOW_MS, then
+ *              write commands to the sink, then test records on the L2CAP bulk channel, for the
+ *              same time each on every PHY. It then closes the link and reconnects with the next
+ *              smaller ATT MTU, so every PHY and MTU combination gets one line per path on VCOM.
+ *              The server prints its own view each time the control point stops a run.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/throughput.h"
+
+#if THROUGHPUT_ENABLE
+#include "gatt_db.h"
+#include "src/conn_param.h"
+#include "src/bulk.h"
+#include "src/irq.h"
+#include "string.h"
+
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+#define ATT_NOTIFICATION_HEADER_LEN (3)
+#define THROUGHPUT_NO_CONNECTION (0xFF)
+
+//Combinations walked by the client, the first MTU is the one connParamLinkInit() offers
+static const uint8_t throughput_phys[] = { CONN_PARAM_PHY_1M, CONN_PARAM_PHY_2M, CONN_PARAM_PHY_CODED };
+static const uint16_t throughput_mtus[] = { CONN_PARAM_MAX_MTU, 131, 67, 23 };
+
+#define THROUGHPUT_NUM_PHYS (sizeof(throughput_phys) / sizeof(throughput_phys[0]))
+#define THROUGHPUT_NUM_MTUS (sizeof(throughput_mtus) / sizeof(throughput_mtus[0]))
+
+//Client test steps
+typedef enum
+{
+  throughput_setup,                 //Waiting for a discovered server
+  throughput_phy_wait,              //PHY under test requested
+  throughput_down,                  //Server source streaming to the client
+  throughput_up,                    //Client streaming to the server sink
+  throughput_bulk,                  //Client streaming on the L2CAP bulk channel
+  throughput_done,
+}throughput_phase_t;
+
+static uint8_t throughput_connection = THROUGHPUT_NO_CONNECTION;
+static uint32_t throughput_sequence = 0;
+static uint8_t throughput_payload_len = THROUGHPUT_PAYLOAD_LEN;
+
+//Server
+static bool throughput_armed = false;            //Source notifications enabled by the client
+static bool throughput_streaming = false;
+static throughput_stats_t throughput_source_stats;
+static throughput_stats_t throughput_sink_stats;
+static throughput_stats_t throughput_bulk_stats;
+
+//Client
+static throughput_phase_t throughput_phase = throughput_setup;
+static uint32_t throughput_phase_ms = 0;
+static uint32_t throughput_phy_step = 0;
+static uint32_t throughput_mtu_step = 0;
+static throughput_stats_t throughput_stats;
+
+
+/*
+ * Returns a printable PHY name
+ *
+ * Parameters:
+ *   uint8_t phy: CONN_PARAM_PHY_x
+ *
+ * Returns:
+ *   const char*: Name of the PHY
+ */
+static const char* throughput_phy_name(uint8_t phy)
+{
+  if(phy == CONN_PARAM_PHY_2M)
+    return "2M";
+  if(phy == CONN_PARAM_PHY_CODED)
+    return "Coded";
+  return "1M";
+}
+
+
+/*
+ * Returns the payload size to send on a link, the configured size limited to what one ATT packet carries
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   size_t: Payload length in bytes
+ */
+static size_t throughput_payload(uint8_t connection)
+{
+  size_t len = connParamMtu(connection) - ATT_NOTIFICATION_HEADER_LEN;
+
+  if((throughput_payload_len != 0) && (throughput_payload_len < len))
+    len = throughput_payload_len;
+  if(len > THROUGHPUT_MAX_PAYLOAD)
+    len = THROUGHPUT_MAX_PAYLOAD;
+  if(len < THROUGHPUT_MIN_PAYLOAD)
+    len = THROUGHPUT_MIN_PAYLOAD;
+
+  return len;
+}
+
+
+/*
+ * Adds one packet to a set of counters
+ *
+ * Parameters:
+ *   throughput_stats_t *stats: Counters of the direction
+ *   size_t len: Payload length
+ *
+ * Returns:
+ *   None
+ */
+static void throughput_count(throughput_stats_t *stats, size_t len)
+{
+  uint32_t now = letimerMilliseconds();
+
+  if(stats->packets == 0)
+    stats->start_ms = now;
+
+  stats->bytes += len;
+  stats->packets++;
+  stats->last_ms = now;
+}
+
+
+/*
+ * Prints the rate, packets per connection event and buffer-full count of one direction on VCOM
+ *
+ * Parameters:
+ *   const char *direction: Label of the line
+ *   uint8_t connection: Stack connection handle
+ *   throughput_stats_t *stats: Counters of the direction
+ *
+ * Returns:
+ *   None
+ */
+static void throughput_report(const char *direction, uint8_t connection, throughput_stats_t *stats)
+{
+  uint32_t elapsed = stats->last_ms - stats->start_ms;
+  uint32_t kbps_x10;
+  uint32_t per_event_x100;
+
+  if((stats->packets < 2) || (elapsed == 0))
+    {
+      LOG_INFO("\r\nThroughput %s PHY %s MTU %d: no data\r\n", direction, throughput_phy_name(connParamPhy(connection)),
+               connParamMtu(connection));
+      return;
+    }
+
+  //bytes * 8 / ms is kbit/s, the interval is in 1.25 ms units
+  kbps_x10 = (uint32_t)(((uint64_t)stats->bytes * 80) / elapsed);
+  per_event_x100 = (uint32_t)(((uint64_t)stats->packets * connParamInterval(connection) * 125) / elapsed);
+
+  LOG_INFO("\r\nThroughput %s PHY %s MTU %d DLE %d: %"PRIu32".%"PRIu32" kbit/s, %"PRIu32".%02"PRIu32" packets/event, %"PRIu32" buffer full\r\n",
+           direction, throughput_phy_name(connParamPhy(connection)), connParamMtu(connection), connParamTxSize(connection),
+           kbps_x10 / 10, kbps_x10 % 10, per_event_x100 / 100, per_event_x100 % 100, stats->drops);
+}
+
+
+/*
+ * Starts or stops the soft timer that refills the stack buffers
+ *
+ * Parameters:
+ *   bool run: true to start the timer
+ *
+ * Returns:
+ *   None
+ */
+static void throughput_timer(bool run)
+{
+  sl_status_t error_status;
+
+  //The timer only runs while streaming so an idle device keeps sleeping
+  error_status = sl_bt_system_set_soft_timer((run == true) ? THROUGHPUT_PUMP_TICKS : 0, THROUGHPUT_TIMER_HANDLE, 0);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nThroughput timer error\r\n");
+}
+
+
+/*
+ * Server: starts the source stream
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void throughput_server_start()
+{
+  memset(&throughput_source_stats, 0, sizeof(throughput_source_stats));
+  throughput_streaming = true;
+  throughput_timer(true);
+  throughputServerPump();
+}
+
+
+/*
+ * Server: stops the source stream and prints every path that carried data
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void throughput_server_stop()
+{
+  if(throughput_streaming == true)
+    {
+      throughput_streaming = false;
+      throughput_timer(false);
+      throughput_report("source", throughput_connection, &throughput_source_stats);
+    }
+
+  if(throughput_sink_stats.packets != 0)
+    throughput_report("sink", throughput_connection, &throughput_sink_stats);
+
+  if(throughput_bulk_stats.packets != 0)
+    throughput_report("l2cap sink", throughput_connection, &throughput_bulk_stats);
+
+  memset(&throughput_sink_stats, 0, sizeof(throughput_sink_stats));
+  memset(&throughput_bulk_stats, 0, sizeof(throughput_bulk_stats));
+}
+
+
+/*
+ * Server: arms or disarms the source when the client writes the throughput source CCCD
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bool enable: true if notifications were enabled
+ *
+ * Returns:
+ *   None
+ */
+void throughputServerConfig(uint8_t connection, bool enable)
+{
+  throughput_connection = connection;
+  throughput_armed = enable;
+
+  if((enable == false) && (throughput_streaming == true))
+    throughput_server_stop();
+}
+
+
+/*
+ * Server: queues notifications until the stack runs out of buffers, called from the throughput soft timer
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void throughputServerPump()
+{
+  sl_status_t error_status;
+  uint8_t payload[THROUGHPUT_MAX_PAYLOAD];
+  size_t len;
+
+  if(throughput_streaming == false)
+    return;
+
+  connParamBusy(throughput_connection);
+
+  len = throughput_payload(throughput_connection);
+  memset(payload, 0xA5, len);
+
+  do
+    {
+      memcpy(payload, &throughput_sequence, sizeof(throughput_sequence));       //Lets a sniffer trace spot gaps
+      error_status = sl_bt_gatt_server_send_notification(throughput_connection, gattdb_throughput_source, len, payload);
+      if(error_status == SL_STATUS_OK)
+        {
+          throughput_sequence++;
+          throughput_count(&throughput_source_stats, len);
+        }
+    }
+  while(error_status == SL_STATUS_OK);
+
+  if(error_status == SL_STATUS_NO_MORE_RESOURCE)
+    throughput_source_stats.drops++;
+  else
+    LOG_ERROR("\r\nThroughput notification error: %d\r\n", error_status);
+}
+
+
+/*
+ * Client: writes a command to the server control point
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   uint8_t opcode: THROUGHPUT_CMD_x
+ *
+ * Returns:
+ *   bool: true if the write was queued
+ */
+static bool throughput_client_command(uint8_t connection, uint8_t opcode)
+{
+  sl_status_t error_status;
+  uint8_t command[2] = { opcode, throughput_payload_len };
+
+  //Both boards run the same GATT database, so the local handle is the server handle
+  error_status = sl_bt_gatt_write_characteristic_value(connection, gattdb_throughput_control,
+                                                       (opcode == THROUGHPUT_CMD_START) ? 2 : 1, command);
+  if(error_status != SL_STATUS_OK)
+    {
+      LOG_ERROR("\r\nError writing the throughput control point: %d\r\n", error_status);
+      return false;
+    }
+
+  return true;
+}
+
+
+/*
+ * Client: moves on to the next PHY, or to the next ATT MTU once every PHY was measured
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   uint32_t now: Current time in ms
+ *
+ * Returns:
+ *   None
+ */
+static void throughput_client_next(uint8_t connection, uint32_t now)
+{
+  sl_status_t error_status;
+  uint16_t max_mtu;
+
+  throughput_phase = throughput_phy_wait;
+  throughput_phase_ms = now;
+
+  if(++throughput_phy_step < THROUGHPUT_NUM_PHYS)
+    {
+      error_status = sl_bt_connection_set_preferred_phy(connection, throughput_phys[throughput_phy_step], CONN_PARAM_PHY_ANY);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError requesting the test PHY\r\n");
+      return;
+    }
+
+  //The MTU is exchanged once per connection, the next size needs a new one
+  if(++throughput_mtu_step >= THROUGHPUT_NUM_MTUS)
+    {
+      LOG_INFO("\r\nThroughput test done\r\n");
+      throughput_phase = throughput_done;
+      error_status = sl_bt_gatt_set_characteristic_notification(connection, gattdb_throughput_source, sl_bt_gatt_disable);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError disabling throughput notifications\r\n");
+      error_status = sl_bt_gatt_set_max_mtu(CONN_PARAM_MAX_MTU, &max_mtu);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError setting the ATT MTU\r\n");
+      return;
+    }
+
+  error_status = sl_bt_gatt_set_max_mtu(throughput_mtus[throughput_mtu_step], &max_mtu);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting the ATT MTU\r\n");
+
+  error_status = sl_bt_connection_close(connection);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError closing the test connection\r\n");
+}
+
+
+/*
+ * Client: drives the test on a server, called once per second for every open connection
+ *
+ * Each step starts at most one GATT procedure, the next tick is a second later so the previous one
+ * has completed by then
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bool ready: true once discovery has finished on the connection
+ *
+ * Returns:
+ *   None
+ */
+void throughputClientPoll(uint8_t connection, bool ready)
+{
+  sl_status_t error_status;
+  uint32_t now = letimerMilliseconds();
+  uint32_t elapsed;
+
+  if(throughput_phase == throughput_done)
+    return;
+
+  if(throughput_connection == THROUGHPUT_NO_CONNECTION)
+    {
+      if(ready == false)
+        return;
+
+      error_status = sl_bt_gatt_set_characteristic_notification(connection, gattdb_throughput_source, sl_bt_gatt_notification);
+      if(error_status != SL_STATUS_OK)
+        {
+          LOG_ERROR("\r\nError enabling throughput notifications: %d\r\n", error_status);
+          return;
+        }
+
+      throughput_connection = connection;
+      throughput_phy_step = 0;
+      throughput_phase = throughput_phy_wait;
+      throughput_phase_ms = now;
+      error_status = sl_bt_connection_set_preferred_phy(connection, throughput_phys[0], CONN_PARAM_PHY_ANY);
+      if(error_status != SL_STATUS_OK)
+        LOG_ERROR("\r\nError requesting the test PHY\r\n");
+      return;
+    }
+
+  if(connection != throughput_connection)
+    return;
+
+  connParamBusy(connection);
+
+  elapsed = now - throughput_phase_ms;
+
+  switch(throughput_phase)
+  {
+    case throughput_phy_wait:
+      if(connParamPhy(connection) == throughput_phys[throughput_phy_step])
+        {
+          if(throughput_client_command(connection, THROUGHPUT_CMD_START) == false)
+            break;
+
+          memset(&throughput_stats, 0, sizeof(throughput_stats));
+          throughput_phase = throughput_down;
+          throughput_phase_ms = now;
+          break;
+        }
+
+      //A PHY the link never takes is reported after one window
+      if(elapsed >= THROUGHPUT_WINDOW_MS)
+        {
+          LOG_INFO("\r\nThroughput PHY %s MTU %d: PHY not accepted by the link\r\n", throughput_phy_name(throughput_phys[throughput_phy_step]),
+                   connParamMtu(connection));
+          throughput_client_next(connection, now);
+        }
+      break;
+
+    case throughput_down:
+      if(elapsed < THROUGHPUT_WINDOW_MS)
+        break;
+
+      throughput_client_command(connection, THROUGHPUT_CMD_STOP);
+      throughput_report("down", connection, &throughput_stats);
+
+      //Write commands are not GATT procedures, so the sink stream may start while the stop is in flight
+      memset(&throughput_stats, 0, sizeof(throughput_stats));
+      throughput_phase = throughput_up;
+      throughput_phase_ms = now;
+      throughput_timer(true);
+      throughputClientPump();
+      break;
+
+    case throughput_up:
+      if(elapsed < THROUGHPUT_WINDOW_MS)
+        break;
+
+      throughput_timer(false);
+      throughput_client_command(connection, THROUGHPUT_CMD_STOP);
+      throughput_report("up", connection, &throughput_stats);
+
+      //The same direction again without ATT, if the server accepted the bulk channel
+      if(bulkMaxRecord(connection) == 0)
+        {
+          LOG_INFO("\r\nThroughput l2cap: no bulk channel\r\n");
+          throughput_client_next(connection, now);
+          break;
+        }
+
+      memset(&throughput_stats, 0, sizeof(throughput_stats));
+      throughput_phase = throughput_bulk;
+      throughput_phase_ms = now;
+      throughput_timer(true);
+      throughputClientPump();
+      break;
+
+    case throughput_bulk:
+      if(elapsed < THROUGHPUT_WINDOW_MS)
+        break;
+
+      throughput_timer(false);
+      throughput_client_command(connection, THROUGHPUT_CMD_STOP);
+      throughput_report("l2cap", connection, &throughput_stats);
+      throughput_client_next(connection, now);
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+/*
+ * Client: queues write commands to the sink, or test records on the bulk channel, until the stack or the peer runs
+ * out of buffers, called from the throughput soft timer
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void throughputClientPump()
+{
+  sl_status_t error_status;
+  uint8_t payload[THROUGHPUT_MAX_PAYLOAD];
+  uint16_t sent_len;
+  size_t len;
+
+  if(((throughput_phase != throughput_up) && (throughput_phase != throughput_bulk)) || (throughput_connection == THROUGHPUT_NO_CONNECTION))
+    return;
+
+  len = throughput_payload(throughput_connection);
+  if((throughput_phase == throughput_bulk) && (len > bulkMaxRecord(throughput_connection)))
+    len = bulkMaxRecord(throughput_connection);
+  memset(payload, 0x5A, len);
+
+  do
+    {
+      memcpy(payload, &throughput_sequence, sizeof(throughput_sequence));
+      if(throughput_phase == throughput_bulk)
+        {
+          error_status = bulkSend(throughput_connection, bulk_type_test, payload, len);
+          sent_len = len;
+        }
+      else
+        error_status = sl_bt_gatt_write_characteristic_value_without_response(throughput_connection, gattdb_throughput_sink,
+                                                                              len, payload, &sent_len);
+      if(error_status == SL_STATUS_OK)
+        {
+          throughput_sequence++;
+          throughput_count(&throughput_stats, sent_len);
+        }
+    }
+  while(error_status == SL_STATUS_OK);
+
+  //On the bulk channel this also counts the times the server had no credit left for us
+  if(error_status == SL_STATUS_NO_MORE_RESOURCE)
+    throughput_stats.drops++;
+  else
+    LOG_ERROR("\r\nThroughput send error: %d\r\n", error_status);
+}
+
+
+/*
+ * Client: counts a received throughput notification
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   size_t len: Payload length
+ *
+ * Returns:
+ *   None
+ */
+void throughputClientData(uint8_t connection, size_t len)
+{
+  //Notifications still in flight after the stop belong to no window
+  if((connection == throughput_connection) && (throughput_phase == throughput_down))
+    throughput_count(&throughput_stats, len);
+}
+
+
+/*
+ * Either role: counts a test record received on the L2CAP bulk channel
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   size_t len: Record payload length
+ *
+ * Returns:
+ *   None
+ */
+void throughputBulkData(uint8_t connection, size_t len)
+{
+  throughput_connection = connection;
+  throughput_count(&throughput_bulk_stats, len);
+}
+
+
+/*
+ * Either role: forgets a closed connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void throughputClosed(uint8_t connection)
+{
+  if(connection != throughput_connection)
+    return;
+
+  //Server side, the run ended without a stop so print what was measured
+  if((throughput_streaming == true) || (throughput_sink_stats.packets != 0) || (throughput_bulk_stats.packets != 0))
+    throughput_server_stop();
+  throughput_armed = false;
+
+  //Client side, the test restarts on the next discovered server
+  if((throughput_phase == throughput_up) || (throughput_phase == throughput_bulk))
+    throughput_timer(false);
+  if(throughput_phase != throughput_done)
+    throughput_phase = throughput_setup;
+
+  throughput_connection = THROUGHPUT_NO_CONNECTION;
+}
+
+
+/*
+ * Server: counts sink writes and serves the control point
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void throughput_handle_ble_event(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+
+  switch (SL_BT_MSG_ID(evt->header))
+  {
+    case sl_bt_evt_gatt_server_user_write_request_id:
+      if(evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_throughput_sink)
+        {
+          //Write commands take no response
+          throughput_connection = evt->data.evt_gatt_server_user_write_request.connection;
+          connParamBusy(throughput_connection);
+          throughput_count(&throughput_sink_stats, evt->data.evt_gatt_server_user_write_request.value.len);
+        }
+
+      if(evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_throughput_control)
+        {
+          uint8_t att_errorcode = 0;
+          uint8array *value = &evt->data.evt_gatt_server_user_write_request.value;
+
+          throughput_connection = evt->data.evt_gatt_server_user_write_request.connection;
+
+          if(value->len < 1)
+            att_errorcode = SL_STATUS_BT_ATT_INVALID_ATT_LENGTH & 0xFF;
+
+          else
+            {
+              switch(value->data[0])
+              {
+                case THROUGHPUT_CMD_START:
+                  if(throughput_armed == false)
+                    {
+                      att_errorcode = SL_STATUS_BT_ATT_CLIENT_CHARACTERISTIC_CONFIGURATION_DESCRIPTOR_IMPROPERLY_CONFIGURED & 0xFF;
+                      break;
+                    }
+                  if(value->len >= 2)
+                    throughput_payload_len = value->data[1];
+                  throughput_server_start();
+                  break;
+
+                case THROUGHPUT_CMD_STOP:
+                  throughput_server_stop();
+                  break;
+
+                case THROUGHPUT_CMD_PAYLOAD:
+                  if(value->len < 2)
+                    att_errorcode = SL_STATUS_BT_ATT_INVALID_ATT_LENGTH & 0xFF;
+                  else
+                    throughput_payload_len = value->data[1];
+                  break;
+
+                default:
+                  att_errorcode = SL_STATUS_BT_ATT_VALUE_NOT_ALLOWED & 0xFF;
+                  break;
+              }
+            }
+
+          error_status = sl_bt_gatt_server_send_user_write_response(throughput_connection, gattdb_throughput_control, att_errorcode);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError sending the throughput control response\r\n");
+        }
+      break;
+
+    case sl_bt_evt_gatt_server_user_read_request_id:
+      if(evt->data.evt_gatt_server_user_read_request.characteristic == gattdb_throughput_control)
+        {
+          uint32_t counters[5];
+          uint16_t sent_len;
+
+          //Little endian like the rest of the ATT payloads on this core
+          counters[0] = throughput_source_stats.bytes;
+          counters[1] = throughput_source_stats.packets;
+          counters[2] = throughput_source_stats.drops;
+          counters[3] = throughput_sink_stats.bytes;
+          counters[4] = throughput_sink_stats.packets;
+
+          error_status = sl_bt_gatt_server_send_user_read_response(evt->data.evt_gatt_server_user_read_request.connection,
+                                                                   gattdb_throughput_control, 0, sizeof(counters),
+                                                                   (uint8_t *)counters, &sent_len);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError sending the throughput read response\r\n");
+        }
+      break;
+
+    default:
+      break;
+  }
+}
+
+#endif   //THROUGHPUT_ENABLE
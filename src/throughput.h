@@ -0,0 +1,170 @@
+/**
+ * @file    :   throughput.h
+ * @brief   :   Headers and function definitions for the link throughput test
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef THROUGHPUT_H
+#define THROUGHPUT_H
+
+#include "stdint.h"
+#include "stddef.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+
+//Set to 1 in both roles to run the benchmark: the client walks every PHY and ATT MTU combination on the first
+//server it discovers and measures both GATT directions and the L2CAP bulk channel, the server serves the
+//Throughput Test Service
+#define THROUGHPUT_ENABLE (0)
+
+//Measurement time per combination and path
+#define THROUGHPUT_WINDOW_MS (5000)
+
+//Soft timer that refills the stack buffers while a side streams, 164 ticks is 5 ms
+#define THROUGHPUT_TIMER_HANDLE (4)
+#define THROUGHPUT_PUMP_TICKS (164)
+
+//Largest notification or write command payload, ATT MTU 247 less the 3 byte ATT header
+#define THROUGHPUT_MAX_PAYLOAD (244)
+
+//Payload size the client asks for in both directions, 0 follows the ATT MTU of the link
+#define THROUGHPUT_PAYLOAD_LEN (0)
+
+//Smallest payload, the first 4 bytes carry the sequence number
+#define THROUGHPUT_MIN_PAYLOAD (4)
+
+//Throughput control point opcodes
+#define THROUGHPUT_CMD_START (0x01)                //Optional payload size byte follows
+#define THROUGHPUT_CMD_STOP (0x02)                 //Stops the source and prints the server counters on VCOM
+#define THROUGHPUT_CMD_PAYLOAD (0x03)              //Payload size byte follows
+
+//Counters of one direction
+typedef struct
+{
+  uint32_t bytes;
+  uint32_t packets;
+  uint32_t drops;                   //Sends the stack refused because its buffers were full
+  uint32_t start_ms;                //First packet of the window
+  uint32_t last_ms;                 //Latest packet of the window
+}throughput_stats_t;
+
+
+#if THROUGHPUT_ENABLE
+
+/*
+ * Server: arms or disarms the source when the client writes the throughput source CCCD
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bool enable: true if notifications were enabled
+ *
+ * Returns:
+ *   None
+ */
+void throughputServerConfig(uint8_t connection, bool enable);
+
+
+/*
+ * Server: queues notifications until the stack runs out of buffers, called from the throughput soft timer
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void throughputServerPump();
+
+
+/*
+ * Client: drives the test on a server, called once per second for every open connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   bool ready: true once discovery has finished on the connection
+ *
+ * Returns:
+ *   None
+ */
+void throughputClientPoll(uint8_t connection, bool ready);
+
+
+/*
+ * Client: queues write commands to the sink, or test records on the bulk channel, until the stack or the peer runs
+ * out of buffers, called from the throughput soft timer
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void throughputClientPump();
+
+
+/*
+ * Client: counts a received throughput notification
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   size_t len: Payload length
+ *
+ * Returns:
+ *   None
+ */
+void throughputClientData(uint8_t connection, size_t len);
+
+
+/*
+ * Either role: counts a test record received on the L2CAP bulk channel
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *   size_t len: Record payload length
+ *
+ * Returns:
+ *   None
+ */
+void throughputBulkData(uint8_t connection, size_t len);
+
+
+/*
+ * Either role: forgets a closed connection
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle
+ *
+ * Returns:
+ *   None
+ */
+void throughputClosed(uint8_t connection);
+
+
+/*
+ * Server: counts sink writes and serves the control point
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void throughput_handle_ble_event(sl_bt_msg_t *evt);
+
+#else
+
+static inline void throughputServerConfig(uint8_t connection, bool enable) { (void)connection; (void)enable; }
+static inline void throughputServerPump() {}
+static inline void throughputClientPoll(uint8_t connection, bool ready) { (void)connection; (void)ready; }
+static inline void throughputClientPump() {}
+static inline void throughputClientData(uint8_t connection, size_t len) { (void)connection; (void)len; }
+static inline void throughputBulkData(uint8_t connection, size_t len) { (void)connection; (void)len; }
+static inline void throughputClosed(uint8_t connection) { (void)connection; }
+static inline void throughput_handle_ble_event(sl_bt_msg_t *evt) { (void)evt; }
+
+#endif   //THROUGHPUT_ENABLE
+
+#endif   //THROUGHPUT_H
@@ -0,0 +1,373 @@
+/**
+ * @file    :   trace.c
+ * @brief   :   API for the binary event trace recorder
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/trace.h"
+
+#if TRACE_ENABLE
+
+#include "em_core.h"
+#include "em_cmu.h"
+#include "gatt_db.h"
+#include "ble_device_type.h"
+#include "src/irq.h"
+#include "src/scheduler.h"
+#include "src/server_conn.h"
+#include "string.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+#define TRACE_INDEX_MASK (TRACE_DEPTH - 1)
+
+#define ATT_HEADER_LEN (1)
+
+#if (TRACE_DEPTH & TRACE_INDEX_MASK)
+#error "TRACE_DEPTH must be a power of 2"
+#endif
+
+static trace_record_t trace_ring[TRACE_DEPTH];
+static uint32_t trace_head = 0;              //Total number of records written since the last clear
+static uint32_t trace_read_cursor = 0;       //Next record returned by a GATT read
+static bool trace_dump_active = false;       //A VCOM dump is being printed
+static uint32_t trace_dump_cursor = 0;       //Next record printed by the dump
+static uint32_t trace_dump_end = 0;          //trace_head when the dump started, later records are left out
+
+
+/*
+ * Enables the DWT cycle counter and clears the trace ring
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void traceInit()
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;       //Enable the DWT block
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                  //Start the cycle counter
+
+  trace_head = 0;
+  trace_read_cursor = 0;
+}
+
+
+/*
+ * Returns the state of the state machine owned by this role
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint8_t: Temperature state on the server, discovery state on the client
+ */
+uint8_t traceState()
+{
+  if(IsServerDevice())
+    return (uint8_t)getTemperatureState();
+
+  return (uint8_t)getDiscoveryState();
+}
+
+
+/*
+ * Appends a record to the ring, overwriting the oldest one when full. Safe to call from an ISR
+ *
+ * Parameters:
+ *   trace_type_t type: Record type
+ *   uint32_t id: Bluetooth event id, external signal mask or trace_isr_t
+ *   uint8_t state_before: State before the handler ran
+ *   uint8_t state_after: State after the handler ran
+ *   uint32_t start_cycles: traceCycles() value taken at handler entry
+ *   uint32_t start_ticks: LETIMER0 tick count taken at handler entry
+ *
+ * Returns:
+ *   None
+ */
+void traceRecord(trace_type_t type, uint32_t id, uint8_t state_before, uint8_t state_after, uint32_t start_cycles, uint32_t start_ticks)
+{
+  trace_record_t *record;
+  uint32_t cycles = traceCycles() - start_cycles;        //Unsigned difference handles the CYCCNT wrap
+
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+
+  record = &trace_ring[trace_head & TRACE_INDEX_MASK];
+  record->type = (uint8_t)type;
+  record->state_before = state_before;
+  record->state_after = state_after;
+  record->seq = (uint8_t)trace_head;
+  record->id = id;
+  record->cycles = cycles;
+  record->timestamp = start_ticks;
+
+  trace_head++;
+
+  CORE_EXIT_CRITICAL();
+}
+
+
+/*
+ * Copies the record at the given position out of the ring
+ *
+ * Parameters:
+ *   uint32_t position: Record position, must be within the last TRACE_DEPTH records
+ *   trace_record_t *record: Destination
+ *
+ * Returns:
+ *   None
+ */
+static void trace_copy(uint32_t position, trace_record_t *record)
+{
+  CORE_DECLARE_IRQ_STATE;
+
+  CORE_ENTER_CRITICAL();
+  memcpy(record, &trace_ring[position & TRACE_INDEX_MASK], sizeof(trace_record_t));
+  CORE_EXIT_CRITICAL();
+}
+
+
+/*
+ * Returns the oldest position still held in the ring
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t: Oldest valid record position
+ */
+static uint32_t trace_oldest()
+{
+  return (trace_head > TRACE_DEPTH) ? (trace_head - TRACE_DEPTH) : 0;
+}
+
+
+/*
+ * Starts or stops the soft timer that paces the VCOM dump
+ *
+ * Parameters:
+ *   bool run: true to start the timer
+ *
+ * Returns:
+ *   None
+ */
+static void trace_dump_timer(bool run)
+{
+  sl_status_t error_status;
+
+  error_status = sl_bt_system_set_soft_timer((run == true) ? TRACE_DUMP_TICKS : 0, TRACE_TIMER_HANDLE, 0);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nTrace timer error\r\n");
+}
+
+
+/*
+ * Prints the next TRACE_DUMP_CHUNK records of the dump, and the end marker once every record is out
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void trace_dump_chunk()
+{
+  trace_record_t record;
+  uint8_t *bytes = (uint8_t *)&record;
+  uint32_t printed = 0;
+
+  if(trace_dump_active == false)
+    return;
+
+  //Records overwritten since the dump started are skipped, they show as a sequence gap
+  if(trace_dump_cursor < trace_oldest())
+    trace_dump_cursor = trace_oldest();
+
+  while((trace_dump_cursor < trace_dump_end) && (printed < TRACE_DUMP_CHUNK))
+    {
+      trace_copy(trace_dump_cursor, &record);
+      trace_dump_cursor++;
+      printed++;
+
+      app_log("TRACE ");
+      for(uint32_t i = 0; i < sizeof(trace_record_t); i++)
+        app_log("%02x", bytes[i]);
+      app_log("\n");
+    }
+
+  if(trace_dump_cursor >= trace_dump_end)
+    {
+      app_log("TRACE END\n");
+      trace_dump_active = false;
+      trace_dump_timer(false);
+    }
+}
+
+
+/*
+ * Starts printing the records held in the ring to VCOM, one hex encoded record per line. The records
+ * are printed TRACE_DUMP_CHUNK at a time from the trace soft timer so the event loop is never held up
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void traceDump()
+{
+  if(trace_dump_active == true)                    //Already printing, the running dump carries on
+    return;
+
+  trace_dump_end = trace_head;
+  trace_dump_cursor = trace_oldest();
+  trace_dump_active = true;
+
+  app_log("TRACE BEGIN v%d size=%d count=%"PRIu32" tick_hz=%"PRIu32" cpu_hz=%"PRIu32"\n",
+          TRACE_FORMAT_VERSION, (int)sizeof(trace_record_t), trace_dump_end - trace_dump_cursor,
+          letimerTickFrequency(), CMU_ClockFreqGet(cmuClock_CORE));
+
+  trace_dump_timer(true);
+}
+
+
+/*
+ * Checks that a trace request came over an encrypted link, the records show the timing of every handler
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle of the request
+ *
+ * Returns:
+ *   bool: true if the link is encrypted
+ */
+static bool trace_link_encrypted(uint8_t connection)
+{
+  server_conn_t *ctx = serverConnFind(connection);
+
+  return (ctx != NULL) && (ctx->is_encrypted == true);
+}
+
+
+/*
+ * Serves the trace characteristic: user reads stream records, user writes take a TRACE_CMD_* command.
+ * Both need an encrypted link. Also paces a VCOM dump on the trace soft timer
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void trace_handle_ble_event(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+
+  switch (SL_BT_MSG_ID(evt->header))
+  {
+    case sl_bt_evt_gatt_server_user_read_request_id:
+      if(evt->data.evt_gatt_server_user_read_request.characteristic == gattdb_trace_data)
+        {
+          uint8_t buffer[sizeof(trace_record_t) * 4];
+          uint16_t mtu = 0;
+          uint16_t sent_len;
+          size_t len = 0;
+
+          if(trace_link_encrypted(evt->data.evt_gatt_server_user_read_request.connection) == false)
+            {
+              error_status = sl_bt_gatt_server_send_user_read_response(evt->data.evt_gatt_server_user_read_request.connection,
+                                                                       gattdb_trace_data, SL_STATUS_BT_ATT_INSUFFICIENT_ENCRYPTION & 0xFF,
+                                                                       0, buffer, &sent_len);
+              if(error_status != SL_STATUS_OK)
+                LOG_ERROR("\r\nError sending the trace read response\r\n");
+              break;
+            }
+
+          error_status = sl_bt_gatt_server_get_mtu(evt->data.evt_gatt_server_user_read_request.connection, &mtu);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError reading the ATT MTU\r\n");
+
+          if(trace_read_cursor < trace_oldest())                  //Records the reader had not fetched were overwritten
+            trace_read_cursor = trace_oldest();
+
+          //Return as many whole records as fit in one ATT response, an empty response marks the end
+          while((trace_read_cursor < trace_head) && (len + sizeof(trace_record_t) <= sizeof(buffer))
+                && (len + sizeof(trace_record_t) + ATT_HEADER_LEN <= mtu))
+            {
+              trace_copy(trace_read_cursor, (trace_record_t *)&buffer[len]);
+              trace_read_cursor++;
+              len += sizeof(trace_record_t);
+            }
+
+          error_status = sl_bt_gatt_server_send_user_read_response(evt->data.evt_gatt_server_user_read_request.connection,
+                                                                   gattdb_trace_data, 0, len, buffer, &sent_len);
+          if(error_status != SL_STATUS_OK)
+            LOG_ERROR("\r\nError sending the trace read response\r\n");
+        }
+      break;
+
+    case sl_bt_evt_gatt_server_user_write_request_id:
+      if(evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_trace_data)
+        {
+          uint8_t att_errorcode = 0;
+
+          if(trace_link_encrypted(evt->data.evt_gatt_server_user_write_request.connection) == false)
+            att_errorcode = SL_STATUS_BT_ATT_INSUFFICIENT_ENCRYPTION & 0xFF;
+
+          else if(evt->data.evt_gatt_server_user_write_request.value.len < 1)
+            att_errorcode = SL_STATUS_BT_ATT_INVALID_ATT_LENGTH & 0xFF;
+
+          else
+            {
+              switch(evt->data.evt_gatt_server_user_write_request.value.data[0])
+              {
+                case TRACE_CMD_CLEAR:
+                  trace_head = 0;
+                  trace_read_cursor = 0;
+                  trace_dump_cursor = 0;
+                  trace_dump_end = 0;                     //A running dump prints its end marker on the next timer event
+                  break;
+
+                case TRACE_CMD_REWIND:
+                  trace_read_cursor = trace_oldest();
+                  break;
+
+                case TRACE_CMD_DUMP_VCOM:
+                  traceDump();
+                  break;
+
+                default:
+                  att_errorcode = SL_STATUS_BT_ATT_VALUE_NOT_ALLOWED & 0xFF;
+                  break;
+              }
+            }
+
+          if(evt->data.evt_gatt_server_user_write_request.att_opcode == sl_bt_gatt_write_request)
+            {
+              error_status = sl_bt_gatt_server_send_user_write_response(evt->data.evt_gatt_server_user_write_request.connection,
+                                                                        gattdb_trace_data, att_errorcode);
+              if(error_status != SL_STATUS_OK)
+                LOG_ERROR("\r\nError sending the trace write response\r\n");
+            }
+        }
+      break;
+
+    case sl_bt_evt_system_soft_timer_id:
+      if(evt->data.evt_system_soft_timer.handle == TRACE_TIMER_HANDLE)
+        trace_dump_chunk();
+      break;
+
+    default:
+      break;
+  }
+}
+
+#endif   //TRACE_ENABLE
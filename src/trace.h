@@ -0,0 +1,187 @@
+/**
+ * @file    :   trace.h
+ * @brief   :   Headers and function definitions for the binary event trace recorder
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "stdint.h"
+#include "em_device.h"
+#include "sl_bt_api.h"
+#include "src/irq.h"
+
+//Set to 0 to compile the recorder out, every call then becomes an empty inline
+#define TRACE_ENABLE (1)
+
+//Number of records kept in the ring, must be a power of 2
+#define TRACE_DEPTH (128)
+
+//Version of the record layout below, printed in the dump header
+#define TRACE_FORMAT_VERSION (1)
+
+//Value used for the state fields when no state machine applies
+#define TRACE_STATE_NONE (0xFF)
+
+//Soft timer that paces a VCOM dump, 1638 ticks is 50 ms
+#define TRACE_TIMER_HANDLE (6)
+#define TRACE_DUMP_TICKS (1638)
+
+//Records printed per soft timer event, about 14 ms of VCOM output at 115200 baud
+#define TRACE_DUMP_CHUNK (4)
+
+//Commands written to the trace characteristic
+#define TRACE_CMD_CLEAR (0x00)
+#define TRACE_CMD_REWIND (0x01)
+#define TRACE_CMD_DUMP_VCOM (0x02)
+
+//Record types
+typedef enum
+{
+  TRACE_TYPE_BT_EVENT = 1,
+  TRACE_TYPE_EXT_SIGNAL = 2,
+  TRACE_TYPE_ISR = 3
+}trace_type_t;
+
+//Interrupt identifiers for TRACE_TYPE_ISR records
+typedef enum
+{
+  TRACE_ISR_LETIMER0 = 1,
+  TRACE_ISR_I2C0 = 2,
+  TRACE_ISR_GPIO_EVEN = 3,
+  TRACE_ISR_GPIO_ODD = 4,
+  TRACE_ISR_LDMA = 5
+}trace_isr_t;
+
+//One trace record, 16 bytes, little endian on the wire
+typedef struct __attribute__((packed))
+{
+  uint8_t type;            //trace_type_t
+  uint8_t state_before;    //State machine state before the handler ran
+  uint8_t state_after;     //State machine state after the handler ran
+  uint8_t seq;             //Sequence number, wraps at 256, gaps mean lost records
+  uint32_t id;             //Bluetooth event id, external signal mask or trace_isr_t
+  uint32_t cycles;         //DWT CYCCNT cycles spent in the handler
+  uint32_t timestamp;      //LETIMER0 ticks at handler entry, low 32 bits
+}trace_record_t;
+
+
+#if TRACE_ENABLE
+
+/*
+ * Enables the DWT cycle counter and clears the trace ring
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void traceInit();
+
+
+/*
+ * Returns the current DWT cycle count, used to mark the entry of a handler
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t: DWT CYCCNT value
+ */
+static inline uint32_t traceCycles()
+{
+  return DWT->CYCCNT;
+}
+
+
+/*
+ * Returns the state of the state machine owned by this role
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint8_t: Temperature state on the server, discovery state on the client
+ */
+uint8_t traceState();
+
+
+/*
+ * Appends a record to the ring, overwriting the oldest one when full. Safe to call from an ISR
+ *
+ * Parameters:
+ *   trace_type_t type: Record type
+ *   uint32_t id: Bluetooth event id, external signal mask or trace_isr_t
+ *   uint8_t state_before: State before the handler ran
+ *   uint8_t state_after: State after the handler ran
+ *   uint32_t start_cycles: traceCycles() value taken at handler entry
+ *   uint32_t start_ticks: LETIMER0 tick count taken at handler entry
+ *
+ * Returns:
+ *   None
+ */
+void traceRecord(trace_type_t type, uint32_t id, uint8_t state_before, uint8_t state_after, uint32_t start_cycles, uint32_t start_ticks);
+
+
+/*
+ * Starts printing the records held in the ring to VCOM, one hex encoded record per line. The records
+ * are printed TRACE_DUMP_CHUNK at a time from the trace soft timer so the event loop is never held up
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void traceDump();
+
+
+/*
+ * Serves the trace characteristic: user reads stream records, user writes take a TRACE_CMD_* command.
+ * Both need an encrypted link. Also paces a VCOM dump on the trace soft timer
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: Bluetooth events
+ *
+ * Returns:
+ *   None
+ */
+void trace_handle_ble_event(sl_bt_msg_t *evt);
+
+#else
+
+static inline void traceInit() {}
+static inline uint32_t traceCycles() { return 0; }
+static inline uint8_t traceState() { return TRACE_STATE_NONE; }
+static inline void traceRecord(trace_type_t type, uint32_t id, uint8_t state_before, uint8_t state_after, uint32_t start_cycles, uint32_t start_ticks)
+{
+  (void)type; (void)id; (void)state_before; (void)state_after; (void)start_cycles; (void)start_ticks;
+}
+static inline void traceDump() {}
+static inline void trace_handle_ble_event(sl_bt_msg_t *evt) { (void)evt; }
+
+#endif   //TRACE_ENABLE
+
+
+/*
+ * Marks the entry of a handler and records it on exit. Both expand to nothing when the recorder is compiled out
+ */
+#if TRACE_ENABLE
+#define TRACE_ENTER() \
+  uint32_t trace_start_cycles = traceCycles(); \
+  uint32_t trace_start_ticks = (uint32_t)letimerTicks(); \
+  uint8_t trace_state_before = traceState()
+
+#define TRACE_EXIT(type, id) \
+  traceRecord((type), (id), trace_state_before, traceState(), trace_start_cycles, trace_start_ticks)
+#else
+#define TRACE_ENTER()
+#define TRACE_EXIT(type, id)
+#endif
+
+#endif   //TRACE_H
@@ -0,0 +1,254 @@
+/**
+ * @file    :   tx_power.c
+ * @brief   :   API for the TX power control
+ *
+ *              Live links are left to LE Power Control once the golden range is set. The PA table is
+ *              built once at boot with RAIL_ConvertDbmToRaw() from the curves in pa_conversions_efr32.c,
+ *              keeping only the candidates that land on a different PA level, so each advertising step
+ *              is a real change at the antenna and adjusting it is an index step with no curve
+ *              evaluation. The advertising set takes its own power, the radio keeps its full range.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include "src/tx_power.h"
+#include "ble_device_type.h"
+
+#if TX_POWER_CONTROL_ENABLE
+#include "src/conn_param.h"
+
+// Include logging specifically for this .c file
+#define INCLUDE_LOG_DEBUG 1
+#include "src/log.h"
+
+//Lower and upper RSSI of the golden range for a receiver sensitivity
+#define TX_POWER_GOLDEN_MIN(sensitivity) ((sensitivity) + TX_POWER_MARGIN_DB)
+#define TX_POWER_GOLDEN_MAX(sensitivity) ((sensitivity) + TX_POWER_MARGIN_DB + TX_POWER_HYSTERESIS_DB)
+
+
+/*
+ * Sets the golden range LE Power Control holds the peer's signal in, both roles
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void txPowerControlBoot(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  const int8_t golden_range[] =
+  {
+    TX_POWER_GOLDEN_MIN(TX_POWER_SENSITIVITY_1M), TX_POWER_GOLDEN_MAX(TX_POWER_SENSITIVITY_1M),
+    TX_POWER_GOLDEN_MIN(TX_POWER_SENSITIVITY_2M), TX_POWER_GOLDEN_MAX(TX_POWER_SENSITIVITY_2M),
+    TX_POWER_GOLDEN_MIN(TX_POWER_SENSITIVITY_CODED_S8), TX_POWER_GOLDEN_MAX(TX_POWER_SENSITIVITY_CODED_S8),
+    TX_POWER_GOLDEN_MIN(TX_POWER_SENSITIVITY_CODED_S2), TX_POWER_GOLDEN_MAX(TX_POWER_SENSITIVITY_CODED_S2),
+  };
+
+  (void)evt;
+
+  error_status = sl_bt_system_linklayer_configure(sl_bt_system_linklayer_config_key_power_control_golden_range,
+                                                  sizeof(golden_range), (const uint8_t *)golden_range);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError setting the power control golden range: 0x%04x\r\n", (unsigned int)error_status);
+}
+
+#endif   //TX_POWER_CONTROL_ENABLE
+
+
+#if BUILD_INCLUDES_BLE_SERVER && TX_POWER_CONTROL_ENABLE
+#include "rail.h"
+#include "pa_conversions_efr32.h"
+#include "src/server_conn.h"
+
+//One level of the PA table
+typedef struct
+{
+  int16_t power_ddbm;               //Radiated power of the level in 0.1 dBm
+  uint8_t raw;                      //PA power level it maps to
+}tx_power_level_t;
+
+static struct
+{
+  tx_power_level_t table[TX_POWER_TABLE_MAX];     //Highest power first
+  uint8_t count;
+  uint8_t level;                    //Index in table of the level learned for the fast advertising step
+  bool is_proposed;                 //A link closed since the fast advertising step last started
+}tx_power;
+
+
+/*
+ * Prints a power in 0.1 dBm as dBm with one decimal
+ *
+ * Parameters:
+ *   const char *what: What runs at the power
+ *   int16_t power_ddbm: Power in 0.1 dBm
+ *
+ * Returns:
+ *   None
+ */
+static void tx_power_log(const char *what, int16_t power_ddbm)
+{
+  LOG_INFO("\r\n%s TX power %d.%d dBm\r\n", what, power_ddbm / 10, (power_ddbm < 0) ? -(power_ddbm % 10) : power_ddbm % 10);
+}
+
+
+/*
+ * Builds the PA table from the PA conversion curves for the advertising power
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void txPowerBoot(sl_bt_msg_t *evt)
+{
+  RAIL_TxPowerMode_t mode = sl_rail_util_pa_get_tx_power_config_2p4ghz()->mode;
+  RAIL_TxPowerLevel_t raw;
+
+  (void)evt;
+
+  //The stack has loaded the PA curves by the boot event
+  tx_power.count = 0;
+  for(int32_t power = SL_BT_CONFIG_MAX_TX_POWER; (power >= SL_BT_CONFIG_MIN_TX_POWER) && (tx_power.count < TX_POWER_TABLE_MAX); power -= TX_POWER_STEP_DDBM)
+    {
+      raw = RAIL_ConvertDbmToRaw(RAIL_EFR32_HANDLE, mode, power);
+      if((tx_power.count != 0) && (raw == tx_power.table[tx_power.count - 1].raw))
+        continue;
+
+      tx_power.table[tx_power.count].raw = raw;
+      tx_power.table[tx_power.count].power_ddbm = RAIL_ConvertRawToDbm(RAIL_EFR32_HANDLE, mode, raw);
+      tx_power.count++;
+    }
+
+  tx_power.level = 0;
+  tx_power.is_proposed = false;
+
+  LOG_INFO("\r\nTX power control: %d PA levels from %d to %d 0.1 dBm\r\n", tx_power.count, tx_power.table[0].power_ddbm,
+           tx_power.table[tx_power.count - 1].power_ddbm);
+}
+
+
+/*
+ * Returns the level of the table nearest above a power, so a level taken from it never runs weaker
+ *
+ * Parameters:
+ *   int16_t power_ddbm: Power in 0.1 dBm
+ *
+ * Returns:
+ *   int32_t: Index in table
+ */
+static int32_t tx_power_level_of(int16_t power_ddbm)
+{
+  int32_t level = 0;
+
+  while(((level + 1) < tx_power.count) && (tx_power.table[level + 1].power_ddbm >= power_ddbm))
+    level++;
+
+  return level;
+}
+
+
+/*
+ * Reads the power LE Power Control holds a link at, with each RSSI sample of the link
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_rssi_id
+ *
+ * Returns:
+ *   None
+ */
+void txPowerRssi(sl_bt_msg_t *evt)
+{
+  sl_status_t error_status;
+  server_conn_t *ctx = serverConnFromEvent(evt);
+  int8_t current_dbm;
+  int8_t max_dbm;
+
+  if(ctx == NULL)
+    return;
+
+  //CONN_PARAM_PHY_* are the sl_bt_gap_phy_coding_t values of the uncoded PHYs and of Coded S=8
+  error_status = sl_bt_connection_get_tx_power(ctx->connection, connParamPhy(ctx->connection), &current_dbm, &max_dbm);
+  if(error_status != SL_STATUS_OK)
+    LOG_ERROR("\r\nError reading the connection TX power: 0x%04x\r\n", (unsigned int)error_status);
+  else if(current_dbm != SL_BT_CONNECTION_TX_POWER_UNAVAILABLE)
+    ctx->tx_power_ddbm = current_dbm * 10;
+}
+
+
+/*
+ * Takes the proposal of a closing link for the level of the fast advertising step, called before its context is freed
+ *
+ * Parameters:
+ *   struct server_conn *ctx: Context of the closing link
+ *   uint16_t reason: Close reason from sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void txPowerLinkClosed(struct server_conn *ctx, uint16_t reason)
+{
+  int32_t level;                                                //Index 0 is the highest power
+
+  if((ctx == NULL) || (tx_power.count == 0))
+    return;
+
+  if((reason == SL_STATUS_BT_CTRL_CONNECTION_TIMEOUT) || (ctx->tx_power_ddbm == TX_POWER_UNKNOWN_DDBM))
+    level = 0;                                                  //The link was lost or never reported, start over from the maximum
+
+  else
+    {
+      level = tx_power_level_of(ctx->tx_power_ddbm);            //Where power control held the link
+      if(ctx->link.timeouts_total != 0)
+        level -= TX_POWER_TIMEOUT_STEPS;
+    }
+
+  if(level < 0)
+    level = 0;
+
+  //Every link that closed since the last fast step has to agree, the highest power asked for wins
+  if((tx_power.is_proposed == false) || (level < tx_power.level))
+    tx_power.level = level;
+  tx_power.is_proposed = true;
+}
+
+
+/*
+ * Sets the power of the advertising set before advertising starts. The set must not be advertising
+ *
+ * Parameters:
+ *   uint8_t handle: Advertising set handle
+ *   bool is_fast: The fast step, which runs at the learned level, the later steps run at the maximum
+ *
+ * Returns:
+ *   None
+ */
+void txPowerAdvertise(uint8_t handle, bool is_fast)
+{
+  sl_status_t error_status;
+  int16_t set_power;
+  uint8_t level = (is_fast == true) ? tx_power.level : 0;
+
+  if(tx_power.count == 0)
+    return;
+
+  if(is_fast == true)
+    tx_power.is_proposed = false;
+
+  //Takes effect when the set starts
+  error_status = sl_bt_advertiser_set_tx_power(handle, tx_power.table[level].power_ddbm, &set_power);
+  if(error_status != SL_STATUS_OK)
+    {
+      LOG_ERROR("\r\nError setting the advertising TX power: 0x%04x\r\n", (unsigned int)error_status);
+      return;
+    }
+
+  tx_power_log("Advertising", set_power);
+}
+
+#endif   //BUILD_INCLUDES_BLE_SERVER && TX_POWER_CONTROL_ENABLE
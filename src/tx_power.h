@@ -0,0 +1,136 @@
+/**
+ * @file    :   tx_power.h
+ * @brief   :   Headers and function definitions for the TX power control
+ *
+ *              Live links run LE Power Control (bluetooth_feature_power_control): each side asks the
+ *              other to step its power down while the RSSI it receives is above the golden range and
+ *              back up as soon as it falls below, so the power follows the link while it is open. Both
+ *              roles set the golden range at boot, the client's range is what steers the server's power.
+ *              The controller acts on RSSI only: a missed indication confirmation does not raise the
+ *              power of the live link, the link raises it once the signal that caused the miss drops
+ *              below the range, and an ATT timeout ends the link. The radio keeps the full range from
+ *              SL_BT_CONFIG_MIN_TX_POWER to SL_BT_CONFIG_MAX_TX_POWER so the controller can always go
+ *              back up.
+ *
+ *              Advertising has no peer to steer it, so each server link proposes, as it closes, the level
+ *              the fast advertising step runs at: the level power control held it at, two steps up after
+ *              a missed indication confirmation and the maximum after a supervision timeout. The later
+ *              advertising steps run at the maximum to stay discoverable.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef TX_POWER_H
+#define TX_POWER_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "sl_bt_api.h"
+#include "sl_bluetooth_config.h"
+
+//Set to 0 to advertise at the configured maximum and leave live links on the stack's default golden range
+#define TX_POWER_CONTROL_ENABLE (1)
+
+//Candidate levels of the PA table in 0.1 dBm, SL_BT_CONFIG_MAX_TX_POWER down to SL_BT_CONFIG_MIN_TX_POWER in 1 dB steps.
+//Candidates the PA cannot tell apart are merged when the table is built
+#define TX_POWER_STEP_DDBM (10)
+#define TX_POWER_TABLE_MAX (((SL_BT_CONFIG_MAX_TX_POWER - SL_BT_CONFIG_MIN_TX_POWER) / TX_POWER_STEP_DDBM) + 1)
+
+//Receiver sensitivity in dBm per PHY, from the EFR32BG13 data sheet
+#define TX_POWER_SENSITIVITY_1M (-94)
+#define TX_POWER_SENSITIVITY_2M (-91)
+#define TX_POWER_SENSITIVITY_CODED_S8 (-102)
+#define TX_POWER_SENSITIVITY_CODED_S2 (-97)
+
+//Golden range of the received RSSI: the margin over the sensitivity a link has to keep in dB, and the width above it
+//the peer holds its power in. The peer steps down above the margin plus the hysteresis and up below the margin
+#define TX_POWER_MARGIN_DB (20)
+#define TX_POWER_HYSTERESIS_DB (6)
+
+//Steps up after a missed indication confirmation, for the fast advertising step
+#define TX_POWER_TIMEOUT_STEPS (2)
+
+//Link power before the stack has reported one
+#define TX_POWER_UNKNOWN_DDBM (INT16_MIN)
+
+//server_conn_t, declared here because src/server_conn.h includes src/scheduler.h
+struct server_conn;
+
+
+#if TX_POWER_CONTROL_ENABLE
+
+/*
+ * Sets the golden range LE Power Control holds the peer's signal in, both roles
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void txPowerControlBoot(sl_bt_msg_t *evt);
+
+
+/*
+ * Builds the PA table from the PA conversion curves for the advertising power
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_system_boot_id
+ *
+ * Returns:
+ *   None
+ */
+void txPowerBoot(sl_bt_msg_t *evt);
+
+
+/*
+ * Reads the power LE Power Control holds a link at, with each RSSI sample of the link
+ *
+ * Parameters:
+ *   sl_bt_msg_t event: sl_bt_evt_connection_rssi_id
+ *
+ * Returns:
+ *   None
+ */
+void txPowerRssi(sl_bt_msg_t *evt);
+
+
+/*
+ * Takes the proposal of a closing link for the level of the fast advertising step, called before its context is freed
+ *
+ * Parameters:
+ *   struct server_conn *ctx: Context of the closing link
+ *   uint16_t reason: Close reason from sl_bt_evt_connection_closed_id
+ *
+ * Returns:
+ *   None
+ */
+void txPowerLinkClosed(struct server_conn *ctx, uint16_t reason);
+
+
+/*
+ * Sets the power of the advertising set before advertising starts. The set must not be advertising
+ *
+ * Parameters:
+ *   uint8_t handle: Advertising set handle
+ *   bool is_fast: The fast step, which runs at the learned level, the later steps run at the maximum
+ *
+ * Returns:
+ *   None
+ */
+void txPowerAdvertise(uint8_t handle, bool is_fast);
+
+#else
+
+static inline void txPowerControlBoot(sl_bt_msg_t *evt) { (void)evt; }
+static inline void txPowerBoot(sl_bt_msg_t *evt) { (void)evt; }
+static inline void txPowerRssi(sl_bt_msg_t *evt) { (void)evt; }
+static inline void txPowerLinkClosed(struct server_conn *ctx, uint16_t reason) { (void)ctx; (void)reason; }
+static inline void txPowerAdvertise(uint8_t handle, bool is_fast) { (void)handle; (void)is_fast; }
+
+#endif   //TX_POWER_CONTROL_ENABLE
+
+
+#endif   //TX_POWER_H
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+gateway_ingest.py - Decoder for the binary frames a client sends over VCOM in
+gateway mode (GATEWAY_ENABLE in src/gateway.h)
+
+Input is the VCOM port (needs pyserial), a capture file, or - for stdin. The
+decoder resynchronises on the sync byte and the CRC, so a capture may start
+mid frame. Frames are written as CSV or JSON lines, log frames included.
+Sequence gaps are frames the client dropped because its transmit ring was
+full, they are counted in the summary printed to stderr at the end.
+
+Frame, little endian:
+  sync 0xA5, payload length, type, seq, time_ms (uint32), payload,
+  CRC-16/CCITT-FALSE of length..payload (uint16)
+
+Usage:
+  gateway_ingest.py /dev/ttyACM0 --port --format json
+  gateway_ingest.py capture.bin --output samples.csv
+"""
+
+import argparse
+import binascii
+import csv
+import json
+import struct
+import sys
+
+SYNC = 0xA5
+HEADER = struct.Struct("<BBBBI")
+CRC = struct.Struct("<H")
+
+FRAME_SAMPLE = 1
+FRAME_LINK = 2
+FRAME_STATS = 3
+FRAME_LOG = 4
+
+SAMPLE = struct.Struct("<BBhI")
+LINK = struct.Struct("<BBB6sH")
+STATS = struct.Struct("<BBBhhhiI")
+
+LINK_EVENTS = {1: "opened", 2: "closed"}
+
+COLUMNS = ["time_ms", "seq", "type", "server", "connection", "temp_c", "samples",
+           "event", "address", "reason", "count", "latest_c", "min_c", "max_c",
+           "mean_c", "variance", "text"]
+
+
+def decode_payload(ftype, payload):
+    """Returns the fields of one frame payload, None for an unknown type or length"""
+    if ftype == FRAME_SAMPLE and len(payload) == SAMPLE.size:
+        server, connection, temp_c, samples = SAMPLE.unpack(payload)
+        return {"type": "sample", "server": server, "connection": connection,
+                "temp_c": temp_c, "samples": samples}
+    if ftype == FRAME_LINK and len(payload) == LINK.size:
+        event, server, connection, address, reason = LINK.unpack(payload)
+        return {"type": "link", "event": LINK_EVENTS.get(event, str(event)),
+                "server": None if server == 0xFF else server, "connection": connection,
+                "address": ":".join("%02x" % b for b in reversed(address)),
+                "reason": "0x%04x" % reason}
+    if ftype == FRAME_STATS and len(payload) == STATS.size:
+        server, connection, count, latest, vmin, vmax, mean_x10, var_x100 = STATS.unpack(payload)
+        return {"type": "stats", "server": server, "connection": connection, "count": count,
+                "latest_c": latest, "min_c": vmin, "max_c": vmax,
+                "mean_c": mean_x10 / 10.0, "variance": var_x100 / 100.0}
+    if ftype == FRAME_LOG:
+        return {"type": "log", "text": payload.decode("ascii", errors="replace")}
+    return None
+
+
+class Decoder:
+    """Splits a byte stream into frames, dropping bytes that do not start a frame with a good CRC"""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.frames = 0
+        self.crc_errors = 0
+        self.skipped = 0
+        self.lost = 0
+        self.last_seq = None
+
+    def feed(self, data):
+        self.buffer += data
+        buf = self.buffer
+        pos = 0
+        end = len(buf)
+
+        while True:
+            start = buf.find(SYNC, pos)
+            if start < 0:
+                self.skipped += end - pos
+                pos = end
+                break
+            self.skipped += start - pos
+            pos = start
+
+            if end - pos < HEADER.size:
+                break
+            length = buf[pos + 1]
+            total = HEADER.size + length + CRC.size
+            if end - pos < total:
+                break
+
+            body = bytes(buf[pos + 1:pos + HEADER.size + length])
+            if binascii.crc_hqx(body, 0xFFFF) != CRC.unpack_from(buf, pos + HEADER.size + length)[0]:
+                # Not a frame, or a damaged one: look for the next sync byte
+                self.crc_errors += 1
+                self.skipped += 1
+                pos += 1
+                continue
+
+            _, _, ftype, seq, time_ms = HEADER.unpack_from(buf, pos)
+            pos += total
+
+            if self.last_seq is not None:
+                self.lost += (seq - self.last_seq - 1) & 0xFF
+            self.last_seq = seq
+            self.frames += 1
+
+            fields = decode_payload(ftype, body[HEADER.size - 1:])
+            if fields is None:
+                fields = {"type": "type%d" % ftype}
+            fields["time_ms"] = time_ms
+            fields["seq"] = seq
+            yield fields
+
+        del buf[:pos]
+
+
+def open_input(args):
+    if args.port:
+        try:
+            import serial
+        except ImportError:
+            sys.exit("--port needs pyserial")
+        return serial.Serial(args.input, args.baud, rtscts=True, timeout=0.1)
+    if args.input == "-":
+        return sys.stdin.buffer
+    return open(args.input, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="serial port with --port, capture file, or - for stdin")
+    parser.add_argument("--port", action="store_true", help="input is a serial port")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--format", choices=["csv", "json"], default="csv")
+    parser.add_argument("--output", help="write here instead of stdout")
+    parser.add_argument("--no-log", action="store_true", help="leave log frames out of the output")
+    args = parser.parse_args()
+
+    source = open_input(args)
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = None
+    if args.format == "csv":
+        writer = csv.DictWriter(out, fieldnames=COLUMNS, extrasaction="ignore")
+        writer.writeheader()
+
+    decoder = Decoder()
+    try:
+        while True:
+            # read1 returns what is available instead of waiting for a full block
+            data = source.read1(65536) if hasattr(source, "read1") else source.read(4096)
+            if not data:
+                if args.port:
+                    continue
+                break
+            for frame in decoder.feed(data):
+                if args.no_log and frame["type"] == "log":
+                    continue
+                if writer:
+                    writer.writerow(frame)
+                else:
+                    out.write(json.dumps(frame) + "\n")
+            if args.port:
+                out.flush()
+    except KeyboardInterrupt:
+        pass
+
+    print("%d frames, %d lost, %d CRC errors, %d bytes skipped" % (
+        decoder.frames, decoder.lost, decoder.crc_errors, decoder.skipped), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,938 @@
+/**
+ * @file    :   hal.c
+ * @brief   :   Host stand-in for the parts of emlib, the board and the platform services the firmware
+ *              calls. The peripherals keep the register behaviour the firmware checks: the LETIMER0
+ *              counts down from COMP0 on the prescaled LFXO and raises UF and COMP1, the push buttons
+ *              raise the GPIO edge interrupts, the Si7021 answers the I2C transfers with the temperature
+ *              the driver sets. Interrupt handlers run at the virtual time their flag is raised, between
+ *              two stack events like on the target.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "host.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_letimer.h"
+#include "em_i2c.h"
+#include "sl_i2cspm.h"
+#include "sl_power_manager.h"
+#include "glib.h"
+#include "dmd.h"
+#include "rail.h"
+#include "pa_conversions_efr32.h"
+#include "btl_interface.h"
+#include "sl_memlcd_display.h"
+#include "gatt_db.h"
+#include "src/profile.h"
+
+//Interrupt handlers of the firmware, src/irq.c
+void LETIMER0_IRQHandler(void);
+void I2C0_IRQHandler(void);
+void GPIO_EVEN_IRQHandler(void);
+void GPIO_ODD_IRQHandler(void);
+
+#define HAL_LFXO_HZ (32768)
+#define HAL_ULFRCO_HZ (1000)
+#define HAL_I2C_BIT_US (10)                 //Standard mode, 100 kHz
+#define HAL_I2C_BYTE_BITS (9)               //Eight data bits and the acknowledge
+#define HAL_BUTTON_PORT (gpioPortF)
+#define HAL_BUTTON0_PIN (6)                 //PB0
+#define HAL_BUTTON1_PIN (7)                 //PB1
+#define HAL_GPIO_PINS (16)
+#define HAL_GPIO_EVEN_MASK (0x55555555UL)
+#define HAL_DISPLAY_LINES (SL_MEMLCD_DISPLAY_HEIGHT / 8)
+#define HAL_DISPLAY_COLUMNS (32)
+#define HAL_IRQ_RUN_MAX (64)                //Handler calls in one run before the flags are taken as stuck
+#define HAL_PA_MAX_RAW (252)                //Highest level of the 2.4 GHz high power PA
+#define HAL_PA_MAX_DDBM (100)               //Output power at the highest level
+
+LETIMER_TypeDef host_letimer0;
+I2C_TypeDef host_i2c0;
+DWT_Type host_dwt;
+CoreDebug_Type host_core_debug;
+const GLIB_Font_t GLIB_FontNarrow6x8;
+
+static bool irq_enabled[HOST_IRQn_COUNT];
+
+//Clock tree
+static struct
+{
+  CMU_Select_TypeDef lfa_select;
+  uint32_t letimer_div;
+}cmu;
+
+//LETIMER0, ticks are counted from the enable
+static struct
+{
+  bool running;
+  uint64_t start_us;
+  uint64_t synced;                    //Last tick the flags are raised up to
+  uint64_t last_uf_us;                //Time of the last underflow
+}letimer;
+
+//GPIO, one external interrupt line per pin number
+static struct
+{
+  uint8_t level[HOST_GPIO_PORT_COUNT][HAL_GPIO_PINS];
+  struct
+  {
+    bool configured;
+    GPIO_Port_TypeDef port;
+    bool rising;
+    bool falling;
+  }ext[HAL_GPIO_PINS];
+  uint32_t flags;
+  uint32_t enabled;
+}gpio;
+
+//I2C0 with the Si7021 on the bus
+static struct
+{
+  I2C_TransferSeq_TypeDef *seq;
+  uint64_t done_us;
+  double temperature_c;
+  uint32_t samples;
+}i2c;
+
+//Power manager requirements and the time they held the MCU out of EM2
+static struct
+{
+  uint32_t em1_requests;
+  uint64_t em1_since_us;
+  uint64_t em1_us;
+}power;
+
+static char display_lines[HAL_DISPLAY_LINES][HAL_DISPLAY_COLUMNS + 1];
+static uint8_t display_frame[(SL_MEMLCD_DISPLAY_WIDTH * SL_MEMLCD_DISPLAY_HEIGHT * SL_MEMLCD_DISPLAY_BPP) / 8];
+static RAIL_TxPowerConfig_t pa_config = { .mode = RAIL_TX_POWER_MODE_2P4_HP, .voltage = 3300, .rampTime = 10 };
+
+
+/*
+ * Sets up the board, the buttons rest high through their pull-ups
+ *
+ * Parameters:
+ *   bool hold_button1: PB1 is held through reset, it picks the other role of a dual build
+ *   double temperature_c: Temperature the Si7021 reads
+ *
+ * Returns:
+ *   None
+ */
+void halInit(bool hold_button1, double temperature_c)
+{
+  memset(gpio.level, 1, sizeof(gpio.level));
+  gpio.level[HAL_BUTTON_PORT][HAL_BUTTON1_PIN] = (hold_button1 == true) ? 0 : 1;
+  cmu.lfa_select = cmuSelect_Disabled;
+  cmu.letimer_div = 1;
+  i2c.temperature_c = temperature_c;
+}
+
+
+/*
+ * Returns the LETIMER0 counter clock
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint32_t frequency: Hz
+ */
+static uint32_t hal_letimer_freq()
+{
+  uint32_t lfa = (cmu.lfa_select == cmuSelect_ULFRCO) ? HAL_ULFRCO_HZ : HAL_LFXO_HZ;
+
+  return lfa / cmu.letimer_div;
+}
+
+
+/*
+ * Returns the number of LETIMER0 ticks since the enable at a time
+ *
+ * Parameters:
+ *   uint64_t time_us: Virtual time
+ *
+ * Returns:
+ *   uint64_t ticks
+ */
+static uint64_t hal_letimer_ticks(uint64_t time_us)
+{
+  return ((time_us - letimer.start_us) * hal_letimer_freq()) / 1000000ULL;
+}
+
+
+/*
+ * Returns the time of a LETIMER0 tick
+ *
+ * Parameters:
+ *   uint64_t tick: Ticks since the enable
+ *
+ * Returns:
+ *   uint64_t time_us: First virtual microsecond the tick has happened at
+ */
+static uint64_t hal_letimer_time(uint64_t tick)
+{
+  uint32_t freq = hal_letimer_freq();
+
+  return letimer.start_us + ((tick * 1000000ULL) + freq - 1) / freq;
+}
+
+
+/*
+ * Returns the first tick after another one the counter reaches a value at
+ *
+ * The counter is 0 at the enable, the first tick underflows it to COMP0, so
+ * tick 1 + offset + n * (COMP0 + 1) is where it holds COMP0 - offset.
+ *
+ * Parameters:
+ *   uint64_t after: Tick to search from, exclusive
+ *   uint32_t offset: COMP0 minus the counter value
+ *
+ * Returns:
+ *   uint64_t tick
+ */
+static uint64_t hal_letimer_next(uint64_t after, uint32_t offset)
+{
+  uint64_t period = (uint64_t)LETIMER0->COMP0 + 1;
+  uint64_t base = 1 + offset;
+
+  if(after < base)
+    return base;
+
+  return base + (((after - base) / period) + 1) * period;
+}
+
+
+/*
+ * Raises the LETIMER0 flags of the ticks up to now and applies writes to IFC
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void hal_letimer_sync()
+{
+  uint64_t now;
+  uint64_t tick;
+
+  if(LETIMER0->IFC != 0)                                  //A write to IFC clears and reads back 0
+    {
+      LETIMER0->IF &= ~LETIMER0->IFC;
+      LETIMER0->IFC = 0;
+    }
+
+  if(letimer.running == false)
+    return;
+
+  now = hal_letimer_ticks(host_now_us);
+  if(now <= letimer.synced)
+    return;
+
+  tick = hal_letimer_next(letimer.synced, 0);
+  if(tick <= now)
+    {
+      LETIMER0->IF |= LETIMER_IF_UF;
+      tick += ((now - tick) / ((uint64_t)LETIMER0->COMP0 + 1)) * ((uint64_t)LETIMER0->COMP0 + 1);
+      letimer.last_uf_us = hal_letimer_time(tick);
+    }
+
+  if((LETIMER0->COMP1 <= LETIMER0->COMP0) && (hal_letimer_next(letimer.synced, LETIMER0->COMP0 - LETIMER0->COMP1) <= now))
+    LETIMER0->IF |= LETIMER_IF_COMP1;
+
+  letimer.synced = now;
+  LETIMER0->CNT = (now == 0) ? 0 : LETIMER0->COMP0 - (uint32_t)((now - 1) % ((uint64_t)LETIMER0->COMP0 + 1));
+}
+
+
+/*
+ * Returns the time the next enabled LETIMER0 flag is raised
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t time_us: HOST_NO_DEADLINE with no enabled source
+ */
+static uint64_t hal_letimer_deadline()
+{
+  uint64_t deadline = HOST_NO_DEADLINE;
+  uint64_t time;
+
+  if(letimer.running == false)
+    return deadline;
+
+  if(LETIMER0->IEN & LETIMER_IEN_UF)
+    deadline = hal_letimer_time(hal_letimer_next(letimer.synced, 0));
+
+  if((LETIMER0->IEN & LETIMER_IEN_COMP1) && (LETIMER0->COMP1 <= LETIMER0->COMP0))
+    {
+      time = hal_letimer_time(hal_letimer_next(letimer.synced, LETIMER0->COMP0 - LETIMER0->COMP1));
+      if(time < deadline)
+        deadline = time;
+    }
+
+  return deadline;
+}
+
+
+/*
+ * Returns true while an interrupt is enabled in the NVIC and raised by its peripheral
+ *
+ * Parameters:
+ *   IRQn_Type irq: Interrupt number
+ *
+ * Returns:
+ *   bool
+ */
+static bool hal_irq_ready(IRQn_Type irq)
+{
+  if(irq_enabled[irq] == false)
+    return false;
+
+  switch(irq)
+  {
+    case LETIMER0_IRQn:
+      hal_letimer_sync();
+      return ((LETIMER0->IF & LETIMER0->IEN) != 0);
+
+    case I2C0_IRQn:
+      return ((i2c.seq != NULL) && (host_now_us >= i2c.done_us));
+
+    case GPIO_EVEN_IRQn:
+      return ((gpio.flags & gpio.enabled & HAL_GPIO_EVEN_MASK) != 0);
+
+    case GPIO_ODD_IRQn:
+      return ((gpio.flags & gpio.enabled & ~HAL_GPIO_EVEN_MASK) != 0);
+
+    default:
+      return false;
+  }
+}
+
+
+/*
+ * Returns the earliest time an interrupt is raised
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t time_us: Now with an interrupt pending, HOST_NO_DEADLINE with none ahead
+ */
+uint64_t halNextDeadline()
+{
+  uint64_t deadline = HOST_NO_DEADLINE;
+
+  if(hal_irq_ready(LETIMER0_IRQn) || hal_irq_ready(I2C0_IRQn) || hal_irq_ready(GPIO_EVEN_IRQn) || hal_irq_ready(GPIO_ODD_IRQn))
+    return host_now_us;
+
+  if(irq_enabled[LETIMER0_IRQn] == true)
+    deadline = hal_letimer_deadline();
+
+  if((irq_enabled[I2C0_IRQn] == true) && (i2c.seq != NULL) && (i2c.done_us < deadline))
+    deadline = i2c.done_us;
+
+  return deadline;
+}
+
+
+/*
+ * Runs the handlers of the pending interrupts, lowest number first like the NVIC at equal priority
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void halRun()
+{
+  uint32_t runs = 0;
+  bool ran = true;
+
+  while((ran == true) && (runs < HAL_IRQ_RUN_MAX))
+    {
+      ran = true;
+      halSyncCycles();
+
+      if(hal_irq_ready(GPIO_EVEN_IRQn))
+        GPIO_EVEN_IRQHandler();
+      else if(hal_irq_ready(I2C0_IRQn))
+        I2C0_IRQHandler();
+      else if(hal_irq_ready(GPIO_ODD_IRQn))
+        GPIO_ODD_IRQHandler();
+      else if(hal_irq_ready(LETIMER0_IRQn))
+        LETIMER0_IRQHandler();
+      else
+        ran = false;
+
+      runs++;
+    }
+
+  if(runs == HAL_IRQ_RUN_MAX)
+    fprintf(stderr, "host: interrupt flags not cleared after %u handler calls\n", (unsigned int)runs);
+}
+
+
+/*
+ * Presses or releases a push button
+ *
+ * Parameters:
+ *   unsigned int button: 0 for PB0, 1 for PB1
+ *   bool pressed: The buttons are active low
+ *
+ * Returns:
+ *   None
+ */
+void halButton(unsigned int button, bool pressed)
+{
+  unsigned int pin = (button == 0) ? HAL_BUTTON0_PIN : HAL_BUTTON1_PIN;
+  uint8_t level = (pressed == true) ? 0 : 1;
+
+  if(gpio.level[HAL_BUTTON_PORT][pin] == level)
+    return;
+
+  gpio.level[HAL_BUTTON_PORT][pin] = level;
+
+  if((gpio.ext[pin].configured == true) && (gpio.ext[pin].port == HAL_BUTTON_PORT) &&
+      (((level == 1) && (gpio.ext[pin].rising == true)) || ((level == 0) && (gpio.ext[pin].falling == true))))
+    gpio.flags |= (1UL << pin);
+}
+
+
+/*
+ * Sets the temperature the Si7021 reads from now on
+ *
+ * Parameters:
+ *   double temperature_c
+ *
+ * Returns:
+ *   None
+ */
+void halTemperature(double temperature_c)
+{
+  i2c.temperature_c = temperature_c;
+}
+
+
+#if HOST_REAL_CYCLES
+/*
+ * Reads the DWT registers with CYCCNT counting host nanoseconds, so a probe measures the code between its ends
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   DWT_Type*: The DWT registers
+ */
+DWT_Type *hostDwt()
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  host_dwt.CYCCNT = (uint32_t)(((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec);
+  return &host_dwt;
+}
+#endif
+
+
+/*
+ * Makes the DWT cycle counter follow the virtual time, handlers take no time on the host. Left alone with
+ * HOST_REAL_CYCLES, where it counts host nanoseconds
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void halSyncCycles()
+{
+  if((HOST_REAL_CYCLES == 0) && (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    DWT->CYCCNT = (uint32_t)((host_now_us * (HOST_CORE_CLOCK_HZ / 100000ULL)) / 10ULL);
+}
+
+
+/*
+ * Prints the display and the energy mode totals of the node to stderr
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void halReport()
+{
+  uint64_t em1_us = power.em1_us;
+
+  if(power.em1_requests != 0)
+    em1_us += host_now_us - power.em1_since_us;
+
+  fprintf(stderr, "host: %lu temperature samples, %lu ms held in EM1\n", (unsigned long)i2c.samples, (unsigned long)(em1_us / 1000));
+  if(HOST_REAL_CYCLES == 1)
+    profileDump();                                      //Probe totals of the run in host nanoseconds
+  for(uint32_t line = 0; line < HAL_DISPLAY_LINES; line++)
+    {
+      if(display_lines[line][0] != '\0')
+        fprintf(stderr, "host: lcd %2lu |%s|\n", (unsigned long)line, display_lines[line]);
+    }
+}
+
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  irq_enabled[irq] = true;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+  irq_enabled[irq] = false;
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+bool hostIrqEnabled(IRQn_Type irq)
+{
+  return irq_enabled[irq];
+}
+
+
+void CMU_OscillatorEnable(CMU_Osc_TypeDef osc, bool enable, bool wait)
+{
+  (void)osc;
+  (void)enable;
+  (void)wait;
+}
+
+void CMU_ClockSelectSet(CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref)
+{
+  if(clock == cmuClock_LFA)
+    cmu.lfa_select = ref;
+}
+
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable)
+{
+  (void)clock;
+  (void)enable;
+}
+
+void CMU_ClockDivSet(CMU_Clock_TypeDef clock, CMU_ClkDiv_TypeDef div)
+{
+  if((clock == cmuClock_LETIMER0) && (div != 0))
+    cmu.letimer_div = div;
+}
+
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock)
+{
+  switch(clock)
+  {
+    case cmuClock_LFA:
+      return (cmu.lfa_select == cmuSelect_ULFRCO) ? HAL_ULFRCO_HZ : HAL_LFXO_HZ;
+
+    case cmuClock_LETIMER0:
+      return hal_letimer_freq();
+
+    default:
+      return HOST_CORE_CLOCK_HZ;
+  }
+}
+
+
+void LETIMER_Init(LETIMER_TypeDef *letimer_reg, const LETIMER_Init_TypeDef *init)
+{
+  letimer_reg->CTRL = 0;
+  letimer_reg->IF = 0;
+  letimer_reg->IFC = 0;
+
+  //A top value loads COMP0 and makes it the top, as in emlib of series 1
+  letimer_reg->COMP0 = (init->topValue != 0) ? init->topValue : 0xFFFF;
+
+  LETIMER_Enable(letimer_reg, init->enable);
+}
+
+void LETIMER_Enable(LETIMER_TypeDef *letimer_reg, bool enable)
+{
+  hal_letimer_sync();
+
+  if((enable == true) && (letimer.running == false))
+    {
+      letimer.start_us = host_now_us;
+      letimer.synced = 0;
+      letimer_reg->CNT = 0;
+    }
+  letimer.running = enable;
+}
+
+uint32_t LETIMER_CounterGet(LETIMER_TypeDef *letimer_reg)
+{
+  hal_letimer_sync();
+  return letimer_reg->CNT;
+}
+
+uint32_t LETIMER_CompareGet(LETIMER_TypeDef *letimer_reg, unsigned int comp)
+{
+  return (comp == 0) ? letimer_reg->COMP0 : letimer_reg->COMP1;
+}
+
+void LETIMER_CompareSet(LETIMER_TypeDef *letimer_reg, unsigned int comp, uint32_t value)
+{
+  hal_letimer_sync();                                     //Matches before the write use the old value
+
+  if(comp == 0)
+    letimer_reg->COMP0 = value;
+  else
+    letimer_reg->COMP1 = value;
+}
+
+void LETIMER_IntEnable(LETIMER_TypeDef *letimer_reg, uint32_t flags)
+{
+  hal_letimer_sync();
+  letimer_reg->IEN |= flags;
+}
+
+void LETIMER_IntDisable(LETIMER_TypeDef *letimer_reg, uint32_t flags)
+{
+  hal_letimer_sync();
+  letimer_reg->IEN &= ~flags;
+}
+
+void LETIMER_IntClear(LETIMER_TypeDef *letimer_reg, uint32_t flags)
+{
+  hal_letimer_sync();
+  letimer_reg->IF &= ~flags;
+}
+
+uint32_t LETIMER_IntGet(LETIMER_TypeDef *letimer_reg)
+{
+  hal_letimer_sync();
+  return letimer_reg->IF;
+}
+
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out)
+{
+  //Inputs keep the level the board drives them to, the buttons rest on their pull-ups
+  if(mode == gpioModePushPull)
+    gpio.level[port][pin] = (out != 0) ? 1 : 0;
+}
+
+void GPIO_DriveStrengthSet(GPIO_Port_TypeDef port, GPIO_DriveStrength_TypeDef strength)
+{
+  (void)port;
+  (void)strength;
+}
+
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  gpio.level[port][pin] = 1;
+}
+
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  gpio.level[port][pin] = 0;
+}
+
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin)
+{
+  return gpio.level[port][pin];
+}
+
+void GPIO_ExtIntConfig(GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo, bool risingEdge, bool fallingEdge, bool enable)
+{
+  (void)pin;
+
+  gpio.ext[intNo].configured = true;
+  gpio.ext[intNo].port = port;
+  gpio.ext[intNo].rising = risingEdge;
+  gpio.ext[intNo].falling = fallingEdge;
+  gpio.flags &= ~(1UL << intNo);
+
+  if(enable == true)
+    gpio.enabled |= (1UL << intNo);
+  else
+    gpio.enabled &= ~(1UL << intNo);
+}
+
+void GPIO_IntDisable(uint32_t flags)
+{
+  gpio.enabled &= ~flags;
+}
+
+void GPIO_IntEnable(uint32_t flags)
+{
+  gpio.enabled |= flags;
+}
+
+void GPIO_IntClear(uint32_t flags)
+{
+  gpio.flags &= ~flags;
+}
+
+uint32_t GPIO_IntGet()
+{
+  return gpio.flags;
+}
+
+
+void I2CSPM_Init(I2CSPM_Init_TypeDef *init)
+{
+  (void)init;
+}
+
+void I2C_Enable(I2C_TypeDef *i2c_reg, bool enable)
+{
+  (void)i2c_reg;
+  (void)enable;
+}
+
+I2C_TransferReturn_TypeDef I2C_TransferInit(I2C_TypeDef *i2c_reg, I2C_TransferSeq_TypeDef *seq)
+{
+  (void)i2c_reg;
+
+  if(i2c.seq != NULL)
+    return i2cTransferUsageFault;
+
+  //Start, the address byte, the data bytes and the stop
+  i2c.seq = seq;
+  i2c.done_us = host_now_us + ((uint64_t)(seq->buf[0].len + 1) * HAL_I2C_BYTE_BITS + 2) * HAL_I2C_BIT_US;
+
+  return i2cTransferInProgress;
+}
+
+I2C_TransferReturn_TypeDef I2C_Transfer(I2C_TypeDef *i2c_reg)
+{
+  I2C_TransferSeq_TypeDef *seq = i2c.seq;
+  double code;
+
+  (void)i2c_reg;
+
+  if(seq == NULL)
+    return i2cTransferUsageFault;
+
+  if(host_now_us < i2c.done_us)
+    return i2cTransferInProgress;
+
+  i2c.seq = NULL;
+
+  if(seq->flags & I2C_FLAG_READ)
+    {
+      //Si7021 temperature code, most significant byte first
+      code = ((i2c.temperature_c + 46.85) * 65536.0) / 175.72;
+      if(code < 0)
+        code = 0;
+      if(code > 65535)
+        code = 65535;
+
+      if(seq->buf[0].len >= 2)
+        {
+          seq->buf[0].data[0] = (uint8_t)((uint32_t)code >> 8);
+          seq->buf[0].data[1] = (uint8_t)((uint32_t)code & 0xFC);
+        }
+
+      i2c.samples++;
+      stackSample(i2c.samples);
+      hostPrint("MARK SAMPLE %lu %llu %lu", (unsigned long)i2c.samples, (unsigned long long)letimer.last_uf_us,
+                (unsigned long)stackIndicationsEnabled(gattdb_rgb_state));
+    }
+
+  return i2cTransferDone;
+}
+
+
+void sl_power_manager_add_em_requirement(sl_power_manager_em_t em)
+{
+  if(em != SL_POWER_MANAGER_EM1)
+    return;
+
+  if(power.em1_requests == 0)
+    power.em1_since_us = host_now_us;
+  power.em1_requests++;
+}
+
+void sl_power_manager_remove_em_requirement(sl_power_manager_em_t em)
+{
+  if((em != SL_POWER_MANAGER_EM1) || (power.em1_requests == 0))
+    return;
+
+  power.em1_requests--;
+  if(power.em1_requests == 0)
+    power.em1_us += host_now_us - power.em1_since_us;
+}
+
+void sl_power_manager_sleep()
+{
+}
+
+
+EMSTATUS DMD_init(void *initConfig)
+{
+  (void)initConfig;
+  return DMD_OK;
+}
+
+EMSTATUS DMD_getFrameBuffer(void **framebuffer)
+{
+  *framebuffer = display_frame;
+  return DMD_OK;
+}
+
+EMSTATUS DMD_updateDisplay()
+{
+  return DMD_OK;
+}
+
+EMSTATUS GLIB_contextInit(GLIB_Context_t *pContext)
+{
+  (void)pContext;
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_clear(GLIB_Context_t *pContext)
+{
+  (void)pContext;
+  memset(display_lines, 0, sizeof(display_lines));
+  memset(display_frame, 0, sizeof(display_frame));
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_setFont(GLIB_Context_t *pContext, GLIB_Font_t *pFont)
+{
+  (void)pContext;
+  (void)pFont;
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawStringOnLine(GLIB_Context_t *pContext, const char *pString, uint8_t line, GLIB_Align_t align,
+                               int32_t xOffset, int32_t yOffset, bool opaque)
+{
+  (void)pContext;
+  (void)align;
+  (void)xOffset;
+  (void)yOffset;
+  (void)opaque;
+
+  if(line < HAL_DISPLAY_LINES)
+    snprintf(display_lines[line], sizeof(display_lines[line]), "%s", pString);
+
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawLine(GLIB_Context_t *pContext, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+  (void)pContext;
+  (void)x1;
+  (void)y1;
+  (void)x2;
+  (void)y2;
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawLineV(GLIB_Context_t *pContext, int32_t x1, int32_t y1, int32_t y2)
+{
+  (void)pContext;
+  (void)x1;
+  (void)y1;
+  (void)y2;
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawRectFilled(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect)
+{
+  (void)pContext;
+  (void)pRect;
+  return GLIB_OK;
+}
+
+
+RAIL_TxPowerConfig_t *sl_rail_util_pa_get_tx_power_config_2p4ghz()
+{
+  return &pa_config;
+}
+
+//A curve of the shape of the high power PA, 20 dB per decade of the level, not the calibrated one
+RAIL_TxPowerLevel_t RAIL_ConvertDbmToRaw(RAIL_Handle_t railHandle, RAIL_TxPowerMode_t mode, RAIL_TxPower_t power)
+{
+  double raw = HAL_PA_MAX_RAW * pow(10.0, (power - HAL_PA_MAX_DDBM) / 200.0);
+
+  (void)railHandle;
+  (void)mode;
+
+  if(raw < 1)
+    return 1;
+  if(raw > HAL_PA_MAX_RAW)
+    return HAL_PA_MAX_RAW;
+
+  return (RAIL_TxPowerLevel_t)lround(raw);
+}
+
+RAIL_TxPower_t RAIL_ConvertRawToDbm(RAIL_Handle_t railHandle, RAIL_TxPowerMode_t mode, RAIL_TxPowerLevel_t powerLevel)
+{
+  (void)railHandle;
+  (void)mode;
+
+  if(powerLevel == 0)
+    powerLevel = 1;
+
+  return (RAIL_TxPower_t)lround(HAL_PA_MAX_DDBM + 200.0 * log10((double)powerLevel / HAL_PA_MAX_RAW));
+}
+
+
+//There is no storage slot on the host, OTA is refused when it starts
+int32_t bootloader_init()
+{
+  return BOOTLOADER_OK;
+}
+
+int32_t bootloader_getStorageSlotInfo(uint32_t slotId, BootloaderStorageSlot_t *slot)
+{
+  (void)slotId;
+  (void)slot;
+  return BOOTLOADER_ERROR_STORAGE_INVALID_SLOT;
+}
+
+int32_t bootloader_eraseWriteStorage(uint32_t slotId, uint32_t offset, uint8_t *buffer, size_t length)
+{
+  (void)slotId;
+  (void)offset;
+  (void)buffer;
+  (void)length;
+  return BOOTLOADER_ERROR_STORAGE_INVALID_SLOT;
+}
+
+int32_t bootloader_initVerifyImage(uint32_t slotId, void *context, size_t contextSize)
+{
+  (void)slotId;
+  (void)context;
+  (void)contextSize;
+  return BOOTLOADER_ERROR_STORAGE_INVALID_SLOT;
+}
+
+int32_t bootloader_continueVerifyImage(void *context, BootloaderParserCallback_t metadataCallback)
+{
+  (void)context;
+  (void)metadataCallback;
+  return BOOTLOADER_ERROR_PARSE_FAILED;
+}
+
+int32_t bootloader_setImageToBootload(int32_t slotId)
+{
+  (void)slotId;
+  return BOOTLOADER_ERROR_STORAGE_INVALID_SLOT;
+}
+
+void bootloader_rebootAndInstall()
+{
+  fprintf(stderr, "host: reboot into the bootloader requested\n");
+}
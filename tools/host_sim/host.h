@@ -0,0 +1,49 @@
+/**
+ * @file    :   host.h
+ * @brief   :   Interface between the pieces of the host build of the firmware. hal.c stands in for emlib and
+ *              the board, stack.c for the Bluetooth stack, main.c runs them against the lines of the
+ *              simulation driver on stdin and prints what the node puts on the air to stdout.
+ *
+ *              Time is virtual and only moves when the driver says so. Every deadline of the board and
+ *              the stack is reported back to the driver, which wakes the node for the earliest of them.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_SIM_HOST_H
+#define HOST_SIM_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bt_api.h"
+
+#define HOST_NO_DEADLINE (UINT64_MAX)
+
+//Virtual time of the node in microseconds
+extern uint64_t host_now_us;
+
+void hostPrint(const char *format, ...) __attribute__((format(printf, 1, 2)));
+void hostHex(char *text, const uint8_t *data, size_t len);
+size_t hostUnhex(uint8_t *data, size_t size, const char *text);
+
+void halInit(bool hold_button1, double temperature_c);
+uint64_t halNextDeadline(void);
+void halRun(void);
+void halButton(unsigned int button, bool pressed);
+void halTemperature(double temperature_c);
+void halSyncCycles(void);
+void halReport(void);
+
+void stackInit(const bd_addr *address);
+void stackBoot(void);
+uint64_t stackNextDeadline(void);
+void stackRun(void);
+bool stackPopEvent(sl_bt_msg_t *evt);
+void stackCommand(const char *command, char *args);
+uint32_t stackIndicationsEnabled(uint16_t characteristic);
+void stackSample(uint32_t seq);
+void stackReport(void);
+
+#endif   //HOST_SIM_HOST_H
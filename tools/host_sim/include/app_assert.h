@@ -0,0 +1,26 @@
+/**
+ * @file    :   app_assert.h
+ * @brief   :   Host build stand-in for the application asserts, a failed assert ends the node
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_APP_ASSERT_H
+#define HOST_APP_ASSERT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define app_assert(expr, ...)                   \
+  do {                                          \
+    if (!(expr)) {                              \
+      fprintf(stderr, "Assert failed: " #expr "\n"); \
+      exit(1);                                  \
+    }                                           \
+  } while (0)
+
+#define app_assert_status(sc) app_assert((sc) == SL_STATUS_OK)
+
+#endif   //HOST_APP_ASSERT_H
@@ -0,0 +1,21 @@
+/**
+ * @file    :   app_log.h
+ * @brief   :   Host build stand-in for the VCOM log, the log of a node goes to its stderr. stdout carries
+ *              the lines to the simulation driver
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_APP_LOG_H
+#define HOST_APP_LOG_H
+
+#include <stdio.h>
+
+#define app_log(...) fprintf(stderr, __VA_ARGS__)
+#define app_log_info(...) fprintf(stderr, __VA_ARGS__)
+#define app_log_warning(...) fprintf(stderr, __VA_ARGS__)
+#define app_log_error(...) fprintf(stderr, __VA_ARGS__)
+
+#endif   //HOST_APP_LOG_H
@@ -0,0 +1,37 @@
+/**
+ * @file    :   btl_interface.h
+ * @brief   :   Host build stand-in for the application interface of the Gecko bootloader. A node has no
+ *              storage slot, so bootloader_init() fails and the OTA service refuses images like on a
+ *              board flashed without a bootloader
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_BTL_INTERFACE_H
+#define HOST_BTL_INTERFACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "btl_errorcode.h"
+
+#define BOOTLOADER_STORAGE_VERIFICATION_CONTEXT_SIZE (384)
+
+typedef struct
+{
+  uint32_t address;
+  uint32_t length;
+} BootloaderStorageSlot_t;
+
+typedef void (*BootloaderParserCallback_t)(uint32_t address, uint8_t *data, size_t length, void *context);
+
+int32_t bootloader_init(void);
+int32_t bootloader_getStorageSlotInfo(uint32_t slotId, BootloaderStorageSlot_t *slot);
+int32_t bootloader_eraseWriteStorage(uint32_t slotId, uint32_t offset, uint8_t *buffer, size_t length);
+int32_t bootloader_initVerifyImage(uint32_t slotId, void *context, size_t contextSize);
+int32_t bootloader_continueVerifyImage(void *context, BootloaderParserCallback_t metadataCallback);
+int32_t bootloader_setImageToBootload(int32_t slotId);
+void bootloader_rebootAndInstall(void);
+
+#endif   //HOST_BTL_INTERFACE_H
@@ -0,0 +1,21 @@
+/**
+ * @file    :   dmd.h
+ * @brief   :   Host build stand-in for the dot matrix display driver, a framebuffer in RAM
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_DMD_H
+#define HOST_DMD_H
+
+#include "glib.h"
+
+#define DMD_OK (0)
+
+EMSTATUS DMD_init(void *initConfig);
+EMSTATUS DMD_getFrameBuffer(void **framebuffer);
+EMSTATUS DMD_updateDisplay(void);
+
+#endif   //HOST_DMD_H
@@ -0,0 +1,59 @@
+/**
+ * @file    :   em_cmu.h
+ * @brief   :   Host build stand-in for the emlib clock management unit
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_EM_CMU_H
+#define HOST_EM_CMU_H
+
+#include "em_device.h"
+#include "em_gpio.h"
+#include "em_common.h"
+
+//Core clock of the target, the HFXO
+#define HOST_CORE_CLOCK_HZ (38400000UL)
+
+typedef enum
+{
+  cmuClock_CORE,
+  cmuClock_HF,
+  cmuClock_LFA,
+  cmuClock_LFB,
+  cmuClock_LETIMER0,
+  cmuClock_GPIO,
+  cmuClock_I2C0,
+  cmuClock_USART0,
+  cmuClock_LDMA,
+} CMU_Clock_TypeDef;
+
+typedef enum
+{
+  cmuOsc_LFXO,
+  cmuOsc_LFRCO,
+  cmuOsc_ULFRCO,
+  cmuOsc_HFXO,
+  cmuOsc_HFRCO,
+} CMU_Osc_TypeDef;
+
+typedef enum
+{
+  cmuSelect_Disabled,
+  cmuSelect_LFXO,
+  cmuSelect_LFRCO,
+  cmuSelect_ULFRCO,
+  cmuSelect_HFXO,
+} CMU_Select_TypeDef;
+
+typedef uint32_t CMU_ClkDiv_TypeDef;
+
+void CMU_OscillatorEnable(CMU_Osc_TypeDef osc, bool enable, bool wait);
+void CMU_ClockSelectSet(CMU_Clock_TypeDef clock, CMU_Select_TypeDef ref);
+void CMU_ClockEnable(CMU_Clock_TypeDef clock, bool enable);
+void CMU_ClockDivSet(CMU_Clock_TypeDef clock, CMU_ClkDiv_TypeDef div);
+uint32_t CMU_ClockFreqGet(CMU_Clock_TypeDef clock);
+
+#endif   //HOST_EM_CMU_H
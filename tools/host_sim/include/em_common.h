@@ -0,0 +1,27 @@
+/**
+ * @file    :   em_common.h
+ * @brief   :   Host build stand-in for the emlib common macros
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_EM_COMMON_H
+#define HOST_EM_COMMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SL_WEAK __attribute__((weak))
+#define SL_PACK_START(x)
+#define SL_PACK_END()
+#define SL_ATTRIBUTE_PACKED __attribute__((packed))
+#define SL_ALIGN(x)
+#define SL_ATTRIBUTE_ALIGN(x) __attribute__((aligned(x)))
+#define SL_MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define SL_MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+#define EFM_ASSERT(expr) ((void)(expr))
+
+#endif   //HOST_EM_COMMON_H
@@ -0,0 +1,25 @@
+/**
+ * @file    :   em_core.h
+ * @brief   :   Host build stand-in for the emlib critical sections, a node runs its interrupts and events on one thread
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_EM_CORE_H
+#define HOST_EM_CORE_H
+
+#include "em_device.h"
+
+typedef uint32_t CORE_irqState_t;
+
+#define CORE_DECLARE_IRQ_STATE        CORE_irqState_t irqState = 0
+#define CORE_ENTER_CRITICAL()         ((void)irqState)
+#define CORE_EXIT_CRITICAL()          ((void)irqState)
+#define CORE_ENTER_ATOMIC()           ((void)irqState)
+#define CORE_EXIT_ATOMIC()            ((void)irqState)
+#define CORE_CRITICAL_SECTION(yourcode) { yourcode }
+#define CORE_ATOMIC_SECTION(yourcode) { yourcode }
+
+#endif   //HOST_EM_CORE_H
@@ -0,0 +1,68 @@
+/**
+ * @file    :   em_device.h
+ * @brief   :   Host build stand-in for the EFR32BG13 device header: interrupt numbers, NVIC and the DWT cycle counter
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_EM_DEVICE_H
+#define HOST_EM_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "em_common.h"
+
+//Interrupt numbers of the EFR32BG13P, the ones the firmware enables
+typedef enum
+{
+  LDMA_IRQn = 9,
+  GPIO_EVEN_IRQn = 10,
+  USART0_TX_IRQn = 13,
+  I2C0_IRQn = 17,
+  GPIO_ODD_IRQn = 18,
+  LETIMER0_IRQn = 27,
+  HOST_IRQn_COUNT = 32
+} IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+bool hostIrqEnabled(IRQn_Type irq);
+
+//Set to 1, make HOST_REAL_CYCLES=1, to have CYCCNT count host nanoseconds so the profiling probes time the firmware code
+#ifndef HOST_REAL_CYCLES
+#define HOST_REAL_CYCLES (0)
+#endif
+
+//DWT and CoreDebug registers the profiler and trace use, CYCCNT follows the virtual clock
+typedef struct
+{
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type host_dwt;
+extern CoreDebug_Type host_core_debug;
+
+#if HOST_REAL_CYCLES
+DWT_Type *hostDwt(void);
+#define DWT (hostDwt())
+#else
+#define DWT (&host_dwt)
+#endif
+#define CoreDebug (&host_core_debug)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+
+#define __BKPT(value) ((void)(value))
+#define __NOP()
+#define __INLINE inline
+
+#endif   //HOST_EM_DEVICE_H
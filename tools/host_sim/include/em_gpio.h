@@ -0,0 +1,55 @@
+/**
+ * @file    :   em_gpio.h
+ * @brief   :   Host build stand-in for the emlib GPIO driver, push buttons are pressed by the driver of the simulation
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_EM_GPIO_H
+#define HOST_EM_GPIO_H
+
+#include "em_device.h"
+
+typedef enum
+{
+  gpioPortA,
+  gpioPortB,
+  gpioPortC,
+  gpioPortD,
+  gpioPortE,
+  gpioPortF,
+  HOST_GPIO_PORT_COUNT
+} GPIO_Port_TypeDef;
+
+typedef enum
+{
+  gpioModeDisabled,
+  gpioModeInput,
+  gpioModeInputPull,
+  gpioModeInputPullFilter,
+  gpioModePushPull,
+  gpioModeWiredAnd,
+} GPIO_Mode_TypeDef;
+
+typedef enum
+{
+  gpioDriveStrengthWeakAlternateWeak,
+  gpioDriveStrengthWeakAlternateStrong,
+  gpioDriveStrengthStrongAlternateWeak,
+  gpioDriveStrengthStrongAlternateStrong,
+} GPIO_DriveStrength_TypeDef;
+
+void GPIO_PinModeSet(GPIO_Port_TypeDef port, unsigned int pin, GPIO_Mode_TypeDef mode, unsigned int out);
+void GPIO_DriveStrengthSet(GPIO_Port_TypeDef port, GPIO_DriveStrength_TypeDef strength);
+void GPIO_PinOutSet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_PinOutClear(GPIO_Port_TypeDef port, unsigned int pin);
+unsigned int GPIO_PinInGet(GPIO_Port_TypeDef port, unsigned int pin);
+void GPIO_ExtIntConfig(GPIO_Port_TypeDef port, unsigned int pin, unsigned int intNo, bool risingEdge, bool fallingEdge, bool enable);
+void GPIO_IntDisable(uint32_t flags);
+void GPIO_IntEnable(uint32_t flags);
+void GPIO_IntClear(uint32_t flags);
+uint32_t GPIO_IntGet(void);
+
+#endif   //HOST_EM_GPIO_H
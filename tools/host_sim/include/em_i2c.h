@@ -0,0 +1,63 @@
+/**
+ * @file    :   em_i2c.h
+ * @brief   :   Host build stand-in for the emlib I2C driver, the Si7021 answers with the temperature of the node
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_EM_I2C_H
+#define HOST_EM_I2C_H
+
+#include "em_device.h"
+
+typedef struct
+{
+  uint32_t placeholder;
+} I2C_TypeDef;
+
+extern I2C_TypeDef host_i2c0;
+
+#define I2C0 (&host_i2c0)
+
+#define I2C_FREQ_STANDARD_MAX (100000)
+#define I2C_FLAG_WRITE (0x0001)
+#define I2C_FLAG_READ (0x0002)
+#define I2C_FLAG_WRITE_READ (0x0004)
+#define I2C_FLAG_WRITE_WRITE (0x0008)
+
+typedef enum
+{
+  i2cClockHLRStandard,
+  i2cClockHLRAsymetric,
+  i2cClockHLRFast,
+} I2C_ClockHLR_TypeDef;
+
+typedef enum
+{
+  i2cTransferInProgress = 1,
+  i2cTransferDone = 0,
+  i2cTransferNack = -1,
+  i2cTransferBusErr = -2,
+  i2cTransferArbLost = -3,
+  i2cTransferUsageFault = -4,
+  i2cTransferSwFault = -5
+} I2C_TransferReturn_TypeDef;
+
+typedef struct
+{
+  uint16_t addr;
+  uint16_t flags;
+  struct
+  {
+    uint8_t *data;
+    uint16_t len;
+  } buf[2];
+} I2C_TransferSeq_TypeDef;
+
+void I2C_Enable(I2C_TypeDef *i2c, bool enable);
+I2C_TransferReturn_TypeDef I2C_TransferInit(I2C_TypeDef *i2c, I2C_TransferSeq_TypeDef *seq);
+I2C_TransferReturn_TypeDef I2C_Transfer(I2C_TypeDef *i2c);
+
+#endif   //HOST_EM_I2C_H
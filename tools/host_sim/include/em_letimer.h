@@ -0,0 +1,81 @@
+/**
+ * @file    :   em_letimer.h
+ * @brief   :   Host build stand-in for LETIMER0, the counter is derived from the virtual clock of the node
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_EM_LETIMER_H
+#define HOST_EM_LETIMER_H
+
+#include "em_device.h"
+
+//Registers the firmware reads back, IFC reads as 0 like the write-only register of the target
+typedef struct
+{
+  volatile uint32_t CTRL;
+  volatile uint32_t CNT;
+  volatile uint32_t COMP0;
+  volatile uint32_t COMP1;
+  volatile uint32_t IF;
+  volatile uint32_t IFC;
+  volatile uint32_t IEN;
+} LETIMER_TypeDef;
+
+extern LETIMER_TypeDef host_letimer0;
+
+#define LETIMER0 (&host_letimer0)
+
+#define LETIMER_IF_COMP0 (0x1UL << 0)
+#define LETIMER_IF_COMP1 (0x1UL << 1)
+#define LETIMER_IF_UF (0x1UL << 2)
+#define LETIMER_IFC_COMP0 LETIMER_IF_COMP0
+#define LETIMER_IFC_COMP1 LETIMER_IF_COMP1
+#define LETIMER_IFC_UF LETIMER_IF_UF
+#define LETIMER_IEN_COMP0 LETIMER_IF_COMP0
+#define LETIMER_IEN_COMP1 LETIMER_IF_COMP1
+#define LETIMER_IEN_UF LETIMER_IF_UF
+
+typedef enum
+{
+  letimerRepeatFree,
+  letimerRepeatOneshot,
+  letimerRepeatBuffered,
+  letimerRepeatDouble,
+} LETIMER_RepeatMode_TypeDef;
+
+typedef enum
+{
+  letimerUFOANone,
+  letimerUFOAToggle,
+  letimerUFOAPulse,
+  letimerUFOAPwm,
+} LETIMER_UFOA_TypeDef;
+
+typedef struct
+{
+  bool enable;
+  bool debugRun;
+  bool comp0Top;
+  bool bufTop;
+  uint8_t out0Pol;
+  uint8_t out1Pol;
+  LETIMER_UFOA_TypeDef ufoa0;
+  LETIMER_UFOA_TypeDef ufoa1;
+  LETIMER_RepeatMode_TypeDef repMode;
+  uint32_t topValue;
+} LETIMER_Init_TypeDef;
+
+void LETIMER_Init(LETIMER_TypeDef *letimer, const LETIMER_Init_TypeDef *init);
+void LETIMER_Enable(LETIMER_TypeDef *letimer, bool enable);
+uint32_t LETIMER_CounterGet(LETIMER_TypeDef *letimer);
+uint32_t LETIMER_CompareGet(LETIMER_TypeDef *letimer, unsigned int comp);
+void LETIMER_CompareSet(LETIMER_TypeDef *letimer, unsigned int comp, uint32_t value);
+void LETIMER_IntEnable(LETIMER_TypeDef *letimer, uint32_t flags);
+void LETIMER_IntDisable(LETIMER_TypeDef *letimer, uint32_t flags);
+void LETIMER_IntClear(LETIMER_TypeDef *letimer, uint32_t flags);
+uint32_t LETIMER_IntGet(LETIMER_TypeDef *letimer);
+
+#endif   //HOST_EM_LETIMER_H
@@ -0,0 +1,63 @@
+/**
+ * @file    :   glib.h
+ * @brief   :   Host build stand-in for the graphics library, text rows are kept so a node can print its LCD
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_GLIB_H
+#define HOST_GLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef uint32_t EMSTATUS;
+
+#define GLIB_OK (0)
+
+typedef enum
+{
+  Black,
+  White,
+} GLIB_Color_t;
+
+typedef enum
+{
+  GLIB_ALIGN_LEFT,
+  GLIB_ALIGN_CENTER,
+  GLIB_ALIGN_RIGHT,
+} GLIB_Align_t;
+
+typedef struct
+{
+  uint32_t placeholder;
+} GLIB_Font_t;
+
+typedef struct
+{
+  int32_t xMin;
+  int32_t yMin;
+  int32_t xMax;
+  int32_t yMax;
+} GLIB_Rectangle_t;
+
+typedef struct
+{
+  uint32_t foregroundColor;
+  uint32_t backgroundColor;
+} GLIB_Context_t;
+
+extern const GLIB_Font_t GLIB_FontNarrow6x8;
+
+EMSTATUS GLIB_contextInit(GLIB_Context_t *pContext);
+EMSTATUS GLIB_clear(GLIB_Context_t *pContext);
+EMSTATUS GLIB_setFont(GLIB_Context_t *pContext, GLIB_Font_t *pFont);
+EMSTATUS GLIB_drawStringOnLine(GLIB_Context_t *pContext, const char *pString, uint8_t line, GLIB_Align_t align,
+                               int32_t xOffset, int32_t yOffset, bool opaque);
+EMSTATUS GLIB_drawLine(GLIB_Context_t *pContext, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+EMSTATUS GLIB_drawLineV(GLIB_Context_t *pContext, int32_t x1, int32_t y1, int32_t y2);
+EMSTATUS GLIB_drawRectFilled(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect);
+
+#endif   //HOST_GLIB_H
@@ -0,0 +1,17 @@
+/**
+ * @file    :   pa_conversions_efr32.h
+ * @brief   :   Host build stand-in for the PA configuration of the RAIL utilities
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_PA_CONVERSIONS_EFR32_H
+#define HOST_PA_CONVERSIONS_EFR32_H
+
+#include "rail.h"
+
+RAIL_TxPowerConfig_t *sl_rail_util_pa_get_tx_power_config_2p4ghz(void);
+
+#endif   //HOST_PA_CONVERSIONS_EFR32_H
@@ -0,0 +1,33 @@
+/**
+ * @file    :   rail.h
+ * @brief   :   Host build stand-in for the RAIL TX power conversions
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_RAIL_H
+#define HOST_RAIL_H
+
+#include <stdint.h>
+
+typedef void *RAIL_Handle_t;
+typedef int16_t RAIL_TxPower_t;
+typedef uint8_t RAIL_TxPowerLevel_t;
+typedef uint8_t RAIL_TxPowerMode_t;
+
+#define RAIL_EFR32_HANDLE ((RAIL_Handle_t)0xFFFFFFFFUL)
+#define RAIL_TX_POWER_MODE_2P4_HP ((RAIL_TxPowerMode_t)0)
+
+typedef struct
+{
+  RAIL_TxPowerMode_t mode;
+  uint16_t voltage;
+  uint16_t rampTime;
+} RAIL_TxPowerConfig_t;
+
+RAIL_TxPowerLevel_t RAIL_ConvertDbmToRaw(RAIL_Handle_t railHandle, RAIL_TxPowerMode_t mode, RAIL_TxPower_t power);
+RAIL_TxPower_t RAIL_ConvertRawToDbm(RAIL_Handle_t railHandle, RAIL_TxPowerMode_t mode, RAIL_TxPowerLevel_t powerLevel);
+
+#endif   //HOST_RAIL_H
@@ -0,0 +1,32 @@
+/**
+ * @file    :   sl_i2cspm.h
+ * @brief   :   Host build stand-in for the I2C simple polled master init
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_SL_I2CSPM_H
+#define HOST_SL_I2CSPM_H
+
+#include "em_gpio.h"
+#include "em_i2c.h"
+
+typedef struct
+{
+  I2C_TypeDef *port;
+  GPIO_Port_TypeDef sclPort;
+  unsigned int sclPin;
+  GPIO_Port_TypeDef sdaPort;
+  unsigned int sdaPin;
+  uint8_t portLocationScl;
+  uint8_t portLocationSda;
+  uint32_t i2cRefFreq;
+  uint32_t i2cMaxFreq;
+  I2C_ClockHLR_TypeDef i2cClhr;
+} I2CSPM_Init_TypeDef;
+
+void I2CSPM_Init(I2CSPM_Init_TypeDef *init);
+
+#endif   //HOST_SL_I2CSPM_H
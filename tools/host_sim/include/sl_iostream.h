@@ -0,0 +1,10 @@
+/**
+ * @file    :   sl_iostream.h
+ * @brief   :   Host build guard, the VCOM gateway drives the USART and LDMA of the target
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#error "GATEWAY_ENABLE needs the USART and LDMA of the target, build the host simulator with it set to 0"
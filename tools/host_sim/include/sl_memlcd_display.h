@@ -0,0 +1,17 @@
+/**
+ * @file    :   sl_memlcd_display.h
+ * @brief   :   Host build stand-in for the size of the Sharp memory LCD of the starter kit
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_SL_MEMLCD_DISPLAY_H
+#define HOST_SL_MEMLCD_DISPLAY_H
+
+#define SL_MEMLCD_DISPLAY_WIDTH (128)
+#define SL_MEMLCD_DISPLAY_HEIGHT (128)
+#define SL_MEMLCD_DISPLAY_BPP (1)
+
+#endif   //HOST_SL_MEMLCD_DISPLAY_H
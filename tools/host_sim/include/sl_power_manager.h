@@ -0,0 +1,37 @@
+/**
+ * @file    :   sl_power_manager.h
+ * @brief   :   Host build stand-in for the power manager, the energy mode requirements are counted and
+ *              reported when the node exits
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#ifndef HOST_SL_POWER_MANAGER_H
+#define HOST_SL_POWER_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+  SL_POWER_MANAGER_EM0,
+  SL_POWER_MANAGER_EM1,
+  SL_POWER_MANAGER_EM2,
+  SL_POWER_MANAGER_EM3,
+  SL_POWER_MANAGER_EM4,
+} sl_power_manager_em_t;
+
+typedef enum
+{
+  SL_POWER_MANAGER_IGNORE = (1UL << 0UL),
+  SL_POWER_MANAGER_SLEEP = (1UL << 1UL),
+  SL_POWER_MANAGER_WAKEUP = (1UL << 2UL),
+} sl_power_manager_on_isr_exit_t;
+
+void sl_power_manager_add_em_requirement(sl_power_manager_em_t em);
+void sl_power_manager_remove_em_requirement(sl_power_manager_em_t em);
+void sl_power_manager_sleep(void);
+
+#endif   //HOST_SL_POWER_MANAGER_H
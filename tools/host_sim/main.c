@@ -0,0 +1,229 @@
+/**
+ * @file    :   main.c
+ * @brief   :   Main loop of a host node. Runs the firmware of app.c and src/ against hal.c and stack.c,
+ *              one process per node. The simulation driver writes one command per line to stdin,
+ *              "<time_us> <COMMAND> <args>", and the node answers on stdout with the lines its stack and
+ *              board put out, each with the virtual time it happened at, ending with
+ *              "<time_us> IDLE <next_deadline_us|-1>" once the command is handled.
+ *
+ *              Between two commands the node runs every interrupt and stack event due up to the time of
+ *              the second, in time order, the way the main loop of the target drains them after a wake up.
+ *
+ *              Usage: host_node --address <aa:bb:cc:dd:ee:ff> [--server] [--temperature <c>]
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "host.h"
+#include "app.h"
+#include "sl_bluetooth.h"
+
+#define HOST_LINE_MAX (1024)
+#define HOST_STEPS_PER_INSTANT (100000)           //Guard against a deadline that is never served
+
+uint64_t host_now_us;
+
+
+void hostPrint(const char *format, ...)
+{
+  va_list args;
+
+  printf("%llu ", (unsigned long long)host_now_us);
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  putchar('\n');
+}
+
+void hostHex(char *text, const uint8_t *data, size_t len)
+{
+  for(size_t i = 0; i < len; i++)
+    sprintf(&text[i * 2], "%02x", data[i]);
+
+  text[len * 2] = '\0';
+  if(len == 0)
+    strcpy(text, "-");
+}
+
+size_t hostUnhex(uint8_t *data, size_t size, const char *text)
+{
+  size_t len = 0;
+  unsigned int byte;
+
+  if(strcmp(text, "-") == 0)
+    return 0;
+
+  while((len < size) && (text[len * 2] != '\0') && (text[(len * 2) + 1] != '\0') && (sscanf(&text[len * 2], "%2x", &byte) == 1))
+    data[len++] = (uint8_t)byte;
+
+  return len;
+}
+
+
+/*
+ * Hands the queued stack events to the firmware, the interrupts they leave pending run in between
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void host_drain()
+{
+  sl_bt_msg_t evt;
+
+  halRun();
+  app_process_action();
+
+  while(stackPopEvent(&evt) == true)
+    {
+      halSyncCycles();
+      sl_bt_on_event(&evt);
+      app_process_action();
+      halRun();
+    }
+}
+
+
+/*
+ * Returns the earliest deadline of the board and the stack
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t time_us
+ */
+static uint64_t host_next_deadline()
+{
+  uint64_t hal = halNextDeadline();
+  uint64_t stack = stackNextDeadline();
+
+  return (hal < stack) ? hal : stack;
+}
+
+
+/*
+ * Moves the virtual time up to a point, serving every deadline on the way
+ *
+ * Parameters:
+ *   uint64_t time_us
+ *
+ * Returns:
+ *   None
+ */
+static void host_advance(uint64_t time_us)
+{
+  uint64_t next;
+  uint64_t last = host_now_us;
+  uint32_t steps = 0;
+
+  while(((next = host_next_deadline()) != HOST_NO_DEADLINE) && (next <= time_us))
+    {
+      if(next < host_now_us)
+        next = host_now_us;
+
+      if(next != last)
+        {
+          last = next;
+          steps = 0;
+        }
+      else if(++steps == HOST_STEPS_PER_INSTANT)
+        {
+          fprintf(stderr, "host: deadline at %llu us is not served, skipping ahead\n", (unsigned long long)next);
+          break;
+        }
+
+      host_now_us = next;
+      stackRun();
+      host_drain();
+    }
+
+  if(time_us > host_now_us)
+    host_now_us = time_us;
+}
+
+
+int main(int argc, char *argv[])
+{
+  char line[HOST_LINE_MAX];
+  char command[32];
+  bd_addr address = { { 0x01, 0x00, 0x00, 0x00, 0x00, 0x00 } };
+  unsigned int b[6];
+  bool server = false;
+  double temperature_c = 25.0;
+  unsigned long long time_us;
+  unsigned int button;
+  unsigned int pressed;
+  uint64_t next;
+  int used;
+
+  for(int i = 1; i < argc; i++)
+    {
+      if((strcmp(argv[i], "--address") == 0) && ((i + 1) < argc) &&
+          (sscanf(argv[++i], "%x:%x:%x:%x:%x:%x", &b[5], &b[4], &b[3], &b[2], &b[1], &b[0]) == 6))
+        {
+          for(uint32_t j = 0; j < 6; j++)
+            address.addr[j] = (uint8_t)b[j];
+        }
+      else if(strcmp(argv[i], "--server") == 0)
+        server = true;
+      else if((strcmp(argv[i], "--temperature") == 0) && ((i + 1) < argc))
+        temperature_c = atof(argv[++i]);
+      else
+        {
+          fprintf(stderr, "usage: %s --address <aa:bb:cc:dd:ee:ff> [--server] [--temperature <c>]\n", argv[0]);
+          return 1;
+        }
+    }
+
+  halInit(server, temperature_c);
+  stackInit(&address);
+
+  while(fgets(line, sizeof(line), stdin) != NULL)
+    {
+      line[strcspn(line, "\r\n")] = '\0';
+      if(sscanf(line, "%llu %31s %n", &time_us, command, &used) != 2)
+        continue;
+
+      host_advance(time_us);
+
+      if(strcmp(command, "BOOT") == 0)
+        {
+          app_init();
+          stackBoot();
+        }
+      else if(strcmp(command, "BUTTON") == 0)
+        {
+          if(sscanf(&line[used], "%u %u", &button, &pressed) == 2)
+            halButton(button, (pressed != 0));
+        }
+      else if(strcmp(command, "TEMP") == 0)
+        halTemperature(atof(&line[used]));
+      else if(strcmp(command, "QUIT") == 0)
+        break;
+      else if(strcmp(command, "TICK") != 0)
+        stackCommand(command, &line[used]);
+
+      host_drain();
+
+      next = host_next_deadline();
+      if(next == HOST_NO_DEADLINE)
+        hostPrint("IDLE -1");
+      else
+        hostPrint("IDLE %llu", (unsigned long long)next);
+      fflush(stdout);
+    }
+
+  halReport();
+  stackReport();
+  return 0;
+}
@@ -0,0 +1,2956 @@
+/**
+ * @file    :   stack.c
+ * @brief   :   Host stand-in for the Bluetooth stack. The sl_bt_* commands the firmware calls are answered
+ *              here and the events it handles are queued for sl_bt_on_event(). The link layer is left to
+ *              the simulation driver: what the node puts on the air goes to stdout as a line, what the
+ *              peer sends comes back as a command.
+ *
+ *              GATT runs as real ATT PDUs over the link so both ends go through the procedures of the
+ *              target stack: the MTU exchange the central starts on open, service discovery by UUID with
+ *              Find By Type Value, characteristic discovery with Read By Type, the CCCD search and write
+ *              behind sl_bt_gatt_set_characteristic_notification(), reads, one indication in flight per
+ *              link with the 30 s ATT timeout. The server side answers from the GATT database of
+ *              autogen/gatt_db.c and raises the user read and write requests for its user attributes.
+ *
+ *              Pairing is left to the driver too, it answers SEC_REQ with an encryption from a stored
+ *              bond or runs the passkey confirmation through the events of the target stack.
+ *
+ *              Every frame goes on the link as an L2CAP basic frame with its channel, ATT on channel 4 and
+ *              the LE signaling channel 5 carry the credit based connections of sl_bt_l2cap_coc_*, their
+ *              K-frames go on the dynamic channels one per sl_bt_l2cap_coc_send_data() and per data event,
+ *              the way the target stack leaves the SDU length to the application, each taking a credit.
+ *
+ * @author  :   Khyati Satta [khyati.satta@colorado.edu]
+ * @date    :   18 October 2026
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+#include "em_common.h"
+#include "sl_component_catalog.h"
+#include "sl_bluetooth_config.h"
+#include "gatt_db.h"
+
+#define STACK_MAX_CONNECTIONS (SL_BT_CONFIG_MAX_CONNECTIONS)
+#define STACK_MAX_ADVERTISERS (SL_BT_CONFIG_USER_ADVERTISERS)
+#define STACK_MAX_TIMERS (SL_BT_CONFIG_MAX_SOFTWARE_TIMERS)
+#define STACK_EVENT_QUEUE (256)
+#define STACK_SOFT_TIMER_HZ (32768)
+#define STACK_ATT_DEFAULT_MTU (23)
+#define STACK_ATT_MAX_MTU (250)
+#define STACK_ATT_TIMEOUT_US (30000000ULL)
+#define STACK_ATT_PDU_MAX (STACK_ATT_MAX_MTU + 8)
+#define STACK_ADV_DATA_MAX (31)
+#define STACK_MAX_CCCD (8)
+#define STACK_NO_BONDING (0xFF)
+#define STACK_DEFAULT_TXSIZE (27)
+#define STACK_L2CAP_ATT_CID (0x0004)
+#define STACK_L2CAP_SIGNALING_CID (0x0005)
+#define STACK_L2CAP_FIRST_DYNAMIC_CID (0x0040)
+#define STACK_L2CAP_PDU_MAX (STACK_ATT_PDU_MAX)
+#define STACK_COC_MPS_MAX (STACK_ATT_MAX_MTU)     //A K-frame is handed over in one data event
+#define STACK_MAX_COC ((SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS > 0) ? SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS : 1)
+
+//LE signaling codes
+#define L2CAP_COMMAND_REJECT (0x01)
+#define L2CAP_DISCONNECTION_REQ (0x06)
+#define L2CAP_DISCONNECTION_RSP (0x07)
+#define L2CAP_LE_CREDIT_CONNECTION_REQ (0x14)
+#define L2CAP_LE_CREDIT_CONNECTION_RSP (0x15)
+#define L2CAP_LE_FLOW_CONTROL_CREDIT (0x16)
+
+//ATT opcodes
+#define ATT_ERROR_RSP (0x01)
+#define ATT_MTU_REQ (0x02)
+#define ATT_MTU_RSP (0x03)
+#define ATT_FIND_BY_TYPE_REQ (0x06)
+#define ATT_FIND_BY_TYPE_RSP (0x07)
+#define ATT_READ_BY_TYPE_REQ (0x08)
+#define ATT_READ_BY_TYPE_RSP (0x09)
+#define ATT_READ_REQ (0x0A)
+#define ATT_READ_RSP (0x0B)
+#define ATT_READ_BLOB_REQ (0x0C)
+#define ATT_READ_BLOB_RSP (0x0D)
+#define ATT_WRITE_REQ (0x12)
+#define ATT_WRITE_RSP (0x13)
+#define ATT_NOTIFICATION (0x1B)
+#define ATT_INDICATION (0x1D)
+#define ATT_CONFIRMATION (0x1E)
+#define ATT_WRITE_CMD (0x52)
+#define ATT_COMMAND_FLAG (0x40)
+
+//ATT error codes
+#define ATT_ERR_INVALID_HANDLE (0x01)
+#define ATT_ERR_READ_NOT_PERMITTED (0x02)
+#define ATT_ERR_WRITE_NOT_PERMITTED (0x03)
+#define ATT_ERR_INVALID_PDU (0x04)
+#define ATT_ERR_REQUEST_NOT_SUPPORTED (0x06)
+#define ATT_ERR_NOT_FOUND (0x0A)
+#define ATT_ERR_INVALID_LENGTH (0x0D)
+#define ATT_ERR_INSUFFICIENT_ENCRYPTION (0x0F)
+#define ATT_ERR_CCCD_IMPROPER (0xFD)
+#define ATT_STATUS(code) ((uint16_t)(0x1100 | (code)))
+
+#define GATT_UUID_PRIMARY_SERVICE (0x2800)
+#define GATT_UUID_SECONDARY_SERVICE (0x2801)
+#define GATT_UUID_CHARACTERISTIC (0x2803)
+#define GATT_UUID_CCCD (0x2902)
+
+//Attribute datatypes of the generated database
+#define GATTDB_CONST (0x00)
+#define GATTDB_DYNAMIC (0x01)
+#define GATTDB_CONFIG (0x03)
+#define GATTDB_CHARACTERISTIC (0x05)
+#define GATTDB_USER (0x07)
+
+//Permission bits of the generated database
+#define GATTDB_PERM_READ (0x0001)
+#define GATTDB_PERM_WRITE (0x0002)
+#define GATTDB_PERM_READ_BONDED (0x0040)           //Reads need an encrypted link
+#define GATTDB_PERM_WRITE_BONDED (0x0080)          //Writes need an encrypted link
+#define GATTDB_PERM_CCCD_BONDED (0x4000)           //Indications and notifications need an encrypted link
+#define GATTDB_PERM_ADVERTISED (0x8000)            //Service UUID goes in the advertising data
+
+#define CHAR_PROP_NOTIFY (0x10)
+#define CHAR_PROP_INDICATE (0x20)
+
+//Client procedures, one at a time on a link
+typedef enum
+{
+  proc_none,
+  proc_read,
+  proc_read_by_uuid,
+  proc_services,
+  proc_characteristics,
+  proc_cccd_find,
+  proc_cccd_write,
+}stack_proc_t;
+
+typedef struct
+{
+  bool in_use;
+  bool open;
+  bool closing;
+  bool central;
+  bd_addr peer;
+  uint8_t peer_type;
+  uint8_t bonding;
+  uint8_t advertiser;
+  uint16_t interval;
+  uint16_t latency;
+  uint16_t timeout;
+  uint16_t txsize;
+  uint8_t security;
+  uint16_t mtu;
+
+  //GATT client
+  stack_proc_t proc;
+  uint16_t proc_start;
+  uint16_t proc_end;
+  uint16_t proc_characteristic;
+  uint16_t proc_flags;
+  uint8_t proc_uuid[16];
+  uint8_t proc_uuid_len;
+  bool mtu_pending;                 //Internal MTU exchange, user procedures queue behind it
+  uint8_t queued[STACK_ATT_PDU_MAX];
+  size_t queued_len;
+  bool confirm_owed;                //Indication received and not confirmed yet
+
+  //GATT server
+  uint16_t cccd[STACK_MAX_CCCD];
+  bool indication_out;
+  uint16_t indication_char;
+  uint64_t indication_deadline;
+  bool att_dead;                    //Indication timed out, the bearer takes no more
+  bool read_pending;
+  uint16_t read_char;
+  uint8_t read_opcode;
+  bool write_pending;
+  uint16_t write_char;
+
+  //Security manager
+  bool passkey_pending;
+  bool bonding_pending;
+
+  uint8_t signaling_identifier;
+}stack_conn_t;
+
+//Credit based channel, SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS of them across all links
+typedef struct
+{
+  bool in_use;
+  bool open;                        //Response sent or received with success
+  uint8_t connection;
+  uint8_t identifier;               //Signaling identifier of the request until it is answered
+  uint16_t local_cid;
+  uint16_t remote_cid;
+  uint16_t local_mtu;
+  uint16_t local_mps;
+  uint16_t remote_mtu;
+  uint16_t remote_mps;
+  uint16_t tx_credits;              //K-frames the peer still accepts
+  uint16_t rx_credits;              //K-frames the peer may still send
+}stack_coc_t;
+
+typedef struct
+{
+  bool created;
+  bool running;
+  uint32_t interval;                //0.625 ms units
+  uint16_t duration;                //10 ms units, 0 runs until stopped
+  int16_t power;                    //0.1 dBm
+  uint64_t stop_us;
+}stack_adv_t;
+
+typedef struct
+{
+  bool active;
+  uint8_t handle;
+  bool single_shot;
+  uint32_t time;                    //32768 Hz ticks
+  uint64_t start_us;
+  uint64_t count;
+  uint64_t next_us;
+}stack_timer_t;
+
+static sl_bt_msg_t event_queue[STACK_EVENT_QUEUE];
+static uint32_t event_head;
+static uint32_t event_count;
+static uint32_t signal_pending;
+static bool signal_queued;
+
+static stack_conn_t conns[STACK_MAX_CONNECTIONS];
+static stack_adv_t advs[STACK_MAX_ADVERTISERS];
+static stack_timer_t timers[STACK_MAX_TIMERS];
+static stack_coc_t cocs[STACK_MAX_COC];
+
+static struct
+{
+  bd_addr address;
+  uint16_t max_mtu;
+  int16_t tx_max;
+  bool scanning;
+  uint16_t scan_interval;
+  uint16_t scan_window;
+  uint16_t conn_min;
+  uint16_t conn_max;
+  uint16_t conn_latency;
+  uint16_t conn_timeout;
+  uint8_t adv_data[STACK_ADV_DATA_MAX];
+  size_t adv_len;
+  uint32_t sample_seq;
+  uint32_t events;
+  uint32_t dropped;
+}stack;
+
+
+/*
+ * Prints a Bluetooth address most significant byte first
+ *
+ * Parameters:
+ *   char *text: At least 18 bytes
+ *   const bd_addr *address
+ *
+ * Returns:
+ *   None
+ */
+static void stack_addr_text(char *text, const bd_addr *address)
+{
+  sprintf(text, "%02x:%02x:%02x:%02x:%02x:%02x", address->addr[5], address->addr[4], address->addr[3],
+          address->addr[2], address->addr[1], address->addr[0]);
+}
+
+
+/*
+ * Parses a Bluetooth address written most significant byte first
+ *
+ * Parameters:
+ *   bd_addr *address
+ *   const char *text
+ *
+ * Returns:
+ *   bool: false if the text is not an address
+ */
+static bool stack_addr_parse(bd_addr *address, const char *text)
+{
+  unsigned int b[6];
+
+  if(sscanf(text, "%x:%x:%x:%x:%x:%x", &b[5], &b[4], &b[3], &b[2], &b[1], &b[0]) != 6)
+    return false;
+
+  for(uint32_t i = 0; i < 6; i++)
+    address->addr[i] = (uint8_t)b[i];
+
+  return true;
+}
+
+
+static uint16_t get_le16(const uint8_t *data)
+{
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static void put_le16(uint8_t *data, uint16_t value)
+{
+  data[0] = (uint8_t)(value & 0xFF);
+  data[1] = (uint8_t)(value >> 8);
+}
+
+
+/*
+ * Reserves the next event in the queue
+ *
+ * Parameters:
+ *   uint32_t id: Event id
+ *   size_t len: Payload length
+ *
+ * Returns:
+ *   sl_bt_msg_t *: Zeroed event, NULL with the queue full
+ */
+static sl_bt_msg_t *stack_event(uint32_t id, size_t len)
+{
+  sl_bt_msg_t *evt;
+
+  if(event_count == STACK_EVENT_QUEUE)
+    {
+      stack.dropped++;
+      fprintf(stderr, "host: event queue full, event 0x%08lx dropped\n", (unsigned long)id);
+      return NULL;
+    }
+
+  evt = &event_queue[(event_head + event_count) % STACK_EVENT_QUEUE];
+  event_count++;
+
+  memset(evt, 0, sizeof(*evt));
+  evt->header = id | ((len & 0xFF) << 8) | ((len >> 8) & 0x7);
+
+  return evt;
+}
+
+
+/*
+ * Returns the connection of a handle
+ *
+ * Parameters:
+ *   uint8_t connection: Stack connection handle, 1 to STACK_MAX_CONNECTIONS
+ *
+ * Returns:
+ *   stack_conn_t *: NULL if no connection uses the handle
+ */
+static stack_conn_t *stack_conn(uint8_t connection)
+{
+  if((connection == 0) || (connection > STACK_MAX_CONNECTIONS) || (conns[connection - 1].in_use == false))
+    return NULL;
+
+  return &conns[connection - 1];
+}
+
+static uint8_t stack_conn_handle(const stack_conn_t *conn)
+{
+  return (uint8_t)((conn - conns) + 1);
+}
+
+
+/*
+ * Puts an L2CAP basic frame on a link
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   uint16_t cid: Channel of the peer
+ *   const uint8_t *pdu: Information payload
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_l2cap_send(stack_conn_t *conn, uint16_t cid, const uint8_t *pdu, size_t len)
+{
+  char text[(STACK_L2CAP_PDU_MAX * 2) + 1];
+
+  hostHex(text, pdu, len);
+  hostPrint("L2CAP %u %u %s", stack_conn_handle(conn), cid, text);
+}
+
+static void stack_att_send(stack_conn_t *conn, const uint8_t *pdu, size_t len)
+{
+  stack_l2cap_send(conn, STACK_L2CAP_ATT_CID, pdu, len);
+}
+
+
+/*
+ * Sends a client request, it waits for the MTU exchange the central started on open
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   const uint8_t *pdu
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_att_request(stack_conn_t *conn, const uint8_t *pdu, size_t len)
+{
+  if(conn->mtu_pending == true)
+    {
+      memcpy(conn->queued, pdu, len);
+      conn->queued_len = len;
+      return;
+    }
+
+  stack_att_send(conn, pdu, len);
+}
+
+
+static void stack_att_error(stack_conn_t *conn, uint8_t opcode, uint16_t handle, uint8_t code)
+{
+  uint8_t pdu[5] = { ATT_ERROR_RSP, opcode, 0, 0, code };
+
+  put_le16(&pdu[2], handle);
+  stack_att_send(conn, pdu, sizeof(pdu));
+}
+
+
+/*
+ * Returns an attribute of the database
+ *
+ * Parameters:
+ *   uint16_t handle
+ *
+ * Returns:
+ *   const sli_bt_gattdb_attribute_t *: NULL for a handle outside the database
+ */
+static const sli_bt_gattdb_attribute_t *stack_attr(uint16_t handle)
+{
+  if((handle == 0) || (handle > gattdb.attribute_num))
+    return NULL;
+
+  return &gattdb.attributes[handle - 1];
+}
+
+
+/*
+ * Copies a UUID of the database tables, little endian like on the air
+ *
+ * Parameters:
+ *   uint8_t *uuid: 16 bytes
+ *   uint16_t index: Below 0x8000 an entry of the 16-bit table, else of the 128-bit one
+ *
+ * Returns:
+ *   size_t: 2 or 16
+ */
+static size_t stack_uuid(uint8_t *uuid, uint16_t index)
+{
+  if(index < 0x8000)
+    {
+      put_le16(uuid, gattdb.uuid16[index]);
+      return 2;
+    }
+
+  memcpy(uuid, &gattdb.uuid128[(index & 0x7FFF) * 16], 16);
+  return 16;
+}
+
+
+/*
+ * Returns true if an attribute has a 16-bit UUID
+ *
+ * Parameters:
+ *   const sli_bt_gattdb_attribute_t *attr
+ *   uint16_t uuid
+ *
+ * Returns:
+ *   bool
+ */
+static bool stack_attr_is(const sli_bt_gattdb_attribute_t *attr, uint16_t uuid)
+{
+  return ((attr->uuid < 0x8000) && (gattdb.uuid16[attr->uuid] == uuid));
+}
+
+
+/*
+ * Returns the characteristic declaration an attribute belongs to
+ *
+ * Parameters:
+ *   uint16_t handle: Value or descriptor handle
+ *
+ * Returns:
+ *   const sli_bt_gattdb_attribute_t *: NULL outside a characteristic
+ */
+static const sli_bt_gattdb_attribute_t *stack_attr_declaration(uint16_t handle)
+{
+  const sli_bt_gattdb_attribute_t *attr;
+
+  for(uint16_t h = handle; h > 0; h--)
+    {
+      attr = stack_attr(h);
+      if(attr->datatype == GATTDB_CHARACTERISTIC)
+        return attr;
+      if(stack_attr_is(attr, GATT_UUID_PRIMARY_SERVICE) || stack_attr_is(attr, GATT_UUID_SECONDARY_SERVICE))
+        return NULL;
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Returns the client configuration descriptor of a characteristic value
+ *
+ * Parameters:
+ *   uint16_t characteristic: Value handle
+ *
+ * Returns:
+ *   const sli_bt_gattdb_attribute_t *: NULL without one
+ */
+static const sli_bt_gattdb_attribute_t *stack_attr_cccd(uint16_t characteristic)
+{
+  const sli_bt_gattdb_attribute_t *attr;
+
+  for(uint16_t h = characteristic + 1; (attr = stack_attr(h)) != NULL; h++)
+    {
+      if(attr->datatype == GATTDB_CONFIG)
+        return attr;
+      if((attr->datatype == GATTDB_CHARACTERISTIC) || stack_attr_is(attr, GATT_UUID_PRIMARY_SERVICE) ||
+          stack_attr_is(attr, GATT_UUID_SECONDARY_SERVICE))
+        return NULL;
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Copies the value of an attribute the stack answers itself
+ *
+ * Parameters:
+ *   const stack_conn_t *conn: Client configurations are per link
+ *   const sli_bt_gattdb_attribute_t *attr
+ *   uint8_t *value: STACK_ATT_PDU_MAX bytes
+ *
+ * Returns:
+ *   size_t: Length of the value
+ */
+static size_t stack_attr_value(const stack_conn_t *conn, const sli_bt_gattdb_attribute_t *attr, uint8_t *value)
+{
+  size_t len = 0;
+
+  switch(attr->datatype)
+  {
+    case GATTDB_CONST:
+      len = attr->constdata->len;
+      memcpy(value, attr->constdata->data, len);
+      break;
+
+    case GATTDB_DYNAMIC:
+      len = attr->dynamicdata->len;
+      memcpy(value, attr->dynamicdata->data, len);
+      break;
+
+    case GATTDB_CONFIG:
+      put_le16(value, conn->cccd[attr->configdata.clientconfig_index]);
+      len = 2;
+      break;
+
+    case GATTDB_CHARACTERISTIC:
+      value[0] = attr->characteristic.properties;
+      put_le16(&value[1], attr->handle + 1);
+      len = 3 + stack_uuid(&value[3], attr->characteristic.char_uuid);
+      break;
+
+    default:
+      break;
+  }
+
+  return len;
+}
+
+
+/*
+ * Returns the ATT error for a read or write of an attribute on a link, 0 if it is allowed
+ *
+ * Parameters:
+ *   const stack_conn_t *conn
+ *   const sli_bt_gattdb_attribute_t *attr
+ *   bool write
+ *
+ * Returns:
+ *   uint8_t: ATT error code
+ */
+static uint8_t stack_attr_access(const stack_conn_t *conn, const sli_bt_gattdb_attribute_t *attr, bool write)
+{
+  const sli_bt_gattdb_attribute_t *declaration;
+  const sli_bt_gattdb_attribute_t *value;
+
+  if(attr == NULL)
+    return ATT_ERR_INVALID_HANDLE;
+
+  if((write == false) && !(attr->permissions & GATTDB_PERM_READ))
+    return ATT_ERR_READ_NOT_PERMITTED;
+
+  if((write == true) && !(attr->permissions & GATTDB_PERM_WRITE))
+    return ATT_ERR_WRITE_NOT_PERMITTED;
+
+  if(conn->security != sl_bt_connection_mode1_level1)
+    return 0;
+
+  if((write == false) && (attr->permissions & GATTDB_PERM_READ_BONDED))
+    return ATT_ERR_INSUFFICIENT_ENCRYPTION;
+
+  if((write == true) && (attr->permissions & GATTDB_PERM_WRITE_BONDED))
+    return ATT_ERR_INSUFFICIENT_ENCRYPTION;
+
+  //A client configuration takes the security of the value it subscribes to
+  if(attr->datatype == GATTDB_CONFIG)
+    {
+      declaration = stack_attr_declaration(attr->handle);
+      value = (declaration != NULL) ? stack_attr(declaration->handle + 1) : NULL;
+      if((value != NULL) && (value->permissions & GATTDB_PERM_CCCD_BONDED))
+        return ATT_ERR_INSUFFICIENT_ENCRYPTION;
+    }
+
+  return 0;
+}
+
+
+/*
+ * Ends the client procedure of a link
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   uint16_t result: SL_STATUS_OK or the ATT error as a status
+ *
+ * Returns:
+ *   None
+ */
+static void stack_proc_done(stack_conn_t *conn, uint16_t result)
+{
+  sl_bt_msg_t *evt = stack_event(sl_bt_evt_gatt_procedure_completed_id, sizeof(sl_bt_evt_gatt_procedure_completed_t));
+
+  conn->proc = proc_none;
+  if(evt == NULL)
+    return;
+
+  evt->data.evt_gatt_procedure_completed.connection = stack_conn_handle(conn);
+  evt->data.evt_gatt_procedure_completed.result = result;
+}
+
+
+/*
+ * Sends the next Find By Type Value request of a service discovery
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *
+ * Returns:
+ *   None
+ */
+static void stack_proc_services_next(stack_conn_t *conn)
+{
+  uint8_t pdu[7 + 16];
+
+  pdu[0] = ATT_FIND_BY_TYPE_REQ;
+  put_le16(&pdu[1], conn->proc_start);
+  put_le16(&pdu[3], 0xFFFF);
+  put_le16(&pdu[5], GATT_UUID_PRIMARY_SERVICE);
+  memcpy(&pdu[7], conn->proc_uuid, conn->proc_uuid_len);
+  stack_att_request(conn, pdu, 7 + conn->proc_uuid_len);
+}
+
+
+/*
+ * Sends the next Read By Type request of a characteristic discovery or CCCD search
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   uint16_t type: 16-bit attribute type
+ *
+ * Returns:
+ *   None
+ */
+static void stack_proc_read_by_type(stack_conn_t *conn, uint16_t type)
+{
+  uint8_t pdu[7];
+
+  pdu[0] = ATT_READ_BY_TYPE_REQ;
+  put_le16(&pdu[1], conn->proc_start);
+  put_le16(&pdu[3], conn->proc_end);
+  put_le16(&pdu[5], type);
+  stack_att_request(conn, pdu, sizeof(pdu));
+}
+
+
+/*
+ * Handles a response to a client request
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   const uint8_t *pdu
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_client_response(stack_conn_t *conn, const uint8_t *pdu, size_t len)
+{
+  sl_bt_msg_t *evt;
+  uint8_t request[5];
+  uint16_t last = 0;
+  size_t entry;
+  size_t uuid_len;
+
+  if((pdu[0] == ATT_MTU_RSP) && (len >= 3))
+    {
+      conn->mtu_pending = false;
+      conn->mtu = SL_MIN(get_le16(&pdu[1]), stack.max_mtu);
+      if(conn->mtu < STACK_ATT_DEFAULT_MTU)
+        conn->mtu = STACK_ATT_DEFAULT_MTU;
+
+      evt = stack_event(sl_bt_evt_gatt_mtu_exchanged_id, sizeof(sl_bt_evt_gatt_mtu_exchanged_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_gatt_mtu_exchanged.connection = stack_conn_handle(conn);
+          evt->data.evt_gatt_mtu_exchanged.mtu = conn->mtu;
+        }
+
+      if(conn->queued_len != 0)
+        {
+          stack_att_send(conn, conn->queued, conn->queued_len);
+          conn->queued_len = 0;
+        }
+      return;
+    }
+
+  if((pdu[0] == ATT_ERROR_RSP) && (len >= 5))
+    {
+      if(pdu[1] == ATT_MTU_REQ)                           //The server keeps the default MTU
+        {
+          conn->mtu_pending = false;
+          if(conn->queued_len != 0)
+            {
+              stack_att_send(conn, conn->queued, conn->queued_len);
+              conn->queued_len = 0;
+            }
+          return;
+        }
+
+      //Discoveries end on Attribute Not Found
+      if((pdu[4] == ATT_ERR_NOT_FOUND) && ((conn->proc == proc_services) || (conn->proc == proc_characteristics)))
+        stack_proc_done(conn, SL_STATUS_OK);
+      else if(conn->proc != proc_none)
+        stack_proc_done(conn, ATT_STATUS(pdu[4]));
+      return;
+    }
+
+  switch(conn->proc)
+  {
+    case proc_read:
+      if((pdu[0] != ATT_READ_RSP) || (len > STACK_ATT_PDU_MAX))
+        return;
+
+      evt = stack_event(sl_bt_evt_gatt_characteristic_value_id, sizeof(sl_bt_evt_gatt_characteristic_value_t) + len - 1);
+      if(evt != NULL)
+        {
+          evt->data.evt_gatt_characteristic_value.connection = stack_conn_handle(conn);
+          evt->data.evt_gatt_characteristic_value.characteristic = conn->proc_characteristic;
+          evt->data.evt_gatt_characteristic_value.att_opcode = sl_bt_gatt_read_response;
+          evt->data.evt_gatt_characteristic_value.offset = 0;
+          evt->data.evt_gatt_characteristic_value.value.len = (uint8_t)(len - 1);
+          memcpy(evt->data.evt_gatt_characteristic_value.value.data, &pdu[1], len - 1);
+        }
+      stack_proc_done(conn, SL_STATUS_OK);
+      break;
+
+    case proc_read_by_uuid:
+      if((pdu[0] != ATT_READ_BY_TYPE_RSP) || (len < 2) || (pdu[1] < 2))
+        return;
+
+      //One value event per entry, the handle of the server in the characteristic field
+      entry = pdu[1];
+      for(size_t i = 2; (i + entry) <= len; i += entry)
+        {
+          evt = stack_event(sl_bt_evt_gatt_characteristic_value_id, sizeof(sl_bt_evt_gatt_characteristic_value_t) + entry - 2);
+          if(evt == NULL)
+            continue;
+
+          evt->data.evt_gatt_characteristic_value.connection = stack_conn_handle(conn);
+          evt->data.evt_gatt_characteristic_value.characteristic = get_le16(&pdu[i]);
+          evt->data.evt_gatt_characteristic_value.att_opcode = sl_bt_gatt_read_by_type_response;
+          evt->data.evt_gatt_characteristic_value.offset = 0;
+          evt->data.evt_gatt_characteristic_value.value.len = (uint8_t)(entry - 2);
+          memcpy(evt->data.evt_gatt_characteristic_value.value.data, &pdu[i + 2], entry - 2);
+        }
+      stack_proc_done(conn, SL_STATUS_OK);
+      break;
+
+    case proc_services:
+      if((pdu[0] != ATT_FIND_BY_TYPE_RSP) || (len < 5))
+        return;
+
+      for(size_t i = 1; (i + 4) <= len; i += 4)
+        {
+          last = get_le16(&pdu[i + 2]);
+          evt = stack_event(sl_bt_evt_gatt_service_id, sizeof(sl_bt_evt_gatt_service_t) + conn->proc_uuid_len);
+          if(evt == NULL)
+            continue;
+
+          //The service handle carries the group range for the characteristic discovery
+          evt->data.evt_gatt_service.connection = stack_conn_handle(conn);
+          evt->data.evt_gatt_service.service = get_le16(&pdu[i]) | ((uint32_t)last << 16);
+          evt->data.evt_gatt_service.uuid.len = conn->proc_uuid_len;
+          memcpy(evt->data.evt_gatt_service.uuid.data, conn->proc_uuid, conn->proc_uuid_len);
+        }
+
+      if(last == 0xFFFF)
+        stack_proc_done(conn, SL_STATUS_OK);
+      else
+        {
+          conn->proc_start = last + 1;
+          stack_proc_services_next(conn);
+        }
+      break;
+
+    case proc_characteristics:
+      if((pdu[0] != ATT_READ_BY_TYPE_RSP) || (len < 2) || (pdu[1] < 7))
+        return;
+
+      entry = pdu[1];
+      uuid_len = entry - 5;
+      for(size_t i = 2; (i + entry) <= len; i += entry)
+        {
+          last = get_le16(&pdu[i]);
+          if((uuid_len != conn->proc_uuid_len) || (memcmp(&pdu[i + 5], conn->proc_uuid, uuid_len) != 0))
+            continue;
+
+          evt = stack_event(sl_bt_evt_gatt_characteristic_id, sizeof(sl_bt_evt_gatt_characteristic_t) + uuid_len);
+          if(evt == NULL)
+            continue;
+
+          evt->data.evt_gatt_characteristic.connection = stack_conn_handle(conn);
+          evt->data.evt_gatt_characteristic.characteristic = get_le16(&pdu[i + 3]);
+          evt->data.evt_gatt_characteristic.properties = pdu[i + 2];
+          evt->data.evt_gatt_characteristic.uuid.len = (uint8_t)uuid_len;
+          memcpy(evt->data.evt_gatt_characteristic.uuid.data, &pdu[i + 5], uuid_len);
+        }
+
+      if(last >= conn->proc_end)
+        stack_proc_done(conn, SL_STATUS_OK);
+      else
+        {
+          conn->proc_start = last + 1;
+          stack_proc_read_by_type(conn, GATT_UUID_CHARACTERISTIC);
+        }
+      break;
+
+    case proc_cccd_find:
+      if((pdu[0] != ATT_READ_BY_TYPE_RSP) || (len < 4))
+        return;
+
+      conn->proc = proc_cccd_write;
+      request[0] = ATT_WRITE_REQ;
+      request[1] = pdu[2];
+      request[2] = pdu[3];
+      put_le16(&request[3], conn->proc_flags);
+      stack_att_request(conn, request, sizeof(request));
+      break;
+
+    case proc_cccd_write:
+      if(pdu[0] == ATT_WRITE_RSP)
+        stack_proc_done(conn, SL_STATUS_OK);
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+/*
+ * Answers a Find By Type Value request, only primary services are searched by value
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   const uint8_t *pdu
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_server_find_by_type(stack_conn_t *conn, const uint8_t *pdu, size_t len)
+{
+  uint8_t rsp[STACK_ATT_PDU_MAX];
+  size_t rsp_len = 1;
+  uint8_t value[STACK_ATT_PDU_MAX];
+  uint16_t start = get_le16(&pdu[1]);
+  uint16_t end = get_le16(&pdu[3]);
+  const sli_bt_gattdb_attribute_t *attr;
+  uint16_t group_end;
+
+  rsp[0] = ATT_FIND_BY_TYPE_RSP;
+
+  if(get_le16(&pdu[5]) == GATT_UUID_PRIMARY_SERVICE)
+    {
+      for(uint16_t h = SL_MAX(start, 1); (h <= end) && ((attr = stack_attr(h)) != NULL); h++)
+        {
+          if(!stack_attr_is(attr, GATT_UUID_PRIMARY_SERVICE) || (stack_attr_value(conn, attr, value) != (len - 7)) ||
+              (memcmp(value, &pdu[7], len - 7) != 0))
+            continue;
+
+          group_end = 0xFFFF;
+          for(uint16_t next = h + 1; (attr = stack_attr(next)) != NULL; next++)
+            {
+              if(stack_attr_is(attr, GATT_UUID_PRIMARY_SERVICE) || stack_attr_is(attr, GATT_UUID_SECONDARY_SERVICE))
+                {
+                  group_end = next - 1;
+                  break;
+                }
+            }
+
+          if((rsp_len + 4) > conn->mtu)
+            break;
+
+          put_le16(&rsp[rsp_len], h);
+          put_le16(&rsp[rsp_len + 2], group_end);
+          rsp_len += 4;
+        }
+    }
+
+  if(rsp_len == 1)
+    stack_att_error(conn, ATT_FIND_BY_TYPE_REQ, start, ATT_ERR_NOT_FOUND);
+  else
+    stack_att_send(conn, rsp, rsp_len);
+}
+
+
+/*
+ * Answers a Read By Type request for the attributes the stack holds the values of
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   const uint8_t *pdu
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_server_read_by_type(stack_conn_t *conn, const uint8_t *pdu, size_t len)
+{
+  uint8_t rsp[STACK_ATT_PDU_MAX];
+  size_t rsp_len = 2;
+  uint8_t value[STACK_ATT_PDU_MAX];
+  uint8_t uuid[16];
+  size_t value_len;
+  uint16_t start = get_le16(&pdu[1]);
+  uint16_t end = get_le16(&pdu[3]);
+  const sli_bt_gattdb_attribute_t *attr;
+  uint8_t error;
+
+  rsp[0] = ATT_READ_BY_TYPE_RSP;
+  rsp[1] = 0;
+
+  for(uint16_t h = SL_MAX(start, 1); (h <= end) && ((attr = stack_attr(h)) != NULL); h++)
+    {
+      if((stack_uuid(uuid, attr->uuid) != (len - 5)) || (memcmp(uuid, &pdu[5], len - 5) != 0))
+        continue;
+
+      error = stack_attr_access(conn, attr, false);
+      if((error == 0) && (attr->datatype == GATTDB_USER))
+        error = ATT_ERR_REQUEST_NOT_SUPPORTED;
+
+      if(error != 0)
+        {
+          if(rsp_len == 2)
+            {
+              stack_att_error(conn, ATT_READ_BY_TYPE_REQ, h, error);
+              return;
+            }
+          break;
+        }
+
+      value_len = SL_MIN(stack_attr_value(conn, attr, value), (size_t)(conn->mtu - 4));
+      if(rsp[1] == 0)
+        rsp[1] = (uint8_t)(value_len + 2);
+
+      //Every entry of a response has the length of the first
+      if(((value_len + 2) != rsp[1]) || ((rsp_len + rsp[1]) > conn->mtu))
+        break;
+
+      put_le16(&rsp[rsp_len], h);
+      memcpy(&rsp[rsp_len + 2], value, value_len);
+      rsp_len += rsp[1];
+    }
+
+  if(rsp_len == 2)
+    stack_att_error(conn, ATT_READ_BY_TYPE_REQ, start, ATT_ERR_NOT_FOUND);
+  else
+    stack_att_send(conn, rsp, rsp_len);
+}
+
+
+/*
+ * Answers a Read or Read Blob request, user attributes go to the firmware
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   uint8_t opcode
+ *   uint16_t handle
+ *   uint16_t offset
+ *
+ * Returns:
+ *   None
+ */
+static void stack_server_read(stack_conn_t *conn, uint8_t opcode, uint16_t handle, uint16_t offset)
+{
+  const sli_bt_gattdb_attribute_t *attr = stack_attr(handle);
+  uint8_t rsp[STACK_ATT_PDU_MAX];
+  uint8_t value[STACK_ATT_PDU_MAX];
+  size_t value_len;
+  sl_bt_msg_t *evt;
+  uint8_t error = stack_attr_access(conn, attr, false);
+
+  if(error != 0)
+    {
+      stack_att_error(conn, opcode, handle, error);
+      return;
+    }
+
+  if(attr->datatype == GATTDB_USER)
+    {
+      evt = stack_event(sl_bt_evt_gatt_server_user_read_request_id, sizeof(sl_bt_evt_gatt_server_user_read_request_t));
+      if(evt == NULL)
+        return;
+
+      conn->read_pending = true;
+      conn->read_char = handle;
+      conn->read_opcode = opcode;
+      evt->data.evt_gatt_server_user_read_request.connection = stack_conn_handle(conn);
+      evt->data.evt_gatt_server_user_read_request.characteristic = handle;
+      evt->data.evt_gatt_server_user_read_request.att_opcode = opcode;
+      evt->data.evt_gatt_server_user_read_request.offset = offset;
+      return;
+    }
+
+  value_len = stack_attr_value(conn, attr, value);
+  if(offset > value_len)
+    {
+      stack_att_error(conn, opcode, handle, 0x07);       //Invalid Offset
+      return;
+    }
+
+  value_len = SL_MIN(value_len - offset, (size_t)(conn->mtu - 1));
+  rsp[0] = opcode + 1;
+  memcpy(&rsp[1], &value[offset], value_len);
+  stack_att_send(conn, rsp, value_len + 1);
+}
+
+
+/*
+ * Handles a Write request or command
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   const uint8_t *pdu
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_server_write(stack_conn_t *conn, const uint8_t *pdu, size_t len)
+{
+  uint8_t opcode = pdu[0];
+  uint16_t handle = get_le16(&pdu[1]);
+  const sli_bt_gattdb_attribute_t *attr = stack_attr(handle);
+  const sli_bt_gattdb_attribute_t *declaration;
+  uint8_t rsp = ATT_WRITE_RSP;
+  uint16_t config;
+  sl_bt_msg_t *evt;
+  uint8_t error = stack_attr_access(conn, attr, true);
+
+  if(error != 0)
+    {
+      if(opcode == ATT_WRITE_REQ)
+        stack_att_error(conn, opcode, handle, error);
+      return;
+    }
+
+  switch(attr->datatype)
+  {
+    case GATTDB_CONFIG:
+      if(len != 5)
+        {
+          stack_att_error(conn, opcode, handle, ATT_ERR_INVALID_LENGTH);
+          return;
+        }
+
+      config = get_le16(&pdu[3]);
+      if(config & ~attr->configdata.flags)
+        {
+          stack_att_error(conn, opcode, handle, ATT_ERR_CCCD_IMPROPER);
+          return;
+        }
+
+      conn->cccd[attr->configdata.clientconfig_index] = config;
+      if(opcode == ATT_WRITE_REQ)
+        stack_att_send(conn, &rsp, 1);
+
+      declaration = stack_attr_declaration(handle);
+      evt = stack_event(sl_bt_evt_gatt_server_characteristic_status_id, sizeof(sl_bt_evt_gatt_server_characteristic_status_t));
+      if((evt != NULL) && (declaration != NULL))
+        {
+          evt->data.evt_gatt_server_characteristic_status.connection = stack_conn_handle(conn);
+          evt->data.evt_gatt_server_characteristic_status.characteristic = declaration->handle + 1;
+          evt->data.evt_gatt_server_characteristic_status.status_flags = sl_bt_gatt_server_client_config;
+          evt->data.evt_gatt_server_characteristic_status.client_config_flags = config;
+          evt->data.evt_gatt_server_characteristic_status.client_config = handle;
+        }
+      break;
+
+    case GATTDB_USER:
+      evt = stack_event(sl_bt_evt_gatt_server_user_write_request_id, sizeof(sl_bt_evt_gatt_server_user_write_request_t) + len - 3);
+      if(evt == NULL)
+        return;
+
+      if(opcode == ATT_WRITE_REQ)
+        {
+          conn->write_pending = true;
+          conn->write_char = handle;
+        }
+      evt->data.evt_gatt_server_user_write_request.connection = stack_conn_handle(conn);
+      evt->data.evt_gatt_server_user_write_request.characteristic = handle;
+      evt->data.evt_gatt_server_user_write_request.att_opcode = opcode;
+      evt->data.evt_gatt_server_user_write_request.offset = 0;
+      evt->data.evt_gatt_server_user_write_request.value.len = (uint8_t)(len - 3);
+      memcpy(evt->data.evt_gatt_server_user_write_request.value.data, &pdu[3], len - 3);
+      break;
+
+    case GATTDB_DYNAMIC:
+      if((len - 3) > attr->dynamicdata->max_len)
+        {
+          stack_att_error(conn, opcode, handle, ATT_ERR_INVALID_LENGTH);
+          return;
+        }
+
+      attr->dynamicdata->len = (uint16_t)(len - 3);
+      memcpy(attr->dynamicdata->data, &pdu[3], len - 3);
+      if(opcode == ATT_WRITE_REQ)
+        stack_att_send(conn, &rsp, 1);
+      break;
+
+    default:
+      stack_att_error(conn, opcode, handle, ATT_ERR_WRITE_NOT_PERMITTED);
+      break;
+  }
+}
+
+
+/*
+ * Handles an ATT PDU the peer sent on a link
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   const uint8_t *pdu
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_att_receive(stack_conn_t *conn, const uint8_t *pdu, size_t len)
+{
+  uint8_t rsp[3];
+  sl_bt_msg_t *evt;
+
+  if(len == 0)
+    return;
+
+  switch(pdu[0])
+  {
+    case ATT_MTU_REQ:
+      if(len < 3)
+        break;
+
+      conn->mtu = SL_MAX(SL_MIN(get_le16(&pdu[1]), stack.max_mtu), STACK_ATT_DEFAULT_MTU);
+      rsp[0] = ATT_MTU_RSP;
+      put_le16(&rsp[1], stack.max_mtu);
+      stack_att_send(conn, rsp, sizeof(rsp));
+
+      evt = stack_event(sl_bt_evt_gatt_mtu_exchanged_id, sizeof(sl_bt_evt_gatt_mtu_exchanged_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_gatt_mtu_exchanged.connection = stack_conn_handle(conn);
+          evt->data.evt_gatt_mtu_exchanged.mtu = conn->mtu;
+        }
+      break;
+
+    case ATT_FIND_BY_TYPE_REQ:
+      if(len < 7)
+        stack_att_error(conn, pdu[0], 0, ATT_ERR_INVALID_PDU);
+      else
+        stack_server_find_by_type(conn, pdu, len);
+      break;
+
+    case ATT_READ_BY_TYPE_REQ:
+      if((len != 7) && (len != 21))
+        stack_att_error(conn, pdu[0], 0, ATT_ERR_INVALID_PDU);
+      else
+        stack_server_read_by_type(conn, pdu, len);
+      break;
+
+    case ATT_READ_REQ:
+      if(len >= 3)
+        stack_server_read(conn, pdu[0], get_le16(&pdu[1]), 0);
+      break;
+
+    case ATT_READ_BLOB_REQ:
+      if(len >= 5)
+        stack_server_read(conn, pdu[0], get_le16(&pdu[1]), get_le16(&pdu[3]));
+      break;
+
+    case ATT_WRITE_REQ:
+    case ATT_WRITE_CMD:
+      if(len >= 3)
+        stack_server_write(conn, pdu, len);
+      break;
+
+    case ATT_CONFIRMATION:
+      if(conn->indication_out == false)
+        break;
+
+      conn->indication_out = false;
+      evt = stack_event(sl_bt_evt_gatt_server_characteristic_status_id, sizeof(sl_bt_evt_gatt_server_characteristic_status_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_gatt_server_characteristic_status.connection = stack_conn_handle(conn);
+          evt->data.evt_gatt_server_characteristic_status.characteristic = conn->indication_char;
+          evt->data.evt_gatt_server_characteristic_status.status_flags = sl_bt_gatt_server_confirmation;
+        }
+      break;
+
+    case ATT_INDICATION:
+    case ATT_NOTIFICATION:
+      if((len < 3) || (len > STACK_ATT_PDU_MAX))
+        break;
+
+      evt = stack_event(sl_bt_evt_gatt_characteristic_value_id, sizeof(sl_bt_evt_gatt_characteristic_value_t) + len - 3);
+      if(evt == NULL)
+        break;
+
+      if(pdu[0] == ATT_INDICATION)
+        conn->confirm_owed = true;
+      evt->data.evt_gatt_characteristic_value.connection = stack_conn_handle(conn);
+      evt->data.evt_gatt_characteristic_value.characteristic = get_le16(&pdu[1]);
+      evt->data.evt_gatt_characteristic_value.att_opcode = pdu[0];
+      evt->data.evt_gatt_characteristic_value.offset = 0;
+      evt->data.evt_gatt_characteristic_value.value.len = (uint8_t)(len - 3);
+      memcpy(evt->data.evt_gatt_characteristic_value.value.data, &pdu[3], len - 3);
+      break;
+
+    case ATT_ERROR_RSP:
+    case ATT_MTU_RSP:
+    case ATT_FIND_BY_TYPE_RSP:
+    case ATT_READ_BY_TYPE_RSP:
+    case ATT_READ_RSP:
+    case ATT_READ_BLOB_RSP:
+    case ATT_WRITE_RSP:
+      stack_client_response(conn, pdu, len);
+      break;
+
+    default:
+      if(!(pdu[0] & ATT_COMMAND_FLAG))
+        stack_att_error(conn, pdu[0], 0, ATT_ERR_REQUEST_NOT_SUPPORTED);
+      break;
+  }
+}
+
+
+/*
+ * Returns the channel of a link by the CID of one of its ends
+ *
+ * Parameters:
+ *   uint8_t connection
+ *   uint16_t cid
+ *   bool remote: true to match the CID of the peer, false to match the local one
+ *
+ * Returns:
+ *   stack_coc_t *: NULL if no channel of the link uses the CID
+ */
+static stack_coc_t *stack_coc_find(uint8_t connection, uint16_t cid, bool remote)
+{
+  for(uint32_t i = 0; i < STACK_MAX_COC; i++)
+    {
+      if((cocs[i].in_use == true) && (cocs[i].connection == connection) &&
+          (((remote == true) ? cocs[i].remote_cid : cocs[i].local_cid) == cid))
+        return &cocs[i];
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Reserves a free channel, NULL once SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS are in use
+ *
+ * Parameters:
+ *   uint8_t connection
+ *
+ * Returns:
+ *   stack_coc_t *
+ */
+static stack_coc_t *stack_coc_alloc(uint8_t connection)
+{
+  for(uint32_t i = 0; i < SL_BT_CONFIG_USER_L2CAP_COC_CHANNELS; i++)
+    {
+      if(cocs[i].in_use == false)
+        {
+          memset(&cocs[i], 0, sizeof(cocs[i]));
+          cocs[i].in_use = true;
+          cocs[i].connection = connection;
+          cocs[i].local_cid = (uint16_t)(STACK_L2CAP_FIRST_DYNAMIC_CID + i);
+          return &cocs[i];
+        }
+    }
+
+  return NULL;
+}
+
+
+/*
+ * Sends an LE signaling command
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   uint8_t code
+ *   uint8_t identifier: Identifier of the request, or of the request answered
+ *   const uint8_t *data: Command data
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_signal_send(stack_conn_t *conn, uint8_t code, uint8_t identifier, const uint8_t *data, size_t len)
+{
+  uint8_t pdu[16];
+
+  pdu[0] = code;
+  pdu[1] = identifier;
+  put_le16(&pdu[2], (uint16_t)len);
+  memcpy(&pdu[4], data, len);
+  stack_l2cap_send(conn, STACK_L2CAP_SIGNALING_CID, pdu, len + 4);
+}
+
+
+/*
+ * Frees a channel, telling the peer and the firmware
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   stack_coc_t *coc
+ *   uint16_t reason: Status the firmware gets in the channel disconnected event
+ *   bool request: true to send the disconnection request to the peer
+ *
+ * Returns:
+ *   None
+ */
+static void stack_coc_disconnect(stack_conn_t *conn, stack_coc_t *coc, uint16_t reason, bool request)
+{
+  sl_bt_msg_t *evt;
+  uint8_t data[4];
+
+  if(request == true)
+    {
+      put_le16(&data[0], coc->remote_cid);
+      put_le16(&data[2], coc->local_cid);
+      stack_signal_send(conn, L2CAP_DISCONNECTION_REQ, ++conn->signaling_identifier, data, sizeof(data));
+    }
+
+  evt = stack_event(sl_bt_evt_l2cap_coc_channel_disconnected_id, sizeof(sl_bt_evt_l2cap_coc_channel_disconnected_t));
+  if(evt != NULL)
+    {
+      evt->data.evt_l2cap_coc_channel_disconnected.connection = coc->connection;
+      evt->data.evt_l2cap_coc_channel_disconnected.cid = coc->remote_cid;
+      evt->data.evt_l2cap_coc_channel_disconnected.reason = reason;
+    }
+
+  memset(coc, 0, sizeof(*coc));
+}
+
+
+/*
+ * Handles an LE signaling command the peer sent on a link
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   const uint8_t *pdu
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_signal_receive(stack_conn_t *conn, const uint8_t *pdu, size_t len)
+{
+  uint8_t connection = stack_conn_handle(conn);
+  uint8_t data[10];
+  sl_bt_msg_t *evt;
+  stack_coc_t *coc;
+
+  if((len < 4) || (get_le16(&pdu[2]) > (len - 4)))
+    return;
+
+  switch(pdu[0])
+  {
+    case L2CAP_LE_CREDIT_CONNECTION_REQ:
+      if(len < 14)
+        return;
+
+      //With every channel in use the stack refuses on its own, the firmware never hears of the request
+      coc = stack_coc_alloc(connection);
+      if(coc == NULL)
+        {
+          memset(data, 0, sizeof(data));
+          put_le16(&data[8], sl_bt_l2cap_no_resources_available);
+          stack_signal_send(conn, L2CAP_LE_CREDIT_CONNECTION_RSP, pdu[1], data, sizeof(data));
+          return;
+        }
+
+      coc->identifier = pdu[1];
+      coc->remote_cid = get_le16(&pdu[6]);
+      coc->remote_mtu = get_le16(&pdu[8]);
+      coc->remote_mps = get_le16(&pdu[10]);
+      coc->tx_credits = get_le16(&pdu[12]);
+
+      evt = stack_event(sl_bt_evt_l2cap_coc_connection_request_id, sizeof(sl_bt_evt_l2cap_coc_connection_request_t));
+      if(evt == NULL)
+        return;
+
+      evt->data.evt_l2cap_coc_connection_request.connection = connection;
+      evt->data.evt_l2cap_coc_connection_request.le_psm = get_le16(&pdu[4]);
+      evt->data.evt_l2cap_coc_connection_request.source_cid = coc->remote_cid;
+      evt->data.evt_l2cap_coc_connection_request.mtu = coc->remote_mtu;
+      evt->data.evt_l2cap_coc_connection_request.mps = coc->remote_mps;
+      evt->data.evt_l2cap_coc_connection_request.initial_credit = coc->tx_credits;
+      evt->data.evt_l2cap_coc_connection_request.flags = conn->security;
+      evt->data.evt_l2cap_coc_connection_request.encryption_key_size = (conn->security != sl_bt_connection_mode1_level1) ? 16 : 0;
+      break;
+
+    case L2CAP_LE_CREDIT_CONNECTION_RSP:
+      if(len < 14)
+        return;
+
+      coc = NULL;
+      for(uint32_t i = 0; (coc == NULL) && (i < STACK_MAX_COC); i++)
+        {
+          if((cocs[i].in_use == true) && (cocs[i].open == false) && (cocs[i].remote_cid == 0) &&
+              (cocs[i].connection == connection) && (cocs[i].identifier == pdu[1]))
+            coc = &cocs[i];
+        }
+      if(coc == NULL)
+        return;
+
+      evt = stack_event(sl_bt_evt_l2cap_coc_connection_response_id, sizeof(sl_bt_evt_l2cap_coc_connection_response_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_l2cap_coc_connection_response.connection = connection;
+          evt->data.evt_l2cap_coc_connection_response.destination_cid = get_le16(&pdu[4]);
+          evt->data.evt_l2cap_coc_connection_response.mtu = get_le16(&pdu[6]);
+          evt->data.evt_l2cap_coc_connection_response.mps = get_le16(&pdu[8]);
+          evt->data.evt_l2cap_coc_connection_response.initial_credit = get_le16(&pdu[10]);
+          evt->data.evt_l2cap_coc_connection_response.l2cap_errorcode = get_le16(&pdu[12]);
+        }
+
+      if(get_le16(&pdu[12]) != sl_bt_l2cap_connection_successful)
+        {
+          memset(coc, 0, sizeof(*coc));
+          return;
+        }
+
+      coc->open = true;
+      coc->remote_cid = get_le16(&pdu[4]);
+      coc->remote_mtu = get_le16(&pdu[6]);
+      coc->remote_mps = get_le16(&pdu[8]);
+      coc->tx_credits = get_le16(&pdu[10]);
+      break;
+
+    case L2CAP_LE_FLOW_CONTROL_CREDIT:
+      if(len < 8)
+        return;
+
+      coc = stack_coc_find(connection, get_le16(&pdu[4]), true);
+      if((coc == NULL) || (coc->open == false))
+        return;
+
+      if(((uint32_t)coc->tx_credits + get_le16(&pdu[6])) > 0xFFFF)
+        {
+          stack_coc_disconnect(conn, coc, SL_STATUS_BT_L2CAP_FLOW_CONTROL_CREDIT_OVERFLOWED, true);
+          return;
+        }
+
+      coc->tx_credits += get_le16(&pdu[6]);
+      evt = stack_event(sl_bt_evt_l2cap_coc_le_flow_control_credit_id, sizeof(sl_bt_evt_l2cap_coc_le_flow_control_credit_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_l2cap_coc_le_flow_control_credit.connection = connection;
+          evt->data.evt_l2cap_coc_le_flow_control_credit.cid = coc->remote_cid;
+          evt->data.evt_l2cap_coc_le_flow_control_credit.credits = get_le16(&pdu[6]);
+        }
+      break;
+
+    case L2CAP_DISCONNECTION_REQ:
+      if(len < 8)
+        return;
+
+      //Destination first: the CID of this end, then the CID of the peer
+      coc = stack_coc_find(connection, get_le16(&pdu[4]), false);
+      memcpy(data, &pdu[4], 4);
+      stack_signal_send(conn, L2CAP_DISCONNECTION_RSP, pdu[1], data, 4);
+      if(coc != NULL)
+        stack_coc_disconnect(conn, coc, SL_STATUS_BT_L2CAP_REMOTE_DISCONNECTED, false);
+      break;
+
+    case L2CAP_DISCONNECTION_RSP:
+      break;
+
+    case L2CAP_COMMAND_REJECT:
+      if(len < 6)
+        return;
+
+      evt = stack_event(sl_bt_evt_l2cap_command_rejected_id, sizeof(sl_bt_evt_l2cap_command_rejected_t));
+      if(evt == NULL)
+        return;
+
+      evt->data.evt_l2cap_command_rejected.connection = connection;
+      evt->data.evt_l2cap_command_rejected.reason = get_le16(&pdu[4]);
+
+      //The rejected request is the one sent with the identifier of the reject
+      for(uint32_t i = 0; i < STACK_MAX_COC; i++)
+        {
+          if((cocs[i].in_use == true) && (cocs[i].open == false) && (cocs[i].remote_cid == 0) &&
+              (cocs[i].connection == connection) && (cocs[i].identifier == pdu[1]))
+            {
+              evt->data.evt_l2cap_command_rejected.code = sl_bt_l2cap_connection_request;
+              memset(&cocs[i], 0, sizeof(cocs[i]));
+            }
+        }
+      break;
+
+    default:
+      //Responses this end never asked for are dropped, requests it does not know are rejected
+      if((pdu[0] & 0x01) == 0)
+        {
+          put_le16(data, sl_bt_l2cap_command_not_understood);
+          stack_signal_send(conn, L2CAP_COMMAND_REJECT, pdu[1], data, 2);
+        }
+      break;
+  }
+}
+
+
+/*
+ * Handles a K-frame the peer sent on a credit based channel and hands it on in a data event
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *   uint16_t cid: Local CID the frame was sent to
+ *   const uint8_t *pdu
+ *   size_t len
+ *
+ * Returns:
+ *   None
+ */
+static void stack_coc_receive(stack_conn_t *conn, uint16_t cid, const uint8_t *pdu, size_t len)
+{
+  stack_coc_t *coc = stack_coc_find(stack_conn_handle(conn), cid, false);
+  sl_bt_msg_t *evt;
+
+  if((coc == NULL) || (coc->open == false))
+    return;
+
+  if(coc->rx_credits == 0)
+    {
+      stack_coc_disconnect(conn, coc, SL_STATUS_BT_L2CAP_FLOW_CONTROL_VIOLATED, true);
+      return;
+    }
+  coc->rx_credits--;
+
+  if(len > coc->local_mps)
+    {
+      stack_coc_disconnect(conn, coc, SL_STATUS_BT_L2CAP_LE_DISCONNECTED, true);
+      return;
+    }
+
+  evt = stack_event(sl_bt_evt_l2cap_coc_data_id, sizeof(sl_bt_evt_l2cap_coc_data_t) + len);
+  if(evt == NULL)
+    return;
+
+  evt->data.evt_l2cap_coc_data.connection = coc->connection;
+  evt->data.evt_l2cap_coc_data.cid = coc->remote_cid;
+  evt->data.evt_l2cap_coc_data.data.len = (uint8_t)len;
+  memcpy(evt->data.evt_l2cap_coc_data.data.data, pdu, len);
+}
+
+
+/*
+ * Queues the parameters event of a link
+ *
+ * Parameters:
+ *   stack_conn_t *conn
+ *
+ * Returns:
+ *   None
+ */
+static void stack_parameters_event(stack_conn_t *conn)
+{
+  sl_bt_msg_t *evt = stack_event(sl_bt_evt_connection_parameters_id, sizeof(sl_bt_evt_connection_parameters_t));
+
+  if(evt == NULL)
+    return;
+
+  evt->data.evt_connection_parameters.connection = stack_conn_handle(conn);
+  evt->data.evt_connection_parameters.interval = conn->interval;
+  evt->data.evt_connection_parameters.latency = conn->latency;
+  evt->data.evt_connection_parameters.timeout = conn->timeout;
+  evt->data.evt_connection_parameters.security_mode = conn->security;
+  evt->data.evt_connection_parameters.txsize = conn->txsize;
+}
+
+
+/*
+ * Builds the advertising data the stack sends when the firmware sets none: the flags and the 128-bit
+ * UUIDs of the advertised services that fit, marked incomplete when one does not
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void stack_adv_data()
+{
+  const sli_bt_gattdb_attribute_t *attr;
+  size_t list = 0;
+  bool complete = true;
+
+  stack.adv_data[0] = 2;
+  stack.adv_data[1] = 0x01;                               //Flags
+  stack.adv_data[2] = 0x06;                               //LE General Discoverable, BR/EDR not supported
+  stack.adv_len = 3;
+
+  for(uint16_t h = 1; (attr = stack_attr(h)) != NULL; h++)
+    {
+      if(!stack_attr_is(attr, GATT_UUID_PRIMARY_SERVICE) || !(attr->permissions & GATTDB_PERM_ADVERTISED) ||
+          (attr->constdata->len != 16))
+        continue;
+
+      if(list == 0)
+        {
+          if((stack.adv_len + 2 + 16) > STACK_ADV_DATA_MAX)
+            {
+              complete = false;
+              break;
+            }
+          list = stack.adv_len;
+          stack.adv_data[list] = 1;
+          stack.adv_len += 2;
+        }
+
+      if((stack.adv_len + 16) > STACK_ADV_DATA_MAX)
+        {
+          complete = false;
+          break;
+        }
+
+      memcpy(&stack.adv_data[stack.adv_len], attr->constdata->data, 16);
+      stack.adv_data[list] += 16;
+      stack.adv_len += 16;
+    }
+
+  if(list != 0)
+    stack.adv_data[list + 1] = (complete == true) ? 0x07 : 0x06;
+}
+
+
+/*
+ * Fills the database hash the stack computes over the GATT database at boot
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+static void stack_database_hash()
+{
+  const sli_bt_gattdb_attribute_t *attr = stack_attr(gattdb_database_hash);
+  const sli_bt_gattdb_attribute_t *a;
+  uint64_t hash[2] = { 0xCBF29CE484222325ULL, 0x84222325CBF29CE4ULL };
+  uint8_t value[STACK_ATT_PDU_MAX];
+  size_t len;
+
+  //Two FNV-1a runs over the types and values of the database, not the AES-CMAC of the specification
+  for(uint16_t h = 1; h <= gattdb.attribute_num; h++)
+    {
+      a = stack_attr(h);
+      len = stack_uuid(value, a->uuid);
+      if((a->datatype == GATTDB_CONST) || (a->datatype == GATTDB_CHARACTERISTIC))
+        len += stack_attr_value(NULL, a, &value[len]);
+
+      for(size_t i = 0; i < len; i++)
+        {
+          hash[0] = (hash[0] ^ value[i]) * 0x100000001B3ULL;
+          hash[1] = (hash[1] ^ value[len - 1 - i]) * 0x100000001B3ULL;
+        }
+    }
+
+  for(uint32_t i = 0; (i < 16) && (i < attr->dynamicdata->max_len); i++)
+    attr->dynamicdata->data[i] = (uint8_t)(hash[i / 8] >> ((i % 8) * 8));
+  attr->dynamicdata->len = SL_MIN(16, attr->dynamicdata->max_len);
+}
+
+
+/*
+ * Sets up the stack
+ *
+ * Parameters:
+ *   const bd_addr *address: Identity address of the node
+ *
+ * Returns:
+ *   None
+ */
+void stackInit(const bd_addr *address)
+{
+  stack.address = *address;
+  stack.max_mtu = STACK_ATT_MAX_MTU;
+  stack.tx_max = SL_BT_CONFIG_MAX_TX_POWER;
+  stack.scan_interval = 16;
+  stack.scan_window = 16;
+  stack.conn_min = 24;
+  stack.conn_max = 40;
+  stack.conn_latency = 0;
+  stack.conn_timeout = 100;
+
+  stack_adv_data();
+  stack_database_hash();
+}
+
+
+/*
+ * Queues the boot event
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void stackBoot()
+{
+  sl_bt_msg_t *evt = stack_event(sl_bt_evt_system_boot_id, sizeof(sl_bt_evt_system_boot_t));
+
+  if(evt == NULL)
+    return;
+
+  evt->data.evt_system_boot.major = 3;
+  evt->data.evt_system_boot.minor = 2;
+  evt->data.evt_system_boot.patch = 3;
+}
+
+
+/*
+ * Returns the earliest time the stack raises an event on its own
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   uint64_t time_us: HOST_NO_DEADLINE with nothing ahead
+ */
+uint64_t stackNextDeadline()
+{
+  uint64_t deadline = HOST_NO_DEADLINE;
+
+  for(uint32_t i = 0; i < STACK_MAX_TIMERS; i++)
+    {
+      if((timers[i].active == true) && (timers[i].next_us < deadline))
+        deadline = timers[i].next_us;
+    }
+
+  for(uint32_t i = 0; i < STACK_MAX_ADVERTISERS; i++)
+    {
+      if((advs[i].running == true) && (advs[i].duration != 0) && (advs[i].stop_us < deadline))
+        deadline = advs[i].stop_us;
+    }
+
+  for(uint32_t i = 0; i < STACK_MAX_CONNECTIONS; i++)
+    {
+      if((conns[i].in_use == true) && (conns[i].indication_out == true) && (conns[i].att_dead == false) &&
+          (conns[i].indication_deadline < deadline))
+        deadline = conns[i].indication_deadline;
+    }
+
+  return deadline;
+}
+
+
+/*
+ * Raises the events of the deadlines that are due
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void stackRun()
+{
+  sl_bt_msg_t *evt;
+
+  for(uint32_t i = 0; i < STACK_MAX_TIMERS; i++)
+    {
+      if((timers[i].active == false) || (timers[i].next_us > host_now_us))
+        continue;
+
+      evt = stack_event(sl_bt_evt_system_soft_timer_id, sizeof(sl_bt_evt_system_soft_timer_t));
+      if(evt != NULL)
+        evt->data.evt_system_soft_timer.handle = timers[i].handle;
+
+      if(timers[i].single_shot == true)
+        timers[i].active = false;
+      else
+        {
+          timers[i].count++;
+          timers[i].next_us = timers[i].start_us + (((timers[i].count + 1) * timers[i].time * 1000000ULL) / STACK_SOFT_TIMER_HZ);
+        }
+    }
+
+  for(uint32_t i = 0; i < STACK_MAX_ADVERTISERS; i++)
+    {
+      if((advs[i].running == false) || (advs[i].duration == 0) || (advs[i].stop_us > host_now_us))
+        continue;
+
+      advs[i].running = false;
+      hostPrint("ADV_STOP %lu", (unsigned long)i);
+      evt = stack_event(sl_bt_evt_advertiser_timeout_id, sizeof(sl_bt_evt_advertiser_timeout_t));
+      if(evt != NULL)
+        evt->data.evt_advertiser_timeout.handle = (uint8_t)i;
+    }
+
+  for(uint32_t i = 0; i < STACK_MAX_CONNECTIONS; i++)
+    {
+      if((conns[i].in_use == false) || (conns[i].indication_out == false) || (conns[i].att_dead == true) ||
+          (conns[i].indication_deadline > host_now_us))
+        continue;
+
+      conns[i].att_dead = true;
+      evt = stack_event(sl_bt_evt_gatt_server_indication_timeout_id, sizeof(sl_bt_evt_gatt_server_indication_timeout_t));
+      if(evt != NULL)
+        evt->data.evt_gatt_server_indication_timeout.connection = (uint8_t)(i + 1);
+    }
+}
+
+
+/*
+ * Takes the next event off the queue, external signals raised since it was queued are merged into it
+ *
+ * Parameters:
+ *   sl_bt_msg_t *evt: Copy of the event
+ *
+ * Returns:
+ *   bool: false with the queue empty
+ */
+bool stackPopEvent(sl_bt_msg_t *evt)
+{
+  if(event_count == 0)
+    return false;
+
+  *evt = event_queue[event_head];
+  event_head = (event_head + 1) % STACK_EVENT_QUEUE;
+  event_count--;
+
+  if(SL_BT_MSG_ID(evt->header) == sl_bt_evt_system_external_signal_id)
+    {
+      evt->data.evt_system_external_signal.extsignals = signal_pending;
+      signal_pending = 0;
+      signal_queued = false;
+    }
+
+  stack.events++;
+  return true;
+}
+
+
+/*
+ * Records the last temperature sample, indications are tagged with it for the latency of the driver
+ *
+ * Parameters:
+ *   uint32_t seq: Samples taken since boot
+ *
+ * Returns:
+ *   None
+ */
+void stackSample(uint32_t seq)
+{
+  stack.sample_seq = seq;
+}
+
+
+/*
+ * Returns the number of links with indications of a characteristic enabled
+ *
+ * Parameters:
+ *   uint16_t characteristic: Value handle
+ *
+ * Returns:
+ *   uint32_t
+ */
+uint32_t stackIndicationsEnabled(uint16_t characteristic)
+{
+  const sli_bt_gattdb_attribute_t *cccd = stack_attr_cccd(characteristic);
+  uint32_t count = 0;
+
+  if(cccd == NULL)
+    return 0;
+
+  for(uint32_t i = 0; i < STACK_MAX_CONNECTIONS; i++)
+    {
+      if((conns[i].in_use == true) && (conns[i].open == true) && (conns[i].cccd[cccd->configdata.clientconfig_index] & sl_bt_gatt_server_indication))
+        count++;
+    }
+
+  return count;
+}
+
+
+/*
+ * Prints the totals of the stack to stderr
+ *
+ * Parameters:
+ *   None
+ *
+ * Returns:
+ *   None
+ */
+void stackReport()
+{
+  fprintf(stderr, "host: %lu stack events, %lu dropped\n", (unsigned long)stack.events, (unsigned long)stack.dropped);
+}
+
+
+/*
+ * Applies a command of the driver that comes from the air or the peer
+ *
+ * Parameters:
+ *   const char *command: First word of the line
+ *   char *args: Rest of the line
+ *
+ * Returns:
+ *   None
+ */
+void stackCommand(const char *command, char *args)
+{
+  sl_bt_msg_t *evt;
+  stack_conn_t *conn;
+  char addr_text[32];
+  char hex[(STACK_ATT_PDU_MAX * 2) + 8];
+  char link[32];
+  char handle_text[8];
+  uint8_t data[STACK_ATT_PDU_MAX];
+  unsigned int a, b, c, d, e, f, g;
+  int rssi;
+  size_t len;
+  bd_addr address;
+
+  if(strcmp(command, "ADV") == 0)
+    {
+      //ADV <addr> <addr_type> <packet_type> <rssi> <tx_power> <hex>
+      if((stack.scanning == false) || (sscanf(args, "%31s %u %u %d %d %519s", addr_text, &a, &b, &rssi, (int *)&c, hex) != 6) ||
+          (stack_addr_parse(&address, addr_text) == false))
+        return;
+
+      len = hostUnhex(data, STACK_ADV_DATA_MAX, hex);
+      evt = stack_event(sl_bt_evt_scanner_scan_report_id, sizeof(sl_bt_evt_scanner_scan_report_t) + len);
+      if(evt == NULL)
+        return;
+
+      evt->data.evt_scanner_scan_report.packet_type = (uint8_t)b;
+      evt->data.evt_scanner_scan_report.address = address;
+      evt->data.evt_scanner_scan_report.address_type = (uint8_t)a;
+      evt->data.evt_scanner_scan_report.bonding = STACK_NO_BONDING;
+      evt->data.evt_scanner_scan_report.primary_phy = sl_bt_gap_1m_phy;
+      evt->data.evt_scanner_scan_report.secondary_phy = 0;
+      evt->data.evt_scanner_scan_report.adv_sid = 0xFF;
+      evt->data.evt_scanner_scan_report.tx_power = (int8_t)(int)c;
+      evt->data.evt_scanner_scan_report.rssi = (int8_t)rssi;
+      evt->data.evt_scanner_scan_report.channel = 37;
+      evt->data.evt_scanner_scan_report.data.len = (uint8_t)len;
+      memcpy(evt->data.evt_scanner_scan_report.data.data, data, len);
+      return;
+    }
+
+  if(strcmp(command, "CONNECTED") == 0)
+    {
+      //CONNECTED <link> <conn|-> <central> <peer_addr> <peer_type> <advertiser> <bonding> <interval> <latency> <timeout>
+      if((sscanf(args, "%31s %7s %u %31s %u %u %u %u %u %u", link, handle_text, &a, addr_text, &b, &c, &d, &e, &f, &g) != 10) ||
+          (stack_addr_parse(&address, addr_text) == false))
+        return;
+
+      conn = NULL;
+      if(strcmp(handle_text, "-") != 0)
+        conn = stack_conn((uint8_t)atoi(handle_text));
+      else
+        {
+          for(uint32_t i = 0; (conn == NULL) && (i < STACK_MAX_CONNECTIONS); i++)
+            {
+              if(conns[i].in_use == false)
+                conn = &conns[i];
+            }
+        }
+
+      if(conn == NULL)
+        {
+          hostPrint("HANDLE %s -", link);
+          return;
+        }
+
+      memset(conn, 0, sizeof(*conn));
+      conn->in_use = true;
+      conn->open = true;
+      conn->central = (a != 0);
+      conn->peer = address;
+      conn->peer_type = (uint8_t)b;
+      conn->advertiser = (uint8_t)c;
+      conn->bonding = (uint8_t)d;
+      conn->interval = (uint16_t)e;
+      conn->latency = (uint16_t)f;
+      conn->timeout = (uint16_t)g;
+      conn->txsize = STACK_DEFAULT_TXSIZE;
+      conn->security = sl_bt_connection_mode1_level1;
+      conn->mtu = STACK_ATT_DEFAULT_MTU;
+      hostPrint("HANDLE %s %u", link, stack_conn_handle(conn));
+
+      //A connectable set stops once a central connects to it
+      if((conn->central == false) && (conn->advertiser < STACK_MAX_ADVERTISERS) && (advs[conn->advertiser].running == true))
+        {
+          advs[conn->advertiser].running = false;
+          hostPrint("ADV_STOP %u", conn->advertiser);
+        }
+
+      evt = stack_event(sl_bt_evt_connection_opened_id, sizeof(sl_bt_evt_connection_opened_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_connection_opened.address = conn->peer;
+          evt->data.evt_connection_opened.address_type = conn->peer_type;
+          evt->data.evt_connection_opened.master = (conn->central == true) ? 1 : 0;
+          evt->data.evt_connection_opened.connection = stack_conn_handle(conn);
+          evt->data.evt_connection_opened.bonding = conn->bonding;
+          evt->data.evt_connection_opened.advertiser = (conn->central == true) ? 0xFF : conn->advertiser;
+        }
+      stack_parameters_event(conn);
+
+      if((conn->central == true) && (stack.max_mtu > STACK_ATT_DEFAULT_MTU))
+        {
+          data[0] = ATT_MTU_REQ;
+          put_le16(&data[1], stack.max_mtu);
+          stack_att_send(conn, data, 3);
+          conn->mtu_pending = true;
+        }
+      return;
+    }
+
+  if(sscanf(args, "%u", &a) != 1)
+    return;
+  conn = stack_conn((uint8_t)a);
+  if(conn == NULL)
+    return;
+
+  if(strcmp(command, "CLOSED") == 0)
+    {
+      //CLOSED <conn> <reason>
+      if(sscanf(args, "%u %x", &a, &b) != 2)
+        return;
+
+      //Channels go with their link, the firmware learns it from the closed event
+      for(uint32_t i = 0; i < STACK_MAX_COC; i++)
+        {
+          if((cocs[i].in_use == true) && (cocs[i].connection == (uint8_t)a))
+            memset(&cocs[i], 0, sizeof(cocs[i]));
+        }
+
+      memset(conn, 0, sizeof(*conn));
+      evt = stack_event(sl_bt_evt_connection_closed_id, sizeof(sl_bt_evt_connection_closed_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_connection_closed.reason = (uint16_t)b;
+          evt->data.evt_connection_closed.connection = (uint8_t)a;
+        }
+    }
+  else if(strcmp(command, "L2CAP") == 0)
+    {
+      //L2CAP <conn> <cid> <hex>
+      if(sscanf(args, "%u %u %519s", &a, &b, hex) != 3)
+        return;
+
+      len = hostUnhex(data, sizeof(data), hex);
+      if(b == STACK_L2CAP_ATT_CID)
+        stack_att_receive(conn, data, len);
+      else if(b == STACK_L2CAP_SIGNALING_CID)
+        stack_signal_receive(conn, data, len);
+      else if(b >= STACK_L2CAP_FIRST_DYNAMIC_CID)
+        stack_coc_receive(conn, (uint16_t)b, data, len);
+    }
+  else if(strcmp(command, "PARAMS") == 0)
+    {
+      //PARAMS <conn> <interval> <latency> <timeout> <txsize>
+      if(sscanf(args, "%u %u %u %u %u", &a, &b, &c, &d, &e) != 5)
+        return;
+
+      conn->interval = (uint16_t)b;
+      conn->latency = (uint16_t)c;
+      conn->timeout = (uint16_t)d;
+      conn->txsize = (uint16_t)e;
+      stack_parameters_event(conn);
+    }
+  else if(strcmp(command, "PHY") == 0)
+    {
+      //PHY <conn> <phy>
+      if(sscanf(args, "%u %u", &a, &b) != 2)
+        return;
+
+      evt = stack_event(sl_bt_evt_connection_phy_status_id, sizeof(sl_bt_evt_connection_phy_status_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_connection_phy_status.connection = (uint8_t)a;
+          evt->data.evt_connection_phy_status.phy = (uint8_t)b;
+        }
+    }
+  else if(strcmp(command, "RSSI") == 0)
+    {
+      //RSSI <conn> <rssi>
+      if(sscanf(args, "%u %d", &a, &rssi) != 2)
+        return;
+
+      evt = stack_event(sl_bt_evt_connection_rssi_id, sizeof(sl_bt_evt_connection_rssi_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_connection_rssi.connection = (uint8_t)a;
+          evt->data.evt_connection_rssi.status = 0;
+          evt->data.evt_connection_rssi.rssi = (int8_t)rssi;
+        }
+    }
+  else if(strcmp(command, "ENCRYPTED") == 0)
+    {
+      //ENCRYPTED <conn> <bonding>, the link is encrypted with the keys of a stored bond
+      if(sscanf(args, "%u %u", &a, &b) != 2)
+        return;
+
+      conn->bonding = (uint8_t)b;
+      conn->security = sl_bt_connection_mode1_level4;
+      stack_parameters_event(conn);
+    }
+  else if(strcmp(command, "BOND_REQ") == 0)
+    {
+      //BOND_REQ <conn>, the central asks the peripheral to pair and bond
+      conn->bonding_pending = true;
+      evt = stack_event(sl_bt_evt_sm_confirm_bonding_id, sizeof(sl_bt_evt_sm_confirm_bonding_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_sm_confirm_bonding.connection = (uint8_t)a;
+          evt->data.evt_sm_confirm_bonding.bonding_handle = (uint8_t)-1;
+        }
+    }
+  else if(strcmp(command, "PASSKEY_SHOW") == 0)
+    {
+      //PASSKEY_SHOW <conn> <passkey>, numeric comparison with display and yes/no on both boards
+      if(sscanf(args, "%u %u", &a, &b) != 2)
+        return;
+
+      conn->passkey_pending = true;
+      evt = stack_event(sl_bt_evt_sm_confirm_passkey_id, sizeof(sl_bt_evt_sm_confirm_passkey_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_sm_confirm_passkey.connection = (uint8_t)a;
+          evt->data.evt_sm_confirm_passkey.passkey = b;
+        }
+    }
+  else if(strcmp(command, "BONDED") == 0)
+    {
+      //BONDED <conn> <bonding>
+      if(sscanf(args, "%u %u", &a, &b) != 2)
+        return;
+
+      conn->passkey_pending = false;
+      conn->bonding = (uint8_t)b;
+      conn->security = sl_bt_connection_mode1_level4;
+      stack_parameters_event(conn);
+
+      evt = stack_event(sl_bt_evt_sm_bonded_id, sizeof(sl_bt_evt_sm_bonded_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_sm_bonded.connection = (uint8_t)a;
+          evt->data.evt_sm_bonded.bonding = (uint8_t)b;
+          evt->data.evt_sm_bonded.security_mode = sl_bt_connection_mode1_level4;
+        }
+    }
+  else if(strcmp(command, "BOND_FAILED") == 0)
+    {
+      //BOND_FAILED <conn> <reason>
+      if(sscanf(args, "%u %x", &a, &b) != 2)
+        return;
+
+      conn->passkey_pending = false;
+      conn->bonding_pending = false;
+      evt = stack_event(sl_bt_evt_sm_bonding_failed_id, sizeof(sl_bt_evt_sm_bonding_failed_t));
+      if(evt != NULL)
+        {
+          evt->data.evt_sm_bonding_failed.connection = (uint8_t)a;
+          evt->data.evt_sm_bonding_failed.reason = (uint16_t)b;
+        }
+    }
+}
+
+
+void sl_bt_external_signal(uint32_t signals)
+{
+  sl_bt_msg_t *evt;
+
+  signal_pending |= signals;
+  if(signal_queued == true)
+    return;
+
+  evt = stack_event(sl_bt_evt_system_external_signal_id, sizeof(sl_bt_evt_system_external_signal_t));
+  if(evt != NULL)
+    signal_queued = true;
+}
+
+
+sl_status_t sl_bt_system_get_identity_address(bd_addr *address, uint8_t *type)
+{
+  *address = stack.address;
+  *type = 0;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_system_set_soft_timer(uint32_t time, uint8_t handle, uint8_t single_shot)
+{
+  stack_timer_t *timer = NULL;
+
+  for(uint32_t i = 0; (timer == NULL) && (i < STACK_MAX_TIMERS); i++)
+    {
+      if((timers[i].active == true) && (timers[i].handle == handle))
+        timer = &timers[i];
+    }
+
+  if(time == 0)
+    {
+      if(timer != NULL)
+        timer->active = false;
+      return SL_STATUS_OK;
+    }
+
+  for(uint32_t i = 0; (timer == NULL) && (i < STACK_MAX_TIMERS); i++)
+    {
+      if(timers[i].active == false)
+        timer = &timers[i];
+    }
+
+  if(timer == NULL)
+    return SL_STATUS_NO_MORE_RESOURCE;
+
+  timer->active = true;
+  timer->handle = handle;
+  timer->single_shot = (single_shot != 0);
+  timer->time = time;
+  timer->start_us = host_now_us;
+  timer->count = 0;
+  timer->next_us = host_now_us + ((time * 1000000ULL) / STACK_SOFT_TIMER_HZ);
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_system_set_tx_power(int16_t min_power, int16_t max_power, int16_t *set_min, int16_t *set_max)
+{
+  *set_min = SL_MAX(min_power, SL_BT_CONFIG_MIN_TX_POWER);
+  *set_max = SL_MIN(SL_MAX(max_power, *set_min), SL_BT_CONFIG_MAX_TX_POWER);
+  stack.tx_max = *set_max;
+  hostPrint("TXPOWER %d", stack.tx_max);
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_system_linklayer_configure(uint8_t key, size_t data_len, const uint8_t *data)
+{
+  //The driver does not model LE Power Control, links run at the radio's maximum
+  (void)key;
+  (void)data_len;
+  (void)data;
+  return SL_STATUS_OK;
+}
+
+
+sl_status_t sl_bt_advertiser_create_set(uint8_t *handle)
+{
+  for(uint32_t i = 0; i < STACK_MAX_ADVERTISERS; i++)
+    {
+      if(advs[i].created == false)
+        {
+          memset(&advs[i], 0, sizeof(advs[i]));
+          advs[i].created = true;
+          advs[i].interval = 160;
+          advs[i].power = SL_BT_CONFIG_MAX_TX_POWER;
+          *handle = (uint8_t)i;
+          return SL_STATUS_OK;
+        }
+    }
+
+  return SL_STATUS_NO_MORE_RESOURCE;
+}
+
+sl_status_t sl_bt_advertiser_set_timing(uint8_t handle, uint32_t interval_min, uint32_t interval_max, uint16_t duration, uint8_t maxevents)
+{
+  (void)interval_max;
+  (void)maxevents;
+
+  if((handle >= STACK_MAX_ADVERTISERS) || (advs[handle].created == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  advs[handle].interval = interval_min;
+  advs[handle].duration = duration;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_advertiser_set_tx_power(uint8_t handle, int16_t power, int16_t *set_power)
+{
+  if((handle >= STACK_MAX_ADVERTISERS) || (advs[handle].created == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  advs[handle].power = SL_MIN(power, stack.tx_max);
+  *set_power = advs[handle].power;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_advertiser_start(uint8_t handle, uint8_t discover, uint8_t connect)
+{
+  char hex[(STACK_ADV_DATA_MAX * 2) + 1];
+  bool connectable = ((connect == sl_bt_advertiser_connectable_scannable) || (connect == sl_bt_advertiser_connectable_non_scannable));
+  bool room = false;
+
+  (void)discover;
+
+  if((handle >= STACK_MAX_ADVERTISERS) || (advs[handle].created == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  for(uint32_t i = 0; i < STACK_MAX_CONNECTIONS; i++)
+    {
+      if(conns[i].in_use == false)
+        room = true;
+    }
+
+  if((connectable == true) && (room == false))
+    return SL_STATUS_NO_MORE_RESOURCE;
+
+  advs[handle].running = true;
+  advs[handle].stop_us = host_now_us + (advs[handle].duration * 10000ULL);
+
+  hostHex(hex, stack.adv_data, stack.adv_len);
+  hostPrint("ADV_START %u %lu %u %d %s", handle, (unsigned long)(advs[handle].interval * 625UL), (connectable == true) ? 1 : 0,
+            advs[handle].power, hex);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_advertiser_stop(uint8_t handle)
+{
+  if((handle >= STACK_MAX_ADVERTISERS) || (advs[handle].created == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  if(advs[handle].running == true)
+    {
+      advs[handle].running = false;
+      hostPrint("ADV_STOP %u", handle);
+    }
+
+  return SL_STATUS_OK;
+}
+
+
+sl_status_t sl_bt_scanner_set_mode(uint8_t phys, uint8_t scan_mode)
+{
+  (void)phys;
+  (void)scan_mode;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_set_timing(uint8_t phys, uint16_t scan_interval, uint16_t scan_window)
+{
+  (void)phys;
+
+  stack.scan_interval = scan_interval;
+  stack.scan_window = scan_window;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_start(uint8_t scanning_phy, uint8_t discover_mode)
+{
+  (void)scanning_phy;
+  (void)discover_mode;
+
+  stack.scanning = true;
+  hostPrint("SCAN_START %lu %lu", (unsigned long)(stack.scan_interval * 625UL), (unsigned long)(stack.scan_window * 625UL));
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_stop()
+{
+  if(stack.scanning == true)
+    {
+      stack.scanning = false;
+      hostPrint("SCAN_STOP");
+    }
+
+  return SL_STATUS_OK;
+}
+
+
+sl_status_t sl_bt_connection_set_default_parameters(uint16_t min_interval, uint16_t max_interval, uint16_t latency, uint16_t timeout,
+                                                   uint16_t min_ce_length, uint16_t max_ce_length)
+{
+  (void)min_ce_length;
+  (void)max_ce_length;
+
+  stack.conn_min = min_interval;
+  stack.conn_max = max_interval;
+  stack.conn_latency = latency;
+  stack.conn_timeout = timeout;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_set_default_preferred_phy(uint8_t preferred_phy, uint8_t accepted_phy)
+{
+  (void)preferred_phy;
+  (void)accepted_phy;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_open(bd_addr address, uint8_t address_type, uint8_t initiating_phy, uint8_t *connection)
+{
+  char text[32];
+  stack_conn_t *conn = NULL;
+
+  (void)initiating_phy;
+
+  for(uint32_t i = 0; i < STACK_MAX_CONNECTIONS; i++)
+    {
+      if((conns[i].in_use == true) && (conns[i].open == false))
+        return SL_STATUS_INVALID_STATE;                   //One connection is established at a time
+      if((conn == NULL) && (conns[i].in_use == false))
+        conn = &conns[i];
+    }
+
+  if(conn == NULL)
+    return SL_STATUS_NO_MORE_RESOURCE;
+
+  memset(conn, 0, sizeof(*conn));
+  conn->in_use = true;
+  conn->central = true;
+  conn->peer = address;
+  conn->peer_type = address_type;
+  *connection = stack_conn_handle(conn);
+
+  stack_addr_text(text, &address);
+  hostPrint("OPEN %u %s %u %u %u %u", *connection, text, stack.conn_min, stack.conn_max, stack.conn_latency, stack.conn_timeout);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_close(uint8_t connection)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  if(conn == NULL)
+    return SL_STATUS_INVALID_HANDLE;
+
+  if(conn->closing == false)
+    {
+      conn->closing = true;
+      hostPrint("CLOSE %u", connection);
+    }
+
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_set_parameters(uint8_t connection, uint16_t min_interval, uint16_t max_interval, uint16_t latency,
+                                           uint16_t timeout, uint16_t min_ce_length, uint16_t max_ce_length)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  (void)min_ce_length;
+  (void)max_ce_length;
+
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  hostPrint("PARAMS_REQ %u %u %u %u %u", connection, min_interval, max_interval, latency, timeout);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_set_preferred_phy(uint8_t connection, uint8_t preferred_phy, uint8_t accepted_phy)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  hostPrint("PHY_REQ %u %u %u", connection, preferred_phy, accepted_phy);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_get_rssi(uint8_t connection)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  hostPrint("RSSI_REQ %u", connection);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_get_tx_power(uint8_t connection, uint8_t phy, int8_t *current_level, int8_t *max_level)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  (void)phy;
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  *current_level = stack.tx_max / 10;
+  *max_level = stack.tx_max / 10;
+  return SL_STATUS_OK;
+}
+
+
+sl_status_t sl_bt_gatt_set_max_mtu(uint16_t max_mtu, uint16_t *max_mtu_out)
+{
+  stack.max_mtu = SL_MAX(SL_MIN(max_mtu, STACK_ATT_MAX_MTU), STACK_ATT_DEFAULT_MTU);
+  *max_mtu_out = stack.max_mtu;
+  return SL_STATUS_OK;
+}
+
+
+/*
+ * Returns the link a client procedure can start on
+ *
+ * Parameters:
+ *   uint8_t connection
+ *   sl_status_t *status: Why it cannot
+ *
+ * Returns:
+ *   stack_conn_t *: NULL if it cannot
+ */
+static stack_conn_t *stack_proc_conn(uint8_t connection, sl_status_t *status)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->open == false))
+    {
+      *status = SL_STATUS_INVALID_HANDLE;
+      return NULL;
+    }
+
+  if(conn->proc != proc_none)
+    {
+      *status = SL_STATUS_INVALID_STATE;
+      return NULL;
+    }
+
+  *status = SL_STATUS_OK;
+  return conn;
+}
+
+sl_status_t sl_bt_gatt_discover_primary_services_by_uuid(uint8_t connection, size_t uuid_len, const uint8_t* uuid)
+{
+  sl_status_t status;
+  stack_conn_t *conn = stack_proc_conn(connection, &status);
+
+  if(conn == NULL)
+    return status;
+
+  if((uuid_len != 2) && (uuid_len != 16))
+    return SL_STATUS_INVALID_PARAMETER;
+
+  conn->proc = proc_services;
+  conn->proc_start = 1;
+  conn->proc_uuid_len = (uint8_t)uuid_len;
+  memcpy(conn->proc_uuid, uuid, uuid_len);
+  stack_proc_services_next(conn);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_discover_characteristics_by_uuid(uint8_t connection, uint32_t service, size_t uuid_len, const uint8_t* uuid)
+{
+  sl_status_t status;
+  stack_conn_t *conn = stack_proc_conn(connection, &status);
+
+  if(conn == NULL)
+    return status;
+
+  if((uuid_len != 2) && (uuid_len != 16))
+    return SL_STATUS_INVALID_PARAMETER;
+
+  conn->proc = proc_characteristics;
+  conn->proc_start = (uint16_t)(service & 0xFFFF);
+  conn->proc_end = (uint16_t)(service >> 16);
+  conn->proc_uuid_len = (uint8_t)uuid_len;
+  memcpy(conn->proc_uuid, uuid, uuid_len);
+  stack_proc_read_by_type(conn, GATT_UUID_CHARACTERISTIC);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_set_characteristic_notification(uint8_t connection, uint16_t characteristic, uint8_t flags)
+{
+  sl_status_t status;
+  stack_conn_t *conn = stack_proc_conn(connection, &status);
+
+  if(conn == NULL)
+    return status;
+
+  //The client configuration is searched for from the value on, then written
+  conn->proc = proc_cccd_find;
+  conn->proc_flags = flags;
+  conn->proc_start = characteristic + 1;
+  conn->proc_end = 0xFFFF;
+  stack_proc_read_by_type(conn, GATT_UUID_CCCD);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_read_characteristic_value(uint8_t connection, uint16_t characteristic)
+{
+  uint8_t pdu[3] = { ATT_READ_REQ, 0, 0 };
+  sl_status_t status;
+  stack_conn_t *conn = stack_proc_conn(connection, &status);
+
+  if(conn == NULL)
+    return status;
+
+  conn->proc = proc_read;
+  conn->proc_characteristic = characteristic;
+  put_le16(&pdu[1], characteristic);
+  stack_att_request(conn, pdu, sizeof(pdu));
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_read_characteristic_value_by_uuid(uint8_t connection, uint32_t service, size_t uuid_len, const uint8_t* uuid)
+{
+  uint8_t pdu[21];
+  sl_status_t status;
+  stack_conn_t *conn = stack_proc_conn(connection, &status);
+
+  if(conn == NULL)
+    return status;
+
+  if((uuid_len != 2) && (uuid_len != 16))
+    return SL_STATUS_INVALID_PARAMETER;
+
+  //The service handle carries the range to search, first handle low, last handle high
+  conn->proc = proc_read_by_uuid;
+  pdu[0] = ATT_READ_BY_TYPE_REQ;
+  put_le16(&pdu[1], (uint16_t)(service & 0xFFFF));
+  put_le16(&pdu[3], (uint16_t)(service >> 16));
+  memcpy(&pdu[5], uuid, uuid_len);
+  stack_att_request(conn, pdu, 5 + uuid_len);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_send_characteristic_confirmation(uint8_t connection)
+{
+  uint8_t pdu = ATT_CONFIRMATION;
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  if(conn->confirm_owed == false)
+    return SL_STATUS_INVALID_STATE;
+
+  conn->confirm_owed = false;
+  stack_att_send(conn, &pdu, 1);
+  return SL_STATUS_OK;
+}
+
+
+sl_status_t sl_bt_gatt_server_get_mtu(uint8_t connection, uint16_t *mtu)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  if(conn == NULL)
+    return SL_STATUS_INVALID_HANDLE;
+
+  *mtu = conn->mtu;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_send_indication(uint8_t connection, uint16_t characteristic, size_t value_len, const uint8_t* value)
+{
+  uint8_t pdu[STACK_ATT_PDU_MAX];
+  const sli_bt_gattdb_attribute_t *declaration = stack_attr_declaration(characteristic);
+  const sli_bt_gattdb_attribute_t *cccd = stack_attr_cccd(characteristic);
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  if((declaration == NULL) || (cccd == NULL) || !(declaration->characteristic.properties & CHAR_PROP_INDICATE))
+    return SL_STATUS_INVALID_PARAMETER;
+
+  if(!(conn->cccd[cccd->configdata.clientconfig_index] & sl_bt_gatt_server_indication) || (conn->att_dead == true))
+    return SL_STATUS_INVALID_STATE;
+
+  if(conn->indication_out == true)
+    return SL_STATUS_IN_PROGRESS;
+
+  if(value_len > (size_t)(conn->mtu - 3))
+    return SL_STATUS_COMMAND_TOO_LONG;
+
+  pdu[0] = ATT_INDICATION;
+  put_le16(&pdu[1], characteristic);
+  memcpy(&pdu[3], value, value_len);
+
+  conn->indication_out = true;
+  conn->indication_char = characteristic;
+  conn->indication_deadline = host_now_us + STACK_ATT_TIMEOUT_US;
+  hostPrint("MARK IND %u %u %lu", connection, characteristic, (unsigned long)stack.sample_seq);
+  stack_att_send(conn, pdu, value_len + 3);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_send_user_read_response(uint8_t connection, uint16_t characteristic, uint8_t att_errorcode,
+                                                     size_t value_len, const uint8_t* value, uint16_t *sent_len)
+{
+  uint8_t pdu[STACK_ATT_PDU_MAX];
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  if((conn->read_pending == false) || (conn->read_char != characteristic))
+    return SL_STATUS_INVALID_STATE;
+
+  conn->read_pending = false;
+
+  if(att_errorcode != 0)
+    {
+      stack_att_error(conn, conn->read_opcode, characteristic, att_errorcode);
+      *sent_len = 0;
+      return SL_STATUS_OK;
+    }
+
+  value_len = SL_MIN(value_len, (size_t)(conn->mtu - 1));
+  pdu[0] = conn->read_opcode + 1;
+  memcpy(&pdu[1], value, value_len);
+  stack_att_send(conn, pdu, value_len + 1);
+  *sent_len = (uint16_t)value_len;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_send_user_write_response(uint8_t connection, uint16_t characteristic, uint8_t att_errorcode)
+{
+  uint8_t rsp = ATT_WRITE_RSP;
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  if((conn->write_pending == false) || (conn->write_char != characteristic))
+    return SL_STATUS_INVALID_STATE;
+
+  conn->write_pending = false;
+
+  if(att_errorcode != 0)
+    stack_att_error(conn, ATT_WRITE_REQ, characteristic, att_errorcode);
+  else
+    stack_att_send(conn, &rsp, 1);
+
+  return SL_STATUS_OK;
+}
+
+
+sl_status_t sl_bt_sm_configure(uint8_t flags, uint8_t io_capabilities)
+{
+  (void)flags;
+  (void)io_capabilities;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_set_bondable_mode(uint8_t bondable)
+{
+  (void)bondable;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_store_bonding_configuration(uint8_t max_bonding_count, uint8_t policy_flags)
+{
+  (void)max_bonding_count;
+  (void)policy_flags;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_delete_bondings()
+{
+  hostPrint("BOND_DELETE all");
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_delete_bonding(uint8_t bonding)
+{
+  hostPrint("BOND_DELETE %u", bonding);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_increase_security(uint8_t connection)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->open == false))
+    return SL_STATUS_INVALID_HANDLE;
+
+  hostPrint("SEC_REQ %u", connection);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_passkey_confirm(uint8_t connection, uint8_t confirm)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->passkey_pending == false))
+    return SL_STATUS_INVALID_STATE;
+
+  conn->passkey_pending = false;
+  hostPrint("PASSKEY %u %u", connection, confirm);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_bonding_confirm(uint8_t connection, uint8_t confirm)
+{
+  stack_conn_t *conn = stack_conn(connection);
+
+  if((conn == NULL) || (conn->bonding_pending == false))
+    return SL_STATUS_INVALID_STATE;
+
+  conn->bonding_pending = false;
+  hostPrint("BOND_CONFIRM %u %u", connection, confirm);
+  return SL_STATUS_OK;
+}
+
+
+sl_status_t sl_bt_l2cap_coc_send_connection_request(uint8_t connection, uint16_t le_psm, uint16_t mtu, uint16_t mps, uint16_t initial_credit)
+{
+  stack_conn_t *conn = stack_conn(connection);
+  stack_coc_t *coc;
+  uint8_t data[10];
+
+  if(conn == NULL)
+    return SL_STATUS_INVALID_HANDLE;
+
+  if((mtu < 23) || (mps < 23) || (mps > STACK_COC_MPS_MAX))
+    return SL_STATUS_INVALID_PARAMETER;
+
+  coc = stack_coc_alloc(connection);
+  if(coc == NULL)
+    return SL_STATUS_NO_MORE_RESOURCE;
+
+  coc->identifier = ++conn->signaling_identifier;
+  coc->local_mtu = mtu;
+  coc->local_mps = mps;
+  coc->rx_credits = initial_credit;
+
+  put_le16(&data[0], le_psm);
+  put_le16(&data[2], coc->local_cid);
+  put_le16(&data[4], mtu);
+  put_le16(&data[6], mps);
+  put_le16(&data[8], initial_credit);
+  stack_signal_send(conn, L2CAP_LE_CREDIT_CONNECTION_REQ, coc->identifier, data, sizeof(data));
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_l2cap_coc_send_connection_response(uint8_t connection, uint16_t cid, uint16_t mtu, uint16_t mps, uint16_t initial_credit,
+                                                    uint16_t l2cap_errorcode)
+{
+  stack_conn_t *conn = stack_conn(connection);
+  stack_coc_t *coc;
+  uint8_t data[10];
+
+  if(conn == NULL)
+    return SL_STATUS_INVALID_HANDLE;
+
+  coc = stack_coc_find(connection, cid, true);
+  if((coc == NULL) || (coc->open == true))
+    return SL_STATUS_BT_L2CAP_CID_NOT_EXIST;
+
+  if((l2cap_errorcode == sl_bt_l2cap_connection_successful) &&
+      ((mtu < 23) || (mps < 23) || (mps > STACK_COC_MPS_MAX)))
+    return SL_STATUS_INVALID_PARAMETER;
+
+  memset(data, 0, sizeof(data));
+  if(l2cap_errorcode == sl_bt_l2cap_connection_successful)
+    {
+      put_le16(&data[0], coc->local_cid);
+      put_le16(&data[2], mtu);
+      put_le16(&data[4], mps);
+      put_le16(&data[6], initial_credit);
+    }
+  put_le16(&data[8], l2cap_errorcode);
+  stack_signal_send(conn, L2CAP_LE_CREDIT_CONNECTION_RSP, coc->identifier, data, sizeof(data));
+
+  if(l2cap_errorcode != sl_bt_l2cap_connection_successful)
+    {
+      memset(coc, 0, sizeof(*coc));
+      return SL_STATUS_OK;
+    }
+
+  coc->open = true;
+  coc->local_mtu = mtu;
+  coc->local_mps = mps;
+  coc->rx_credits = initial_credit;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_l2cap_coc_send_data(uint8_t connection, uint16_t cid, size_t data_len, const uint8_t* data)
+{
+  stack_conn_t *conn = stack_conn(connection);
+  stack_coc_t *coc;
+
+  if(conn == NULL)
+    return SL_STATUS_INVALID_HANDLE;
+
+  coc = stack_coc_find(connection, cid, true);
+  if((coc == NULL) || (coc->open == false))
+    return SL_STATUS_BT_L2CAP_CID_NOT_EXIST;
+
+  if((data_len > coc->remote_mps) || (data_len > STACK_L2CAP_PDU_MAX))
+    return SL_STATUS_INVALID_PARAMETER;
+
+  if(coc->tx_credits == 0)
+    return SL_STATUS_BT_L2CAP_NO_FLOW_CONTROL_CREDIT;
+
+  coc->tx_credits--;
+  stack_l2cap_send(conn, coc->remote_cid, data, data_len);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_l2cap_coc_send_le_flow_control_credit(uint8_t connection, uint16_t cid, uint16_t credits)
+{
+  stack_conn_t *conn = stack_conn(connection);
+  stack_coc_t *coc;
+  uint8_t data[4];
+
+  if(conn == NULL)
+    return SL_STATUS_INVALID_HANDLE;
+
+  coc = stack_coc_find(connection, cid, true);
+  if((coc == NULL) || (coc->open == false))
+    return SL_STATUS_BT_L2CAP_CID_NOT_EXIST;
+
+  coc->rx_credits += credits;
+  put_le16(&data[0], coc->local_cid);
+  put_le16(&data[2], credits);
+  stack_signal_send(conn, L2CAP_LE_FLOW_CONTROL_CREDIT, ++conn->signaling_identifier, data, sizeof(data));
+  return SL_STATUS_OK;
+}
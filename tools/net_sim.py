@@ -0,0 +1,738 @@
+#!/usr/bin/env python3
+"""
+net_sim.py - Host simulator of many servers and clients sharing the air, for
+sizing a network before putting boards on a bench
+
+Every node is the firmware itself: tools/host_sim builds app.c, src/ and the
+generated GATT database for the host against a stand-in of the Bluetooth stack
+and emlib, and this script runs one build/host_node process per node. The
+firmware makes every decision on its own, from the advertising steps and the
+client ranking the scan reports to discovery, the parameter updates and the
+indications. This script only plays the air between the processes:
+  - advertising packets reach a scanning node with the duty of its scan window,
+    a RSSI from the path loss of the pair, the TX power and 4 dB of fading, and
+    a connection opens at the next advertising event of the target,
+  - connection events run on the interval and peripheral latency the nodes
+    agreed on, and carry the L2CAP frames of the nodes, ATT, signaling and the
+    credit based bulk channel, fragmented into 27 byte link layer packets, a
+    few exchanges per event,
+  - parameter, PHY and encryption procedures take effect at an instant a few
+    events ahead, like the link layer procedures,
+  - packets are lost independently with --loss and resent on the next
+    exchange, a link closes on its supervision timeout or a random drop,
+  - an event that needs the radio of a node busy with another event of it is
+    skipped, the link skipped most in a row goes first the next time, and
+    clocks drift by up to 50 ppm so links of different centrals slide over
+    each other.
+
+Bonds are provisioned by default: both ends of a pair hold a bond from their
+first connection, so the client encrypts the link straight away and the
+temperature indications can be enabled. With --pair the nodes pair on the first
+connection instead and the script presses PB0 on both boards to confirm the
+passkey. The client's first CCCD writes are refused until the link is
+encrypted, and it writes them again once pairing ends.
+
+The metrics come from the nodes: the server prints every temperature sample and
+every indication it sends, and the script times the indication from the sample
+to its arrival at the client.
+
+Topologies are SERVERSxCLIENTS, e.g. 32x2 is 32 servers and 2 clients.
+
+Usage:
+  make -C tools/host_sim
+  net_sim.py
+  net_sim.py --topology 8x1,16x1,32x4 --loss 0.05 --duration 600 --csv out.csv
+"""
+
+import argparse
+import collections
+import csv
+import heapq
+import os
+import random
+import re
+import subprocess
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+HOST_SIM = os.path.join(os.path.dirname(os.path.abspath(__file__)), "host_sim")
+
+SOURCES = ["app.h", "config/sl_bluetooth_connection_config.h", "src/connection.h", "autogen/gatt_db.h"]
+
+L2CAP_ATT_CID = 0x0004
+ATT_INDICATION = 0x1D
+NO_BONDING = 0xFF
+
+#Reasons of sl_bt_evt_connection_closed
+REASON_UNKNOWN_CONNECTION = 0x1002
+REASON_SUPERVISION_TIMEOUT = 0x1008
+REASON_REMOTE_USER = 0x1013
+REASON_LOCAL_HOST = 0x1016
+REASON_FAILED_TO_ESTABLISH = 0x103E
+REASON_NUMERIC_COMPARISON = 0x120C
+
+INSTANT_EVENTS = 6                           #Events between a procedure request and its instant
+ADV_EVENT_US = 1200                          #Radio time of an advertising event on the three channels
+T_IFS_US = 150
+CLOCK_PPM = 50
+
+COLUMNS = ["topology", "links", "samples_s", "delivered_pct", "latency_mean_ms", "latency_p95_ms",
+           "latency_max_ms", "overflows", "retransmits", "skipped_events", "supervision_drops",
+           "random_drops", "full_s"]
+
+
+def read_defines(root):
+    """Returns the integer #defines of the firmware sources, expressions of other defines included"""
+    raw = {}
+    for name in SOURCES:
+        with open(os.path.join(root, name)) as f:
+            for line in f:
+                m = re.match(r"\s*#define\s+(\w+)\s+(.+?)\s*(//.*)?$", line)
+                if m:
+                    raw[m.group(1)] = m.group(2)
+
+    values = {}
+    for _ in range(8):
+        for name, expr in raw.items():
+            if name in values:
+                continue
+            expr = re.sub(r"\b(0x[0-9a-fA-F]+|\d+)[uUlL]*\b", lambda m: str(int(m.group(1), 0)), expr)
+            expr = re.sub(r"\b[A-Za-z_]\w*\b", lambda m: str(values.get(m.group(0), m.group(0))), expr)
+            if re.fullmatch(r"[\s\d()+\-*/]+", expr):
+                try:
+                    values[name] = int(eval(expr.replace("/", "//"), {"__builtins__": {}}))
+                except (SyntaxError, ZeroDivisionError, TypeError):
+                    pass
+    return values
+
+
+class Config:
+    """Firmware limits, plus the air of the run"""
+
+    def __init__(self, defines, args):
+        d = defines
+        self.client_max = d["CLIENT_MAX_SERVERS"]
+        self.temperature_char = d["gattdb_rgb_state"]
+
+        self.loss = args.loss
+        self.exchanges = args.exchanges
+        self.drop_rate_us = args.drops_per_hour / 3600e6
+        self.rssi_range = (args.rssi_min, args.rssi_max)
+        self.pair = args.pair
+        self.confirm_us = int(args.confirm_ms * 1000)
+
+
+class Node:
+    """One host_node process"""
+
+    def __init__(self, sim, index, server, address, args):
+        self.sim = sim
+        self.index = index
+        self.server = server
+        self.address = address
+        self.ppm = sim.rng.uniform(-CLOCK_PPM, CLOCK_PPM)
+        self.deadline = None
+        self.adv = {}                        #Advertising set handle -> AdvSet
+        self.scan_duty = None
+        self.opening = None
+        self.conns = {}                      #Connection handle -> Link
+        self.bonds = {}                      #Peer address -> bonding handle
+        self.next_bond = 0
+        self.busy_until = 0
+        self.tx_ddbm = 0
+        self.samples = {}                    #Sample sequence -> time
+        self.ind_seq = {}                    #Connection -> sample sequence of the indication just sent
+
+        command = [args.binary, "--address", address, "--temperature", "%.1f" % sim.rng.uniform(18, 30)]
+        if server:
+            command.append("--server")       #PB1 held through reset picks the server role of a dual build
+        stderr = subprocess.DEVNULL
+        if args.logs:
+            os.makedirs(args.logs, exist_ok=True)
+            stderr = open(os.path.join(args.logs, "%s_%s.log" % (sim.name, address.replace(":", ""))), "w")
+        self.proc = subprocess.Popen(command, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=stderr,
+                                     universal_newlines=True, bufsize=1)
+
+    def send(self, t, line):
+        """Hands a command to the node and returns the lines it answered with"""
+        self.proc.stdin.write("%d %s\n" % (t, line))
+        self.proc.stdin.flush()
+        out = []
+        while True:
+            reply = self.proc.stdout.readline()
+            if not reply:
+                raise RuntimeError("node %s exited" % self.address)
+            words = reply.split()
+            if words[1] == "IDLE":
+                self.deadline = None if words[2] == "-1" else int(words[2])
+                return out
+            out.append((int(words[0]), words[1], words[2:]))
+
+    def bond(self, peer):
+        if peer not in self.bonds:
+            self.bonds[peer] = self.next_bond
+            self.next_bond += 1
+        return self.bonds[peer]
+
+    def quit(self, t):
+        self.proc.stdin.write("%d QUIT\n" % t)
+        self.proc.stdin.close()
+        self.proc.wait()
+
+
+class AdvSet:
+    def __init__(self, handle, interval_us, connectable, tx_ddbm, data):
+        self.handle = handle
+        self.interval_us = interval_us
+        self.connectable = connectable
+        self.tx_ddbm = tx_ddbm
+        self.data = data
+        self.running = True
+
+
+class Link:
+    def __init__(self, sim, central, peripheral, adv_handle, interval, latency, timeout):
+        self.id = sim.next_link
+        sim.next_link += 1
+        self.central = central
+        self.peripheral = peripheral
+        self.handle = {central: None, peripheral: None}
+        self.adv_handle = adv_handle
+        self.interval = interval             #1.25 ms units
+        self.latency = latency
+        self.timeout = timeout               #10 ms units
+        self.phy = 1
+        self.txsize = 27
+        self.encrypted = False
+        self.alive = True
+        self.event = 0
+        self.last_wake = 0
+        self.last_rx = sim.now
+        self.queue = {central: collections.deque(), peripheral: collections.deque()}
+        self.in_event = False
+        self.updates = []                    #(instant, function, args)
+        self.pairing = None
+        self.next_at = 0
+        self.skips = 0                       #Events skipped in a row, the scheduler favours the link with most
+
+    def peer(self, node):
+        return self.peripheral if node is self.central else self.central
+
+    def interval_us(self):
+        return int(self.interval * 1250 * (1 + self.central.ppm * 1e-6))
+
+
+class Sim:
+    def __init__(self, cfg, servers, clients, seed, args):
+        self.cfg = cfg
+        self.name = "%dx%d" % (servers, clients)
+        self.rng = random.Random(seed)
+        self.queue = []
+        self.seq = 0
+        self.now = 0
+        self.next_link = 0
+        self.links = {}
+        self.servers = [Node(self, i, True, "00:0b:57:01:%02x:%02x" % (i >> 8, i & 0xFF), args) for i in range(servers)]
+        self.clients = [Node(self, i, False, "00:0b:57:02:%02x:%02x" % (i >> 8, i & 0xFF), args) for i in range(clients)]
+        self.nodes = {n.address: n for n in self.servers + self.clients}
+        self.path = {}                       #RSSI at 0 dBm of a pair
+
+        self.enabled = 0
+        self.sent = 0
+        self.delivered = 0
+        self.latencies = []
+        self.retransmits = 0
+        self.skipped = 0
+        self.supervision_drops = 0
+        self.random_drops = 0
+        self.full_at = {}
+
+        for node in self.nodes.values():
+            self.at(self.rng.randint(0, 100000), self.boot, node)
+
+    def at(self, t, fn, *args):
+        self.seq += 1
+        heapq.heappush(self.queue, (max(t, self.now), self.seq, fn, args))
+
+    def run(self, duration_us):
+        while self.queue and self.queue[0][0] <= duration_us:
+            self.now, _, fn, args = heapq.heappop(self.queue)
+            fn(*args)
+        for node in self.nodes.values():
+            node.quit(duration_us)
+
+    def lost(self):
+        return self.rng.random() < self.cfg.loss
+
+    def rssi(self, a, b, tx_ddbm):
+        key = tuple(sorted((a.address, b.address)))
+        if key not in self.path:
+            self.path[key] = self.rng.uniform(*self.cfg.rssi_range)
+        return int(round(self.path[key] + tx_ddbm / 10.0 + self.rng.gauss(0, 4)))
+
+    # Node processes
+
+    def command(self, node, line, t=None):
+        """Sends a command at the current time, or a later one inside a connection event, and acts on the answer"""
+        t = self.now if t is None else t
+        for when, kind, words in node.send(t, line):
+            self.output(node, max(when, self.now), kind, words)
+        if node.deadline is not None:
+            self.at(max(node.deadline, t + 1), self.wake, node, node.deadline)
+
+    def wake(self, node, deadline):
+        if node.deadline == deadline:
+            self.command(node, "TICK")
+
+    def boot(self, node):
+        self.command(node, "BOOT")
+        if node.server:
+            self.at(self.now + 10000, self.command, node, "BUTTON 1 0")
+
+    def press(self, node, button):
+        self.command(node, "BUTTON %d 1" % button)
+        self.at(self.now + 100000, self.command, node, "BUTTON %d 0" % button)
+
+    def output(self, node, t, kind, words):
+        if kind == "ADV_START":
+            handle = int(words[0])
+            adv = AdvSet(handle, int(words[1]), words[2] == "1", int(words[3]), words[4])
+            node.adv[handle] = adv
+            self.at(t + self.rng.randint(0, 10000), self.adv_event, node, adv)
+        elif kind == "ADV_STOP":
+            adv = node.adv.pop(int(words[0]), None)
+            if adv:
+                adv.running = False
+        elif kind == "SCAN_START":
+            node.scan_duty = int(words[1]) / float(int(words[0]))
+        elif kind == "SCAN_STOP":
+            node.scan_duty = None
+        elif kind == "OPEN":
+            node.opening = (int(words[0]), words[1], int(words[2]), int(words[4]), int(words[5]))
+        elif kind == "HANDLE":
+            link = self.links.get(int(words[0]))
+            if link and words[1] != "-":
+                link.handle[node] = int(words[1])
+                node.conns[int(words[1])] = link
+        elif kind == "TXPOWER":
+            node.tx_ddbm = int(words[0])
+        elif kind == "BOND_DELETE":
+            if words[0] == "all":
+                node.bonds.clear()
+            else:
+                node.bonds = {peer: h for peer, h in node.bonds.items() if h != int(words[0])}
+        elif kind == "MARK":
+            self.mark(node, t, words)
+        elif kind == "CLOSE":
+            self.close_request(node, int(words[0]))
+        else:
+            link = node.conns.get(int(words[0]))
+            if link is None or not link.alive:
+                return
+            if kind == "L2CAP":
+                self.l2cap(node, link, int(words[1]), words[2])
+            elif kind == "PARAMS_REQ":
+                self.procedure(link, self.params, link, int(words[1]), int(words[3]), int(words[4]))
+            elif kind == "PHY_REQ":
+                accepted = int(words[1]) & int(words[2]) & 0x03     #Series 1 radios do 1M and 2M
+                self.procedure(link, self.phy, link, 2 if accepted & 2 else (1 if accepted & 1 else link.phy))
+            elif kind == "RSSI_REQ":
+                peer = link.peer(node)
+                self.at(t + link.interval_us(), self.command, node,
+                        "RSSI %d %d" % (link.handle[node], self.rssi(node, peer, peer.tx_ddbm)))
+            elif kind == "SEC_REQ":
+                self.security(link)
+            elif kind == "BOND_CONFIRM":
+                self.bond_confirm(link, words[1] == "1")
+            elif kind == "PASSKEY":
+                self.passkey(link, node, words[1] == "1")
+
+    def mark(self, node, t, words):
+        if words[0] == "SAMPLE":
+            node.samples[int(words[1])] = t
+            self.enabled += int(words[3])
+        elif words[0] == "IND" and int(words[2]) == self.cfg.temperature_char:
+            self.sent += 1
+            node.ind_seq[int(words[1])] = int(words[3])
+
+    # Advertising and connection setup
+
+    def adv_event(self, node, adv):
+        if not adv.running:
+            return
+        if node.busy_until <= self.now:
+            node.busy_until = self.now + ADV_EVENT_US
+            for other in list(self.nodes.values()):
+                if other is node or not adv.running:
+                    continue
+                if (adv.connectable and other.opening and other.opening[1] == node.address
+                        and other.busy_until <= self.now and not self.lost()):
+                    self.connect(other, node, adv)
+                    return
+                if other.scan_duty and self.rng.random() < other.scan_duty and not self.lost():
+                    self.command(other, "ADV %s 0 %d %d %d %s" % (node.address, 0 if adv.connectable else 3,
+                                 self.rssi(node, other, adv.tx_ddbm), adv.tx_ddbm // 10, adv.data))
+        if adv.running:
+            self.at(self.now + adv.interval_us + self.rng.randint(0, 10000), self.adv_event, node, adv)
+
+    def connect(self, central, peripheral, adv):
+        handle, _, interval, latency, timeout = central.opening
+        central.opening = None
+        if self.cfg.pair:
+            bond_c = central.bonds.get(peripheral.address, NO_BONDING)
+            bond_p = peripheral.bonds.get(central.address, NO_BONDING)
+        else:
+            bond_c = central.bond(peripheral.address)
+            bond_p = peripheral.bond(central.address)
+
+        link = Link(self, central, peripheral, adv.handle, interval, latency, timeout)
+        self.links[link.id] = link
+        link.handle[central] = handle
+        central.conns[handle] = link
+        self.command(peripheral, "CONNECTED %d - 0 %s 0 %d %d %d %d %d" % (
+            link.id, central.address, adv.handle, bond_p, interval, latency, timeout), self.now + 1250)
+        if link.handle[peripheral] is None:
+            del central.conns[handle]
+            self.links.pop(link.id)
+            link.alive = False
+            self.command(central, "CLOSED %d %x" % (handle, REASON_FAILED_TO_ESTABLISH), self.now + 1250)
+            return
+        self.command(central, "CONNECTED %d %d 1 %s 0 255 %d %d %d %d" % (
+            link.id, handle, peripheral.address, bond_c, interval, latency, timeout), self.now + 1250)
+        link.last_rx = self.now
+
+        target = min(len(self.servers), self.cfg.client_max)
+        if not central.server and central.index not in self.full_at and len(central.conns) >= target:
+            self.full_at[central.index] = self.now
+        if self.cfg.drop_rate_us > 0:
+            self.at(self.now + int(self.rng.expovariate(self.cfg.drop_rate_us)), self.drop, link)
+        link.next_at = self.anchor(link, self.now)
+        self.at(link.next_at, self.conn_event, link)
+
+    def anchor(self, link, now):
+        """Next anchor of a link, the central places it in the middle of the widest gap between the events
+        of its other links"""
+        interval = link.interval_us()
+        taken = sorted((l.next_at - now) % interval for l in link.central.conns.values()
+                       if l is not link and l.central is link.central and l.alive)
+        offset = 0
+        if taken:
+            gaps = [((taken[(i + 1) % len(taken)] - start) % interval or interval, start) for i, start in enumerate(taken)]
+            gap, start = max(gaps)
+            offset = (start + gap // 2) % interval
+        return now + interval + offset
+
+    def close_request(self, node, handle):
+        if node.opening and node.opening[0] == handle:
+            node.opening = None
+            self.command(node, "CLOSED %d %x" % (handle, REASON_UNKNOWN_CONNECTION))
+            return
+        link = node.conns.get(handle)
+        if link and link.alive:
+            reasons = (REASON_LOCAL_HOST, REASON_REMOTE_USER)
+            if node is link.peripheral:
+                reasons = reasons[::-1]
+            self.procedure(link, self.close, link, reasons[0], reasons[1], instant=1)
+
+    def close(self, link, central_reason, peripheral_reason):
+        if not link.alive:
+            return
+        link.alive = False
+        self.links.pop(link.id, None)
+        for node, reason in ((link.central, central_reason), (link.peripheral, peripheral_reason)):
+            handle = link.handle[node]
+            if handle is not None and node.conns.get(handle) is link:
+                del node.conns[handle]
+                self.command(node, "CLOSED %d %x" % (handle, reason))
+
+    def drop(self, link):
+        if link.alive:
+            self.random_drops += 1
+            self.close(link, REASON_SUPERVISION_TIMEOUT, REASON_SUPERVISION_TIMEOUT)
+
+    # Link layer procedures
+
+    def procedure(self, link, fn, *args, instant=INSTANT_EVENTS):
+        link.updates.append((link.event + instant, fn, args))
+
+    def both(self, link, fmt, *args):
+        for node in (link.central, link.peripheral):
+            if link.alive:
+                self.command(node, fmt % ((link.handle[node],) + args))
+
+    def params(self, link, interval, latency, timeout):
+        link.interval, link.latency, link.timeout = interval, latency, timeout
+        self.both(link, "PARAMS %d %d %d %d %d", interval, latency, timeout, link.txsize)
+        link.next_at = self.anchor(link, self.now)
+
+    def phy(self, link, phy):
+        if phy == link.phy:
+            return                           #Both ends asked, the second request changes nothing
+        link.phy = phy
+        self.both(link, "PHY %d %d", phy)
+
+    def security(self, link):
+        central, peripheral = link.central, link.peripheral
+        if link.encrypted or link.pairing:
+            return
+        if central.address in peripheral.bonds and peripheral.address in central.bonds:
+            self.procedure(link, self.encrypt, link, instant=3)
+        elif self.cfg.pair:
+            link.pairing = {"passkey": self.rng.randint(0, 999999), "confirmed": set()}
+            self.procedure(link, self.command, peripheral, "BOND_REQ %d" % link.handle[peripheral], instant=2)
+        else:
+            self.procedure(link, self.bonded, link, instant=3)
+
+    def encrypt(self, link):
+        link.encrypted = True
+        for node in (link.central, link.peripheral):
+            if link.alive:
+                self.command(node, "ENCRYPTED %d %d" % (link.handle[node], node.bonds[link.peer(node).address]))
+
+    def bond_confirm(self, link, ok):
+        if not link.pairing:
+            return
+        if not ok:
+            self.pairing_failed(link)
+            return
+        self.procedure(link, self.show_passkey, link, instant=2)
+
+    def show_passkey(self, link):
+        self.both(link, "PASSKEY_SHOW %d %d", link.pairing["passkey"])
+        for node in (link.central, link.peripheral):
+            self.at(self.now + self.cfg.confirm_us, self.press, node, 0)
+
+    def passkey(self, link, node, ok):
+        if not link.pairing:
+            return
+        if not ok:
+            self.pairing_failed(link)
+            return
+        link.pairing["confirmed"].add(node)
+        if len(link.pairing["confirmed"]) == 2:
+            self.procedure(link, self.bonded, link, instant=3)
+
+    def bonded(self, link):
+        link.pairing = None
+        link.encrypted = True
+        for node in (link.central, link.peripheral):
+            if link.alive:
+                self.command(node, "BONDED %d %d" % (link.handle[node], node.bond(link.peer(node).address)))
+
+    def pairing_failed(self, link):
+        link.pairing = None
+        self.both(link, "BOND_FAILED %d %x", REASON_NUMERIC_COMPARISON)
+
+    # Connection events
+
+    def air_us(self, link, length):
+        """Air time of a link layer packet, preamble, access address, header, MIC and CRC around the payload"""
+        octets = (2 if link.phy == 2 else 1) + 4 + 2 + length + (4 if link.encrypted and length else 0) + 3
+        return octets * 8 // link.phy
+
+    def l2cap(self, node, link, cid, text):
+        pdu = bytes.fromhex(text) if text != "-" else b""
+        tag = None
+        if cid == L2CAP_ATT_CID and pdu and pdu[0] == ATT_INDICATION and link.handle[node] in node.ind_seq:
+            tag = (node, node.ind_seq.pop(link.handle[node]))
+        #The L2CAP header in front, sent in txsize fragments. A frame the node answers with inside an event
+        #waits for the next one
+        link.queue[node].append({"cid": cid, "pdu": pdu, "left": len(pdu) + 4, "tag": tag, "fresh": link.in_event})
+
+    def sendable(self, link, node):
+        q = link.queue[node]
+        return bool(q) and not q[0]["fresh"]
+
+    def deliver(self, link, node, entry, t):
+        """A frame reached the peer of the node that sent it"""
+        peer = link.peer(node)
+        pdu = entry["pdu"]
+        if (entry["cid"] == L2CAP_ATT_CID and pdu and pdu[0] == ATT_INDICATION
+                and int.from_bytes(pdu[1:3], "little") == self.cfg.temperature_char and entry["tag"]):
+            server, seq = entry["tag"]
+            self.delivered += 1
+            if seq in server.samples:
+                self.latencies.append((t - server.samples[seq]) / 1000.0)
+        self.command(peer, "L2CAP %d %d %s" % (link.handle[peer], entry["cid"], pdu.hex() or "-"), t)
+
+    def conn_event(self, link):
+        if not link.alive:
+            return
+        link.event += 1
+
+        due = [u for u in link.updates if u[0] <= link.event]
+        link.updates = [u for u in link.updates if u[0] > link.event]
+        for _, fn, args in due:
+            fn(*args)
+            if not link.alive:
+                return
+
+        central, peripheral = link.central, link.peripheral
+        wake = (self.sendable(link, peripheral) or bool(link.updates) or link.event - link.last_wake > link.latency)
+
+        if wake:
+            if self.blocked(link):
+                self.skipped += 1
+                link.skips += 1
+            else:
+                link.skips = 0
+                elapsed = self.exchange(link)
+                central.busy_until = peripheral.busy_until = self.now + elapsed
+        elif central.busy_until <= self.now:
+            central.busy_until = self.now + self.air_us(link, 0)
+
+        if not link.alive:
+            return
+        if self.now - link.last_rx > link.timeout * 10000:
+            self.supervision_drops += 1
+            self.close(link, REASON_SUPERVISION_TIMEOUT, REASON_SUPERVISION_TIMEOUT)
+            return
+
+        if link.next_at <= self.now:
+            link.next_at = self.now + link.interval_us()
+        self.at(link.next_at, self.conn_event, link)
+
+    def blocked(self, link):
+        """True if an end is busy, or an event of another link of the ends that was skipped more often
+        starts before this one would be over"""
+        central, peripheral = link.central, link.peripheral
+        if central.busy_until > self.now or peripheral.busy_until > self.now:
+            return True
+        fragments = sum(-(-e["left"] // link.txsize) for q in link.queue.values() for e in q if not e["fresh"])
+        if fragments:
+            end = self.now + min(self.cfg.exchanges, fragments) * 2 * (self.air_us(link, link.txsize) + T_IFS_US)
+        else:
+            end = self.now + 2 * (self.air_us(link, 0) + T_IFS_US)
+        for other in set(central.conns.values()) | set(peripheral.conns.values()):
+            if other is not link and other.alive and other.skips > link.skips and self.now <= other.next_at < end:
+                return True
+        return False
+
+    def exchange(self, link):
+        """Runs the packet exchanges of one event, returns its radio time"""
+        elapsed = 0
+        link.in_event = True
+        for n in range(self.cfg.exchanges):
+            sent = {}
+            for node in (link.central, link.peripheral):
+                sent[node] = min(link.txsize, link.queue[node][0]["left"]) if self.sendable(link, node) else 0
+            if n and not sent[link.central] and not sent[link.peripheral]:
+                break
+
+            elapsed += self.air_us(link, sent[link.central]) + T_IFS_US
+            if self.lost():
+                if sent[link.central]:
+                    self.retransmits += 1
+                break
+            link.last_wake = link.event
+            self.fragment(link, link.central, sent[link.central], elapsed)
+            if not link.alive:
+                break
+
+            elapsed += self.air_us(link, sent[link.peripheral]) + T_IFS_US
+            if self.lost():
+                if sent[link.peripheral]:
+                    self.retransmits += 1
+                break
+            link.last_rx = self.now
+            self.fragment(link, link.peripheral, sent[link.peripheral], elapsed)
+            if not link.alive:
+                break
+        link.in_event = False
+        for q in link.queue.values():
+            for entry in q:
+                entry["fresh"] = False
+        return elapsed
+
+    def fragment(self, link, node, length, elapsed):
+        if not length:
+            return
+        entry = link.queue[node][0]
+        entry["left"] -= length
+        if entry["left"] <= 0:
+            link.queue[node].popleft()
+            self.deliver(link, node, entry, self.now + elapsed)
+
+    def results(self, name, duration_us):
+        lat = sorted(self.latencies)
+        full = [self.full_at.get(c.index) for c in self.clients]
+        return {
+            "topology": name,
+            "links": len(self.links),
+            "samples_s": round(self.delivered * 1e6 / duration_us, 2),
+            "delivered_pct": round(100.0 * self.delivered / self.enabled, 1) if self.enabled else 0.0,
+            "latency_mean_ms": round(sum(lat) / len(lat), 1) if lat else None,
+            "latency_p95_ms": round(lat[int(0.95 * (len(lat) - 1))], 1) if lat else None,
+            "latency_max_ms": round(lat[-1], 1) if lat else None,
+            "overflows": max(0, self.enabled - self.sent),
+            "retransmits": self.retransmits,
+            "skipped_events": self.skipped,
+            "supervision_drops": self.supervision_drops,
+            "random_drops": self.random_drops,
+            "full_s": round(max(full) / 1e6, 1) if None not in full else None,
+        }
+
+
+def parse_topology(text):
+    m = re.fullmatch(r"(\d+)x(\d+)", text.strip())
+    if not m or int(m.group(1)) < 1 or int(m.group(2)) < 1:
+        raise argparse.ArgumentTypeError("topology must be SERVERSxCLIENTS, got %r" % text)
+    return int(m.group(1)), int(m.group(2))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--topology", default="1x1,4x1,8x1,16x1,32x1,16x2,32x4",
+                        help="comma separated SERVERSxCLIENTS list")
+    parser.add_argument("--duration", type=float, default=300, help="simulated seconds per topology")
+    parser.add_argument("--loss", type=float, default=0.02, help="probability a packet is lost")
+    parser.add_argument("--exchanges", type=int, default=4, help="packet exchanges in one connection event")
+    parser.add_argument("--drops-per-hour", type=float, default=2.0, help="random drops per connection per hour")
+    parser.add_argument("--rssi-min", type=float, default=-90, help="weakest mean RSSI of a pair at 0 dBm")
+    parser.add_argument("--rssi-max", type=float, default=-45, help="strongest mean RSSI of a pair at 0 dBm")
+    parser.add_argument("--pair", action="store_true", help="pair on the first connection instead of provisioned bonds")
+    parser.add_argument("--confirm-ms", type=float, default=1000, help="time to press PB0 on a passkey with --pair")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--root", default=ROOT, help="repository holding the firmware headers")
+    parser.add_argument("--binary", default=os.path.join(HOST_SIM, "build", "host_node"),
+                        help="host build of the firmware, made with make -C tools/host_sim")
+    parser.add_argument("--logs", help="directory for the log of every node")
+    parser.add_argument("--csv", help="also write the results here")
+    args = parser.parse_args()
+
+    try:
+        topologies = [parse_topology(t) for t in args.topology.split(",")]
+    except argparse.ArgumentTypeError as e:
+        parser.error(str(e))
+
+    if not os.path.exists(args.binary):
+        parser.error("%s is missing, build it with make -C %s" % (args.binary, os.path.relpath(HOST_SIM)))
+
+    cfg = Config(read_defines(args.root), args)
+    duration_us = int(args.duration * 1e6)
+
+    rows = []
+    for servers, clients in topologies:
+        sim = Sim(cfg, servers, clients, args.seed, args)
+        sim.run(duration_us)
+        rows.append(sim.results("%dx%d" % (servers, clients), duration_us))
+
+    print("%d servers per client, %d exchanges per event, %.0f%% loss, %s, %.0f s per topology" % (
+        cfg.client_max, cfg.exchanges, cfg.loss * 100, "pairing" if cfg.pair else "bonded", args.duration))
+    print("%-9s %5s %9s %6s %8s %8s %8s %6s %6s %7s %5s %5s %7s" % (
+        "topology", "links", "samples/s", "deliv%", "lat_mean", "lat_p95", "lat_max", "ovfl", "retx",
+        "skipped", "sup", "drop", "full_s"))
+    for r in rows:
+        print("%-9s %5d %9.2f %6.1f %8s %8s %8s %6d %6d %7d %5d %5d %7s" % (
+            r["topology"], r["links"], r["samples_s"], r["delivered_pct"], r["latency_mean_ms"],
+            r["latency_p95_ms"], r["latency_max_ms"], r["overflows"], r["retransmits"], r["skipped_events"],
+            r["supervision_drops"], r["random_drops"], r["full_s"] if r["full_s"] is not None else "-"))
+
+    if args.csv:
+        with open(args.csv, "w", newline="") as f:
+            writer = csv.DictWriter(f, fieldnames=COLUMNS)
+            writer.writeheader()
+            writer.writerows(rows)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""
+trace_analyze.py - Offline analyser for the event trace recorded by src/trace.c
+
+Input is either
+  - a VCOM capture containing a "TRACE BEGIN" ... "TRACE END" dump (write 0x02
+    to the trace characteristic to produce one), or
+  - a raw binary file of back to back 16 byte records, the format returned by
+    reads of the trace characteristic.
+
+Prints per handler latency statistics with a log2 cycle histogram and can
+write the records as a CSV timeline.
+
+Usage:
+  trace_analyze.py capture.txt
+  trace_analyze.py trace.bin --cpu-hz 38400000 --tick-hz 8192 --timeline out.csv
+"""
+
+import argparse
+import csv
+import re
+import struct
+import sys
+
+RECORD = struct.Struct("<BBBBIII")
+
+TYPE_BT_EVENT = 1
+TYPE_EXT_SIGNAL = 2
+TYPE_ISR = 3
+
+BT_EVENTS = {
+    0x000100a0: "system_boot",
+    0x030100a0: "system_external_signal",
+    0x070100a0: "system_soft_timer",
+    0x010400a0: "advertiser_timeout",
+    0x010500a0: "scanner_scan_report",
+    0x000600a0: "connection_opened",
+    0x010600a0: "connection_closed",
+    0x020600a0: "connection_parameters",
+    0x030600a0: "connection_rssi",
+    0x040600a0: "connection_phy_status",
+    0x000900a0: "gatt_mtu_exchanged",
+    0x010900a0: "gatt_service",
+    0x020900a0: "gatt_characteristic",
+    0x030900a0: "gatt_descriptor",
+    0x040900a0: "gatt_characteristic_value",
+    0x060900a0: "gatt_procedure_completed",
+    0x000a00a0: "gatt_server_attribute_value",
+    0x010a00a0: "gatt_server_user_read_request",
+    0x020a00a0: "gatt_server_user_write_request",
+    0x030a00a0: "gatt_server_characteristic_status",
+    0x050a00a0: "gatt_server_indication_timeout",
+    0x020f00a0: "sm_confirm_passkey",
+    0x030f00a0: "sm_bonded",
+    0x040f00a0: "sm_bonding_failed",
+    0x090f00a0: "sm_confirm_bonding",
+}
+
+EXT_SIGNALS = {
+    1: "LETIMER0_UF",
+    2: "LETIMER0_COMP1",
+    4: "I2C_Transfer_Complete",
+    8: "EXT_BUTTON0",
+    16: "EXT_BUTTON1",
+}
+
+ISRS = {
+    1: "LETIMER0_IRQHandler",
+    2: "I2C0_IRQHandler",
+    3: "GPIO_EVEN_IRQHandler",
+    4: "GPIO_ODD_IRQHandler",
+    5: "LDMA_IRQHandler",
+}
+
+
+def handler_name(rtype, rid):
+    if rtype == TYPE_BT_EVENT:
+        return "evt:" + BT_EVENTS.get(rid, "0x%08x" % rid)
+    if rtype == TYPE_EXT_SIGNAL:
+        return "sig:" + EXT_SIGNALS.get(rid, "0x%x" % rid)
+    if rtype == TYPE_ISR:
+        return "isr:" + ISRS.get(rid, str(rid))
+    return "type%d:0x%x" % (rtype, rid)
+
+
+def load(path):
+    """Returns (records, tick_hz, cpu_hz) with the rates None when not in the file"""
+    data = open(path, "rb").read()
+    tick_hz = cpu_hz = None
+
+    if b"TRACE BEGIN" in data:
+        raw = bytearray()
+        text = data.decode("ascii", errors="replace")
+        header = re.search(r"TRACE BEGIN v(\d+) size=(\d+).*?tick_hz=(\d+) cpu_hz=(\d+)", text)
+        if header:
+            if int(header.group(2)) != RECORD.size:
+                sys.exit("unsupported record size %s" % header.group(2))
+            tick_hz = int(header.group(3))
+            cpu_hz = int(header.group(4))
+        for line in text.splitlines():
+            m = re.match(r"\s*TRACE ([0-9a-fA-F]{%d})\s*$" % (RECORD.size * 2), line)
+            if m:
+                raw += bytes.fromhex(m.group(1))
+        data = bytes(raw)
+
+    if len(data) % RECORD.size:
+        print("warning: ignoring %d trailing bytes" % (len(data) % RECORD.size), file=sys.stderr)
+
+    records = [RECORD.unpack_from(data, off)
+               for off in range(0, len(data) - RECORD.size + 1, RECORD.size)]
+    return records, tick_hz, cpu_hz
+
+
+def percentile(sorted_values, pct):
+    if not sorted_values:
+        return 0
+    index = min(len(sorted_values) - 1, int(round(pct / 100.0 * (len(sorted_values) - 1))))
+    return sorted_values[index]
+
+
+def histogram(values, width=40):
+    buckets = {}
+    for v in values:
+        buckets[max(v, 1).bit_length() - 1] = buckets.get(max(v, 1).bit_length() - 1, 0) + 1
+    peak = max(buckets.values())
+    lines = []
+    for b in range(min(buckets), max(buckets) + 1):
+        n = buckets.get(b, 0)
+        lines.append("      %9d..%-9d %6d %s" % (1 << b, (2 << b) - 1, n, "#" * ((n * width + peak - 1) // peak)))
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input")
+    parser.add_argument("--cpu-hz", type=int, help="core clock, defaults to the dump header or 38400000")
+    parser.add_argument("--tick-hz", type=int, help="LETIMER0 tick rate, defaults to the dump header or 8192")
+    parser.add_argument("--timeline", help="write a CSV timeline to this file")
+    parser.add_argument("--no-histogram", action="store_true")
+    args = parser.parse_args()
+
+    records, tick_hz, cpu_hz = load(args.input)
+    cpu_hz = args.cpu_hz or cpu_hz or 38400000
+    tick_hz = args.tick_hz or tick_hz or 8192
+
+    if not records:
+        sys.exit("no trace records found")
+
+    # Sequence gaps mean the ring wrapped between reads or records were dropped
+    lost = sum((cur[3] - prev[3] - 1) & 0xFF for prev, cur in zip(records, records[1:]))
+
+    handlers = {}
+    for rtype, before, after, seq, rid, cycles, ts in records:
+        handlers.setdefault(handler_name(rtype, rid), []).append(cycles)
+
+    print("%d records, %d lost, cpu %d Hz, tick %d Hz" % (len(records), lost, cpu_hz, tick_hz))
+    print("%-44s %6s %9s %9s %9s %9s %10s" % ("handler", "count", "min us", "p50 us", "p95 us", "max us", "total us"))
+    us = lambda c: c * 1e6 / cpu_hz
+    for name, cycles in sorted(handlers.items(), key=lambda kv: -sum(kv[1])):
+        cycles.sort()
+        print("%-44s %6d %9.1f %9.1f %9.1f %9.1f %10.1f" % (
+            name, len(cycles), us(cycles[0]), us(percentile(cycles, 50)),
+            us(percentile(cycles, 95)), us(cycles[-1]), us(sum(cycles))))
+        if not args.no_histogram:
+            for line in histogram(cycles):
+                print(line)
+
+    if args.timeline:
+        with open(args.timeline, "w", newline="") as f:
+            writer = csv.writer(f)
+            writer.writerow(["seq", "time_us", "handler", "state_before", "state_after", "cycles", "duration_us"])
+            # Timestamps are the low 32 bits of the tick counter, unwrap them
+            base = records[0][6]
+            wraps = 0
+            last = base
+            for rtype, before, after, seq, rid, cycles, ts in records:
+                if ts < last and last - ts > 0x80000000:
+                    wraps += 1
+                last = ts
+                ticks = (wraps << 32) + ts - base
+                writer.writerow([seq, "%.1f" % (ticks * 1e6 / tick_hz), handler_name(rtype, rid),
+                                 before, after, cycles, "%.2f" % us(cycles)])
+
+
+if __name__ == "__main__":
+    main()